@@ -0,0 +1,95 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/**
+ * 主機版 Arduino 核心（native 建置）
+ * 只提供本專案用到的部分：Serial 輸出到 stdout、時間函數由可控時鐘提供（見 host_sim.h）
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <cmath>
+
+using std::min;
+using std::max;
+using std::abs;
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+#define IRAM_ATTR
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+/**
+ * 序列埠：輸出寫到 stdout，輸入來自 host_serial_feed()
+ */
+class HostSerial
+{
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    explicit operator bool() const { return true; }
+
+    int printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char *text);
+    size_t print(char c);
+    size_t print(int value) { return print((long)value); }
+    size_t print(unsigned int value) { return print((unsigned long)value); }
+    size_t print(long value);
+    size_t print(unsigned long value);
+    size_t print(double value, int digits = 2);
+    template <typename T>
+    size_t println(T value)
+    {
+        size_t n = print(value);
+        return n + println();
+    }
+    size_t println() { return print('\n'); }
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *data, size_t length);
+    size_t write(const char *text) { return print(text); }
+    void flush();
+
+    int available();
+    int read();
+    int peek();
+};
+
+extern HostSerial Serial;
+
+/**
+ * ESP 物件：週期計數以單調時鐘換算（假設 240 MHz）
+ */
+class HostEsp
+{
+public:
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getSketchSize() { return 0; }
+    uint32_t getFreeHeap() { return 320 * 1024; }
+    uint32_t getHeapSize() { return 320 * 1024; }
+    void restart() { exit(0); }
+};
+
+extern HostEsp ESP;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,6 @@
+#ifndef HOST_TENSORFLOWLITE_ESP32_H
+#define HOST_TENSORFLOWLITE_ESP32_H
+
+// 主機建置不連結 TensorFlow Lite；main.cpp 只引用此標頭、未使用其 API
+
+#endif // HOST_TENSORFLOWLITE_ESP32_H
@@ -0,0 +1,118 @@
+#ifndef HOST_DRIVER_I2S_H
+#define HOST_DRIVER_I2S_H
+
+/**
+ * 主機版 I2S 驅動（舊版 driver/i2s.h API，只支援 RX）
+ * 依可控時鐘以 sample_rate 產生資料，每填滿一個 DMA 緩衝區（dma_buf_len 個 frame）送出 RX_DONE 事件；
+ * 未讀取的緩衝區超過 dma_buf_count 個時丟棄最舊的一個並送出 RX_Q_OVF，與裝置上主迴圈過慢時相同。
+ * 資料來源由 host_sim.h 設定（檔案、合成訊號或回調，預設為靜音）
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+typedef enum
+{
+    I2S_NUM_0 = 0,
+    I2S_NUM_1 = 1,
+    I2S_NUM_MAX
+} i2s_port_t;
+
+typedef enum
+{
+    I2S_MODE_MASTER = (1 << 0),
+    I2S_MODE_SLAVE = (1 << 1),
+    I2S_MODE_TX = (1 << 2),
+    I2S_MODE_RX = (1 << 3)
+} i2s_mode_t;
+
+typedef enum
+{
+    I2S_BITS_PER_SAMPLE_8BIT = 8,
+    I2S_BITS_PER_SAMPLE_16BIT = 16,
+    I2S_BITS_PER_SAMPLE_24BIT = 24,
+    I2S_BITS_PER_SAMPLE_32BIT = 32
+} i2s_bits_per_sample_t;
+
+typedef enum
+{
+    I2S_CHANNEL_FMT_RIGHT_LEFT,
+    I2S_CHANNEL_FMT_ALL_RIGHT,
+    I2S_CHANNEL_FMT_ALL_LEFT,
+    I2S_CHANNEL_FMT_ONLY_RIGHT,
+    I2S_CHANNEL_FMT_ONLY_LEFT
+} i2s_channel_fmt_t;
+
+typedef enum
+{
+    I2S_COMM_FORMAT_STAND_I2S = 0x01,
+    I2S_COMM_FORMAT_STAND_MSB = 0x02
+} i2s_comm_format_t;
+
+typedef enum
+{
+    I2S_EVENT_DMA_ERROR,
+    I2S_EVENT_TX_DONE,
+    I2S_EVENT_RX_DONE,
+    I2S_EVENT_TX_Q_OVF,
+    I2S_EVENT_RX_Q_OVF,
+    I2S_EVENT_MAX
+} i2s_event_type_t;
+
+typedef struct
+{
+    i2s_event_type_t type;
+    size_t size;
+} i2s_event_t;
+
+#define ESP_INTR_FLAG_LEVEL1 (1 << 1)
+#define I2S_PIN_NO_CHANGE (-1)
+
+typedef struct
+{
+    i2s_mode_t mode;
+    uint32_t sample_rate;
+    i2s_bits_per_sample_t bits_per_sample;
+    i2s_channel_fmt_t channel_format;
+    i2s_comm_format_t communication_format;
+    int intr_alloc_flags;
+    int dma_buf_count;
+    int dma_buf_len;
+    bool use_apll;
+    bool tx_desc_auto_clear;
+    int fixed_mclk;
+} i2s_config_t;
+
+typedef struct
+{
+    int mck_io_num;
+    int bck_io_num;
+    int ws_io_num;
+    int data_out_num;
+    int data_in_num;
+} i2s_pin_config_t;
+
+/**
+ * 安裝驅動（開始產生資料）；queue_size > 0 且 i2s_queue 非 nullptr 時建立事件佇列
+ */
+esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t *config, int queue_size, void *i2s_queue);
+esp_err_t i2s_driver_uninstall(i2s_port_t port);
+esp_err_t i2s_set_pin(i2s_port_t port, const i2s_pin_config_t *pins);
+
+/**
+ * 清除尚未讀取的 DMA 緩衝區
+ */
+esp_err_t i2s_zero_dma_buffer(i2s_port_t port);
+
+/**
+ * 讀取已填滿的 DMA 緩衝區（以 frame 為單位，32-bit 槽位）
+ * 資料不足時：REALTIME 模式等待至逾時；SIMULATED 模式把時鐘推進到資料就緒（等於 CPU 閒置等待）。
+ * 非阻塞讀取（ticks_to_wait = 0）回傳現有的部分；SIMULATED 模式下完全沒有資料時把時鐘推進到
+ * 下一個緩衝區完成（相當於主迴圈空轉輪詢）但本次仍回傳 0。MANUAL 模式只回傳現有資料
+ */
+esp_err_t i2s_read(i2s_port_t port, void *dest, size_t size, size_t *bytes_read, TickType_t ticks_to_wait);
+
+#endif // HOST_DRIVER_I2S_H
@@ -0,0 +1,13 @@
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+#include <stdio.h>
+
+// 主機上 ESP_LOGE / ESP_LOGW 輸出到 stderr，其餘等級略過（與裝置預設等級相同）
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "E (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "W (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ((void)0)
+#define ESP_LOGD(tag, format, ...) ((void)0)
+#define ESP_LOGV(tag, format, ...) ((void)0)
+
+#endif // HOST_ESP_LOG_H
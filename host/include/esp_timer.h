@@ -0,0 +1,11 @@
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <stdint.h>
+
+/**
+ * 開機後的微秒數（與 micros() 同一個可控時鐘）
+ */
+int64_t esp_timer_get_time();
+
+#endif // HOST_ESP_TIMER_H
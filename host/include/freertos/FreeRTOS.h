@@ -0,0 +1,36 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+/**
+ * 主機版 FreeRTOS（以 std::thread 實作，見 host/src/host_freertos.cpp）
+ * tick 為 1 ms；主執行緒視為 Arduino loopTask（核心 1）
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define errQUEUE_EMPTY pdFALSE
+#define errQUEUE_FULL pdFALSE
+
+#define configTICK_RATE_HZ 1000
+#define configMAX_PRIORITIES 25
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((TickType_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define tskIDLE_PRIORITY 0
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+/**
+ * 目前執行緒的核心編號（建立任務時指定的核心；主執行緒為 1）
+ */
+BaseType_t xPortGetCoreID();
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,20 @@
+#ifndef HOST_FREERTOS_QUEUE_H
+#define HOST_FREERTOS_QUEUE_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct HostQueue *QueueHandle_t;
+
+/**
+ * 固定長度、以複製傳遞的佇列（mutex + condition_variable），等待時間以 tick（ms）計
+ */
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticks_to_wait);
+BaseType_t xQueueReset(QueueHandle_t queue);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#define xQueueSendToBack(queue, item, ticks) xQueueSend((queue), (item), (ticks))
+
+#endif // HOST_FREERTOS_QUEUE_H
@@ -0,0 +1,34 @@
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+typedef struct HostTask *TaskHandle_t;
+
+/**
+ * 每個任務一個 std::thread；優先權與堆疊大小只做記錄
+ */
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stack_depth, void *parameter,
+                                   UBaseType_t priority, TaskHandle_t *created_task, BaseType_t core_id);
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stack_depth, void *parameter,
+                       UBaseType_t priority, TaskHandle_t *created_task);
+
+/**
+ * 刪除任務：std::thread 無法強制終止，被刪除的任務在下一次 vTaskDelay / 佇列等待時結束，
+ * 呼叫端等待它結束才返回（nullptr 表示刪除自己，立即結束）
+ */
+void vTaskDelete(TaskHandle_t task);
+
+/**
+ * 延遲：主執行緒等同 delay()（依時鐘模式），其他任務實際睡眠
+ */
+void vTaskDelay(TickType_t ticks);
+
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+const char *pcTaskGetName(TaskHandle_t task);
+
+#define taskYIELD() vTaskDelay(0)
+
+#endif // HOST_FREERTOS_TASK_H
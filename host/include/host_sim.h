@@ -0,0 +1,90 @@
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * 主機模擬控制介面（只在 native 建置存在，韌體程式碼不需引用）
+ * 測試或工具用來控制時鐘、I2S 輸入來源與序列埠輸入
+ */
+
+// ========== 時鐘 ==========
+
+/**
+ * 時鐘模式
+ *   SIMULATED（預設）：單調時鐘 + 跳躍量。主執行緒的 delay() 與等待 I2S 資料只推進時間不睡眠，
+ *                      程式碼本身的執行時間照實計入，因此比即時快但耗時量測仍然有效
+ *   REALTIME：delay() 真的睡眠，I2S 依實際時間產生資料（觀察即時行為、搭配序列埠工具）
+ *   MANUAL：時間只由 delay() 與 host_clock_advance_us() 推進，不受執行速度影響（可重現的測試）
+ */
+enum HostClockMode
+{
+    HOST_CLOCK_SIMULATED = 0,
+    HOST_CLOCK_REALTIME,
+    HOST_CLOCK_MANUAL
+};
+
+void host_clock_set_mode(HostClockMode mode);
+HostClockMode host_clock_get_mode();
+
+/**
+ * 目前時間（微秒，程式啟動為 0；millis / micros / esp_timer_get_time 都由此而來）
+ */
+int64_t host_clock_now_us();
+
+/**
+ * 推進時間（REALTIME 模式下為實際睡眠）
+ */
+void host_clock_advance_us(int64_t us);
+
+// ========== I2S 輸入 ==========
+
+/**
+ * 樣本來源回調：填入 frames 個 frame（每個 frame channels 個 32-bit 槽位，
+ * 與 INMP441 相同為 24-bit 左對齊），回傳實際填入數，少於 frames 表示來源結束
+ */
+typedef size_t (*HostI2SSource)(int32_t *slots, size_t frames, uint8_t channels, void *context);
+
+/**
+ * 自訂來源（nullptr 恢復為靜音）
+ */
+void host_i2s_set_source(HostI2SSource source, void *context);
+
+/**
+ * 由檔案讀取：WAV（PCM 16/24/32-bit 或 32-bit float）或無標頭的 16-bit 單聲道 raw
+ * 單聲道檔案在立體聲擷取時複製到兩個聲道；取樣率不符時只警告、不重新取樣
+ */
+bool host_i2s_open_file(const char *path);
+
+/**
+ * 合成來源：正弦波 + 白雜訊（dBFS，低於 -120 視為關閉）
+ */
+void host_i2s_set_tone(float frequency, float tone_dbfs, float noise_dbfs);
+
+/**
+ * 來源是否已結束（之後以靜音補足，擷取端照常運作）
+ */
+bool host_i2s_finished();
+
+/**
+ * 累計產生的 frame 數與 DMA 溢位次數（含被丟棄的緩衝區）
+ */
+uint64_t host_i2s_frames_generated();
+uint32_t host_i2s_overflows();
+
+// ========== 序列埠輸入 ==========
+
+/**
+ * 加入序列埠輸入（之後由 Serial.available() / Serial.read() 取得）
+ */
+void host_serial_feed(const char *text);
+
+/**
+ * 序列埠輸出分接：設定後 Serial.write(data, length) 的位元組改交給 tap（不寫入 stdout），nullptr 恢復
+ * 測試用來檢查二進位輸出（追蹤傾印、日誌權杖）
+ */
+typedef void (*HostSerialTap)(const uint8_t *data, size_t length, void *context);
+void host_serial_set_tap(HostSerialTap tap, void *context);
+
+#endif // HOST_SIM_H
@@ -0,0 +1,255 @@
+#include <Arduino.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "host_sim.h"
+#include "host_internal.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// 全域實例
+HostSerial Serial;
+HostEsp ESP;
+
+// ========== 時鐘 ==========
+
+static std::atomic<int> clock_mode(HOST_CLOCK_SIMULATED);
+static std::atomic<int64_t> clock_offset_us(0); // SIMULATED / REALTIME：實際時間之外的跳躍量
+static std::atomic<int64_t> manual_now_us(0);   // MANUAL：目前時間
+
+// 函數內靜態變數：其他全域物件的建構函數可能先呼叫 millis()
+static std::chrono::steady_clock::time_point clock_origin()
+{
+    static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+    return origin;
+}
+
+static std::thread::id main_thread_id()
+{
+    static const std::thread::id id = std::this_thread::get_id();
+    return id;
+}
+
+// 靜態初始化在主執行緒上執行，於此固定時間原點與主執行緒
+static const bool clock_pinned = (clock_origin(), main_thread_id(), true);
+
+bool host_is_main_thread()
+{
+    return std::this_thread::get_id() == main_thread_id();
+}
+
+int64_t host_real_now_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - clock_origin())
+        .count();
+}
+
+void host_sleep_us(int64_t us)
+{
+    if (us > 0)
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+int64_t host_clock_now_us()
+{
+    if (clock_mode.load(std::memory_order_relaxed) == HOST_CLOCK_MANUAL)
+        return manual_now_us.load(std::memory_order_relaxed);
+    return host_real_now_us() + clock_offset_us.load(std::memory_order_relaxed);
+}
+
+/**
+ * 切換模式時保持時間連續（不會倒退）
+ */
+void host_clock_set_mode(HostClockMode mode)
+{
+    int64_t now = host_clock_now_us();
+    if (mode == HOST_CLOCK_MANUAL)
+        manual_now_us.store(now, std::memory_order_relaxed);
+    else
+        clock_offset_us.store(now - host_real_now_us(), std::memory_order_relaxed);
+    clock_mode.store(mode, std::memory_order_relaxed);
+}
+
+HostClockMode host_clock_get_mode()
+{
+    return (HostClockMode)clock_mode.load(std::memory_order_relaxed);
+}
+
+void host_clock_advance_us(int64_t us)
+{
+    if (us <= 0)
+        return;
+
+    switch (host_clock_get_mode())
+    {
+    case HOST_CLOCK_REALTIME:
+        host_sleep_us(us);
+        break;
+    case HOST_CLOCK_MANUAL:
+        manual_now_us.fetch_add(us, std::memory_order_relaxed);
+        break;
+    default:
+        clock_offset_us.fetch_add(us, std::memory_order_relaxed);
+        break;
+    }
+}
+
+unsigned long millis()
+{
+    return (unsigned long)(host_clock_now_us() / 1000);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)host_clock_now_us();
+}
+
+int64_t esp_timer_get_time()
+{
+    return host_clock_now_us();
+}
+
+void delay(unsigned long ms)
+{
+    if (host_is_main_thread())
+        host_clock_advance_us((int64_t)ms * 1000);
+    else
+        host_sleep_us((int64_t)ms * 1000);
+}
+
+/**
+ * 忙等待實際時間（測試以此製造固定的 CPU 耗時）；MANUAL 模式另外推進時鐘
+ */
+void delayMicroseconds(unsigned int us)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < std::chrono::microseconds(us))
+    {
+    }
+    if (host_clock_get_mode() == HOST_CLOCK_MANUAL && host_is_main_thread())
+        host_clock_advance_us(us);
+}
+
+void yield()
+{
+    std::this_thread::yield();
+}
+
+uint32_t HostEsp::getCycleCount()
+{
+    return (uint32_t)(host_real_now_us() * getCpuFreqMHz());
+}
+
+// ========== 序列埠 ==========
+
+static std::mutex serial_input_mutex;
+static std::deque<char> serial_input;
+static HostSerialTap serial_tap = nullptr; // 由測試主執行緒設定，輸出也在主執行緒
+static void *serial_tap_context = nullptr;
+
+void host_serial_feed(const char *text)
+{
+    std::lock_guard<std::mutex> lock(serial_input_mutex);
+    for (; *text; text++)
+        serial_input.push_back(*text);
+}
+
+int HostSerial::printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int length = vprintf(format, args);
+    va_end(args);
+    return length;
+}
+
+size_t HostSerial::print(const char *text)
+{
+    return fputs(text, stdout) >= 0 ? strlen(text) : 0;
+}
+
+size_t HostSerial::print(char c)
+{
+    return fputc(c, stdout) != EOF ? 1 : 0;
+}
+
+size_t HostSerial::print(long value)
+{
+    return (size_t)::printf("%ld", value);
+}
+
+size_t HostSerial::print(unsigned long value)
+{
+    return (size_t)::printf("%lu", value);
+}
+
+size_t HostSerial::print(double value, int digits)
+{
+    return (size_t)::printf("%.*f", digits, value);
+}
+
+size_t HostSerial::write(uint8_t c)
+{
+    return fputc(c, stdout) != EOF ? 1 : 0;
+}
+
+void host_serial_set_tap(HostSerialTap tap, void *context)
+{
+    serial_tap_context = context;
+    serial_tap = tap;
+}
+
+size_t HostSerial::write(const uint8_t *data, size_t length)
+{
+    if (serial_tap)
+    {
+        serial_tap(data, length, serial_tap_context);
+        return length;
+    }
+    return fwrite(data, 1, length, stdout);
+}
+
+void HostSerial::flush()
+{
+    fflush(stdout);
+}
+
+int HostSerial::available()
+{
+    std::lock_guard<std::mutex> lock(serial_input_mutex);
+    return (int)serial_input.size();
+}
+
+int HostSerial::read()
+{
+    std::lock_guard<std::mutex> lock(serial_input_mutex);
+    if (serial_input.empty())
+        return -1;
+    int c = (uint8_t)serial_input.front();
+    serial_input.pop_front();
+    return c;
+}
+
+int HostSerial::peek()
+{
+    std::lock_guard<std::mutex> lock(serial_input_mutex);
+    return serial_input.empty() ? -1 : (uint8_t)serial_input.front();
+}
+
+// ========== ESP-IDF ==========
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code)
+    {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    default: return "UNKNOWN ERROR";
+    }
+}
@@ -0,0 +1,296 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include <Arduino.h>
+#include "host_internal.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ========== 任務 ==========
+
+#define HOST_MAIN_CORE 1 // Arduino loopTask 執行於核心 1
+
+struct HostTask
+{
+    std::thread thread;
+    std::string name;
+    TaskFunction_t function;
+    void *parameter;
+    BaseType_t core;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool delete_requested;
+};
+
+/**
+ * 任務被刪除時由取消點拋出，於執行緒入口捕捉後結束
+ */
+struct HostTaskExit
+{
+};
+
+static thread_local HostTask *current_task = nullptr;
+
+/**
+ * 取消點：其他任務已要求刪除本任務時結束執行緒
+ */
+static void check_delete_requested()
+{
+    if (!current_task)
+        return;
+    std::lock_guard<std::mutex> lock(current_task->mutex);
+    if (current_task->delete_requested)
+        throw HostTaskExit();
+}
+
+static void task_entry(HostTask *task)
+{
+    current_task = task;
+    try
+    {
+        task->function(task->parameter);
+    }
+    catch (const HostTaskExit &)
+    {
+    }
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stack_depth, void *parameter,
+                                   UBaseType_t priority, TaskHandle_t *created_task, BaseType_t core_id)
+{
+    (void)stack_depth;
+    (void)priority;
+
+    HostTask *task = new HostTask();
+    task->name = name ? name : "";
+    task->function = function;
+    task->parameter = parameter;
+    task->core = (core_id == tskNO_AFFINITY) ? 0 : core_id;
+    task->delete_requested = false;
+    task->thread = std::thread(task_entry, task);
+
+    if (created_task)
+        *created_task = task;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stack_depth, void *parameter,
+                       UBaseType_t priority, TaskHandle_t *created_task)
+{
+    return xTaskCreatePinnedToCore(function, name, stack_depth, parameter, priority, created_task, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (!task || task == current_task)
+    {
+        // 刪除自己：分離執行緒後離開（HostTask 隨之洩漏，與 FreeRTOS 由 idle 任務回收相近）
+        if (!current_task)
+            return; // 主執行緒不可刪除
+        current_task->thread.detach();
+        throw HostTaskExit();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->delete_requested = true;
+    }
+    task->wake.notify_all();
+    if (task->thread.joinable())
+        task->thread.join();
+    delete task;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    if (!current_task)
+    {
+        // 主執行緒：依時鐘模式推進（SIMULATED / MANUAL 不睡眠）
+        if (ticks)
+            delay(ticks * portTICK_PERIOD_MS);
+        else
+            yield();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(current_task->mutex);
+    current_task->wake.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS),
+                                [] { return current_task->delete_requested; });
+    if (current_task->delete_requested)
+        throw HostTaskExit();
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return (TickType_t)(millis() / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return current_task;
+}
+
+const char *pcTaskGetName(TaskHandle_t task)
+{
+    if (!task)
+        task = current_task;
+    return task ? task->name.c_str() : "loopTask";
+}
+
+BaseType_t xPortGetCoreID()
+{
+    return current_task ? current_task->core : HOST_MAIN_CORE;
+}
+
+// ========== 佇列 ==========
+
+struct HostQueue
+{
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::vector<uint8_t>> items;
+    size_t length;
+    size_t item_size;
+    void (*catch_up)(void *);
+    void *producer;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    if (length == 0)
+        return nullptr;
+
+    HostQueue *queue = new HostQueue();
+    queue->length = length;
+    queue->item_size = item_size;
+    queue->catch_up = nullptr;
+    queue->producer = nullptr;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    delete queue;
+}
+
+/**
+ * 等待條件成立，逾時回傳 false（portMAX_DELAY 表示無限等待）；
+ * 任務等待期間會被刪除請求喚醒
+ */
+template <typename Predicate>
+static bool wait_queue(HostQueue *queue, std::unique_lock<std::mutex> &lock, TickType_t ticks, Predicate ready)
+{
+    if (ready())
+        return true;
+    if (ticks == 0)
+        return false;
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ticks * portTICK_PERIOD_MS);
+    while (!ready())
+    {
+        // 分段等待以便檢查刪除請求
+        auto step = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+        if (ticks != portMAX_DELAY && deadline < step)
+            step = deadline;
+        queue->changed.wait_until(lock, step);
+
+        lock.unlock();
+        check_delete_requested();
+        lock.lock();
+
+        if (ticks != portMAX_DELAY && std::chrono::steady_clock::now() >= deadline)
+            return ready();
+    }
+    return true;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait)
+{
+    if (!queue)
+        return errQUEUE_FULL;
+
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!wait_queue(queue, lock, ticks_to_wait, [queue] { return queue->items.size() < queue->length; }))
+        return errQUEUE_FULL;
+
+    const uint8_t *bytes = (const uint8_t *)item;
+    queue->items.push_back(std::vector<uint8_t>(bytes, bytes + queue->item_size));
+    lock.unlock();
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+void host_queue_set_producer(QueueHandle_t queue, void (*catch_up)(void *), void *context)
+{
+    queue->catch_up = catch_up;
+    queue->producer = context;
+}
+
+/**
+ * 讓生產端先補上進度（不持有佇列的鎖，生產端寫入時自行上鎖）
+ */
+static void catch_up_producer(HostQueue *queue)
+{
+    if (queue->catch_up)
+        queue->catch_up(queue->producer);
+}
+
+void host_queue_overwrite_oldest(QueueHandle_t queue, const void *item)
+{
+    if (!queue)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (queue->items.size() >= queue->length)
+            queue->items.pop_front();
+        const uint8_t *bytes = (const uint8_t *)item;
+        queue->items.push_back(std::vector<uint8_t>(bytes, bytes + queue->item_size));
+    }
+    queue->changed.notify_all();
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticks_to_wait)
+{
+    if (!queue)
+        return errQUEUE_EMPTY;
+
+    catch_up_producer(queue);
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!wait_queue(queue, lock, ticks_to_wait, [queue] { return !queue->items.empty(); }))
+        return errQUEUE_EMPTY;
+
+    memcpy(buffer, queue->items.front().data(), queue->item_size);
+    queue->items.pop_front();
+    lock.unlock();
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+    if (!queue)
+        return pdPASS;
+
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->items.clear();
+    }
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    if (!queue)
+        return 0;
+    catch_up_producer(queue);
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return (UBaseType_t)queue->items.size();
+}
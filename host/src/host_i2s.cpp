@@ -0,0 +1,510 @@
+#include "driver/i2s.h"
+#include "host_sim.h"
+#include "host_internal.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+// ========== 資料來源 ==========
+
+enum HostSourceKind
+{
+    HOST_SOURCE_SILENCE,
+    HOST_SOURCE_CALLBACK,
+    HOST_SOURCE_FILE,
+    HOST_SOURCE_TONE
+};
+
+struct HostSourceState
+{
+    HostSourceKind kind;
+    HostI2SSource callback;
+    void *context;
+
+    std::vector<int32_t> file_slots; // 左對齊 32-bit，依檔案聲道數交錯
+    uint8_t file_channels;
+    uint32_t file_rate;              // 0 = 未知（raw）
+    size_t file_position;            // frame
+
+    float tone_frequency;
+    float tone_amplitude;            // 32-bit 滿刻度的比例
+    float noise_amplitude;           // 均勻分布半寬（同上）
+    double tone_phase;
+    uint32_t noise_state;
+
+    bool finished;
+    uint64_t frames_generated;
+    uint32_t overflows;
+};
+
+static std::mutex i2s_mutex;
+static HostSourceState source = {HOST_SOURCE_SILENCE, nullptr, nullptr, {}, 1, 0, 0, 0.0f, 0.0f, 0.0f, 0.0, 1u, false, 0, 0};
+
+static int32_t clamp_slot(double value)
+{
+    if (value >= 2147483647.0)
+        return INT32_MAX;
+    if (value <= -2147483648.0)
+        return INT32_MIN;
+    return (int32_t)value;
+}
+
+/**
+ * xorshift32，產生 [-1, 1) 的均勻分布
+ */
+static float next_noise()
+{
+    uint32_t x = source.noise_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    source.noise_state = x;
+    return (float)((int32_t)x) / 2147483648.0f;
+}
+
+static void generate(int32_t *slots, size_t frames, uint8_t channels, uint32_t sample_rate)
+{
+    size_t produced = 0;
+
+    switch (source.kind)
+    {
+    case HOST_SOURCE_CALLBACK:
+        if (!source.finished)
+        {
+            produced = source.callback(slots, frames, channels, source.context);
+            source.finished = produced < frames;
+        }
+        break;
+
+    case HOST_SOURCE_FILE:
+        for (; produced < frames && source.file_position < source.file_slots.size() / source.file_channels; produced++)
+        {
+            const int32_t *frame = &source.file_slots[source.file_position++ * source.file_channels];
+            for (uint8_t ch = 0; ch < channels; ch++)
+                slots[produced * channels + ch] = frame[std::min((uint8_t)(source.file_channels - 1), ch)];
+        }
+        source.finished = produced < frames;
+        break;
+
+    case HOST_SOURCE_TONE:
+    {
+        double step = 2.0 * M_PI * source.tone_frequency / sample_rate;
+        for (; produced < frames; produced++)
+        {
+            double value = source.tone_amplitude * sin(source.tone_phase);
+            if (source.noise_amplitude > 0.0f)
+                value += source.noise_amplitude * next_noise();
+            source.tone_phase = fmod(source.tone_phase + step, 2.0 * M_PI);
+            int32_t slot = clamp_slot(value * 2147483648.0);
+            for (uint8_t ch = 0; ch < channels; ch++)
+                slots[produced * channels + ch] = slot;
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    // 來源結束或靜音時以 0 補足
+    memset(slots + produced * channels, 0, (frames - produced) * channels * sizeof(int32_t));
+    source.frames_generated += frames;
+}
+
+static void reset_source(HostSourceKind kind)
+{
+    source.kind = kind;
+    source.finished = false;
+    source.file_slots.clear();
+    source.file_channels = 1;
+    source.file_rate = 0;
+    source.file_position = 0;
+}
+
+void host_i2s_set_source(HostI2SSource callback, void *context)
+{
+    std::lock_guard<std::mutex> lock(i2s_mutex);
+    reset_source(callback ? HOST_SOURCE_CALLBACK : HOST_SOURCE_SILENCE);
+    source.callback = callback;
+    source.context = context;
+}
+
+void host_i2s_set_tone(float frequency, float tone_dbfs, float noise_dbfs)
+{
+    std::lock_guard<std::mutex> lock(i2s_mutex);
+    reset_source(HOST_SOURCE_TONE);
+    source.tone_frequency = frequency;
+    source.tone_amplitude = (tone_dbfs > -120.0f) ? powf(10.0f, tone_dbfs / 20.0f) : 0.0f;
+    // 均勻分布 RMS = 半寬 / √3
+    source.noise_amplitude = (noise_dbfs > -120.0f) ? powf(10.0f, noise_dbfs / 20.0f) * sqrtf(3.0f) : 0.0f;
+    source.tone_phase = 0.0;
+    source.noise_state = 0x12345678u;
+}
+
+bool host_i2s_finished()
+{
+    std::lock_guard<std::mutex> lock(i2s_mutex);
+    return source.finished;
+}
+
+uint64_t host_i2s_frames_generated()
+{
+    std::lock_guard<std::mutex> lock(i2s_mutex);
+    return source.frames_generated;
+}
+
+uint32_t host_i2s_overflows()
+{
+    std::lock_guard<std::mutex> lock(i2s_mutex);
+    return source.overflows;
+}
+
+// ========== 檔案 ==========
+
+static uint32_t read_le(const uint8_t *data, int bytes)
+{
+    uint32_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--)
+        value = (value << 8) | data[i];
+    return value;
+}
+
+/**
+ * WAV 樣本轉為 32-bit 左對齊（與 INMP441 的 I2S 槽位相同）
+ */
+static int32_t wav_sample_to_slot(const uint8_t *data, uint16_t format, uint16_t bits)
+{
+    if (format == 3 && bits == 32)
+    {
+        float value;
+        memcpy(&value, data, sizeof(value));
+        return clamp_slot((double)value * 2147483648.0);
+    }
+    switch (bits)
+    {
+    case 8: return ((int32_t)data[0] - 128) << 24;
+    case 16: return (int32_t)(read_le(data, 2) << 16);
+    case 24: return (int32_t)(read_le(data, 3) << 8);
+    default: return (int32_t)read_le(data, 4);
+    }
+}
+
+static bool parse_wav(const std::vector<uint8_t> &file)
+{
+    if (file.size() < 12 || memcmp(file.data(), "RIFF", 4) != 0 || memcmp(file.data() + 8, "WAVE", 4) != 0)
+        return false;
+
+    uint16_t format = 0, channels = 0, bits = 0;
+    uint32_t rate = 0;
+    size_t pos = 12;
+    while (pos + 8 <= file.size())
+    {
+        uint32_t chunk_size = read_le(&file[pos + 4], 4);
+        const uint8_t *chunk = &file[pos + 8];
+        size_t available = std::min((size_t)chunk_size, file.size() - pos - 8);
+
+        if (memcmp(&file[pos], "fmt ", 4) == 0 && available >= 16)
+        {
+            format = (uint16_t)read_le(chunk, 2);
+            channels = (uint16_t)read_le(chunk + 2, 2);
+            rate = read_le(chunk + 4, 4);
+            bits = (uint16_t)read_le(chunk + 14, 2);
+            if (format == 0xFFFE && available >= 26)
+                format = (uint16_t)read_le(chunk + 24, 2); // WAVE_FORMAT_EXTENSIBLE 的子格式
+        }
+        else if (memcmp(&file[pos], "data", 4) == 0)
+        {
+            if ((format != 1 && format != 3) || channels == 0 || (bits != 8 && bits != 16 && bits != 24 && bits != 32))
+            {
+                fprintf(stderr, "host_i2s: 不支援的 WAV 格式（format %u, %u-bit）\n", format, bits);
+                return false;
+            }
+            size_t frame_bytes = (size_t)channels * bits / 8;
+            size_t frames = available / frame_bytes;
+            source.file_slots.resize(frames * channels);
+            for (size_t k = 0; k < frames * channels; k++)
+                source.file_slots[k] = wav_sample_to_slot(chunk + k * (bits / 8), format, bits);
+            source.file_channels = (uint8_t)std::min((uint16_t)255, channels);
+            source.file_rate = rate;
+            return true;
+        }
+        pos += 8 + chunk_size + (chunk_size & 1);
+    }
+    return false;
+}
+
+bool host_i2s_open_file(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "host_i2s: 無法開啟 %s\n", path);
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        data.insert(data.end(), chunk, chunk + n);
+    fclose(file);
+
+    std::lock_guard<std::mutex> lock(i2s_mutex);
+    reset_source(HOST_SOURCE_FILE);
+    if (data.size() >= 12 && memcmp(data.data(), "RIFF", 4) == 0)
+    {
+        if (!parse_wav(data))
+        {
+            reset_source(HOST_SOURCE_SILENCE);
+            return false;
+        }
+    }
+    else
+    {
+        // 無標頭：16-bit 單聲道，取樣率視為與擷取相同
+        source.file_slots.resize(data.size() / 2);
+        for (size_t k = 0; k < source.file_slots.size(); k++)
+            source.file_slots[k] = (int32_t)(read_le(&data[k * 2], 2) << 16);
+    }
+    return true;
+}
+
+// ========== 驅動 ==========
+
+struct HostI2SPort
+{
+    bool installed;
+    uint32_t sample_rate;
+    uint8_t channels;
+    uint8_t slot_bytes;         // 16-bit 設定時每個槽位 2 bytes，其餘 4 bytes
+    uint32_t buf_len;           // 每個 DMA 緩衝區的 frame 數
+    uint32_t buf_count;
+    int64_t start_us;
+    uint64_t buffers_done;      // 安裝後已填滿的緩衝區數
+    std::vector<int32_t> ring;  // 已填滿、尚未讀取的槽位
+    size_t ring_head;
+    size_t ring_count;
+    QueueHandle_t queue;
+};
+
+static HostI2SPort ports[I2S_NUM_MAX];
+
+static void warn_rate_mismatch(const HostI2SPort &port)
+{
+    if (source.kind == HOST_SOURCE_FILE && source.file_rate && source.file_rate != port.sample_rate)
+        fprintf(stderr, "host_i2s: 檔案取樣率 %u Hz 與擷取 %u Hz 不同，未重新取樣\n", source.file_rate, port.sample_rate);
+}
+
+static void post_event(HostI2SPort &port, i2s_event_type_t type, size_t size)
+{
+    i2s_event_t event;
+    event.type = type;
+    event.size = size;
+    host_queue_overwrite_oldest(port.queue, &event);
+}
+
+/**
+ * 第 index 個緩衝區填滿的時間
+ */
+static int64_t buffer_done_us(const HostI2SPort &port, uint64_t index)
+{
+    return port.start_us + (int64_t)((index * port.buf_len * 1000000ULL + port.sample_rate - 1) / port.sample_rate);
+}
+
+/**
+ * 依目前時間補上已填滿的緩衝區；滿時丟棄最舊的緩衝區（RX_Q_OVF）
+ */
+static void update_port(HostI2SPort &port)
+{
+    int64_t elapsed_us = host_clock_now_us() - port.start_us;
+    if (elapsed_us <= 0)
+        return;
+
+    uint64_t target = (uint64_t)elapsed_us * port.sample_rate / (1000000ULL * port.buf_len);
+    size_t buf_slots = (size_t)port.buf_len * port.channels;
+    std::vector<int32_t> block(buf_slots);
+
+    for (; port.buffers_done < target; port.buffers_done++)
+    {
+        generate(block.data(), port.buf_len, port.channels, port.sample_rate);
+
+        if (port.ring_count + buf_slots > port.ring.size())
+        {
+            port.ring_head = (port.ring_head + buf_slots) % port.ring.size();
+            port.ring_count -= buf_slots;
+            source.overflows++;
+            post_event(port, I2S_EVENT_RX_Q_OVF, buf_slots * port.slot_bytes);
+        }
+        size_t tail = (port.ring_head + port.ring_count) % port.ring.size();
+        for (size_t k = 0; k < buf_slots; k++)
+            port.ring[(tail + k) % port.ring.size()] = block[k];
+        port.ring_count += buf_slots;
+        post_event(port, I2S_EVENT_RX_DONE, buf_slots * port.slot_bytes);
+    }
+}
+
+/**
+ * 事件佇列被讀取前補上已填滿的緩衝區（相當於 DMA 中斷已在背景發生）
+ */
+static void catch_up_port(void *context)
+{
+    std::lock_guard<std::mutex> lock(i2s_mutex);
+    HostI2SPort &port = *(HostI2SPort *)context;
+    if (port.installed)
+        update_port(port);
+}
+
+esp_err_t i2s_driver_install(i2s_port_t port_num, const i2s_config_t *config, int queue_size, void *i2s_queue)
+{
+    if (port_num >= I2S_NUM_MAX || !config || config->sample_rate == 0 || config->dma_buf_len <= 0 ||
+        config->dma_buf_count <= 0)
+        return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(i2s_mutex);
+    HostI2SPort &port = ports[port_num];
+    if (port.installed)
+        return ESP_ERR_INVALID_STATE;
+
+    port.sample_rate = config->sample_rate;
+    port.channels = (config->channel_format == I2S_CHANNEL_FMT_RIGHT_LEFT) ? 2 : 1;
+    port.slot_bytes = (config->bits_per_sample == I2S_BITS_PER_SAMPLE_16BIT) ? 2 : 4;
+    port.buf_len = config->dma_buf_len;
+    port.buf_count = config->dma_buf_count;
+    port.start_us = host_clock_now_us();
+    port.buffers_done = 0;
+    port.ring.assign((size_t)port.buf_len * port.buf_count * port.channels, 0);
+    port.ring_head = 0;
+    port.ring_count = 0;
+    port.queue = nullptr;
+    if (queue_size > 0 && i2s_queue)
+    {
+        port.queue = xQueueCreate(queue_size, sizeof(i2s_event_t));
+        host_queue_set_producer(port.queue, catch_up_port, &port);
+        *(QueueHandle_t *)i2s_queue = port.queue;
+    }
+    port.installed = true;
+    warn_rate_mismatch(port);
+    return ESP_OK;
+}
+
+esp_err_t i2s_driver_uninstall(i2s_port_t port_num)
+{
+    if (port_num >= I2S_NUM_MAX)
+        return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(i2s_mutex);
+    HostI2SPort &port = ports[port_num];
+    if (!port.installed)
+        return ESP_ERR_INVALID_STATE;
+
+    vQueueDelete(port.queue);
+    port.queue = nullptr;
+    port.ring.clear();
+    port.installed = false;
+    return ESP_OK;
+}
+
+esp_err_t i2s_set_pin(i2s_port_t port_num, const i2s_pin_config_t *pins)
+{
+    (void)pins;
+    if (port_num >= I2S_NUM_MAX)
+        return ESP_ERR_INVALID_ARG;
+    return ports[port_num].installed ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t i2s_zero_dma_buffer(i2s_port_t port_num)
+{
+    if (port_num >= I2S_NUM_MAX)
+        return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(i2s_mutex);
+    HostI2SPort &port = ports[port_num];
+    if (!port.installed)
+        return ESP_ERR_INVALID_STATE;
+
+    update_port(port);
+    port.ring_head = 0;
+    port.ring_count = 0;
+    return ESP_OK;
+}
+
+/**
+ * 從環形緩衝區取出最多 frames 個 frame 到 dest（依槽位大小寫入），回傳取出數
+ */
+static size_t take_frames(HostI2SPort &port, uint8_t *dest, size_t frames)
+{
+    size_t count = std::min(frames, port.ring_count / port.channels);
+    size_t slots = count * port.channels;
+    for (size_t k = 0; k < slots; k++)
+    {
+        int32_t slot = port.ring[(port.ring_head + k) % port.ring.size()];
+        if (port.slot_bytes == 2)
+        {
+            int16_t value = (int16_t)(slot >> 16);
+            memcpy(dest + k * 2, &value, 2);
+        }
+        else
+        {
+            memcpy(dest + k * 4, &slot, 4);
+        }
+    }
+    port.ring_head = (port.ring_head + slots) % port.ring.size();
+    port.ring_count -= slots;
+    return count;
+}
+
+esp_err_t i2s_read(i2s_port_t port_num, void *dest, size_t size, size_t *bytes_read, TickType_t ticks_to_wait)
+{
+    if (bytes_read)
+        *bytes_read = 0;
+    if (port_num >= I2S_NUM_MAX || !dest || !bytes_read)
+        return ESP_ERR_INVALID_ARG;
+
+    std::unique_lock<std::mutex> lock(i2s_mutex);
+    HostI2SPort &port = ports[port_num];
+    if (!port.installed)
+        return ESP_ERR_INVALID_STATE;
+
+    size_t frame_bytes = (size_t)port.channels * port.slot_bytes;
+    size_t wanted = size / frame_bytes;
+    HostClockMode mode = host_clock_get_mode();
+    int64_t deadline = (ticks_to_wait == portMAX_DELAY)
+                           ? INT64_MAX
+                           : host_clock_now_us() + (int64_t)ticks_to_wait * portTICK_PERIOD_MS * 1000;
+
+    update_port(port);
+    size_t copied = take_frames(port, (uint8_t *)dest, wanted);
+
+    if (copied == 0 && ticks_to_wait == 0 && mode == HOST_CLOCK_SIMULATED)
+    {
+        // 空轉輪詢：直接跳到下一個緩衝區完成
+        host_clock_advance_us(buffer_done_us(port, port.buffers_done + 1) - host_clock_now_us());
+    }
+
+    // 阻塞讀取：每次等到下一個緩衝區完成（MANUAL 模式時間不會自行前進，不等待）
+    while (copied < wanted && ticks_to_wait > 0 && mode != HOST_CLOCK_MANUAL)
+    {
+        int64_t next = buffer_done_us(port, port.buffers_done + 1);
+        if (next > deadline)
+            break;
+
+        int64_t wait = next - host_clock_now_us();
+        if (mode == HOST_CLOCK_REALTIME)
+        {
+            lock.unlock();
+            host_sleep_us(wait);
+            lock.lock();
+        }
+        else
+        {
+            host_clock_advance_us(wait);
+        }
+        update_port(port);
+        copied += take_frames(port, (uint8_t *)dest + copied * frame_bytes, wanted - copied);
+    }
+
+    *bytes_read = copied * frame_bytes;
+    return (copied < wanted && ticks_to_wait > 0 && ticks_to_wait != portMAX_DELAY) ? ESP_ERR_TIMEOUT : ESP_OK;
+}
@@ -0,0 +1,35 @@
+#ifndef HOST_INTERNAL_H
+#define HOST_INTERNAL_H
+
+#include <stdint.h>
+#include "freertos/queue.h"
+
+// 主機模擬層內部共用（不對韌體程式碼公開）
+
+/**
+ * 是否為主執行緒（Arduino loopTask）；時鐘只由主執行緒推進，其他任務實際睡眠
+ */
+bool host_is_main_thread();
+
+/**
+ * 實際經過的單調時間（微秒），不受時鐘模式影響
+ */
+int64_t host_real_now_us();
+
+/**
+ * 實際睡眠（供非主執行緒的任務使用）
+ */
+void host_sleep_us(int64_t us);
+
+/**
+ * 模擬中斷端寫入佇列：佇列滿時丟棄最舊的項目（I2S 驅動處理事件佇列的方式）
+ */
+void host_queue_overwrite_oldest(QueueHandle_t queue, const void *item);
+
+/**
+ * 佇列的生產端補上進度：每次讀取或查詢佇列前先呼叫 catch_up，
+ * 由中斷產生的事件（例如 I2S DMA 完成）因此在消費端查看時才依目前時鐘補齊
+ */
+void host_queue_set_producer(QueueHandle_t queue, void (*catch_up)(void *), void *context);
+
+#endif // HOST_INTERNAL_H
@@ -0,0 +1,127 @@
+/**
+ * 主機版進入點：與 Arduino 核心相同先呼叫 setup()，再重複呼叫 loop()
+ *
+ * 用法:
+ *   edge_command [--run-ms N] [--i2s FILE | --tone HZ[,DBFS[,NOISE_DBFS]]] [--clock simulated|realtime|manual]
+ *                [--serial MS:TEXT]...
+ *
+ *   --run-ms N       setup() 之後執行 loop() 直到時鐘經過 N ms（未指定時：有 --i2s 則播放到檔案結束，否則只執行 setup()）
+ *   --i2s FILE       I2S 輸入改為 WAV / raw 檔案
+ *   --tone ...       I2S 輸入改為正弦波（+ 白雜訊）
+ *   --clock MODE     時鐘模式（見 host_sim.h，預設 simulated）
+ *   --serial MS:TEXT 於 MS 毫秒時送出序列埠輸入（例如 --serial 5000:t 傾印追蹤）
+ */
+
+#include <Arduino.h>
+#include "host_sim.h"
+#include "async_log.h"
+#include <string>
+#include <vector>
+
+void setup();
+void loop();
+
+struct SerialInput
+{
+    unsigned long at_ms;
+    std::string text;
+};
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "用法: %s [--run-ms N] [--i2s FILE | --tone HZ[,DBFS[,NOISE_DBFS]]] "
+            "[--clock simulated|realtime|manual] [--serial MS:TEXT]...\n",
+            program);
+}
+
+int main(int argc, char **argv)
+{
+    long run_ms = -1;
+    bool play_file = false;
+    std::vector<SerialInput> inputs;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (arg == "--help" || arg == "-h")
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        if (!value)
+        {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+
+        if (arg == "--run-ms")
+        {
+            run_ms = atol(value);
+        }
+        else if (arg == "--i2s")
+        {
+            if (!host_i2s_open_file(value))
+                return 1;
+            play_file = true;
+        }
+        else if (arg == "--tone")
+        {
+            float frequency = 1000.0f, tone_dbfs = -20.0f, noise_dbfs = -200.0f;
+            sscanf(value, "%f,%f,%f", &frequency, &tone_dbfs, &noise_dbfs);
+            host_i2s_set_tone(frequency, tone_dbfs, noise_dbfs);
+        }
+        else if (arg == "--clock")
+        {
+            std::string mode = value;
+            if (mode == "realtime")
+                host_clock_set_mode(HOST_CLOCK_REALTIME);
+            else if (mode == "manual")
+                host_clock_set_mode(HOST_CLOCK_MANUAL);
+            else
+                host_clock_set_mode(HOST_CLOCK_SIMULATED);
+        }
+        else if (arg == "--serial")
+        {
+            std::string spec = value;
+            size_t colon = spec.find(':');
+            SerialInput input;
+            input.at_ms = (colon == std::string::npos) ? 0 : strtoul(spec.c_str(), nullptr, 10);
+            input.text = (colon == std::string::npos) ? spec : spec.substr(colon + 1);
+            inputs.push_back(input);
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    setup();
+
+    // MANUAL 模式下 loop() 不會自行推進時間，--run-ms 只適用於會呼叫 delay() 的程式
+    unsigned long start_ms = millis();
+    while (run_ms > 0 ? (long)(millis() - start_ms) < run_ms : (play_file && !host_i2s_finished()))
+    {
+        for (size_t k = 0; k < inputs.size(); k++)
+        {
+            if (!inputs[k].text.empty() && millis() - start_ms >= inputs[k].at_ms)
+            {
+                host_serial_feed(inputs[k].text.c_str());
+                inputs[k].text.clear();
+            }
+        }
+
+        loop();
+
+        // 主機上沒有輸出任務，由主迴圈代為輸出非同步日誌
+        async_log.drain();
+    }
+
+    async_log.flush();
+    Serial.flush();
+    return 0;
+}
@@ -0,0 +1,111 @@
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "debug_print.h"
+
+// 非同步日誌配置
+#ifndef ASYNC_LOG_ENABLED
+#define ASYNC_LOG_ENABLED 1 // 0 = DebugPrint 一律同步寫入 Serial
+#endif
+#define ASYNC_LOG_SLOTS 32           // 環形緩衝區筆數（必須是 2 的冪次）
+#define ASYNC_LOG_RECORD_SIZE 256    // 每筆最長位元組數（含換行），過長截斷
+#define ASYNC_LOG_TASK_STACK 3072    // 輸出任務堆疊大小
+#define ASYNC_LOG_TASK_PRIORITY 1    // 低優先權
+#define ASYNC_LOG_TASK_CORE 0        // 與 loop()（核心 1）分開，輸出不搶音訊處理的 CPU
+#define ASYNC_LOG_DRAIN_INTERVAL_MS 10
+
+/**
+ * 非同步日誌
+ * 生產者把已格式化的整行訊息寫入無鎖環形緩衝區（多生產者、單消費者），
+ * 低優先權任務再輸出到 Serial；緩衝區滿時丟棄並計數，永不阻塞呼叫端。
+ * begin() 之前（或 ASYNC_LOG_ENABLED=0）維持同步輸出
+ */
+class AsyncLog
+{
+public:
+    struct AsyncLogStats
+    {
+        uint32_t written;    // 成功寫入的筆數
+        uint32_t dropped;    // 緩衝區滿而丟棄的筆數
+        uint32_t truncated;  // 超過 ASYNC_LOG_RECORD_SIZE 而截斷的筆數
+        uint32_t drained;    // 已輸出的筆數
+        uint32_t max_depth;  // 緩衝區最高使用筆數
+        uint32_t bytes;      // 送往 Serial 的位元組數（含同步輸出）
+        uint32_t elapsed_ms; // 統計期間（計算每秒位元組數）
+    };
+
+private:
+    struct Slot
+    {
+        std::atomic<uint32_t> sequence; // 等於寫入位置表示可寫，等於位置 + 1 表示可讀
+        uint16_t length;
+        char text[ASYNC_LOG_RECORD_SIZE];
+    };
+
+    Slot slots[ASYNC_LOG_SLOTS];
+    std::atomic<uint32_t> enqueue_pos;
+    uint32_t dequeue_pos;              // 只有消費者修改
+    std::atomic<bool> drain_busy;      // 保證同一時間只有一個消費者
+    std::atomic<bool> running;
+    std::atomic<bool> stop_requested;  // end() 要求輸出任務結束
+    std::atomic<bool> task_alive;      // 輸出任務自行結束前清除
+    void *task_handle;
+
+    std::atomic<uint32_t> written;
+    std::atomic<uint32_t> dropped;
+    std::atomic<uint32_t> truncated;
+    std::atomic<uint32_t> max_depth;
+    std::atomic<uint32_t> bytes;
+    uint32_t drained;
+    uint32_t reported_dropped;         // 已提示過的遺失筆數
+    uint32_t stats_since_ms;           // 統計起點
+
+    void report_drops();
+#if defined(ESP_PLATFORM)
+    static void drain_task(void *arg);
+#endif
+
+public:
+    AsyncLog();
+
+    /**
+     * 啟用非同步輸出（裝置上建立輸出任務；主機上需自行呼叫 drain()）
+     */
+    bool begin();
+
+    /**
+     * 停止輸出任務並輸出剩餘訊息，之後恢復同步輸出
+     */
+    void end();
+
+    bool is_running() const { return running.load(std::memory_order_relaxed); }
+
+    /**
+     * 寫入一行（不阻塞）
+     * @return false 表示緩衝區已滿、訊息被丟棄
+     */
+    bool write(const char *text, size_t length);
+
+    /**
+     * 輸出最多 max_records 筆（由輸出任務或主機測試呼叫）
+     * @return 實際輸出筆數
+     */
+    size_t drain(size_t max_records = ASYNC_LOG_SLOTS);
+
+    /**
+     * 輸出所有剩餘訊息（例如重啟前）
+     */
+    void flush();
+
+    size_t pending() const;
+    AsyncLogStats get_stats() const;
+    void reset_stats();
+    void print_stats(const DebugPrint &out) const;
+};
+
+// 全域實例
+extern AsyncLog async_log;
+
+#endif // ASYNC_LOG_H
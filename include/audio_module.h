@@ -4,6 +4,15 @@
 #include <Arduino.h>
 #include <functional>
 #include "inmp441_module.h"
+#include "gmm_vad.h"
+#include "energy_gate.h"
+#include "spectral_features.h"
+#include "mfcc.h"
+#include "cmvn.h"
+#include "noise_suppression.h"
+#include "deadline_monitor.h"
+#include "load_governor.h"
+#include "metrics.h"
 #include "debug_print.h"
 
 // 音訊處理配置常數
@@ -12,6 +21,7 @@
 
 #define AUDIO_FRAME_SIZE 256            // 每幀音頻樣本數
 #define AUDIO_FRAME_OVERLAP 128         // 幀重疊樣本數
+#define AUDIO_FRAME_HOP (AUDIO_FRAME_SIZE - AUDIO_FRAME_OVERLAP) // 每幀新進樣本數
 #define AUDIO_MAX_AMPLITUDE 32767       // 16-bit 最大振幅
 #define AUDIO_NORMALIZATION_FACTOR 0.8f // 正規化係數
 
@@ -24,13 +34,29 @@
 
 #define SPEECH_BUFFER_SIZE 16384  // 語音緩衝區大小
 
+// 兩段式處理配置
+#define AUDIO_PREROLL_FRAMES 6    // 閘門關閉時保留的歷史幀數（閘門開啟時補算）
+#define AUDIO_GATE_REFRESH_HOPS 8 // 閘門關閉時每隔幾個 hop 仍完整處理一幀，讓 GMM 噪音模型、噪音抑制與 CMVN 持續追蹤背景
+
+// 8kHz 低功耗模式（需 48kHz 過取樣擷取）：閒置時只跑能量閘門，觸發後切回 16kHz
+#define AUDIO_LOW_POWER_SAMPLE_RATE (AUDIO_SAMPLE_RATE / 2)
+#define AUDIO_LOW_POWER_HOP (AUDIO_FRAME_HOP / 2)  // 與完整模式相同的 8ms hop
+#define AUDIO_LOW_POWER_IDLE_HOPS 125             // 完整模式閒置 1 秒後降為 8kHz
+
 // 音頻特徵結構體
 struct AudioFeatures
 {
     float rms_energy;         // RMS 能量
     float zero_crossing_rate; // 零穿越率
-    float spectral_centroid;  // 頻譜重心
+    float spectral_centroid;  // 頻譜重心（相對 Nyquist，0~1）
+    float spectral_rolloff;   // 85% 能量滾降點（相對 Nyquist，0~1）
+    float spectral_flatness;  // 頻譜平坦度（0~1，越高越像噪音）
+    float spectral_flux;      // 與前一幀的頻譜變化量
+    float band_energy[SPECTRAL_BAND_COUNT]; // 各頻帶功率
+    MfccFeatures mfcc;        // MFCC 與一、二階差分
+    float denoised_energy;    // 噪音抑制後的 RMS 能量
     bool is_voice_detected;   // 語音檢測標誌
+    sample_time_t timestamp;  // 幀第一個樣本的樣本時間
 };
 
 // VAD 狀態
@@ -42,6 +68,13 @@ enum VADState
     VAD_SPEECH_END     // 語音結束
 };
 
+// VAD 判決引擎
+enum VADEngine
+{
+    VAD_ENGINE_ENERGY, // 能量/ZCR/頻譜重心範圍檢查（預設）
+    VAD_ENGINE_GMM     // 定點子頻帶 GMM 模型
+};
+
 // VAD 結果結構體
 struct VADResult
 {
@@ -50,6 +83,8 @@ struct VADResult
     bool speech_complete;
     float energy_level;
     unsigned long duration_ms;
+    sample_time_t timestamp;    // 判決所依據的幀結束時的樣本時間
+    sample_time_t speech_start; // 語音段落開始的樣本時間（靜音時為 0）
 };
 
 // 音訊事件回調函數類型
@@ -68,24 +103,60 @@ private:
     INMP441Module inmp441;
 
     // 音訊處理緩衝區
-    int16_t *processed_buffer;
+    audio_sample_t *processed_buffer;
     float *normalized_buffer;
 
     // 幀處理相關
-    int16_t *frame_buffer;
+    audio_sample_t *frame_buffer;
+    audio_sample_t *frame_pcm; // 當前幀的樣本（int16 或 Q31，見 audio_sample.h）
+    sample_time_t frame_buffer_time; // frame_buffer[0] 的樣本時間
+    sample_time_t frame_pcm_time;    // frame_pcm 第一個樣本的樣本時間
     size_t frame_write_pos;
     bool frame_ready_flag;
 
+    // 兩段式處理：每個 hop 先經能量閘門，開啟時才做完整特徵提取
+    bool two_rate_enabled;
+    EnergyGate energy_gate;
+    audio_sample_t *preroll_frames; // 閘門關閉期間的歷史幀環形緩衝區
+    sample_time_t preroll_times[AUDIO_PREROLL_FRAMES];
+    bool preroll_gmm_speech[AUDIO_PREROLL_FRAMES]; // 歷史幀的 GMM 判決（GMM 每個 hop 都執行）
+    int preroll_head;
+    int preroll_count;
+    int gate_closed_hops; // 距上次完整處理的閘門關閉 hop 數
+
+    // 8kHz 低功耗模式
+    bool low_power_enabled;
+    int idle_hops; // 完整模式下連續閒置的 hop 數
+
     // VAD 狀態變量
     VADState vad_current_state;
     int speech_frame_count;
     int silence_frame_count;
-    unsigned long speech_start_time;
-    unsigned long speech_end_time;
+    sample_time_t speech_start_time;
+    sample_time_t speech_end_time;
+
+    // VAD 判決引擎
+    VADEngine vad_engine;
+    GmmVad gmm_vad;
+
+    // 頻譜分析（每幀一次 FFT，所有頻譜特徵與 MFCC 共用）
+    SpectralAnalyzer spectral_analyzer;
+    MfccExtractor mfcc_extractor;
+    float window_table[AUDIO_FRAME_SIZE]; // 預先計算的漢寧窗
+
+    // 梅爾能量噪音抑制（頻譜減法 + PCAN）
+    bool noise_suppression_enabled;
+    NoiseSuppressor noise_suppressor;
+
+    // 倒頻譜平均值/變異數正規化（靜音時更新、語音時凍結）
+    bool cmvn_enabled;
+    CmvnNormalizer cmvn;
 
     // 語音緩衝系統
     float *speech_buffer;
     int speech_buffer_length;
+    AudioFeatures speech_features_sum; // 語音段落內各幀特徵累加（timestamp 為最後一幀）
+    int speech_feature_frames;
 
     // 回調函數
     AudioFrameCallback audio_frame_callback;
@@ -99,20 +170,36 @@ private:
     // 通用 Debug 模組
     DebugPrint debug;
 
+    // 基準測試直接呼叫內部核心（test/dsp_kernel_benchmark.cpp）
+    friend struct KernelBenchmarkAccess;
+
     // 內部方法
-    void normalize_audio(int16_t *input, float *output, size_t length);
+    void normalize_audio(const audio_sample_t *input, float *output, size_t length);
     void apply_window_function(float *data, size_t length);
     float calculate_rms(float *data, size_t length);
-    float calculate_zero_crossing_rate(int16_t *data, size_t length);
-    void extract_audio_features(float *frame, AudioFeatures *features);
-    bool check_frame_ready(int16_t *new_samples, size_t sample_count);
-    void get_current_frame(float *frame_output);
+    float calculate_zero_crossing_rate(const float *data, size_t length);
+    void extract_audio_features(float *frame, AudioFeatures *features, bool with_cepstrum);
+    bool check_frame_ready(const audio_sample_t *new_samples, size_t sample_count, sample_time_t timestamp, size_t *consumed);
+    void get_current_frame(audio_sample_t *pcm_output);
+    void prepare_frame(const audio_sample_t *pcm, float *frame_output);
+    void process_gated_frame();
+    void process_full_frame(const audio_sample_t *pcm, sample_time_t timestamp, bool gmm_speech);
+    void push_preroll_frame(const audio_sample_t *pcm, sample_time_t timestamp, bool gmm_speech);
+    void flush_preroll_frames();
+    void process_low_power_block(const audio_sample_t *samples, size_t sample_count);
+    void enter_low_power_mode();
+    bool run_gmm_vad(const audio_sample_t *pcm);
+    void run_vad_engine(AudioFeatures *features, bool gmm_speech);
+    VADEngine active_vad_engine() const;
+    void update_load_governor(bool on_time);
+    void normalize_features(AudioFeatures *features, bool update_stats);
     VADResult process_vad(const AudioFeatures *features);
     bool collect_speech_data(const float *frame, size_t frame_size);
+    void accumulate_speech_features(const AudioFeatures &features);
     void process_complete_speech_segment();
     
     // INMP441 回調方法
-    void on_inmp441_audio_data(const int16_t *audio_data, size_t sample_count);
+    void on_inmp441_audio_data(const audio_sample_t *audio_data, size_t sample_count, sample_time_t timestamp);
     void on_inmp441_state_change(INMP441State state, const char *message);
 
 public:
@@ -144,27 +231,113 @@ public:
     bool is_capture_running() const { return is_running; }
     VADState get_current_vad_state() const { return vad_current_state; }
     int get_speech_buffer_length() const { return speech_buffer_length; }
+    AudioFeatures get_speech_features() const;
+    const SampleClock& get_sample_clock() const { return inmp441.get_sample_clock(); }
+    const SpectralAnalyzer& get_spectral_analyzer() const { return spectral_analyzer; }
+    const MfccExtractor& get_mfcc_extractor() const { return mfcc_extractor; }
 
     // 配置方法
     void reset_vad();
     void clear_speech_buffer();
+    void set_vad_engine(VADEngine engine);
+    VADEngine get_vad_engine() const { return vad_engine; }
+    const GmmVad& get_gmm_vad() const { return gmm_vad; }
+    void set_two_rate_processing(bool enable);
+    bool is_two_rate_processing_enabled() const { return two_rate_enabled; }
+    bool set_low_power_mode(bool enable); // 需以 INMP441Module::create_oversampled_config() 初始化
+    bool is_low_power_mode_enabled() const { return low_power_enabled; }
+    void set_cmvn_enabled(bool enable);
+    bool is_cmvn_enabled() const { return cmvn_enabled; }
+    const CmvnNormalizer& get_cmvn() const { return cmvn; }
+    void set_noise_suppression_enabled(bool enable);
+    bool is_noise_suppression_enabled() const { return noise_suppression_enabled; }
+    NoiseSuppressor& get_noise_suppressor() { return noise_suppressor; }
 
     // 調試控制方法
     void set_debug(bool enable) { debug.set_debug(enable); }
     bool is_debug_enabled() const { return debug.is_debug_enabled(); }
     DebugPrint& get_debug() { return debug; }
 
-    // 音訊統計信息（調試用）
+    // 音訊統計信息（轉換時串流更新，查詢為 O(1)；振幅皆為 16-bit 刻度）
     struct AudioStats
     {
-        int32_t min_amplitude;
-        int32_t max_amplitude;
-        int32_t avg_amplitude;
-        size_t samples_processed;
-        unsigned long last_activity_time;
+        int32_t min_amplitude;        // 視窗最小值
+        int32_t max_amplitude;        // 視窗最大值
+        int32_t peak_amplitude;       // 最近區塊峰值 |x|
+        int32_t rms_amplitude;        // 最近區塊 RMS
+        float rms_dbfs;               // 最近區塊 RMS（dBFS）
+        float peak_dbfs;              // 最近區塊峰值（dBFS）
+        float dc_mean;                // 視窗平均值（DC 偏移）
+        uint32_t clipped_samples;     // 累計飽和樣本數
+        uint64_t samples_processed;   // 累計轉換樣本數
+        unsigned long last_activity_time; // 最後一個區塊的時間（millis）
     };
 
     AudioStats get_audio_stats() const;
+
+    // VAD 引擎比較統計（GMM 啟用時與能量判決並行比較）
+    struct VADEngineStats
+    {
+        uint32_t frames;              // 總處理幀數
+        uint32_t gmm_frames;          // GMM 處理 hop 數（含閘門關閉的 hop）
+        uint64_t energy_cycles;       // 能量判決（特徵提取）累計週期數
+        uint64_t gmm_cycles;          // GMM 判決累計週期數
+        uint32_t both_speech;         // 兩者皆判為語音
+        uint32_t energy_only;         // 僅能量判決為語音
+        uint32_t gmm_only;            // 僅 GMM 判為語音
+    };
+
+    VADEngineStats get_vad_engine_stats() const { return vad_engine_stats; }
+    void reset_vad_engine_stats();
+    void print_vad_engine_stats() const;
+
+    // 兩段式處理統計
+    struct PipelineTierStats
+    {
+        uint32_t gate_frames;     // 經過能量閘門的幀數（每個 hop）
+        uint32_t full_frames;     // 完整特徵提取的幀數（含補算）
+        uint32_t preroll_frames;  // 閘門開啟時補算的歷史幀數
+        uint64_t silence_cycles;  // 閘門關閉時的累計週期數
+        uint64_t speech_cycles;   // 閘門開啟時的累計週期數
+        uint64_t silence_samples; // 閘門關閉時的樣本數
+        uint64_t speech_samples;  // 閘門開啟時的樣本數
+        uint32_t low_power_hops;  // 8kHz 低功耗模式處理的 hop 數
+        uint64_t low_power_cycles;  // 低功耗模式累計週期數
+        uint64_t low_power_samples; // 低功耗模式樣本數（8kHz）
+        uint32_t wakeups;         // 由低功耗模式喚醒的次數
+        uint32_t strided_frames;  // 負載調節略過完整處理的靜音 hop 數
+        uint32_t refresh_frames;  // 閘門關閉期間為更新自適應統計而完整處理的幀數
+    };
+
+    PipelineTierStats get_pipeline_tier_stats() const { return tier_stats; }
+    void reset_pipeline_tier_stats();
+    void print_pipeline_tier_stats() const;
+
+    // 即時期限監控（可設定預算與錯過回調）
+    DeadlineMonitor& get_deadline_monitor() { return deadline_monitor; }
+
+    // CPU 負載調節（過載時逐級降低品質，餘裕恢復後逐級回復）
+    void set_load_governor_enabled(bool enable);
+    bool is_load_governor_enabled() const { return load_governor_enabled; }
+    LoadGovernor& get_load_governor() { return load_governor; }
+    LoadLevel get_load_level() const { return load_governor_enabled ? load_governor.get_level() : LOAD_LEVEL_FULL; }
+
+private:
+    VADEngineStats vad_engine_stats;
+    PipelineTierStats tier_stats;
+
+    // 每幀即時期限監控
+    DeadlineMonitor deadline_monitor;
+
+    // 負載調節
+    bool load_governor_enabled;
+    LoadGovernor load_governor;
+
+    // 健康指標（指標登錄表管理，隨 metrics 快照匯出）
+    MetricCounter frames_metric;         // 處理的幀（每個 hop）
+    MetricCounter deadline_miss_metric;  // 錯過期限的幀
+    MetricCounter speech_segment_metric; // 完成的語音段落
+    MetricHistogram frame_us_metric;     // 每幀處理時間（微秒，log2 分桶）
 };
 
 #endif // AUDIO_MODULE_H
\ No newline at end of file
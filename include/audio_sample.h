@@ -0,0 +1,61 @@
+#ifndef AUDIO_SAMPLE_H
+#define AUDIO_SAMPLE_H
+
+#include <Arduino.h>
+
+// 擷取樣本格式（編譯期選擇，於 platformio.ini build_flags 加上 -DAUDIO_SAMPLE_Q31=1）
+// 0：int16（預設），24-bit 麥克風輸出在轉換時即縮為 16-bit
+// 1：Q31，int32 樣本保留 INMP441 完整 24-bit 解析度直到特徵提取
+#ifndef AUDIO_SAMPLE_Q31
+#define AUDIO_SAMPLE_Q31 0
+#endif
+
+#if AUDIO_SAMPLE_Q31
+typedef int32_t audio_sample_t;
+#define AUDIO_SAMPLE_SHIFT 16               // 比 int16 多出的小數位元
+#define AUDIO_SAMPLE_MAX INT32_MAX
+#define AUDIO_SAMPLE_MIN INT32_MIN
+#else
+typedef int16_t audio_sample_t;
+#define AUDIO_SAMPLE_SHIFT 0
+#define AUDIO_SAMPLE_MAX INT16_MAX
+#define AUDIO_SAMPLE_MIN INT16_MIN
+#endif
+
+// 與 int16 模式相同刻度的滿刻度值（正規化用）
+#define AUDIO_SAMPLE_FULL_SCALE (32767.0f * (float)(1L << AUDIO_SAMPLE_SHIFT))
+
+/**
+ * 縮為 16-bit（四捨五入並飽和）
+ * 供整數 VAD、能量閘門等以 16-bit 精度設計的前級使用
+ */
+static inline int16_t audio_sample_to_q15(audio_sample_t sample)
+{
+#if AUDIO_SAMPLE_Q31
+    int32_t rounded = ((sample >> (AUDIO_SAMPLE_SHIFT - 1)) + 1) >> 1;
+    return (int16_t)(rounded > INT16_MAX ? INT16_MAX : rounded);
+#else
+    return sample;
+#endif
+}
+
+/**
+ * 取得一段樣本的 16-bit 版本
+ * int16 模式直接回傳原指標；Q31 模式寫入 scratch 並回傳 scratch
+ */
+static inline const int16_t *audio_samples_to_q15(const audio_sample_t *samples, int16_t *scratch, size_t length)
+{
+#if AUDIO_SAMPLE_Q31
+    for (size_t i = 0; i < length; i++)
+    {
+        scratch[i] = audio_sample_to_q15(samples[i]);
+    }
+    return scratch;
+#else
+    (void)scratch;
+    (void)length;
+    return samples;
+#endif
+}
+
+#endif // AUDIO_SAMPLE_H
@@ -0,0 +1,80 @@
+#ifndef BEAMFORMER_H
+#define BEAMFORMER_H
+
+#include <Arduino.h>
+
+// 波束成形配置常數
+#define BEAMFORMER_MAX_DELAY 7              // 最大導向延遲（樣本，48kHz 時約 5cm 麥克風間距）
+#define BEAMFORMER_HISTORY_SIZE 8           // 每聲道歷史長度（2 的冪次，需大於 MAX_DELAY）
+#define BEAMFORMER_NUM_LAGS (2 * BEAMFORMER_MAX_DELAY + 1)
+#define BEAMFORMER_BLOCK_SIZE 256           // 每 256 個樣本更新一次導向
+#define BEAMFORMER_CORR_STRIDE 2            // 互相關每 2 個樣本累加一次（成本減半）
+#define BEAMFORMER_CORR_SHIFT 8             // 互相關前 24-bit 樣本右移位數（乘積維持在 32-bit）
+#define BEAMFORMER_SMOOTHING_SHIFT 2        // 互相關平滑：新區塊權重 1/4
+#define BEAMFORMER_MIN_BLOCK_ENERGY (1LL << 20) // 區塊能量低於此值（約 -54 dBFS）時不更新導向
+#define BEAMFORMER_CYCLE_BUDGET 60          // 每個輸入樣本的週期預算
+
+/**
+ * 雙麥克風延遲相加波束成形器
+ * 輸入為 I2S 交錯立體聲（L, R, L, R, ... 32-bit 容器格式），
+ * 輸出一個增強後的單聲道，格式相同，可直接接在抽取器與轉換階段之前。
+ *
+ * 導向延遲以時域互相關估計：每個區塊累加各延遲的互相關（每 CORR_STRIDE 個樣本一次），
+ * 指數平滑後取最大值；靜音區塊不更新，避免在噪音上亂跳。
+ * 延遲為整數樣本，在 48kHz 過取樣擷取時解析度約 21µs。
+ * 每個樣本的運算量固定（與訊號內容無關），預算見 BEAMFORMER_CYCLE_BUDGET。
+ */
+class DelayAndSumBeamformer
+{
+private:
+    // 各聲道歷史（24-bit 樣本，環形緩衝區）
+    int32_t history_left[BEAMFORMER_HISTORY_SIZE];
+    int32_t history_right[BEAMFORMER_HISTORY_SIZE];
+    int history_pos;
+
+    // 導向估計
+    int64_t block_corr[BEAMFORMER_NUM_LAGS];    // 本區塊互相關
+    int64_t smoothed_corr[BEAMFORMER_NUM_LAGS]; // 平滑後互相關
+    int64_t block_energy;
+    int block_count;
+    int steering_delay; // > 0：右聲道較晚到達，延遲左聲道；< 0 反之
+    bool fixed_steering;
+
+    // 成本統計
+    uint32_t last_cycles;
+    uint64_t total_cycles;
+    uint64_t sample_count;
+    uint32_t steering_updates;
+    uint32_t over_budget_calls;
+
+    void update_steering();
+
+public:
+    DelayAndSumBeamformer();
+
+    /**
+     * 處理 frames 個立體聲樣本（interleaved 長度為 2 × frames），回傳輸出樣本數
+     * output 可與 interleaved 相同（原地處理）
+     */
+    size_t process(const int32_t *interleaved, size_t frames, int32_t *output);
+
+    void reset();
+
+    /**
+     * 固定導向延遲（已知聲源方向時使用），停用自動估計
+     */
+    void set_fixed_steering(int delay);
+    void set_adaptive_steering();
+
+    // 狀態查詢
+    int get_steering_delay() const { return steering_delay; }
+    bool is_fixed_steering() const { return fixed_steering; }
+
+    // 成本統計
+    uint32_t get_last_cycles() const { return last_cycles; }
+    uint32_t get_average_cycles_per_sample() const { return sample_count ? (uint32_t)(total_cycles / sample_count) : 0; }
+    uint32_t get_steering_updates() const { return steering_updates; }
+    uint32_t get_over_budget_calls() const { return over_budget_calls; }
+};
+
+#endif // BEAMFORMER_H
@@ -0,0 +1,66 @@
+#ifndef CMVN_H
+#define CMVN_H
+
+#include <Arduino.h>
+#include "mfcc.h"
+
+// CMVN 配置常數
+#define CMVN_EMA_SHIFT 7               // 指數衰減係數 alpha = 2^-7（8ms/幀時約 1 秒時間常數）
+#define CMVN_WARMUP_FRAMES (1 << CMVN_EMA_SHIFT) // 暖機期間改用累積平均
+#define CMVN_NORMALIZE_VARIANCE 1      // 是否同時做變異數正規化
+#define CMVN_VARIANCE_FLOOR 1e-2f      // 變異數下限（避免放大近乎常數的係數）
+#define CMVN_REFERENCE_RMS 0.003f      // 正規化後的背景 RMS 能量（對應預設增益下的安靜環境）
+
+/**
+ * 串流倒頻譜平均值/變異數正規化
+ * 以指數衰減追蹤每個 MFCC 係數的平均值與變異數，以及背景對數能量。
+ * 統計只在靜音幀更新（語音期間凍結），避免語音本身被正規化掉。
+ * 麥克風增益與房間響應在對數頻譜上是常數偏移，減去平均值即可消除；
+ * RMS 與頻帶能量則依背景能量縮放到 CMVN_REFERENCE_RMS。
+ */
+class CmvnNormalizer
+{
+private:
+    // 浮點統計
+    float mean[MFCC_NUM_COEFFS];
+    float variance[MFCC_NUM_COEFFS];
+    float inv_std[MFCC_NUM_COEFFS];
+    float mean_log_energy;
+    float energy_scale;
+    uint32_t update_count;
+
+    // 定點統計（係數 Q10、變異數 Q20、倒數標準差 Q12）
+    int32_t mean_q[MFCC_NUM_COEFFS];
+    int64_t variance_q[MFCC_NUM_COEFFS];
+    int32_t inv_std_q12[MFCC_NUM_COEFFS];
+    uint32_t update_count_q;
+
+public:
+    CmvnNormalizer();
+
+    void reset();
+
+    /**
+     * 以一個靜音幀更新統計
+     * @param mfcc 未正規化的 MFCC
+     * @param rms_energy 未正規化的 RMS 能量
+     */
+    void update(const MfccFeatures &mfcc, float rms_energy);
+
+    /**
+     * 就地正規化 MFCC 靜態係數（差分不受常數偏移影響，只做變異數縮放）
+     */
+    void apply(MfccFeatures *mfcc) const;
+
+    // 定點版本
+    void update_fixed(const MfccFixedFeatures &mfcc);
+    void apply_fixed(MfccFixedFeatures *mfcc) const;
+
+    // 能量縮放倍數（RMS 乘以此值，功率乘以其平方）
+    float get_energy_scale() const { return energy_scale; }
+    float get_mean(int index) const { return mean[index]; }
+    uint32_t get_update_count() const { return update_count; }
+    bool is_ready() const { return update_count >= CMVN_WARMUP_FRAMES; }
+};
+
+#endif // CMVN_H
@@ -0,0 +1,110 @@
+#ifndef DEADLINE_MONITOR_H
+#define DEADLINE_MONITOR_H
+
+#include <Arduino.h>
+#include <functional>
+#include "sample_clock.h"
+#include "stage_profiler.h"
+#include "debug_print.h"
+
+// 即時期限配置
+#define DEADLINE_BUDGET_US 8000      // 每幀期限：幀最後一個樣本擷取後一個 hop（128 樣本 @ 16kHz）
+#define DEADLINE_RESYNC_US 32000     // 遲到超過 DMA 緩衝時間（8 × 64 樣本）即視為樣本已遺失，重新對齊時間軸
+
+// 期限來源：管線各階段（ProfileStage）加上幀與幀之間的時間（I2S 讀取、轉換、主迴圈其他工作）
+#define DEADLINE_SOURCE_BETWEEN_FRAMES PROFILE_STAGE_COUNT
+#define DEADLINE_SOURCE_COUNT (PROFILE_STAGE_COUNT + 1)
+
+// 可替換的時間來源（微秒），預設為 esp_timer_get_time；主機測試可注入模擬時鐘
+typedef int64_t (*DeadlineTimeSource)();
+
+// 單次期限錯過事件
+struct DeadlineMiss
+{
+    sample_time_t timestamp;  // 錯過期限的幀（第一個樣本的樣本時間）
+    int64_t lateness_us;      // 完成時間超過期限的微秒數
+    int source;               // 本幀最耗時的來源（ProfileStage 或 DEADLINE_SOURCE_BETWEEN_FRAMES）
+    uint32_t source_us;       // 該來源在本幀的耗時
+    uint32_t consecutive;     // 連續錯過次數（含本次）
+};
+
+typedef std::function<void(const DeadlineMiss &miss)> DeadlineMissCallback;
+
+/**
+ * 音訊管線即時期限監控
+ * 每幀的期限 = 幀最後一個樣本的擷取時間（由樣本時鐘換算）+ 預算；
+ * 幀處理期間以 mark() 把經過的時間記到各階段，完成時若超過期限，
+ * 把錯過記在本幀最耗時的來源上，並可呼叫降級策略回調
+ */
+class DeadlineMonitor
+{
+public:
+    struct DeadlineStats
+    {
+        uint32_t frames;               // 已檢查的幀數
+        uint32_t misses;               // 錯過期限的幀數
+        uint32_t resyncs;              // 遲到超過 DMA 緩衝時間而重新對齊的次數
+        uint32_t consecutive_misses;   // 目前連續錯過次數
+        uint32_t max_consecutive;      // 最長連續錯過
+        uint32_t misses_by_source[DEADLINE_SOURCE_COUNT];
+        int64_t min_slack_us;          // 最小餘裕（負值表示曾經遲到）
+        DeadlineMiss worst;            // 遲到最多的一次
+    };
+
+private:
+    DeadlineTimeSource time_source;
+    uint32_t budget_us;
+    DeadlineMissCallback miss_callback;
+
+    // 目前幀
+    bool in_frame;
+    sample_time_t frame_timestamp;
+    int64_t frame_deadline_us;
+    int64_t last_mark_us;
+    int64_t last_end_us;
+    int64_t frame_begin_us;
+    uint32_t last_frame_us; // 上一幀 begin_frame 到 end_frame 的處理時間
+    int64_t rebase_us;  // 樣本遺失後的時間軸修正
+    uint32_t frame_source_us[DEADLINE_SOURCE_COUNT];
+
+    DeadlineStats stats;
+
+public:
+    DeadlineMonitor();
+
+    void set_time_source(DeadlineTimeSource source);
+    void set_budget_us(uint32_t budget) { budget_us = budget; }
+    uint32_t get_budget_us() const { return budget_us; }
+
+    /**
+     * 錯過期限時呼叫（降級策略的掛載點）
+     */
+    void set_miss_callback(DeadlineMissCallback callback) { miss_callback = callback; }
+
+    /**
+     * 開始一幀
+     * @param timestamp 幀第一個樣本的樣本時間
+     * @param release_us 幀最後一個樣本的擷取時間（與時間來源同一時間軸）
+     */
+    void begin_frame(sample_time_t timestamp, int64_t release_us);
+
+    /**
+     * 把上次 mark（或 begin_frame）以來的時間記到 source
+     */
+    void mark(int source);
+
+    /**
+     * 結束一幀並檢查期限
+     * @return 是否在期限內完成
+     */
+    bool end_frame();
+
+    void reset();
+
+    uint32_t get_last_frame_us() const { return last_frame_us; }
+    DeadlineStats get_stats() const { return stats; }
+    void print_stats(const DebugPrint &out) const;
+    static const char *source_name(int source);
+};
+
+#endif // DEADLINE_MONITOR_H
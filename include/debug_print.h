@@ -3,6 +3,183 @@
 
 #include <Arduino.h>
 #include <stdarg.h>
+#include "log_token.h"
+
+#define DEBUG_PRINT_BUFFER_SIZE 320 // 單行格式化緩衝區（模組名稱 + 標籤 + 訊息）
+
+// 日誌等級（數字越大越詳細）
+#define DEBUG_LEVEL_NONE 0
+#define DEBUG_LEVEL_ERROR 1    // error / error_f
+#define DEBUG_LEVEL_WARNING 2  // warning
+#define DEBUG_LEVEL_INFO 3     // info / success
+#define DEBUG_LEVEL_VERBOSE 4  // print / printf（另受執行期 debug 開關控制）
+
+// 全域編譯期上限（於 platformio.ini build_flags 加上 -DDEBUG_LEVEL_MAX=0 即移除所有日誌）
+#ifndef DEBUG_LEVEL_MAX
+#define DEBUG_LEVEL_MAX DEBUG_LEVEL_VERBOSE
+#endif
+
+// 模組編譯期等級：在 .cpp 檔最前面（include 之前）定義 DEBUG_LOCAL_LEVEL
+#ifndef DEBUG_LOCAL_LEVEL
+#define DEBUG_LOCAL_LEVEL DEBUG_LEVEL_MAX
+#endif
+
+#define DEBUG_LEVEL_ENABLED(level) ((level) <= DEBUG_LEVEL_MAX && (level) <= DEBUG_LOCAL_LEVEL)
+
+/**
+ * 實際呼叫：一般模式呼叫 DebugPrint 對應方法；
+ * 權杖化模式（LOG_TOKENIZED=1）以編譯期雜湊取代格式字串，訊息必須是字串常值
+ */
+#if LOG_TOKENIZED
+#define DBG_CALL(dbg, method, kind, ...) DBG_TOKENIZED_CALL(dbg, kind, __VA_ARGS__)
+#define DBG_TOKENIZED_CALL(dbg, kind, format, ...) (dbg).tokenized(kind, LOG_TOKEN(format), ##__VA_ARGS__)
+#else
+#define DBG_CALL(dbg, method, kind, ...) (dbg).method(__VA_ARGS__)
+#endif
+
+/**
+ * 編譯期過濾的日誌巨集
+ * 低於門檻的呼叫是常數為假的分支，連同參數求值一起被編譯器移除；
+ * 門檻內的 print/printf 先檢查執行期開關，關閉時同樣不求值參數
+ */
+#define DBG_PRINT(dbg, message)                                                      \
+    do                                                                               \
+    {                                                                                \
+        if (DEBUG_LEVEL_ENABLED(DEBUG_LEVEL_VERBOSE) && (dbg).is_debug_enabled())    \
+            DBG_CALL(dbg, print, LOG_KIND_PRINT, message);                           \
+    } while (0)
+#define DBG_PRINTF(dbg, ...)                                                         \
+    do                                                                               \
+    {                                                                                \
+        if (DEBUG_LEVEL_ENABLED(DEBUG_LEVEL_VERBOSE) && (dbg).is_debug_enabled())    \
+            DBG_CALL(dbg, printf, LOG_KIND_PRINTF, __VA_ARGS__);                     \
+    } while (0)
+#define DBG_INFO(dbg, message)                                                       \
+    do                                                                               \
+    {                                                                                \
+        if (DEBUG_LEVEL_ENABLED(DEBUG_LEVEL_INFO))                                   \
+            DBG_CALL(dbg, info, LOG_KIND_INFO, message);                             \
+    } while (0)
+#define DBG_SUCCESS(dbg, message)                                                    \
+    do                                                                               \
+    {                                                                                \
+        if (DEBUG_LEVEL_ENABLED(DEBUG_LEVEL_INFO))                                   \
+            DBG_CALL(dbg, success, LOG_KIND_SUCCESS, message);                       \
+    } while (0)
+#define DBG_WARNING(dbg, message)                                                    \
+    do                                                                               \
+    {                                                                                \
+        if (DEBUG_LEVEL_ENABLED(DEBUG_LEVEL_WARNING))                                \
+            DBG_CALL(dbg, warning, LOG_KIND_WARNING, message);                       \
+    } while (0)
+#define DBG_ERROR(dbg, message)                                                      \
+    do                                                                               \
+    {                                                                                \
+        if (DEBUG_LEVEL_ENABLED(DEBUG_LEVEL_ERROR))                                  \
+            DBG_CALL(dbg, error, LOG_KIND_ERROR, message);                           \
+    } while (0)
+#define DBG_ERROR_F(dbg, ...)                                                        \
+    do                                                                               \
+    {                                                                                \
+        if (DEBUG_LEVEL_ENABLED(DEBUG_LEVEL_ERROR))                                  \
+            DBG_CALL(dbg, error_f, LOG_KIND_ERROR, __VA_ARGS__);                     \
+    } while (0)
+
+/**
+ * 限流日誌的呼叫點狀態
+ * 由下列巨集在每個呼叫點以 static 配置（零初始化、無建構函數，不需要鎖或配置記憶體），
+ * 同一呼叫點只應由單一執行緒進入（音訊處理迴圈或回調）
+ */
+struct DebugRateLimiter
+{
+    uint32_t count;        // every-N 的呼叫計數 / 本區間已輸出筆數
+    uint32_t suppressed;   // 尚未回報的略過筆數
+    uint64_t window_start; // 本區間起點（與呼叫端傳入的時間同單位，通常為樣本時間）
+    bool started;
+
+    /**
+     * 每 n 次呼叫放行一次（第 n、2n、… 次）
+     */
+    bool every_n(uint32_t n)
+    {
+        if (++count < n)
+            return false;
+        count = 0;
+        return true;
+    }
+
+    /**
+     * 每個長度為 period 的區間最多放行 burst 次，其餘計入 suppressed
+     */
+    bool burst(uint64_t now, uint64_t period, uint32_t max_count)
+    {
+        if (!started || now - window_start >= period)
+        {
+            started = true;
+            window_start = now;
+            count = 0;
+        }
+        if (count < max_count)
+        {
+            count++;
+            return true;
+        }
+        suppressed++;
+        return false;
+    }
+
+    /**
+     * 每個區間最多放行一次
+     */
+    bool interval(uint64_t now, uint64_t period) { return burst(now, period, 1); }
+
+    /**
+     * 取出並清除略過筆數
+     */
+    uint32_t take_suppressed()
+    {
+        uint32_t value = suppressed;
+        suppressed = 0;
+        return value;
+    }
+};
+
+// 放行時一併回報上一區間被略過的筆數
+#define DBG_REPORT_SUPPRESSED(dbg, limiter)                                          \
+    do                                                                               \
+    {                                                                                \
+        uint32_t dbg_suppressed = (limiter).take_suppressed();                       \
+        if (dbg_suppressed)                                                          \
+            DBG_PRINTF(dbg, "  ↳ 同一呼叫點另有 %lu 筆訊息被略過\n",                 \
+                       (unsigned long)dbg_suppressed);                               \
+    } while (0)
+
+/**
+ * 限流的 printf（僅 VERBOSE 等級，與 DBG_PRINTF 同樣受編譯期門檻與執行期開關控制）
+ * DBG_PRINTF_EVERY_N: 每 n 次呼叫輸出一次
+ * DBG_PRINTF_INTERVAL: 每 period 最多一次（now/period 通常為樣本時間）
+ * DBG_PRINTF_BURST: 每 period 最多 max_count 次，下一次輸出時附上略過筆數
+ */
+#define DBG_PRINTF_EVERY_N(dbg, n, ...)                                              \
+    do                                                                               \
+    {                                                                                \
+        static DebugRateLimiter dbg_limiter;                                         \
+        if (DEBUG_LEVEL_ENABLED(DEBUG_LEVEL_VERBOSE) && (dbg).is_debug_enabled() &&  \
+            dbg_limiter.every_n(n))                                                  \
+            DBG_CALL(dbg, printf, LOG_KIND_PRINTF, __VA_ARGS__);                     \
+    } while (0)
+#define DBG_PRINTF_BURST(dbg, now, period, max_count, ...)                           \
+    do                                                                               \
+    {                                                                                \
+        static DebugRateLimiter dbg_limiter;                                         \
+        if (DEBUG_LEVEL_ENABLED(DEBUG_LEVEL_VERBOSE) && (dbg).is_debug_enabled() &&  \
+            dbg_limiter.burst(now, period, max_count))                               \
+        {                                                                            \
+            DBG_REPORT_SUPPRESSED(dbg, dbg_limiter);                                 \
+            DBG_CALL(dbg, printf, LOG_KIND_PRINTF, __VA_ARGS__);                     \
+        }                                                                            \
+    } while (0)
+#define DBG_PRINTF_INTERVAL(dbg, now, period, ...) DBG_PRINTF_BURST(dbg, now, period, 1, __VA_ARGS__)
 
 /**
  * 通用 Debug 輸出模組
@@ -13,6 +190,7 @@ class DebugPrint
 private:
     bool debug_enabled;
     const char* module_name;
+    uint16_t module_token; // 權杖化日誌用的模組名稱雜湊
 
 public:
     /**
@@ -21,7 +199,7 @@ public:
      * @param enabled 預設是否啟用 debug
      */
     DebugPrint(const char* name = nullptr, bool enabled = false)
-        : debug_enabled(enabled), module_name(name) {}
+        : debug_enabled(enabled), module_name(name), module_token(log_module_token(name)) {}
 
     /**
      * 設置 debug 開關
@@ -36,7 +214,11 @@ public:
     /**
      * 設置模組名稱
      */
-    void set_module_name(const char* name) { module_name = name; }
+    void set_module_name(const char* name)
+    {
+        module_name = name;
+        module_token = log_module_token(name);
+    }
 
     /**
      * 獲取模組名稱
@@ -51,11 +233,7 @@ public:
     {
         if (debug_enabled && message)
         {
-            if (module_name)
-            {
-                Serial.printf("[%s] ", module_name);
-            }
-            Serial.println(message);
+            emit(nullptr, true, "%s", message);
         }
     }
 
@@ -68,20 +246,10 @@ public:
     {
         if (debug_enabled && format)
         {
-            char buffer[256];
             va_list args;
             va_start(args, format);
-            
-            // 如果有模組名稱，先輸出模組名稱
-            if (module_name)
-            {
-                Serial.printf("[%s] ", module_name);
-            }
-            
-            // 格式化輸出
-            vsnprintf(buffer, sizeof(buffer), format, args);
+            vemit(nullptr, false, format, args);
             va_end(args);
-            Serial.print(buffer);
         }
     }
 
@@ -93,15 +261,7 @@ public:
     {
         if (message)
         {
-            if (module_name)
-            {
-                Serial.printf("[%s] ⚠️  WARNING: ", module_name);
-            }
-            else
-            {
-                Serial.print("⚠️  WARNING: ");
-            }
-            Serial.println(message);
+            emit("⚠️  WARNING: ", true, "%s", message);
         }
     }
 
@@ -113,15 +273,7 @@ public:
     {
         if (message)
         {
-            if (module_name)
-            {
-                Serial.printf("[%s] ❌ ERROR: ", module_name);
-            }
-            else
-            {
-                Serial.print("❌ ERROR: ");
-            }
-            Serial.println(message);
+            emit("❌ ERROR: ", true, "%s", message);
         }
     }
 
@@ -134,22 +286,10 @@ public:
     {
         if (format)
         {
-            char buffer[256];
             va_list args;
             va_start(args, format);
-            
-            if (module_name)
-            {
-                Serial.printf("[%s] ❌ ERROR: ", module_name);
-            }
-            else
-            {
-                Serial.print("❌ ERROR: ");
-            }
-            
-            vsnprintf(buffer, sizeof(buffer), format, args);
+            vemit("❌ ERROR: ", true, format, args);
             va_end(args);
-            Serial.println(buffer);
         }
     }
 
@@ -161,15 +301,7 @@ public:
     {
         if (message)
         {
-            if (module_name)
-            {
-                Serial.printf("[%s] ℹ️  ", module_name);
-            }
-            else
-            {
-                Serial.print("ℹ️  ");
-            }
-            Serial.println(message);
+            emit("ℹ️  ", true, "%s", message);
         }
     }
 
@@ -181,17 +313,33 @@ public:
     {
         if (message)
         {
-            if (module_name)
-            {
-                Serial.printf("[%s] ✅ ", module_name);
-            }
-            else
-            {
-                Serial.print("✅ ");
-            }
-            Serial.println(message);
+            emit("✅ ", true, "%s", message);
         }
     }
+
+    /**
+     * 輸出權杖化訊息（由 DBG_* 巨集在 LOG_TOKENIZED=1 時呼叫）
+     * @param kind 封包種類（LogTokenKind）
+     * @param token 格式字串的編譯期雜湊
+     */
+    template <typename... Args>
+    void tokenized(uint8_t kind, uint32_t token, Args... args) const
+    {
+        LogTokenWriter writer(token, module_token, kind);
+        writer.encode(args...);
+        write_frame(writer);
+    }
+
+private:
+    void write_frame(LogTokenWriter& writer) const;
+
+    /**
+     * 把模組名稱、標籤與訊息格式化成一整行後交給非同步日誌（不阻塞音訊處理）
+     * @param label 等級標籤（可為 nullptr）
+     * @param newline 是否在結尾補換行
+     */
+    void emit(const char* label, bool newline, const char* format, ...) const;
+    void vemit(const char* label, bool newline, const char* format, va_list args) const;
 };
 
 /**
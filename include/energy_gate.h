@@ -0,0 +1,47 @@
+#ifndef ENERGY_GATE_H
+#define ENERGY_GATE_H
+
+#include <Arduino.h>
+
+// 能量閘門配置常數（16-bit 樣本的均方值）
+#define ENERGY_GATE_FLOOR_INIT (100 * 100)      // 噪音底線初值
+#define ENERGY_GATE_MIN_MEAN_SQUARE (64 * 64)   // 低於此值永不開啟
+#define ENERGY_GATE_OPEN_MEAN_SQUARE (500 * 500) // 高於此值直接開啟
+#define ENERGY_GATE_FLOOR_RATIO_SHIFT 2         // 高於噪音底線 4 倍 (+6 dB) 即開啟
+#define ENERGY_GATE_PEAK_THRESHOLD 4000         // 峰值觸發閾值
+#define ENERGY_GATE_HANGOVER_FRAMES 8           // 觸發後維持開啟的幀數
+#define ENERGY_GATE_FLOOR_RISE_SHIFT 7          // 噪音底線上升速度（慢）
+#define ENERGY_GATE_FLOOR_FALL_SHIFT 2          // 噪音底線下降速度（快）
+
+/**
+ * 整數能量/峰值閘門
+ * 每個 hop 都執行的低成本前級，決定是否需要完整的特徵提取
+ */
+class EnergyGate
+{
+private:
+    uint32_t noise_floor;      // 追蹤的噪音底線（均方值）
+    uint32_t last_mean_square; // 最近一次均方值
+    int32_t last_peak;         // 最近一次峰值絕對值
+    int hangover;              // 剩餘維持開啟幀數
+    bool gate_open;
+
+public:
+    EnergyGate();
+
+    /**
+     * 處理一段 16-bit 樣本並更新閘門狀態
+     * @return 閘門是否開啟
+     */
+    bool process(const int16_t *samples, size_t length);
+
+    void reset();
+
+    // 狀態查詢
+    bool is_open() const { return gate_open; }
+    uint32_t get_noise_floor() const { return noise_floor; }
+    uint32_t get_last_mean_square() const { return last_mean_square; }
+    int32_t get_last_peak() const { return last_peak; }
+};
+
+#endif // ENERGY_GATE_H
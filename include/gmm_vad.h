@@ -0,0 +1,82 @@
+#ifndef GMM_VAD_H
+#define GMM_VAD_H
+
+#include <Arduino.h>
+
+// GMM VAD 配置常數
+#define GMM_VAD_NUM_BANDS 6          // 子頻帶數量 (80-250, 250-500, 500-1k, 1k-2k, 2k-3k, 3k-4k Hz)
+#define GMM_VAD_MAX_INPUT 256        // 單次處理的最大樣本數（16kHz，需為 32 的倍數）
+#define GMM_VAD_INIT_FRAMES 20       // 啟動期間強制更新噪音模型的幀數
+
+// 模型參數（Q4 dB，即 dB * 16）
+#define GMM_VAD_NOISE_MEAN_INIT (30 * 16)   // 噪音平均能量初值
+#define GMM_VAD_NOISE_STD_INIT (4 * 16)     // 噪音標準差初值
+#define GMM_VAD_NOISE_STD_MIN (2 * 16)      // 噪音標準差下限
+#define GMM_VAD_NOISE_STD_MAX (12 * 16)     // 噪音標準差上限
+#define GMM_VAD_SPEECH_STD (8 * 16)         // 語音標準差（固定）
+#define GMM_VAD_SPEECH_OFFSET (20 * 16)     // 語音平均能量初值相對噪音的偏移
+#define GMM_VAD_MIN_SEPARATION (10 * 16)    // 語音/噪音平均值最小間距
+#define GMM_VAD_MIN_ENERGY (10 * 16)        // 低於此總能量直接判為靜音
+
+// 判決閾值（Q4 自然對數似然比）
+#define GMM_VAD_LOCAL_THRESHOLD (4 * 16)    // 單一頻帶閾值
+#define GMM_VAD_GLOBAL_THRESHOLD (10 * 16)  // 加權總和閾值
+
+/**
+ * 定點 GMM 語音活動檢測器
+ * 參考 WebRTC VAD：以全通 QMF 濾波器樹切出 6 個子頻帶，
+ * 每個頻帶以噪音/語音兩個高斯模型計算對數似然比，全程整數運算
+ */
+class GmmVad
+{
+private:
+    // 濾波器樹狀態（每個分頻器有上下兩個全通分支）
+    int16_t split_state[5][2][2]; // [分頻器][上/下分支][狀態]
+    int16_t split_state_input[2]; // 16kHz -> 8kHz 分頻器
+    int16_t hp_prev_in;           // 80Hz 高通濾波器狀態
+    int32_t hp_prev_out;
+
+    // 每頻帶高斯模型（Q10 dB，即 Q4 再放大 64 倍以保留更新精度）
+    int32_t noise_mean[GMM_VAD_NUM_BANDS];
+    int32_t noise_std[GMM_VAD_NUM_BANDS];
+    int32_t speech_mean[GMM_VAD_NUM_BANDS];
+
+    // 最近一次結果
+    int16_t band_energy[GMM_VAD_NUM_BANDS]; // Q4 dB
+    int32_t last_llr_sum;
+    bool last_decision;
+    uint32_t frame_count;
+
+    // 工作緩衝區
+    int16_t work_hi[GMM_VAD_MAX_INPUT / 2];
+    int16_t work_lo[GMM_VAD_MAX_INPUT / 2];
+    int16_t work_a[GMM_VAD_MAX_INPUT / 4];
+    int16_t work_b[GMM_VAD_MAX_INPUT / 4];
+
+    // 內部方法
+    void compute_band_energies(const int16_t *samples, size_t length);
+    int32_t band_log_likelihood_ratio(int band) const;
+    void update_models(bool is_speech);
+
+public:
+    GmmVad();
+
+    /**
+     * 處理一段連續的 16kHz 樣本（建議為每幀新進的 hop 樣本）
+     * @param samples 16-bit 樣本
+     * @param length 樣本數（32 的倍數，最多 GMM_VAD_MAX_INPUT）
+     * @return 是否判定為語音
+     */
+    bool process(const int16_t *samples, size_t length);
+
+    void reset();
+
+    // 狀態查詢
+    bool get_last_decision() const { return last_decision; }
+    int32_t get_last_llr_sum() const { return last_llr_sum; }
+    float get_band_energy_db(int band) const { return band_energy[band] / 16.0f; }
+    float get_noise_mean_db(int band) const { return noise_mean[band] / 1024.0f; }
+    uint32_t get_frame_count() const { return frame_count; }
+};
+
+#endif // GMM_VAD_H
@@ -5,6 +5,12 @@
 #include <Arduino.h>
 #include <functional>
 #include "debug_print.h"
+#include "audio_sample.h"
+#include "polyphase_decimator.h"
+#include "beamformer.h"
+#include "sample_clock.h"
+#include "metrics.h"
+#include "level_meter.h"
 
 // INMP441 硬體配置常數
 #define INMP441_WS_PIN 42      // WS (Word Select) 信號 - GPIO42
@@ -14,14 +20,39 @@
 #define INMP441_I2S_PORT I2S_NUM_0
 #define INMP441_SAMPLE_RATE 16000    // 16kHz 採樣率，適合語音識別
 #define INMP441_BITS_PER_SAMPLE 32   // INMP441 輸出 24-bit，但使用 32-bit 容器
-#define INMP441_CHANNELS 1           // 單聲道
+#define INMP441_CHANNELS 1           // 單聲道（2 = 雙 INMP441 共用 I2S 匯流排，L/R 腳分別接地與 VDD）
 #define INMP441_DMA_BUF_COUNT 8      // DMA 緩衝區數量
 #define INMP441_DMA_BUF_LEN 64       // 每個 DMA 緩衝區長度
 
+// 過取樣擷取（I2S 以 sample_rate × 抽取倍率運行，再以多相 FIR 抽取）
+#define INMP441_DECIMATION_FACTOR 1        // 預設不過取樣
+#define INMP441_OVERSAMPLE_FACTOR 3        // 48kHz → 16kHz
+#define INMP441_LOW_POWER_FACTOR 6         // 48kHz → 8kHz（低功耗僅能量閘門）
+
+// 擷取健康監測
+#define INMP441_EVENT_QUEUE_SIZE 16      // I2S 事件佇列長度（DMA 溢位事件）
+#define INMP441_LATENCY_BUCKETS METRIC_HISTOGRAM_BUCKETS // 讀取耗時直方圖（log2 微秒分桶，最後一桶為 >= 32.8 ms）
+
 // 數據處理配置
 #define INMP441_BUFFER_SIZE 512      // 讀取緩衝區大小（樣本數）
 #define INMP441_MAX_AMPLITUDE 32767  // 16-bit 最大振幅
-#define INMP441_GAIN_FACTOR 4        // 增益係數（用於調整信號強度）
+#define INMP441_GAIN_FACTOR 4        // 固定增益係數（AGC 停用時使用，亦為 AGC 初始增益）
+
+// 自動增益控制（AGC）
+// 增益 G 以 24-bit → 16-bit 的直接截斷為 1 倍：輸出 = 24-bit 樣本 × G / 256
+// 舊的固定增益 (x >> 4) × 4 相當於 G = 64
+#define INMP441_AGC_ENABLED true
+#define INMP441_AGC_TARGET_LEVEL 8192    // 包絡目標峰值（16-bit，約 -12 dBFS）
+#define INMP441_AGC_MAX_GAIN 128         // 最大增益 G（舊固定增益 +6 dB）
+#define INMP441_AGC_NOISE_GATE 16384     // 包絡低於此值（24-bit，約 -54 dBFS）時保持增益，靜音不會被拉到最大增益
+#define INMP441_AGC_ATTACK_SHIFT 4       // 包絡上升時間常數 2^4 樣本（1 ms）
+#define INMP441_AGC_RELEASE_SHIFT 13     // 包絡下降時間常數 2^13 樣本（約 0.5 s）
+#define INMP441_AGC_UPDATE_INTERVAL 16   // 每 16 樣本重算一次增益（1 ms）
+#define INMP441_AGC_ENV_FRAC_BITS 8      // 包絡小數位元（Q8，避免慢速下降時步進為 0）
+
+// 轉換階段濾波器（Q15 係數，0 表示停用）
+#define INMP441_DC_BLOCK_COEFF 32604     // DC 阻隔極點 0.995（16kHz 時轉角約 13Hz）
+#define INMP441_PRE_EMPHASIS_COEFF 0     // 預強調係數（常用 0.97 = 31785，預設停用）
 
 // INMP441 狀態枚舉
 enum INMP441State
@@ -43,11 +74,20 @@ struct INMP441Config
     uint8_t dma_buf_count;   // DMA 緩衝區數量
     uint8_t dma_buf_len;     // DMA 緩衝區長度
     uint16_t buffer_size;    // 讀取緩衝區大小
-    uint8_t gain_factor;     // 增益係數
+    uint8_t gain_factor;     // 固定增益係數
+    bool agc_enabled;            // 啟用自動增益控制
+    uint16_t agc_target_level;   // AGC 目標峰值（16-bit）
+    uint16_t agc_max_gain;       // AGC 最大增益 G
+    int16_t dc_block_coeff;      // DC 阻隔極點 Q15（0 = 停用）
+    int16_t pre_emphasis_coeff;  // 預強調係數 Q15（0 = 停用）
+    uint8_t decimation_factor;   // 過取樣抽取倍率（1 = 停用，I2S 以 sample_rate 運行）
+    bool use_apll;               // 使用 APLL 產生精確的 I2S 時鐘
+    uint8_t channels;            // 1 = 單麥克風，2 = 立體聲擷取並波束成形為單聲道
 };
 
 // 音訊數據回調函數類型
-typedef std::function<void(const int16_t *audio_data, size_t sample_count)> AudioDataCallback;
+// timestamp 為區塊第一個樣本的樣本時間（見 sample_clock.h）
+typedef std::function<void(const audio_sample_t *audio_data, size_t sample_count, sample_time_t timestamp)> AudioDataCallback;
 typedef std::function<void(INMP441State state, const char *message)> StateChangeCallback;
 
 /**
@@ -62,7 +102,7 @@ private:
     
     // 緩衝區
     int32_t *raw_buffer;      // 原始 32-bit 數據緩衝區
-    int16_t *processed_buffer; // 處理後的 16-bit 數據緩衝區
+    audio_sample_t *processed_buffer; // 處理後的數據緩衝區（int16 或 Q31）
     
     // 狀態管理
     INMP441State current_state;
@@ -72,19 +112,70 @@ private:
     AudioDataCallback audio_data_callback;
     StateChangeCallback state_change_callback;
     
+    // 轉換濾波器狀態（跨區塊保存）
+    int32_t dc_prev_input;    // DC 阻隔 x[n-1]（24-bit）
+    int32_t dc_prev_output;   // DC 阻隔 y[n-1]
+    int32_t dc_feedback_frac; // 回授項捨去的小數（誤差回饋，避免殘留 DC）
+    int32_t pre_prev_input;   // 預強調 y[n-1]
+
+    // AGC 狀態
+    uint32_t agc_envelope;    // 峰值包絡（24-bit 幅度，Q8）
+    uint32_t agc_gain_q16;    // 目前增益 G（Q16）
+    uint16_t agc_counter;     // 距下次重算增益的樣本數
+    MetricCounter clipped_samples; // 飽和樣本數（每個區塊累加一次）
+
+    // 音量統計（轉換時逐樣本累加於暫存器，每個區塊合併一次）
+    uint32_t level_window_ms;
+    AudioLevelMeter level_meter;
+
+    // 過取樣抽取
+    PolyphaseDecimator decimator;
+    bool low_power_mode;      // 抽取到 INMP441_LOW_POWER_FACTOR（輸出 8kHz）
+
+    // 立體聲波束成形（在抽取之前，以擷取取樣率對齊兩個聲道）
+    DelayAndSumBeamformer beamformer;
+
+    // 樣本時鐘（start() 時歸零，每個讀取或轉換的區塊推進）
+    SampleClock sample_clock;
+    sample_time_t block_timestamp; // 最近一個區塊第一個樣本的時間
+
     // 統計信息
     unsigned long total_samples_read;
     unsigned long last_read_time;
     size_t consecutive_errors;
 
+    // 擷取健康監測（每次讀取只多兩次 esp_timer 讀取與一個非阻塞佇列輪詢）
+    QueueHandle_t i2s_event_queue;
+    int64_t capture_start_us;   // start() 或 reset_statistics() 的時間
+    int64_t last_read_us;       // 上次成功讀取的時間
+    uint64_t raw_frames_read;   // I2S 原始幀數（每個聲道各一個樣本）
+    // 以下由指標登錄表管理，可隨 metrics 快照一併匯出
+    MetricCounter total_errors;      // 累計讀取錯誤
+    MetricCounter dma_overflows;     // DMA 接收佇列溢位事件
+    MetricCounter dma_errors;        // DMA 錯誤事件
+    MetricCounter empty_reads;       // 沒有資料可讀的呼叫
+    MetricGauge max_read_gap_us;     // 兩次成功讀取間的最大間隔
+    MetricGauge max_read_us;         // 單次讀取（含抽取與轉換）的最大耗時
+    MetricHistogram read_latency_hist;
+
     // 通用 Debug 模組
     DebugPrint debug;
 
+    // 基準測試直接呼叫內部核心（test/dsp_kernel_benchmark.cpp）
+    friend struct KernelBenchmarkAccess;
+
     // 內部方法
     bool install_i2s_driver();
     void uninstall_i2s_driver();
     bool configure_i2s_pins();
-    void convert_audio_data(const int32_t *raw_data, int16_t *processed_data, size_t length);
+    void convert_audio_data(const int32_t *raw_data, audio_sample_t *processed_data, size_t length);
+    void reset_filter_state();
+    void update_agc_gain();
+    void poll_i2s_events();
+    void record_read_timing(int64_t start_us, int64_t end_us);
+    uint32_t sample_clock_ticks() const;
+    size_t raw_buffer_size() const;
+    bool is_stereo() const { return config.channels == 2; }
     void update_state(INMP441State new_state, const char *message = nullptr);
     
 public:
@@ -101,9 +192,16 @@ public:
     void stop();
     
     // 數據讀取方法
-    size_t read_audio_data(int16_t *output_buffer, size_t max_samples);
+    size_t read_audio_data(audio_sample_t *output_buffer, size_t max_samples);
     size_t read_raw_audio_data(int32_t *output_buffer, size_t max_samples);
     bool read_audio_frame();  // 讀取一幀數據並調用回調
+
+    /**
+     * 以目前配置轉換一段原始 32-bit 樣本（測試與錄音重播用）
+     * 濾波器狀態與即時擷取共用，跨呼叫延續
+     * 立體聲配置時 raw_data 為交錯的 L/R 樣本，length 為總樣本數（2 × frames）
+     */
+    size_t process_raw_samples(const int32_t *raw_data, audio_sample_t *processed_data, size_t length);
     
     // 回調註冊方法
     void set_audio_data_callback(AudioDataCallback callback);
@@ -119,20 +217,65 @@ public:
     INMP441Config get_config() const { return config; }
     bool set_config(const INMP441Config &new_config);
     void reset_to_default_config();
+
+    /**
+     * 低功耗模式：過取樣擷取時把抽取倍率從 3 切換為 6，輸出降為 8kHz
+     * I2S 不需重新安裝，抽取器歷史保留；僅在 decimation_factor 為 3 時可用
+     */
+    bool set_low_power_mode(bool enable);
+    bool is_low_power_mode() const { return low_power_mode; }
+    uint32_t get_capture_sample_rate() const;
+    uint32_t get_output_sample_rate() const;
+    const PolyphaseDecimator& get_decimator() const { return decimator; }
+
+    /**
+     * 樣本時鐘：read_audio_data()/process_raw_samples() 輸出的每個區塊都推進
+     * get_block_timestamp() 為最近一個區塊第一個樣本的時間
+     */
+    const SampleClock& get_sample_clock() const { return sample_clock; }
+    sample_time_t get_block_timestamp() const { return block_timestamp; }
+
+    /**
+     * 立體聲擷取時的波束成形器（可固定導向或查詢目前估計的延遲）
+     */
+    DelayAndSumBeamformer& get_beamformer() { return beamformer; }
     
     // 統計信息
     struct INMP441Stats
     {
-        unsigned long total_samples;     // 總讀取樣本數
-        unsigned long uptime_ms;         // 運行時間（毫秒）
-        size_t error_count;              // 錯誤計數
-        float samples_per_second;        // 每秒樣本數
+        unsigned long total_samples;     // 總讀取樣本數（輸出取樣率）
+        unsigned long uptime_ms;         // 自開始擷取（或重置統計）的時間（毫秒）
+        size_t error_count;              // 累計讀取錯誤
+        size_t consecutive_errors;       // 目前連續讀取錯誤
+        float samples_per_second;        // 實際輸出樣本率
+        float capture_rate;              // 實際 I2S 幀率（與 get_capture_sample_rate() 比較）
+        uint32_t dma_overflows;          // DMA 溢位事件（主迴圈太慢時發生）
+        uint32_t dma_errors;             // DMA 錯誤事件
+        uint32_t empty_reads;            // 沒有資料可讀的呼叫次數
+        uint64_t dropped_samples;        // 估計遺失樣本數：牆上時間應有樣本 − 樣本時鐘 − DMA 緩衝容量
+        uint32_t max_read_gap_us;        // 兩次成功讀取間的最大間隔（微秒）
+        uint32_t max_read_us;            // 單次讀取最大耗時（微秒）
+        uint32_t read_latency_hist[INMP441_LATENCY_BUCKETS]; // 讀取耗時直方圖，第 k 桶為 [2^k, 2^(k+1)) 微秒
         unsigned long last_read_time;    // 最後讀取時間
         size_t buffer_size;              // 緩衝區大小
+        bool agc_enabled;                // AGC 是否啟用
+        float current_gain;              // 目前增益 G（24-bit → 16-bit 的倍數）
+        float current_gain_db;           // 目前增益（dB，相對 G = 1）
+        unsigned long clipped_samples;   // 飽和樣本數
+        float clip_ratio;                // 飽和樣本比例
     };
     
     INMP441Stats get_statistics() const;
     void reset_statistics();
+
+    /**
+     * 串流音量統計（峰值、RMS、DC、視窗 min/max），查詢為 O(1)
+     * reset_statistics() 時一併清除
+     */
+    AudioLevelMeter::Stats get_level_stats() const { return level_meter.get_stats(); }
+    void set_level_window_ms(uint32_t ms);
+    uint32_t get_level_window_ms() const { return level_window_ms; }
+    float get_current_gain() const { return agc_gain_q16 / 65536.0f; }
     
     // 測試和調試方法
     bool self_test();
@@ -144,6 +287,8 @@ public:
 
     // 靜態工廠方法
     static INMP441Config create_default_config();
+    static INMP441Config create_oversampled_config(); // 48kHz + APLL，抽取到 16kHz
+    static INMP441Config create_stereo_config();      // 雙麥克風 48kHz 過取樣 + 波束成形
     static INMP441Config create_custom_config(uint8_t ws_pin, uint8_t sck_pin, uint8_t sd_pin, 
                                              uint32_t sample_rate = INMP441_SAMPLE_RATE);
     
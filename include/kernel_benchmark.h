@@ -0,0 +1,112 @@
+#ifndef KERNEL_BENCHMARK_H
+#define KERNEL_BENCHMARK_H
+
+#include <Arduino.h>
+#include "stage_profiler.h"
+
+// 基準測試配置
+#define KERNEL_BENCHMARK_MAX_CASES 64          // 可登錄的案例數（核心 × 幀長）
+#define KERNEL_BENCHMARK_REPETITIONS 5         // 每個案例的量測次數（報告中位數）
+#define KERNEL_BENCHMARK_MIN_BATCH_US 2000     // 每次量測的最短時間，不足時迭代次數加倍
+#define KERNEL_BENCHMARK_MAX_ITERATIONS 1000000
+#define KERNEL_BENCHMARK_JSON_BEGIN "===== KERNEL_BENCHMARK_JSON_BEGIN =====" // JSON 前後的分隔行，
+#define KERNEL_BENCHMARK_JSON_END "===== KERNEL_BENCHMARK_JSON_END ====="     // 供 benchmark_compare.py 從日誌取出
+
+/**
+ * 讓編譯器認為 value 會被讀取，避免核心的結果未使用而被整段最佳化掉
+ */
+template <typename T>
+inline void benchmark_keep(const T &value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ * 週期計數器：裝置上為 CPU 週期（CCOUNT），x86 主機為 TSC（固定頻率，不隨核心降頻變化）；
+ * 其他主機沒有可用的計數器，cycles_per_frame 回報為 0
+ */
+const char *benchmark_cycle_counter_name();
+
+/**
+ * 基準測試夾具（對應 Google Benchmark 的 Fixture）
+ * set_up 依幀長準備輸入與模組狀態，run 處理一幀，tear_down 釋放資源；只有 run 被計時
+ */
+class KernelBenchmarkFixture
+{
+public:
+    virtual ~KernelBenchmarkFixture() {}
+    virtual void set_up(size_t frame_size) { (void)frame_size; }
+    virtual void run() = 0;
+    virtual void tear_down() {}
+};
+
+struct KernelBenchmarkResult
+{
+    const char *name;         // 核心名稱（JSON 名稱為 name/frame_size）
+    size_t frame_size;        // 每次 run 處理的樣本數
+    uint32_t iterations;      // 每次量測的迭代次數
+    float ns_per_frame;       // 各次量測的中位數
+    float min_ns_per_frame;
+    float max_ns_per_frame;
+    float ns_per_sample;      // ns_per_frame / frame_size
+    float cycles_per_frame;   // 與中位數同一次量測的週期數
+};
+
+/**
+ * 核心微基準測試執行器
+ * 每個案例先加倍迭代次數直到單次量測超過 KERNEL_BENCHMARK_MIN_BATCH_US，
+ * 再以相同次數量測 KERNEL_BENCHMARK_REPETITIONS 次取中位數；
+ * 計時使用 profiler_ticks()（裝置上為 CPU 週期、主機上為奈秒），週期另由週期計數器讀取
+ */
+class KernelBenchmark
+{
+private:
+    struct Case
+    {
+        const char *name;
+        KernelBenchmarkFixture *fixture;
+        size_t frame_size;
+    };
+
+    Case cases[KERNEL_BENCHMARK_MAX_CASES];
+    KernelBenchmarkResult results[KERNEL_BENCHMARK_MAX_CASES];
+    size_t case_count;
+    size_t result_count;
+
+    uint32_t calibrate(KernelBenchmarkFixture *fixture);
+    void measure(KernelBenchmarkFixture *fixture, uint32_t iterations, float *ns, float *cycles);
+
+public:
+    KernelBenchmark();
+
+    /**
+     * 登錄單一幀長（固定輸入大小的核心，例如整幀特徵提取、推論）
+     */
+    bool add(const char *name, KernelBenchmarkFixture *fixture, size_t frame_size);
+
+    /**
+     * 登錄 min_size ~ max_size 間每個 2 的冪次幀長（相當於 Google Benchmark 的 Range）
+     */
+    bool add_range(const char *name, KernelBenchmarkFixture *fixture, size_t min_size, size_t max_size);
+
+    /**
+     * 依登錄順序執行所有案例，名稱含 filter 的才執行（nullptr 表示全部）
+     */
+    void run(const char *filter = nullptr);
+
+    size_t get_result_count() const { return result_count; }
+    const KernelBenchmarkResult &get_result(size_t index) const { return results[index]; }
+    const KernelBenchmarkResult *find_result(const char *name, size_t frame_size) const;
+
+    /**
+     * 人讀的表格
+     */
+    void print_table() const;
+
+    /**
+     * Google Benchmark 相容的 JSON（context + benchmarks），前後加上分隔行
+     */
+    void print_json(const char *executable) const;
+};
+
+#endif // KERNEL_BENCHMARK_H
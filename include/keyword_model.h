@@ -2,6 +2,7 @@
 #define KEYWORD_MODEL_H
 
 #include "audio_module.h"
+#include "metrics.h"
 #include <Arduino.h>
 
 // 關鍵字類別定義
@@ -24,7 +25,7 @@ struct KeywordResult
     float confidence;                   // 置信度 (0.0-1.0)
     float probabilities[KEYWORD_COUNT]; // 各類別機率
     bool is_activation;                 // 是否為激活關鍵字
-    unsigned long timestamp;            // 檢測時間戳
+    sample_time_t timestamp;            // 檢測時間戳（輸入特徵的樣本時間）
 };
 
 // 特徵向量維度
@@ -32,6 +33,9 @@ struct KeywordResult
 #define SEQUENCE_LENGTH 16 // 時序長度(幀數)
 #define TOTAL_FEATURES (FEATURE_SIZE * SEQUENCE_LENGTH)
 
+// 頻譜重心（相對 Nyquist）匹配：語音約落在 0.1–0.25，模板 spectral_peak_freq 使用同一單位
+#define KEYWORD_CENTROID_SCALE 0.75f // 匹配差距縮放（語音重心分布寬度相對舊高頻能量比例 0.3–0.5 的比值）
+
 // 關鍵字檢測器類別
 class KeywordDetector
 {
@@ -48,22 +52,31 @@ private:
 
     // 檢測狀態
     KeywordResult last_result;
-    unsigned long last_detection_time;
+    sample_time_t last_detection_time;
+    bool has_detection;                                  // 冷卻判斷用，不依賴可被外部重設的指標
     static constexpr unsigned long COOLDOWN_MS = 1000; // 1秒冷卻時間
-
-    // 統計資訊
-    int total_detections;
-    int false_positives;
+    static constexpr sample_time_t COOLDOWN_SAMPLES = (sample_time_t)COOLDOWN_MS * AUDIO_SAMPLE_RATE / 1000;
+    sample_time_t current_time;                          // detect() 目前處理的樣本時間（評分日誌限流用）
+    static constexpr uint32_t LOG_BURST = 4;              // 評分日誌每秒最多輸出筆數
+    static constexpr sample_time_t LOG_PERIOD_SAMPLES = AUDIO_SAMPLE_RATE;
+
+    // 統計資訊（指標登錄表管理，隨 metrics 快照匯出）
+    MetricCounter total_detections;    // 觸發的激活關鍵字
+    MetricCounter cooldown_rejections; // 冷卻時間內被忽略的激活關鍵字
+    MetricCounter low_confidence;      // 信心度不足而歸類為未知
     float running_noise_level;
 
+    // 通用 Debug 模組（評分輸出經非同步日誌，不阻塞偵測）
+    DebugPrint debug;
+
 public:
     KeywordDetector();
 
     // 主要檢測函數
     KeywordResult detect(const AudioFeatures &audio_features);
 
-    // 特徵提取
-    void extract_mfcc_features(const float *audio_frame, float *mfcc_features);
+    // 特徵提取（MFCC 由 AudioCaptureModule 每幀計算）
+    void extract_mfcc_features(const AudioFeatures &audio_features, float *mfcc_features);
 
     // 模型推理 (簡化版)
     KeywordClass classify_features(const float features[TOTAL_FEATURES], float *confidence);
@@ -71,21 +84,20 @@ public:
     // 輔助函數
     void reset();
     void print_stats();
-    bool is_in_cooldown();
+    bool is_in_cooldown(sample_time_t now) const; // 以樣本時間判斷，重播結果可重現
 
     // 調試函數
     void print_feature_buffer();
     void calibrate_noise_level(const AudioFeatures &features);
 
 private:
+    // 基準測試直接呼叫內部核心（test/dsp_kernel_benchmark.cpp）
+    friend struct KernelBenchmarkAccess;
+
     // 內部特徵處理
     void update_feature_buffer(const float *new_features);
     void flatten_features(float *output);
 
-    // 簡化的MFCC計算
-    void compute_mel_filters(const float *fft_power, float *mel_output);
-    void apply_dct(const float *mel_input, float *mfcc_output);
-
     // 分類器權重 (預訓練的簡化權重)
     float get_keyword_score(const float *features, KeywordClass keyword);
     void softmax(float *input, int size);
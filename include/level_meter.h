@@ -0,0 +1,120 @@
+#ifndef LEVEL_METER_H
+#define LEVEL_METER_H
+
+#include <Arduino.h>
+
+// 音量統計配置
+#define LEVEL_METER_WINDOW_MS 1000      // 視窗 min/max 區間（毫秒，以樣本時鐘計）
+#define LEVEL_METER_FLOOR_DBFS -120.0f  // 全為 0 的區塊回報的下限
+
+/**
+ * 單一區塊的累加器（轉換迴圈內的區域變數，欄位留在暫存器中）
+ * 樣本以 16-bit 刻度累加：512 樣本的平方和最多 2^39，int64 不會溢位
+ */
+struct AudioLevelAccumulator
+{
+    int32_t min_value;
+    int32_t max_value;
+    int64_t sum;
+    uint64_t sum_squares;
+
+    void reset()
+    {
+        min_value = INT16_MAX;
+        max_value = INT16_MIN;
+        sum = 0;
+        sum_squares = 0;
+    }
+
+    inline void add(int32_t sample)
+    {
+        if (sample < min_value)
+            min_value = sample;
+        if (sample > max_value)
+            max_value = sample;
+        sum += sample;
+        sum_squares += (uint32_t)(sample * sample);
+    }
+};
+
+/**
+ * 串流音量統計
+ * 每個區塊只合併一次累加器，查詢時由累計值換算，成本與區塊大小無關。
+ * 區塊值（峰值、RMS）描述最近一個區塊；視窗值（min/max、DC、RMS）描述最近一個完整視窗，
+ * 第一個視窗完成前則為目前累積中的部分視窗。視窗以樣本時鐘刻度計，低功耗 8kHz 模式下長度不變
+ */
+class AudioLevelMeter
+{
+public:
+    struct Stats
+    {
+        uint64_t total_samples;     // 累計樣本數（實際轉換的輸出樣本）
+        uint32_t clipped_samples;   // 累計飽和樣本數
+        int32_t block_peak;         // 最近區塊峰值 |x|（16-bit 刻度）
+        float block_rms;            // 最近區塊 RMS（16-bit 刻度）
+        float block_rms_dbfs;       // 最近區塊 RMS（dBFS，滿刻度方波為 0 dB）
+        float block_peak_dbfs;      // 最近區塊峰值（dBFS）
+        int32_t window_min;         // 視窗最小值
+        int32_t window_max;         // 視窗最大值
+        float window_dc;            // 視窗平均值（DC 偏移，16-bit 刻度）
+        float window_rms_dbfs;      // 視窗 RMS（dBFS）
+        uint32_t window_samples;    // 視窗實際樣本數
+        int32_t peak_hold;          // 重置以來的最大 |x|
+        unsigned long last_block_time; // 最後一個區塊的時間（millis）
+    };
+
+private:
+    // 累積中的視窗
+    int32_t window_min;
+    int32_t window_max;
+    int64_t window_sum;
+    uint64_t window_sum_squares;
+    uint32_t window_count;
+    uint32_t window_ticks;
+    uint32_t window_length;     // 視窗長度（樣本時鐘刻度）
+
+    // 最近一個完整視窗
+    bool has_window;
+    int32_t last_window_min;
+    int32_t last_window_max;
+    int64_t last_window_sum;
+    uint64_t last_window_sum_squares;
+    uint32_t last_window_count;
+
+    // 最近一個區塊
+    int32_t block_peak;
+    uint64_t block_sum_squares;
+    uint32_t block_count;
+
+    uint64_t total_samples;
+    uint32_t clipped_samples;
+    int32_t peak_hold;
+    unsigned long last_block_time;
+
+    void reset_window();
+
+public:
+    AudioLevelMeter();
+
+    /**
+     * 設定視窗長度（樣本時鐘刻度），並開始新的視窗
+     */
+    void set_window(uint32_t ticks);
+    uint32_t get_window() const { return window_length; }
+
+    /**
+     * 合併一個區塊（每個區塊呼叫一次）
+     * count 為樣本數，ticks 為其涵蓋的樣本時鐘刻度
+     */
+    void add_block(const AudioLevelAccumulator &block, uint32_t count, uint32_t ticks, uint32_t clipped);
+
+    Stats get_stats() const;
+    void reset();
+};
+
+/**
+ * 16-bit 刻度振幅轉 dBFS（0 回傳 LEVEL_METER_FLOOR_DBFS）
+ */
+float level_to_dbfs(float level);
+
+#endif // LEVEL_METER_H
@@ -0,0 +1,125 @@
+#ifndef LOAD_GOVERNOR_H
+#define LOAD_GOVERNOR_H
+
+#include <Arduino.h>
+#include <functional>
+#include "debug_print.h"
+
+// 負載調節預設配置
+#define LOAD_GOVERNOR_DEGRADE_LOAD 0.90f   // 平滑負載高於預算的 90% 即降級
+#define LOAD_GOVERNOR_RECOVER_LOAD 0.60f   // 低於 60% 持續一段時間才恢復
+#define LOAD_GOVERNOR_RECOVER_HOLD_MS 1000 // 恢復前需持續有餘裕的時間
+#define LOAD_GOVERNOR_MIN_DWELL_MS 200     // 兩次切換之間的最短停留時間（避免來回震盪）
+#define LOAD_GOVERNOR_SMOOTHING 0.1f       // 負載指數平滑係數（約 10 幀）
+
+/**
+ * 品質等級（數字越大越省 CPU）
+ */
+enum LoadLevel
+{
+    LOAD_LEVEL_FULL,           // 完整處理
+    LOAD_LEVEL_SILENCE_LITE,   // 靜音時略過倒頻譜（梅爾、噪音抑制、MFCC），只保留 VAD 需要的頻譜特徵
+    LOAD_LEVEL_SILENCE_STRIDE, // 靜音時每兩個 hop 只完整處理一次
+    LOAD_LEVEL_ENERGY_VAD,     // GMM VAD 改用能量 VAD（較小的模型）
+    LOAD_LEVEL_COUNT
+};
+
+// 切換原因
+enum LoadTransitionReason
+{
+    LOAD_REASON_OVERLOAD,      // 平滑負載超過降級門檻
+    LOAD_REASON_DEADLINE_MISS, // 錯過即時期限
+    LOAD_REASON_HEADROOM       // 餘裕恢復
+};
+
+// 單次等級切換
+struct LoadTransition
+{
+    int64_t time_us;   // 切換時間（呼叫端時間軸）
+    LoadLevel from;
+    LoadLevel to;
+    float load;        // 切換時的平滑負載（處理時間 / 預算）
+    LoadTransitionReason reason;
+};
+
+typedef std::function<void(const LoadTransition &transition)> LoadTransitionCallback;
+
+// 負載調節配置
+struct LoadGovernorConfig
+{
+    LoadLevel max_level;       // 允許降到的最低品質等級
+    float degrade_load;
+    float recover_load;
+    uint32_t recover_hold_ms;
+    uint32_t min_dwell_ms;
+    float smoothing;
+};
+
+/**
+ * CPU 負載調節器
+ * 每幀以處理時間對預算的比例更新平滑負載；過載或錯過期限時降一級，
+ * 餘裕持續足夠時間後恢復一級。時間由呼叫端傳入，主機上可用模擬時鐘測試
+ */
+class LoadGovernor
+{
+public:
+    struct LoadGovernorStats
+    {
+        LoadLevel level;                          // 目前等級
+        float load;                               // 目前平滑負載
+        float peak_load;                          // 單幀最高負載
+        uint32_t frames;
+        uint32_t transitions;
+        uint32_t degrades;
+        uint32_t recoveries;
+        uint64_t time_in_level_us[LOAD_LEVEL_COUNT];
+        LoadTransition last_transition;
+    };
+
+private:
+    LoadGovernorConfig config;
+    LoadTransitionCallback transition_callback;
+
+    LoadLevel level;
+    float smoothed_load;
+    int64_t last_update_us;
+    int64_t last_transition_us;
+    int64_t headroom_since_us; // 負載低於恢復門檻的起點（-1 表示目前沒有餘裕）
+    bool has_update;
+
+    LoadGovernorStats stats;
+
+    void change_level(LoadLevel to, int64_t now_us, LoadTransitionReason reason);
+
+public:
+    LoadGovernor();
+    explicit LoadGovernor(const LoadGovernorConfig &custom_config);
+
+    static LoadGovernorConfig create_default_config();
+    void set_config(const LoadGovernorConfig &new_config);
+    const LoadGovernorConfig &get_config() const { return config; }
+
+    void set_transition_callback(LoadTransitionCallback callback) { transition_callback = callback; }
+
+    /**
+     * 每幀處理完後呼叫
+     * @param now_us 目前時間（微秒，可為樣本時鐘換算值或模擬時鐘）
+     * @param busy_us 本幀處理時間
+     * @param budget_us 本幀預算
+     * @param deadline_missed 本幀是否錯過期限（立即降級，仍受最短停留時間限制）
+     * @return 目前等級
+     */
+    LoadLevel update(int64_t now_us, uint32_t busy_us, uint32_t budget_us, bool deadline_missed);
+
+    void reset();
+
+    LoadLevel get_level() const { return level; }
+    float get_load() const { return smoothed_load; }
+    LoadGovernorStats get_stats() const { return stats; }
+    void print_stats(const DebugPrint &out) const;
+
+    static const char *level_name(LoadLevel level);
+    static const char *reason_name(LoadTransitionReason reason);
+};
+
+#endif // LOAD_GOVERNOR_H
@@ -0,0 +1,96 @@
+#ifndef LOG_TOKEN_H
+#define LOG_TOKEN_H
+
+#include <Arduino.h>
+#include <string.h>
+#include <type_traits>
+
+// 權杖化日誌配置
+#ifndef LOG_TOKENIZED
+#define LOG_TOKENIZED 0 // 1 = DBG_* 巨集只輸出格式字串雜湊 + 二進位參數，由 python/log_token_decoder.py 還原
+#endif
+#define LOG_TOKEN_SYNC 0xF5        // 封包起始位元組（UTF-8 文字中不會出現）
+#define LOG_TOKEN_MAX_PAYLOAD 120  // 單一封包最大內容（權杖 + 模組 + 種類 + 參數）
+#define LOG_TOKEN_HEADER_SIZE 7    // 權杖 4 + 模組 2 + 種類 1
+#define LOG_TOKEN_FNV_OFFSET 2166136261u
+#define LOG_TOKEN_FNV_PRIME 16777619u
+
+/**
+ * 封包種類（決定解碼端加上的標籤與是否補換行，與 DebugPrint 各方法對應）
+ */
+enum LogTokenKind
+{
+    LOG_KIND_PRINTF = 0,
+    LOG_KIND_PRINT,
+    LOG_KIND_INFO,
+    LOG_KIND_SUCCESS,
+    LOG_KIND_WARNING,
+    LOG_KIND_ERROR,
+    LOG_KIND_TRUNCATED = 0x80 // 參數超出封包大小，字串參數已截斷
+};
+
+/**
+ * 格式字串雜湊（32-bit FNV-1a，對 UTF-8 位元組計算，與解碼工具相同）
+ */
+constexpr uint32_t log_token_hash(const char *text, uint32_t hash = LOG_TOKEN_FNV_OFFSET)
+{
+    return *text ? log_token_hash(text + 1, (hash ^ (uint8_t)*text) * LOG_TOKEN_FNV_PRIME) : hash;
+}
+
+/**
+ * 模組名稱雜湊（取 FNV-1a 高低 16 位元互斥或）
+ */
+constexpr uint16_t log_module_token(const char *name)
+{
+    return name ? (uint16_t)(log_token_hash(name) ^ (log_token_hash(name) >> 16)) : 0;
+}
+
+// 編譯期計算權杖；格式字串只出現在常數運算式中，不會放進韌體
+#define LOG_TOKEN(format) (std::integral_constant<uint32_t, log_token_hash(format)>::value)
+
+/**
+ * 權杖封包編碼器
+ * 封包格式: [SYNC][長度][權杖 u32][模組 u16][種類 u8][參數...]（小端序）
+ * 參數依 C++ 型別編碼：整數依型別寬度（ESP32 上 int/long/size_t 為 4 位元組，long long 為 8），
+ * 浮點數一律 float，字串以 NUL 結尾
+ */
+class LogTokenWriter
+{
+private:
+    uint8_t frame[2 + LOG_TOKEN_MAX_PAYLOAD];
+    size_t length;
+    bool truncated;
+
+    void put_bytes(const void *data, size_t size);
+
+public:
+    LogTokenWriter(uint32_t token, uint16_t module, uint8_t kind);
+
+    void put(int value) { put_bytes(&value, sizeof(value)); }
+    void put(unsigned int value) { put_bytes(&value, sizeof(value)); }
+    void put(long value) { put_bytes(&value, sizeof(value)); }
+    void put(unsigned long value) { put_bytes(&value, sizeof(value)); }
+    void put(long long value) { put_bytes(&value, sizeof(value)); }
+    void put(unsigned long long value) { put_bytes(&value, sizeof(value)); }
+    void put(double value);
+    void put(const char *text);
+
+    void encode() {}
+
+    template <typename T, typename... Rest>
+    void encode(T value, Rest... rest)
+    {
+        put(value);
+        encode(rest...);
+    }
+
+    /**
+     * 填入長度與截斷旗標，回傳完整封包大小
+     */
+    size_t finish();
+
+    const uint8_t *data() const { return frame; }
+    bool is_truncated() const { return truncated; }
+};
+
+#endif // LOG_TOKEN_H
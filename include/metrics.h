@@ -0,0 +1,168 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "debug_print.h"
+
+// 指標配置
+#define METRIC_HISTOGRAM_BUCKETS 16 // log2 分桶：第 k 桶為 [2^k, 2^(k+1))，第 0 桶含 0，最後一桶含以上
+#define METRICS_SNAPSHOT_SYNC 0xF6  // 二進位快照起始位元組（UTF-8 文字中不會出現，與日誌權杖封包區分）
+#define METRICS_SNAPSHOT_VERSION 1
+#define METRICS_SNAPSHOT_BUFFER_SIZE 1024 // 快照緩衝區（超出時截斷在完整指標邊界）
+
+enum MetricType
+{
+    METRIC_COUNTER = 0,  // 只增不減的計數
+    METRIC_GAUGE,        // 目前值或最大值
+    METRIC_HISTOGRAM     // 固定 log2 分桶的分佈
+};
+
+/**
+ * 指標基底
+ * 建構時串入全域登錄表（侵入式鏈結串列，不配置記憶體），解構時移除。
+ * 登錄與移除應在啟動或測試建立物件時進行；更新值只用 relaxed atomic，任何執行緒都可呼叫
+ */
+class Metric
+{
+private:
+    const char *name;
+    MetricType type;
+    Metric *next;
+
+    friend class MetricsRegistry;
+
+protected:
+    Metric(const char *metric_name, MetricType metric_type);
+    ~Metric();
+
+public:
+    Metric(const Metric &) = delete;
+    Metric &operator=(const Metric &) = delete;
+
+    const char *get_name() const { return name; }
+    MetricType get_type() const { return type; }
+};
+
+/**
+ * 計數器（32-bit：ESP32 上 64-bit atomic 需要鎖）
+ */
+class MetricCounter : public Metric
+{
+private:
+    std::atomic<uint32_t> value;
+
+public:
+    explicit MetricCounter(const char *name) : Metric(name, METRIC_COUNTER), value(0) {}
+
+    void add(uint32_t amount = 1) { value.fetch_add(amount, std::memory_order_relaxed); }
+    uint32_t get() const { return value.load(std::memory_order_relaxed); }
+    void reset() { value.store(0, std::memory_order_relaxed); }
+};
+
+/**
+ * 量測值（有號 32-bit）
+ */
+class MetricGauge : public Metric
+{
+private:
+    std::atomic<int32_t> value;
+
+public:
+    explicit MetricGauge(const char *name) : Metric(name, METRIC_GAUGE), value(0) {}
+
+    void set(int32_t new_value) { value.store(new_value, std::memory_order_relaxed); }
+
+    /**
+     * 只在新值較大時更新（記錄最大值用）
+     */
+    void update_max(int32_t candidate)
+    {
+        int32_t current = value.load(std::memory_order_relaxed);
+        while (candidate > current && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    int32_t get() const { return value.load(std::memory_order_relaxed); }
+    void reset() { value.store(0, std::memory_order_relaxed); }
+};
+
+/**
+ * 直方圖（固定記憶體，log2 分桶）
+ */
+class MetricHistogram : public Metric
+{
+private:
+    std::atomic<uint32_t> buckets[METRIC_HISTOGRAM_BUCKETS];
+
+public:
+    explicit MetricHistogram(const char *name);
+
+    static int bucket_of(uint32_t value)
+    {
+        int bucket = value ? 31 - __builtin_clz(value) : 0;
+        return bucket < METRIC_HISTOGRAM_BUCKETS ? bucket : METRIC_HISTOGRAM_BUCKETS - 1;
+    }
+
+    void record(uint32_t value) { buckets[bucket_of(value)].fetch_add(1, std::memory_order_relaxed); }
+    uint32_t get_bucket(int bucket) const { return buckets[bucket].load(std::memory_order_relaxed); }
+    uint32_t get_count() const;
+    void reset();
+};
+
+/**
+ * 指標登錄表
+ * 以 constexpr 建構函數常數初始化，任何靜態物件建構時都能安全登錄
+ *
+ * 文字快照（單行）: "metrics name=value name=[b0,b1,...] ...\n"（直方圖省略尾端的 0）
+ * 二進位快照（小端序）: [SYNC][長度 u16][版本 u8][指標數 u16]
+ *   每個指標: [類型 u8][名稱 NUL 結尾][計數器/量測值 4 bytes | 直方圖: 桶數 u8 + 各桶 u32]
+ */
+class MetricsRegistry
+{
+private:
+    Metric *head;
+    uint16_t count;
+
+    friend class Metric;
+    void add(Metric *metric);
+    void remove(Metric *metric);
+
+public:
+    constexpr MetricsRegistry() : head(nullptr), count(0) {}
+
+    uint16_t size() const { return count; }
+
+    /**
+     * 依名稱尋找（第一個符合者），找不到回傳 nullptr
+     */
+    const Metric *find(const char *name) const;
+
+    /**
+     * 寫入文字快照，回傳長度（不含 NUL）
+     */
+    size_t snapshot_text(char *buffer, size_t size) const;
+
+    /**
+     * 寫入二進位快照，回傳長度
+     */
+    size_t snapshot_binary(uint8_t *buffer, size_t size) const;
+
+    /**
+     * 把快照送到非同步日誌（分段寫入，不經 DebugPrint 的單行長度限制）
+     */
+    void emit_snapshot(bool binary) const;
+
+    /**
+     * 逐行輸出所有指標（人工閱讀用）
+     */
+    void print(const DebugPrint &out) const;
+
+    void reset_all();
+};
+
+// 全域實例
+extern MetricsRegistry metrics;
+
+#endif // METRICS_H
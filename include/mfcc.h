@@ -0,0 +1,113 @@
+#ifndef MFCC_H
+#define MFCC_H
+
+#include <Arduino.h>
+#include "spectral_features.h"
+
+// MFCC 配置常數
+#define MFCC_NUM_FILTERS 26     // 梅爾濾波器數量
+#define MFCC_NUM_COEFFS 13      // 輸出倒頻譜係數數量（含 c0）
+#define MFCC_LOW_FREQ 60        // 濾波器組最低頻率 (Hz)
+#define MFCC_HIGH_FREQ 7600     // 濾波器組最高頻率 (Hz)
+#define MFCC_DELTA_WINDOW 2     // 差分回歸窗 N（使用前後各 N 幀）
+#define MFCC_HISTORY_SIZE (2 * MFCC_DELTA_WINDOW + 1)
+#define MFCC_LOG_TABLE_BITS 7   // 對數表索引位元數（128 項）
+#define MFCC_LOG_FLOOR 1e-10f   // 梅爾能量下限，避免 log(0)
+
+// 定點格式
+#define MFCC_WEIGHT_FRAC_BITS 12 // 濾波器權重 Q12
+#define MFCC_FIXED_FRAC_BITS 10  // 對數能量與係數 Q10（自然對數單位）
+
+// 單幀 MFCC 輸出（浮點）
+struct MfccFeatures
+{
+    float coeffs[MFCC_NUM_COEFFS]; // 靜態係數
+    float delta[MFCC_NUM_COEFFS];  // 一階差分
+    float delta2[MFCC_NUM_COEFFS]; // 二階差分
+};
+
+// 單幀 MFCC 輸出（定點，Q10）
+struct MfccFixedFeatures
+{
+    int32_t coeffs[MFCC_NUM_COEFFS];
+    int32_t delta[MFCC_NUM_COEFFS];
+    int32_t delta2[MFCC_NUM_COEFFS];
+};
+
+/**
+ * 串流 MFCC 擷取器
+ * 輸入為 SpectralAnalyzer 的共用功率譜，所有三角函數與對數都在建構時查表，
+ * 每幀只做乘加運算。差分以最近 MFCC_HISTORY_SIZE 幀的回歸斜率計算，
+ * 相當於延遲 MFCC_DELTA_WINDOW 幀的中心差分。
+ *
+ * 支援兩段式呼叫：先 compute_mel_energies() 取得梅爾能量，
+ * 中間可插入噪音抑制等處理，再以 compute_from_mel() 完成倒頻譜。
+ */
+class MfccExtractor
+{
+private:
+    // 濾波器組：每個頻點最多屬於相鄰兩個三角濾波器，
+    // 權重 w 給 bin_channel 的上升段，1-w 給前一個濾波器的下降段
+    int8_t bin_channel[SPECTRAL_NUM_BINS]; // -1 表示不在任何濾波器的上升段
+    float bin_weight[SPECTRAL_NUM_BINS];
+    uint16_t bin_weight_q12[SPECTRAL_NUM_BINS];
+    int first_bin;
+    int last_bin;
+
+    // 正交 DCT-II 表
+    float dct_table[MFCC_NUM_COEFFS][MFCC_NUM_FILTERS];
+    int16_t dct_table_q15[MFCC_NUM_COEFFS][MFCC_NUM_FILTERS];
+
+    // log2(1 + (i + 0.5) / 2^bits) 對數表
+    float log2_table[1 << MFCC_LOG_TABLE_BITS];
+    uint16_t log2_table_q10[1 << MFCC_LOG_TABLE_BITS];
+
+    // 浮點差分歷史（環形緩衝區）
+    float coeff_history[MFCC_HISTORY_SIZE][MFCC_NUM_COEFFS];
+    float delta_history[MFCC_HISTORY_SIZE][MFCC_NUM_COEFFS];
+    int history_head;
+    bool history_primed;
+
+    // 定點差分歷史
+    int32_t coeff_history_q[MFCC_HISTORY_SIZE][MFCC_NUM_COEFFS];
+    int32_t delta_history_q[MFCC_HISTORY_SIZE][MFCC_NUM_COEFFS];
+    int history_head_q;
+    bool history_primed_q;
+
+    // 成本統計
+    uint32_t last_cycles;
+    uint64_t total_cycles;
+    uint32_t frame_count;
+
+    // 內部方法
+    void build_filterbank();
+    void build_dct_table();
+    void build_log_table();
+    float fast_log(float x) const;
+    int32_t fixed_log_q10(uint64_t x) const;
+
+public:
+    MfccExtractor();
+
+    // 浮點路徑
+    void compute_mel_energies(const float *power, float *mel_energies) const;
+    void compute_from_mel(const float *mel_energies, MfccFeatures *features);
+    void compute(const float *power, MfccFeatures *features);
+
+    // 定點路徑（功率譜為任意固定比例的 uint32，比例只影響 c0）
+    void compute_mel_energies_fixed(const uint32_t *power, uint64_t *mel_energies) const;
+    void compute_from_mel_fixed(const uint64_t *mel_energies, MfccFixedFeatures *features);
+    void compute_fixed(const uint32_t *power, MfccFixedFeatures *features);
+
+    /**
+     * 清除差分歷史（音訊不連續時呼叫）
+     */
+    void reset();
+
+    // 成本統計（浮點 compute_from_mel()，梅爾能量累加另計）
+    uint32_t get_last_cycles() const { return last_cycles; }
+    uint32_t get_average_cycles() const { return frame_count ? (uint32_t)(total_cycles / frame_count) : 0; }
+    uint32_t get_frame_count() const { return frame_count; }
+};
+
+#endif // MFCC_H
@@ -0,0 +1,91 @@
+#ifndef NOISE_SUPPRESSION_H
+#define NOISE_SUPPRESSION_H
+
+#include <Arduino.h>
+#include "mfcc.h"
+
+// 噪音估計與頻譜減法（參數沿用 TF Micro frontend 預設值）
+#define NS_NOISE_BITS 14               // 平滑係數 Q14
+#define NS_SMOOTHING_BITS 10           // 噪音估計額外精度位元
+#define NS_EVEN_SMOOTHING 0.025f       // 偶數通道噪音平滑係數
+#define NS_ODD_SMOOTHING 0.06f         // 奇數通道噪音平滑係數
+#define NS_MIN_SIGNAL_REMAINING 0.05f  // 減法後至少保留的訊號比例
+#define NS_SPEECH_RATIO_SHIFT 2        // 訊號超過噪音估計 2^2 倍時視為語音
+#define NS_SPEECH_SMOOTHING_SHIFT 4    // 語音期間噪音估計上升速度降為 1/16
+
+// PCAN（每通道自動增益正規化）
+#define NS_PCAN_STRENGTH 0.95f         // 正規化強度（噪音估計的指數）
+#define NS_PCAN_OFFSET 80.0f           // 噪音估計偏移，避免安靜時過度放大
+#define NS_PCAN_GAIN_BITS 21           // 增益表 Q21
+#define NS_PCAN_SNR_BITS 12            // SNR Q12
+#define NS_PCAN_OUTPUT_BITS 6          // 輸出 Q6
+#define NS_PCAN_LUT_STEP_BITS 3        // 增益表每倍頻 2^3 個取樣點
+
+// 浮點介面：梅爾能量乘以此值後轉為 uint32 處理
+#define NS_INPUT_SCALE 65536.0f
+
+#define NS_PCAN_LUT_SIZE ((32 - NS_PCAN_LUT_STEP_BITS) * (1 << NS_PCAN_LUT_STEP_BITS) + 1)
+
+/**
+ * 梅爾濾波器組噪音抑制
+ * 1. 每通道以一階 IIR 追蹤穩態噪音，頻譜減法並保留最低比例
+ * 2. PCAN：以 (噪音 + offset)^-strength 的增益正規化每通道，輸出近似 SNR
+ * 核心為定點實作（查表增益，逐通道無除法與超越函數），浮點介面只做格式轉換。
+ * 放在 MfccExtractor::compute_mel_energies() 與 compute_from_mel() 之間。
+ */
+class NoiseSuppressor
+{
+private:
+    uint64_t noise_estimate[MFCC_NUM_FILTERS]; // 噪音估計（左移 NS_SMOOTHING_BITS）
+    bool primed;
+    bool pcan_enabled;
+
+    uint16_t even_smoothing;
+    uint16_t odd_smoothing;
+    uint16_t min_signal_remaining;
+
+    // PCAN 增益表：小於 2^NS_PCAN_LUT_STEP_BITS 的值直接查表，其餘依倍頻與分段內插
+    uint16_t small_gain_lut[1 << NS_PCAN_LUT_STEP_BITS];
+    uint16_t gain_lut[NS_PCAN_LUT_SIZE];
+
+    // 最近一幀頻譜減法後與減法前的能量比（供能量特徵去噪）
+    float energy_ratio;
+
+    // 成本統計
+    uint32_t last_cycles;
+    uint64_t total_cycles;
+    uint32_t frame_count;
+
+    // 內部方法
+    void build_gain_lut();
+    uint32_t lookup_gain(uint32_t noise) const;
+    static uint32_t pcan_shrink(uint64_t snr);
+
+public:
+    NoiseSuppressor();
+
+    void reset();
+
+    /**
+     * 定點處理（就地）
+     * @param mel_energies MFCC_NUM_FILTERS 個梅爾能量
+     */
+    void process_fixed(uint32_t *mel_energies);
+
+    /**
+     * 浮點處理（就地），啟用 PCAN 時輸出為 SNR 單位
+     */
+    void process(float *mel_energies);
+
+    void set_pcan_enabled(bool enable) { pcan_enabled = enable; }
+    bool is_pcan_enabled() const { return pcan_enabled; }
+
+    float get_energy_ratio() const { return energy_ratio; }
+    uint32_t get_noise_estimate(int channel) const { return (uint32_t)(noise_estimate[channel] >> NS_SMOOTHING_BITS); }
+
+    // 成本統計
+    uint32_t get_last_cycles() const { return last_cycles; }
+    uint32_t get_average_cycles() const { return frame_count ? (uint32_t)(total_cycles / frame_count) : 0; }
+};
+
+#endif // NOISE_SUPPRESSION_H
@@ -0,0 +1,67 @@
+#ifndef POLYPHASE_DECIMATOR_H
+#define POLYPHASE_DECIMATOR_H
+
+#include <Arduino.h>
+
+// 抽取濾波器配置常數
+#define DECIMATOR_TAPS_PER_PHASE 30     // 每個相位的係數數量（總長 = 抽取倍率 × 30）
+#define DECIMATOR_MAX_FACTOR 6          // 最大抽取倍率（48kHz → 8kHz）
+#define DECIMATOR_MAX_TAPS (DECIMATOR_TAPS_PER_PHASE * DECIMATOR_MAX_FACTOR)
+#define DECIMATOR_KAISER_BETA 5.65f     // Kaiser 窗 β（約 60 dB 阻帶衰減）
+#define DECIMATOR_COEFF_BITS 15         // 係數 Q15
+
+/**
+ * 多相 FIR 抽取器
+ * 輸入與輸出都是 I2S 32-bit 容器格式（24-bit 樣本位於高位），
+ * 可直接接在 i2s_read() 與 INMP441 轉換階段之間。
+ *
+ * 只計算保留下來的輸出樣本（等同多相分解），並利用線性相位係數的對稱性
+ * 把乘法減半：每個輸出 taps/2 次乘加，每個輸入樣本 TAPS_PER_PHASE/2 次。
+ * 歷史以雙寫環形緩衝區保存，任意區塊大小皆可串流，切換倍率時保留歷史。
+ */
+class PolyphaseDecimator
+{
+private:
+    int16_t coeffs[DECIMATOR_MAX_TAPS / 2];  // 對稱係數的前半段
+    int32_t history[2 * DECIMATOR_MAX_TAPS]; // 24-bit 樣本，每個樣本寫兩次
+    int history_pos;
+    int factor;
+    int num_taps;
+    int phase;
+
+    // 成本統計
+    uint32_t last_cycles;
+    uint64_t total_cycles;
+    uint32_t output_count;
+
+    void design_filter();
+
+public:
+    PolyphaseDecimator();
+
+    /**
+     * 設定抽取倍率（1 表示直通），並重新設計截止頻率為輸出 Nyquist 的低通濾波器
+     * 歷史保留，可在串流中途切換
+     */
+    bool configure(int decimation_factor);
+
+    /**
+     * 處理一段輸入，回傳輸出樣本數
+     * output 可與 input 相同（原地處理）
+     */
+    size_t process(const int32_t *input, size_t length, int32_t *output);
+
+    void reset();
+
+    // 狀態查詢
+    int get_factor() const { return factor; }
+    int get_num_taps() const { return num_taps; }
+    int16_t get_coefficient(int index) const;
+
+    // 成本統計（每個輸出樣本的平均週期數）
+    uint32_t get_last_cycles() const { return last_cycles; }
+    uint32_t get_average_cycles_per_output() const { return output_count ? (uint32_t)(total_cycles / output_count) : 0; }
+    uint32_t get_output_count() const { return output_count; }
+};
+
+#endif // POLYPHASE_DECIMATOR_H
@@ -0,0 +1,68 @@
+#ifndef SAMPLE_CLOCK_H
+#define SAMPLE_CLOCK_H
+
+#include <Arduino.h>
+
+/**
+ * 樣本時間：自擷取開始以來的樣本數（以標稱輸出取樣率計，如 16kHz）
+ * 64-bit 在 16kHz 下不會溢位；所有區塊、幀、VAD 事件與關鍵字結果都以此標記，
+ * 延遲計算與主機重播不受 millis() 解析度或排程抖動影響
+ */
+typedef uint64_t sample_time_t;
+
+/**
+ * 單調遞增的樣本時鐘
+ * 由擷取端依實際讀到的樣本推進；低功耗 8kHz 模式下每個輸出樣本推進 2 個刻度，
+ * 時間軸在切換取樣率時保持連續。擷取開始時記錄 esp_timer 時間作為牆上時間原點；
+ * DMA 溢位遺失的樣本不計入樣本時間，由 resync() 將原點往後移，之後的換算仍對應實際擷取時間。
+ */
+class SampleClock
+{
+private:
+    uint32_t sample_rate;   // 刻度頻率（標稱輸出取樣率）
+    sample_time_t samples;  // 下一個樣本的時間
+    int64_t start_us;       // start() 時的 esp_timer 時間（微秒）
+    int64_t origin_us;      // 樣本 0 對應的 esp_timer 時間（遺失樣本後往後移）
+
+public:
+    SampleClock();
+
+    /**
+     * 歸零並記錄牆上時間原點（擷取開始時呼叫）
+     */
+    void start(uint32_t rate);
+
+    /**
+     * 推進 ticks 個刻度，回傳推進前的時間（即本區塊第一個樣本的時間）
+     */
+    sample_time_t advance(uint32_t ticks);
+
+    sample_time_t now() const { return samples; }
+    uint32_t get_sample_rate() const { return sample_rate; }
+
+    // 樣本數與時間長度互換
+    uint32_t to_ms(sample_time_t duration) const;
+    uint64_t to_us(sample_time_t duration) const;
+    sample_time_t from_ms(uint32_t ms) const;
+
+    /**
+     * 樣本時間轉為 esp_timer 牆上時間（微秒，與 esp_timer_get_time() 同一時間軸）
+     * 以最近一次 resync() 為準，早於遺失點的樣本換算會偏晚
+     */
+    int64_t to_wall_us(sample_time_t timestamp) const;
+
+    /**
+     * timestamp 的樣本不可能早於 earliest_wall_us 擷取（例如剛讀出的樣本不早於 DMA 緩衝區長度之前）；
+     * 換算結果較早表示之前遺失了樣本，原點往後移到 earliest_wall_us（只前移，誤差不超過緩衝區長度）
+     * @return 原點移動的微秒數
+     */
+    int64_t resync(sample_time_t timestamp, int64_t earliest_wall_us);
+
+    /**
+     * start() 的牆上時間，以及至今因遺失樣本而累計的原點移動（微秒）
+     */
+    int64_t get_start_us() const { return start_us; }
+    int64_t get_resync_us() const { return origin_us - start_us; }
+};
+
+#endif // SAMPLE_CLOCK_H
@@ -0,0 +1,78 @@
+#ifndef SPECTRAL_FEATURES_H
+#define SPECTRAL_FEATURES_H
+
+#include <Arduino.h>
+
+// 頻譜分析配置常數
+#define SPECTRAL_FFT_SIZE 256                          // FFT 點數（等於音訊幀長度）
+#define SPECTRAL_NUM_BINS (SPECTRAL_FFT_SIZE / 2 + 1)  // 實數 FFT 輸出頻點數
+#define SPECTRAL_SAMPLE_RATE 16000                     // 取樣率
+#define SPECTRAL_BAND_COUNT 8                          // 頻帶能量數量
+#define SPECTRAL_ROLLOFF_RATIO 0.85f                   // 滾降點能量比例
+
+// 頻帶邊界 (Hz)，共 SPECTRAL_BAND_COUNT + 1 個
+#define SPECTRAL_BAND_EDGES {0, 250, 500, 1000, 2000, 3000, 4000, 6000, 8000}
+
+// 單幀頻譜特徵
+struct SpectralFeatures
+{
+    float centroid;                       // 頻譜重心（相對 Nyquist，0~1）
+    float rolloff;                        // 85% 能量滾降點（相對 Nyquist，0~1）
+    float flatness;                       // 頻譜平坦度（幾何平均/算術平均，0~1）
+    float flux;                           // 與前一幀幅度譜的 L2 距離
+    float band_energy[SPECTRAL_BAND_COUNT]; // 各頻帶功率總和
+};
+
+/**
+ * 頻譜分析器
+ * 每幀只做一次實數 FFT，所有頻譜特徵與後級（如 MFCC）共用同一份功率譜
+ */
+class SpectralAnalyzer
+{
+private:
+    // 預先計算的表格（建構時計算一次）
+    float twiddle_re[SPECTRAL_FFT_SIZE / 2]; // cos(2*pi*k/N)
+    float twiddle_im[SPECTRAL_FFT_SIZE / 2]; // -sin(2*pi*k/N)
+    uint8_t bit_reverse[SPECTRAL_FFT_SIZE / 2];
+    int band_edges[SPECTRAL_BAND_COUNT + 1]; // 頻帶邊界頻點
+
+    // 工作緩衝區
+    float fft_re[SPECTRAL_FFT_SIZE / 2];
+    float fft_im[SPECTRAL_FFT_SIZE / 2];
+
+    // 共用輸出
+    float power[SPECTRAL_NUM_BINS];
+    float magnitude[SPECTRAL_NUM_BINS];
+    float prev_magnitude[SPECTRAL_NUM_BINS];
+    bool has_previous;
+
+    // 成本統計
+    uint32_t last_cycles;
+    uint64_t total_cycles;
+    uint32_t frame_count;
+
+    // 內部方法
+    void compute_power_spectrum(const float *frame);
+
+public:
+    SpectralAnalyzer();
+
+    /**
+     * 分析一幀（已套用窗函數）的頻譜特徵
+     * @param frame SPECTRAL_FFT_SIZE 個樣本
+     * @param features 輸出特徵
+     */
+    void analyze(const float *frame, SpectralFeatures *features);
+
+    void reset();
+
+    // 共用功率譜 |X[k]|^2，k = 0..SPECTRAL_NUM_BINS-1（未正規化）
+    const float *get_power_spectrum() const { return power; }
+
+    // 成本統計
+    uint32_t get_last_cycles() const { return last_cycles; }
+    uint32_t get_average_cycles() const { return frame_count ? (uint32_t)(total_cycles / frame_count) : 0; }
+    uint32_t get_frame_count() const { return frame_count; }
+};
+
+#endif // SPECTRAL_FEATURES_H
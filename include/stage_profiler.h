@@ -0,0 +1,137 @@
+#ifndef STAGE_PROFILER_H
+#define STAGE_PROFILER_H
+
+#include <Arduino.h>
+#include "debug_print.h"
+
+// 編譯期開關（於 platformio.ini build_flags 加上 -DPROFILER_ENABLED=0 即完全移除）
+// 停用時 PROFILE_SCOPE 等巨集展開為空，StageProfiler 類別與全域實例都不會編譯
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+// 管線各階段
+enum ProfileStage
+{
+    PROFILE_STAGE_BEAMFORM,  // 立體聲延遲相加
+    PROFILE_STAGE_DECIMATE,  // 多相抽取
+    PROFILE_STAGE_CONVERT,   // INMP441 轉換（DC 阻隔、AGC、飽和）
+    PROFILE_STAGE_FRAME,     // 幀組裝（get_current_frame）
+    PROFILE_STAGE_GATE,      // 能量閘門
+    PROFILE_STAGE_FEATURES,  // 特徵提取（FFT、頻譜、MFCC）
+    PROFILE_STAGE_VAD,       // VAD 狀態機
+    PROFILE_STAGE_KEYWORD,   // 關鍵字檢測
+    PROFILE_STAGE_CALLBACK,  // 使用者回調（幀、VAD、語音完成）
+    PROFILE_STAGE_COUNT
+};
+
+/**
+ * 計時來源：裝置上為 CPU 週期計數器，主機上為 CLOCK_MONOTONIC 奈秒
+ * 32-bit 計數只用來量測區間，回繞以無號減法處理（追蹤記錄器在分析器停用時也使用）
+ */
+#if defined(ESP_PLATFORM)
+inline uint32_t profiler_ticks() { return ESP.getCycleCount(); }
+inline uint32_t profiler_ticks_per_us() { return ESP.getCpuFreqMHz(); }
+#else
+#include <time.h>
+inline uint32_t profiler_ticks()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+inline uint32_t profiler_ticks_per_us() { return 1000; }
+#endif
+
+#if PROFILER_ENABLED
+
+// 直方圖：每個 2 的冪次區間再分 4 個子區間（解析度約 ±12%），最高約 2^25 ticks
+#define PROFILER_SUB_BUCKET_BITS 2
+#define PROFILER_SUB_BUCKETS (1 << PROFILER_SUB_BUCKET_BITS)
+#define PROFILER_BUCKETS 96
+
+/**
+ * 各階段耗時統計（固定記憶體，不做任何動態配置）
+ * 每筆記錄只更新計數、總和、最小/最大值與一個直方圖桶，p99 由直方圖估計
+ */
+class StageProfiler
+{
+public:
+    // 單一階段摘要（ticks）
+    struct StageStats
+    {
+        uint32_t count;
+        uint32_t min;
+        uint32_t mean;
+        uint32_t p99;   // 直方圖桶上界，不超過 max
+        uint32_t max;
+    };
+
+private:
+    struct StageData
+    {
+        uint32_t count;
+        uint32_t min;
+        uint32_t max;
+        uint64_t total;
+        uint32_t histogram[PROFILER_BUCKETS];
+    };
+
+    StageData stages[PROFILE_STAGE_COUNT];
+
+    static int bucket_index(uint32_t ticks);
+    static uint32_t bucket_upper_bound(int index);
+
+public:
+    StageProfiler();
+
+    void record(ProfileStage stage, uint32_t ticks);
+
+    /**
+     * 記錄一個區間，並同時送到追蹤記錄器（TRACE_ENABLED 時）
+     */
+    void record_span(ProfileStage stage, uint32_t start, uint32_t end);
+    void reset();
+
+    StageStats get_stats(ProfileStage stage) const;
+
+    /**
+     * 精簡輸出：每個有記錄的階段一行（微秒）
+     */
+    void print(const DebugPrint &out) const;
+
+    static const char *stage_name(ProfileStage stage);
+};
+
+// 全域實例
+extern StageProfiler stage_profiler;
+
+/**
+ * 區塊計時器：建構時讀取計數器，解構時記錄
+ */
+class ScopedStageTimer
+{
+private:
+    ProfileStage stage;
+    uint32_t start;
+
+public:
+    explicit ScopedStageTimer(ProfileStage s) : stage(s), start(profiler_ticks()) {}
+    ~ScopedStageTimer() { stage_profiler.record_span(stage, start, profiler_ticks()); }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(stage) ScopedStageTimer PROFILE_CONCAT(profile_scope_, __LINE__)(stage)
+#define PROFILE_PRINT(out) stage_profiler.print(out)
+#define PROFILE_RESET() stage_profiler.reset()
+
+#else
+
+#define PROFILE_SCOPE(stage) ((void)0)
+#define PROFILE_PRINT(out) ((void)0)
+#define PROFILE_RESET() ((void)0)
+
+#endif // PROFILER_ENABLED
+
+#endif // STAGE_PROFILER_H
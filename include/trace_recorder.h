@@ -0,0 +1,198 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "stage_profiler.h"
+
+// 編譯期開關（於 platformio.ini build_flags 加上 -DTRACE_ENABLED=0 即完全移除）
+// 停用時 TRACE_* 巨集展開為空，TraceRecorder 類別與全域實例都不會編譯
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+// 事件種類：0 ~ PROFILE_STAGE_COUNT - 1 為 PROFILE_SCOPE 的各階段，之後為管線事件
+enum TraceEventId
+{
+    TRACE_EVENT_CAPTURE = PROFILE_STAGE_COUNT, // I2S 讀取（含波束成形、抽取、轉換），arg = 區塊起始樣本時間
+    TRACE_EVENT_HOP,            // 一個 hop 的完整處理（期限監測範圍），arg = 幀起始樣本時間
+    TRACE_EVENT_VAD_STATE,      // VAD 狀態轉換（瞬間事件），arg = 新狀態
+    TRACE_EVENT_DETECTION,      // 關鍵字激活（瞬間事件），arg = 關鍵字類別
+    TRACE_EVENT_DEADLINE_MISS,  // 期限未達成（瞬間事件），arg = 處理耗時（微秒）
+    TRACE_EVENT_SERIAL,         // 日誌輸出到 Serial，arg = 位元組數
+    TRACE_EVENT_SAMPLE_CLOCK,   // 樣本時鐘錨點（瞬間事件），arg = 當下樣本時間（低 32 位元）
+    TRACE_EVENT_COUNT
+};
+
+enum TracePhase
+{
+    TRACE_PHASE_SPAN = 0,  // 區間（start + duration）
+    TRACE_PHASE_INSTANT    // 瞬間事件
+};
+
+#if TRACE_ENABLED
+
+// 追蹤配置
+#define TRACE_RING_EVENTS 1024      // 環形緩衝區事件數（必須是 2 的冪次，每筆 16 bytes）
+#define TRACE_RING_MASK (TRACE_RING_EVENTS - 1)
+#define TRACE_DUMP_SYNC 0xF7        // 傾印起始位元組（與日誌權杖 0xF5、指標快照 0xF6 區分）
+#define TRACE_DUMP_VERSION 1
+#define TRACE_TRIGGER_POST_EVENTS (TRACE_RING_EVENTS / 4) // 觸發後再記錄的事件數
+
+/**
+ * 單筆事件（16 bytes，小端序原樣傾印）
+ * 時間為 profiler_ticks()：裝置上為 CPU 週期、主機上為奈秒，
+ * 由 SAMPLE_CLOCK 錨點換算回樣本時鐘
+ */
+struct TraceEvent
+{
+    uint32_t start;     // 開始時間（ticks）
+    uint32_t duration;  // 區間長度（ticks，瞬間事件為 0）
+    uint32_t arg;       // 事件參數
+    uint8_t id;         // TraceEventId 或 ProfileStage
+    uint8_t phase;      // TracePhase
+    uint8_t core;       // 執行的 CPU 核心
+    uint8_t reserved;
+};
+
+/**
+ * 固定大小的二進位追蹤環形緩衝區（飛行記錄器）
+ * 持續覆寫最舊的事件；每筆只有一次 atomic 遞增與 16 bytes 寫入，多核心可同時記錄。
+ * 傾印前先停止記錄，以 python/trace_to_chrome.py 轉為 Chrome trace_event JSON
+ *
+ * 傾印格式（小端序）:
+ *   [SYNC][版本 u8][其後長度 u32][ticks_per_us u32][取樣率 u32][事件數 u32][覆寫遺失數 u32]
+ *   [名稱數 u8][各事件名稱 NUL 結尾][事件 × 事件數（由舊到新）]
+ */
+class TraceRecorder
+{
+private:
+    TraceEvent events[TRACE_RING_EVENTS];
+    std::atomic<uint32_t> head;      // 下一個寫入位置（單調遞增，取模後為槽位）
+    uint32_t origin;                 // start() 時的 head（之前的事件不傾印）
+    std::atomic<bool> recording;
+    std::atomic<bool> trigger_armed;
+    std::atomic<bool> trigger_fired;
+    std::atomic<uint32_t> stop_at;   // 觸發後停止記錄的位置
+    uint32_t sample_rate;
+
+    static uint8_t current_core();
+
+    void push(uint8_t id, uint8_t phase, uint32_t start, uint32_t duration, uint32_t arg)
+    {
+        if (!recording.load(std::memory_order_relaxed))
+            return;
+        uint32_t pos = head.fetch_add(1, std::memory_order_relaxed);
+        if (trigger_fired.load(std::memory_order_relaxed) &&
+            (int32_t)(pos - stop_at.load(std::memory_order_relaxed)) >= 0)
+        {
+            // 觸發後的事件已記錄足夠：停止，stop_at 之後的位置不寫入也不傾印
+            recording.store(false, std::memory_order_relaxed);
+            return;
+        }
+        TraceEvent &event = events[pos & TRACE_RING_MASK];
+        event.start = start;
+        event.duration = duration;
+        event.arg = arg;
+        event.id = id;
+        event.phase = phase;
+        event.core = current_core();
+        event.reserved = 0;
+    }
+
+public:
+    TraceRecorder();
+
+    void span(uint8_t id, uint32_t start, uint32_t end, uint32_t arg = 0)
+    {
+        push(id, TRACE_PHASE_SPAN, start, end - start, arg);
+    }
+
+    void instant(uint8_t id, uint32_t arg = 0)
+    {
+        if (recording.load(std::memory_order_relaxed)) // 停止時不讀計數器
+            push(id, TRACE_PHASE_INSTANT, profiler_ticks(), 0, arg);
+    }
+
+    /**
+     * 記錄樣本時鐘錨點：此刻樣本時鐘為 samples（擷取端每個區塊呼叫一次）
+     */
+    void clock(uint64_t samples) { instant(TRACE_EVENT_SAMPLE_CLOCK, (uint32_t)samples); }
+    void set_sample_rate(uint32_t rate) { sample_rate = rate; }
+
+    /**
+     * 開始記錄（清除舊事件與觸發狀態）／停止記錄（保留內容供傾印）
+     */
+    void start();
+    void stop() { recording.store(false, std::memory_order_relaxed); }
+    bool is_recording() const { return recording.load(std::memory_order_relaxed); }
+
+    /**
+     * 觸發：arm() 之後第一次 fire() 再記錄 TRACE_TRIGGER_POST_EVENTS 筆就停止，
+     * 緩衝區保留觸發點前後的事件（例如期限未達成時）
+     */
+    void arm() { trigger_armed.store(true, std::memory_order_relaxed); }
+    void fire();
+    bool is_armed() const { return trigger_armed.load(std::memory_order_relaxed); }
+    bool has_fired() const { return trigger_fired.load(std::memory_order_relaxed); }
+
+    /**
+     * 目前緩衝區內的事件數與被覆寫的事件數
+     */
+    uint32_t size() const;
+    uint32_t lost() const;
+    uint32_t get_sample_rate() const { return sample_rate; }
+
+    /**
+     * 停止記錄並經非同步日誌分段傾印（不會與其他日誌交錯），回傳位元組數
+     * 傾印後不會自動重新開始，需再呼叫 start()
+     */
+    size_t dump();
+
+    /**
+     * 依序取得第 index 筆（0 為最舊）
+     */
+    const TraceEvent &get_event(uint32_t index) const;
+
+    static const char *event_name(uint8_t id);
+};
+
+// 全域實例
+extern TraceRecorder trace;
+
+/**
+ * 區塊追蹤：建構時讀取計數器，解構時記錄區間
+ */
+class ScopedTraceSpan
+{
+private:
+    uint8_t id;
+    uint32_t arg;
+    uint32_t start;
+
+public:
+    ScopedTraceSpan(uint8_t event_id, uint32_t event_arg) : id(event_id), arg(event_arg), start(profiler_ticks()) {}
+    ~ScopedTraceSpan() { trace.span(id, start, profiler_ticks(), arg); }
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(id, arg) ScopedTraceSpan TRACE_CONCAT(trace_scope_, __LINE__)((id), (uint32_t)(arg))
+#define TRACE_SPAN(id, start, arg) trace.span((id), (start), profiler_ticks(), (uint32_t)(arg))
+#define TRACE_INSTANT(id, arg) trace.instant((id), (uint32_t)(arg))
+#define TRACE_CLOCK(samples) trace.clock(samples)
+#define TRACE_SET_SAMPLE_RATE(rate) trace.set_sample_rate(rate)
+#define TRACE_FIRE() trace.fire()
+
+#else
+
+#define TRACE_SCOPE(id, arg) ((void)0)
+#define TRACE_SPAN(id, start, arg) ((void)(start))
+#define TRACE_INSTANT(id, arg) ((void)0)
+#define TRACE_CLOCK(samples) ((void)0)
+#define TRACE_SET_SAMPLE_RATE(rate) ((void)0)
+#define TRACE_FIRE() ((void)0)
+
+#endif // TRACE_ENABLED
+
+#endif // TRACE_RECORDER_H
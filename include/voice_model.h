@@ -40,6 +40,9 @@ private:
     static constexpr float SPEECH_ZCR_MAX = 0.35f;
     static constexpr float MUSIC_ZCR_MAX = 0.15f;
     static constexpr float NOISE_ZCR_MIN = 0.3f;
+    static constexpr float SPEECH_CENTROID_MIN = 0.05f;    // 頻譜重心下限（相對 Nyquist，約 400Hz）
+    static constexpr float SPEECH_CENTROID_MAX = 0.45f;    // 頻譜重心上限（約 3.6kHz）
+    static constexpr float SPEECH_CENTROID_CENTER = 0.2f;  // 典型語音頻譜重心（約 1.6kHz）
 
     // 歷史狀態（用於平滑處理）
     static constexpr int HISTORY_SIZE = 10;
@@ -0,0 +1,161 @@
+"""
+核心基準測試結果擷取與比較
+從 test/dsp_kernel_benchmark.cpp 的輸出（主機 stdout 或裝置序列埠）取出 KERNEL_BENCHMARK_JSON 區段，
+加上目前的 git 提交後存檔；指定 --baseline 時逐項比較，耗時增加超過門檻即列為退步並以結束碼 1 離開，
+可直接放進 CI 或 git bisect run。
+
+JSON 欄位與 Google Benchmark 相容（real_time / cpu_time / time_unit），也可以用其 compare.py 比較。
+以 real_time 比較時，中位數與最短耗時都增加超過門檻才判定退步，單次量測受干擾不會誤報。
+
+用法:
+  python benchmark_compare.py --input bench.log -o bench.json                        # 主機：build/dsp_kernel_benchmark > bench.log
+  python benchmark_compare.py --port COM12 -o bench.json                             # 裝置：送出 b 指令並等待結果（需要 pyserial）
+  python benchmark_compare.py --input bench.log --baseline main.json --threshold 5   # 與基準比較
+  python benchmark_compare.py --input new.json --baseline old.json --metric cycles_per_frame
+"""
+
+import argparse
+import json
+import subprocess
+import sys
+import time
+
+JSON_BEGIN = "===== KERNEL_BENCHMARK_JSON_BEGIN ====="
+JSON_END = "===== KERNEL_BENCHMARK_JSON_END ====="
+
+# 設定不同時數字不可直接比較
+CONTEXT_KEYS = ("platform", "cycle_counter", "sample_format", "profiler_enabled", "trace_enabled",
+                "library_build_type", "mhz_per_cpu")
+
+
+def extract_results(text):
+    """取出最後一個完整的 JSON 區段；輸入本身就是 JSON 檔時直接解析"""
+    if text.lstrip().startswith("{"):
+        return json.loads(text)
+
+    end = text.rfind(JSON_END)
+    begin = text.rfind(JSON_BEGIN, 0, end if end >= 0 else len(text))
+    if begin < 0 or end < 0:
+        return None
+    return json.loads(text[begin + len(JSON_BEGIN):end])
+
+
+def git_commit():
+    try:
+        commit = subprocess.check_output(["git", "rev-parse", "--short", "HEAD"], stderr=subprocess.DEVNULL)
+        dirty = subprocess.call(["git", "diff", "--quiet", "HEAD"], stderr=subprocess.DEVNULL) != 0
+        return commit.decode().strip() + ("-dirty" if dirty else "")
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def read_port(port_name, baud, timeout):
+    import serial  # pyserial
+
+    data = bytearray()
+    with serial.Serial(port_name, baud, timeout=0.1) as port:
+        port.write(b"b")
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            data.extend(port.read(4096))
+            if JSON_END.encode() in data:
+                break
+    return data.decode("utf-8", errors="replace")
+
+
+def compare(baseline, current, metric, threshold):
+    """回傳 (表格列, 退步項目數)"""
+    old = {b["name"]: b for b in baseline["benchmarks"]}
+    rows = []
+    regressions = 0
+    for bench in current["benchmarks"]:
+        name = bench["name"]
+        if name not in old:
+            rows.append("  %-38s %12s %12.1f %9s" % (name, "-", bench[metric], "新增"))
+            continue
+
+        before = old.pop(name)
+        if before[metric] <= 0:
+            continue
+        change = (bench[metric] - before[metric]) / before[metric] * 100.0
+
+        # 時間指標另要求最短耗時也增加超過門檻，單次量測受干擾不會誤報
+        consistent = True
+        if metric == "real_time" and before.get("min_time", 0) > 0:
+            consistent = (bench["min_time"] - before["min_time"]) / before["min_time"] * 100.0 > threshold
+        if change > threshold and consistent:
+            mark = "❌ 退步"
+            regressions += 1
+        elif change < -threshold:
+            mark = "✅ 改善"
+        else:
+            mark = ""
+        rows.append("  %-38s %12.1f %12.1f %+8.1f%% %s" % (name, before[metric], bench[metric], change, mark))
+
+    for name in old:
+        rows.append("  %-38s %12.1f %12s %9s" % (name, old[name][metric], "-", "移除"))
+    return rows, regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="核心基準測試結果擷取與比較")
+    parser.add_argument("--port", help="序列埠（例如 COM12 或 /dev/ttyACM0），自動送出 b 指令")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=60.0, help="序列埠等待結果的秒數")
+    parser.add_argument("--input", help="基準測試輸出或已存的 JSON（- 表示 stdin）")
+    parser.add_argument("-o", "--output", help="存檔路徑（加上 git 提交與時間）")
+    parser.add_argument("--baseline", help="作為比較基準的 JSON")
+    parser.add_argument("--metric", choices=("real_time", "ns_per_sample", "cycles_per_frame"), default="real_time",
+                        help="比較的指標（預設 real_time，即中位數 ns/幀）")
+    parser.add_argument("--threshold", type=float, default=10.0, help="退步門檻（百分比，預設 10）")
+    args = parser.parse_args()
+
+    if args.port:
+        text = read_port(args.port, args.baud, args.timeout)
+    else:
+        stream = sys.stdin if args.input in (None, "-") else open(args.input, encoding="utf-8", errors="replace")
+        with stream:
+            text = stream.read()
+
+    results = extract_results(text)
+    if results is None:
+        sys.stderr.write("找不到基準測試結果（%s）\n" % JSON_BEGIN)
+        sys.exit(2)
+
+    context = results.setdefault("context", {})
+    if "git_commit" not in context:
+        commit = git_commit()
+        if commit:
+            context["git_commit"] = commit
+        context["date"] = time.strftime("%Y-%m-%dT%H:%M:%S")
+
+    if args.output:
+        with open(args.output, "w") as out:
+            json.dump(results, out, indent=2, ensure_ascii=False)
+        sys.stderr.write("已寫入 %s（%d 項）\n" % (args.output, len(results["benchmarks"])))
+
+    if not args.baseline:
+        return
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    base_context = baseline.get("context", {})
+    for key in CONTEXT_KEYS:
+        if base_context.get(key) != context.get(key):
+            print("⚠️  %s 不同：基準 %s，目前 %s" % (key, base_context.get(key), context.get(key)))
+
+    print("比較 %s：基準 %s → 目前 %s（門檻 %.1f%%）" % (args.metric, base_context.get("git_commit", args.baseline),
+                                                  context.get("git_commit", "?"), args.threshold))
+    print("  %-38s %12s %12s %9s" % ("名稱", "基準", "目前", "變化"))
+    rows, regressions = compare(baseline, results, args.metric, args.threshold)
+    for row in rows:
+        print(row)
+
+    if regressions:
+        print("❌ %d 項退步" % regressions)
+        sys.exit(1)
+    print("✅ 沒有退步")
+
+
+if __name__ == "__main__":
+    main()
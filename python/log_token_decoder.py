@@ -0,0 +1,356 @@
+"""
+權杖化日誌解碼器
+韌體以 -DLOG_TOKENIZED=1 編譯時，DBG_* 巨集只送出格式字串的 FNV-1a 雜湊與二進位參數
+（封包格式見 include/log_token.h）。本工具掃描 src/ 與 include/ 內的 DBG_* 呼叫建立權杖字典，
+把序列埠資料還原成文字；指標二進位快照（include/metrics.h）解成單行文字，
+追蹤傾印（include/trace_recorder.h）只標示位置（以 trace_to_chrome.py 轉換），其餘非封包的位元組（Serial.println、統計輸出等）原樣輸出。
+
+用法:
+  python log_token_decoder.py --port COM12               # 即時解碼序列埠（需要 pyserial）
+  python log_token_decoder.py --input capture.bin        # 解碼錄下的原始資料
+  python log_token_decoder.py --dictionary               # 列出字典與可省下的 Flash 字串大小
+  加上 --stats 在結束時輸出封包的線上位元組數與還原後文字位元組數（序列埠模式另含每秒位元組數）
+"""
+
+import argparse
+import glob
+import os
+import re
+import struct
+import sys
+import time
+
+LOG_TOKEN_SYNC = 0xF5
+LOG_TOKEN_HEADER_SIZE = 7
+LOG_KIND_TRUNCATED = 0x80
+METRICS_SNAPSHOT_SYNC = 0xF6
+TRACE_DUMP_SYNC = 0xF7
+METRIC_TYPES = ("counter", "gauge", "histogram")
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+
+# 與 DebugPrint 各方法相同的標籤與換行
+KIND_LABELS = {
+    0: ("", False),                 # printf
+    1: ("", True),                  # print
+    2: ("ℹ️  ", True),             # info
+    3: ("✅ ", True),               # success
+    4: ("⚠️  WARNING: ", True),    # warning
+    5: ("❌ ERROR: ", True),        # error / error_f
+}
+
+MACRO_PATTERN = re.compile(r"\bDBG_[A-Z_]+\(")
+MODULE_PATTERN = re.compile(r"(?:\bdebug\w*|\bDebugPrint\s+\w+|set_module_name)\(\s*\"([^\"]+)\"")
+STRING_PATTERN = re.compile(r'\s*"((?:[^"\\]|\\.)*)"')
+SPEC_PATTERN = re.compile(r"%([-+ #0]*)(\d+)?(?:\.(\d+))?(hh|h|ll|l|z|j|t|L)?([diouxXcfFeEgGsp%])")
+
+ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "\\": "\\", '"': '"', "'": "'", "0": "\0"}
+
+
+def fnv1a(data):
+    value = FNV_OFFSET
+    for byte in data:
+        value = ((value ^ byte) * FNV_PRIME) & 0xFFFFFFFF
+    return value
+
+
+def module_token(name):
+    # 與 log_module_token() 相同：32-bit 雜湊高低 16 位元互斥或
+    value = fnv1a(name.encode("utf-8"))
+    return (value ^ (value >> 16)) & 0xFFFF
+
+
+def unescape(literal):
+    result = []
+    i = 0
+    while i < len(literal):
+        if literal[i] == "\\" and i + 1 < len(literal):
+            result.append(ESCAPES.get(literal[i + 1], literal[i + 1]))
+            i += 2
+        else:
+            result.append(literal[i])
+            i += 1
+    return "".join(result)
+
+
+def read_literal(source, pos):
+    # 讀取 pos 開始的一串相鄰字串常值（C 語言會自動串接）
+    parts = []
+    while True:
+        match = STRING_PATTERN.match(source, pos)
+        if not match:
+            break
+        parts.append(unescape(match.group(1)))
+        pos = match.end()
+    return "".join(parts) if parts else None
+
+
+def find_format(source, pos):
+    # 格式字串是巨集參數中第一個以字串常值開頭的參數（限流巨集前面另有次數/時間參數）
+    depth = 0
+    at_argument = False  # 第一個參數是 DebugPrint 物件
+    while pos < len(source):
+        char = source[pos]
+        if at_argument and not char.isspace():
+            if char == '"':
+                return read_literal(source, pos)
+            at_argument = False
+        if char == '"':
+            match = STRING_PATTERN.match(source, pos)
+            pos = match.end() if match else pos + 1
+            continue
+        if char in "([{":
+            depth += 1
+        elif char in ")]}":
+            if depth == 0:
+                return None
+            depth -= 1
+        elif char == "," and depth == 0:
+            at_argument = True
+        pos += 1
+    return None
+
+
+def build_dictionary(source_dirs):
+    formats = {}
+    modules = {}
+    collisions = []
+    files = []
+    for source_dir in source_dirs:
+        files += sorted(glob.glob(os.path.join(source_dir, "*.cpp")) + glob.glob(os.path.join(source_dir, "*.h")))
+    for path in files:
+        with open(path, encoding="utf-8") as f:
+            source = f.read()
+        for match in MACRO_PATTERN.finditer(source):
+            text = find_format(source, match.end())
+            if text is None:
+                continue
+            token = fnv1a(text.encode("utf-8"))
+            if token in formats and formats[token] != text:
+                collisions.append((token, formats[token], text))
+            formats[token] = text
+        for match in MODULE_PATTERN.finditer(source):
+            modules[module_token(match.group(1))] = match.group(1)
+    return formats, modules, collisions
+
+
+def decode_args(fmt, payload, long_size):
+    # 依格式字串的轉換規格讀出參數，回傳 (可供 Python % 使用的格式, 參數)
+    values = []
+    pos = 0
+    py_format = []
+    last = 0
+    for spec in SPEC_PATTERN.finditer(fmt):
+        py_format.append(fmt[last:spec.start()].replace("%", "%%"))
+        last = spec.end()
+        flags, width, precision, length, conversion = spec.groups()
+        if conversion == "%":
+            py_format.append("%%")
+            continue
+        py_format.append("%" + (flags or "") + (width or "") + ("." + precision if precision else "") +
+                         ("d" if conversion == "u" else "x" if conversion == "p" else conversion))
+        if conversion == "s":
+            end = payload.find(b"\0", pos)
+            if end < 0:
+                values.append(payload[pos:].decode("utf-8", "replace") + "…")
+                pos = len(payload)
+            else:
+                values.append(payload[pos:end].decode("utf-8", "replace"))
+                pos = end + 1
+            continue
+
+        if conversion in "fFeEgG":
+            size, code = 4, "f"
+        else:
+            size = 8 if length in ("ll", "j") else long_size if length == "l" else 4
+            signed = conversion in "di"
+            code = {4: "i", 8: "q"}[size] if signed else {4: "I", 8: "Q"}[size]
+        if pos + size > len(payload):
+            values.append(0)
+            continue
+        values.append(struct.unpack_from("<" + code, payload, pos)[0])
+        pos += size
+    py_format.append(fmt[last:].replace("%", "%%"))
+    return "".join(py_format), tuple(values)
+
+
+class Decoder:
+    def __init__(self, formats, modules, long_size):
+        self.formats = formats
+        self.modules = modules
+        self.long_size = long_size
+        self.buffer = bytearray()
+        self.wire_bytes = 0
+        self.text_bytes = 0
+        self.frames = 0
+        self.unknown = 0
+        self.frame_bytes = 0       # 封包佔用的線上位元組
+        self.frame_text_bytes = 0  # 封包還原成文字後的位元組（即文字模式下的輸出量）
+
+    def feed(self, data):
+        self.wire_bytes += len(data)
+        self.buffer.extend(data)
+        output = []
+        while self.buffer:
+            sync = min((i for i in (self.buffer.find(bytes([LOG_TOKEN_SYNC])),
+                                    self.buffer.find(bytes([METRICS_SNAPSHOT_SYNC])),
+                                    self.buffer.find(bytes([TRACE_DUMP_SYNC]))) if i >= 0), default=-1)
+            if sync < 0:
+                output.append(self.take_text(len(self.buffer)))
+                break
+            if sync > 0:
+                output.append(self.take_text(sync))
+                continue
+            if self.buffer[0] == TRACE_DUMP_SYNC:
+                # 追蹤傾印: [SYNC][版本][長度 u32][內容]
+                if len(self.buffer) < 6:
+                    break
+                length = struct.unpack_from("<I", self.buffer, 2)[0]
+                if len(self.buffer) < 6 + length:
+                    break
+                del self.buffer[:6 + length]
+                output.append("<追蹤傾印 %d bytes，以 trace_to_chrome.py 轉換>\n" % (6 + length))
+                continue
+            if self.buffer[0] == METRICS_SNAPSHOT_SYNC:
+                # 指標快照: [SYNC][長度 u16][內容]
+                if len(self.buffer) < 3:
+                    break
+                length = struct.unpack_from("<H", self.buffer, 1)[0]
+                if len(self.buffer) < 3 + length:
+                    break
+                body = bytes(self.buffer[3:3 + length])
+                del self.buffer[:3 + length]
+                output.append(decode_metrics(body))
+                continue
+            if len(self.buffer) < 2 or len(self.buffer) < 2 + self.buffer[1]:
+                break  # 等待封包其餘位元組
+            length = self.buffer[1]
+            frame = bytes(self.buffer[2:2 + length])
+            del self.buffer[:2 + length]
+            self.frame_bytes += 2 + length
+            output.append(self.decode_frame(frame))
+        return "".join(output)
+
+    def take_text(self, count):
+        text = bytes(self.buffer[:count]).decode("utf-8", "replace")
+        del self.buffer[:count]
+        self.text_bytes += count
+        return text
+
+    def decode_frame(self, frame):
+        if len(frame) < LOG_TOKEN_HEADER_SIZE:
+            return ""
+        token, module, kind = struct.unpack_from("<IHB", frame, 0)
+        truncated = kind & LOG_KIND_TRUNCATED
+        label, newline = KIND_LABELS.get(kind & ~LOG_KIND_TRUNCATED, ("", True))
+        self.frames += 1
+
+        fmt = self.formats.get(token)
+        if fmt is None:
+            self.unknown += 1
+            text = "<未知權杖 0x%08X，%d bytes 參數>" % (token, len(frame) - LOG_TOKEN_HEADER_SIZE)
+        else:
+            py_format, values = decode_args(fmt, frame[LOG_TOKEN_HEADER_SIZE:], self.long_size)
+            try:
+                text = py_format % values
+            except (TypeError, ValueError):
+                text = fmt + " " + repr(values)
+            if truncated:
+                text = text.rstrip("\n") + "…" + ("\n" if text.endswith("\n") else "")
+
+        prefix = "[%s] " % self.modules[module] if module in self.modules else ""
+        line = prefix + label + text + ("\n" if newline else "")
+        self.text_bytes += len(line.encode("utf-8"))
+        self.frame_text_bytes += len(line.encode("utf-8"))
+        return line
+
+
+def decode_metrics(body):
+    # 與 MetricsRegistry::snapshot_text 相同的單行格式
+    version, count = struct.unpack_from("<BH", body, 0)
+    pos = 3
+    items = []
+    for _ in range(count):
+        if pos >= len(body):
+            break
+        metric_type = body[pos]
+        end = body.index(b"\0", pos + 1)
+        name = body[pos + 1:end].decode("utf-8", "replace")
+        pos = end + 1
+        if METRIC_TYPES[metric_type] == "histogram":
+            used = body[pos]
+            buckets = struct.unpack_from("<%dI" % used, body, pos + 1)
+            pos += 1 + 4 * used
+            items.append("%s=[%s]" % (name, ",".join(str(b) for b in buckets)))
+        else:
+            value = struct.unpack_from("<I" if metric_type == 0 else "<i", body, pos)[0]
+            pos += 4
+            items.append("%s=%d" % (name, value))
+    return "metrics " + " ".join(items) + "\n" if version == 1 else "<不支援的指標快照版本 %d>\n" % version
+
+
+def print_dictionary(formats, modules, collisions):
+    flash_bytes = sum(len(text.encode("utf-8")) + 1 for text in formats.values())
+    for token, text in sorted(formats.items()):
+        print("0x%08X  %s" % (token, text.rstrip("\n")))
+    print("\n模組: " + ", ".join("%s (0x%04X)" % (name, token) for token, name in sorted(modules.items())))
+    print("格式字串 %d 個，Flash 可省下約 %d bytes（權杖化後不編入韌體）" % (len(formats), flash_bytes))
+    for token, first, second in collisions:
+        print("⚠️  權杖碰撞 0x%08X: %r / %r" % (token, first, second))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="權杖化日誌解碼器")
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+    parser.add_argument("--src", nargs="+", default=[os.path.join(root, "src"), os.path.join(root, "include")],
+                        help="掃描 DBG_* 呼叫的原始碼目錄")
+    parser.add_argument("--port", help="序列埠（例如 COM12 或 /dev/ttyACM0）")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--input", help="錄下的原始資料檔（- 表示 stdin）")
+    parser.add_argument("--dictionary", action="store_true", help="列出權杖字典")
+    parser.add_argument("--stats", action="store_true", help="結束時輸出頻寬統計")
+    parser.add_argument("--long-size", type=int, default=4, choices=(4, 8),
+                        help="%%l 參數寬度：ESP32 為 4，64-bit 主機測試為 8")
+    args = parser.parse_args()
+
+    formats, modules, collisions = build_dictionary(args.src)
+    if args.dictionary:
+        print_dictionary(formats, modules, collisions)
+        return
+
+    decoder = Decoder(formats, modules, args.long_size)
+    start = time.time()
+    out = sys.stdout
+    try:
+        if args.port:
+            import serial  # pyserial
+
+            with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+                while True:
+                    out.write(decoder.feed(port.read(512)))
+                    out.flush()
+        else:
+            stream = sys.stdin.buffer if args.input in (None, "-") else open(args.input, "rb")
+            with stream:
+                while True:
+                    chunk = stream.read(4096)
+                    if not chunk:
+                        break
+                    out.write(decoder.feed(chunk))
+    except KeyboardInterrupt:
+        pass
+
+    if args.stats:
+        ratio = decoder.frame_text_bytes / float(decoder.frame_bytes) if decoder.frame_bytes else 0.0
+        summary = "封包 %d 筆（未知 %d）: 線上 %d bytes，還原文字 %d bytes，縮小 %.1fx；全部線上 %d bytes" % (
+            decoder.frames, decoder.unknown, decoder.frame_bytes, decoder.frame_text_bytes, ratio,
+            decoder.wire_bytes)
+        if args.port:
+            # 即時模式才有意義的每秒位元組數
+            elapsed = max(time.time() - start, 1e-6)
+            summary += "（線上 %.0f B/s，文字模式約 %.0f B/s）" % (
+                decoder.wire_bytes / elapsed, (decoder.text_bytes) / elapsed)
+        sys.stderr.write("\n" + summary + "\n")
+
+if __name__ == "__main__":
+    main()
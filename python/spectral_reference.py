@@ -0,0 +1,77 @@
+"""
+頻譜特徵參考值產生器
+以 NumPy 計算與 SpectralAnalyzer (src/spectral_features.cpp) 相同定義的特徵，
+輸出可直接貼入 test/spectral_features_test.cpp 的參考值。
+
+用法: python spectral_reference.py
+"""
+
+import numpy as np
+
+FFT_SIZE = 256
+SAMPLE_RATE = 16000
+BAND_EDGES_HZ = [0, 250, 500, 1000, 2000, 3000, 4000, 6000, 8000]
+ROLLOFF_RATIO = 0.85
+
+
+def hann(n):
+    # 與 AudioCaptureModule::apply_window_function 相同的對稱漢寧窗
+    i = np.arange(n)
+    return 0.5 * (1.0 - np.cos(2.0 * np.pi * i / (n - 1)))
+
+
+def lcg_noise(count, seed):
+    # 與測試程式相同的線性同餘亂數，提供 -40 dB 左右的寬頻底噪
+    values = []
+    state = seed
+    for _ in range(count):
+        state = (1103515245 * state + 12345) % (1 << 31)
+        values.append((state / float(1 << 31) - 0.5) * 0.02)
+    return np.array(values)
+
+
+def test_frame(index):
+    # 與測試程式相同的合成訊號
+    n = np.arange(FFT_SIZE)
+    if index == 0:
+        x = (0.5 * np.sin(2 * np.pi * 1000 * n / SAMPLE_RATE)
+             + 0.25 * np.sin(2 * np.pi * 3000 * n / SAMPLE_RATE + 0.3)
+             + 0.05 * np.sin(2 * np.pi * 6500 * n / SAMPLE_RATE))
+    else:
+        x = (0.4 * np.sin(2 * np.pi * 1500 * n / SAMPLE_RATE)
+             + 0.1 * np.sin(2 * np.pi * 400 * n / SAMPLE_RATE + 1.0))
+    x = x + lcg_noise(FFT_SIZE, index + 1)
+    return (x.astype(np.float32) * hann(FFT_SIZE).astype(np.float32)).astype(np.float32)
+
+
+def spectral_features(frame, prev_magnitude=None):
+    spectrum = np.fft.rfft(frame.astype(np.float64))
+    power = np.abs(spectrum) ** 2
+    magnitude = np.abs(spectrum)
+    half = FFT_SIZE // 2
+    bins = np.arange(len(power))
+
+    total = power.sum()
+    centroid = (bins * power).sum() / total / half
+    rolloff = np.argmax(np.cumsum(power) >= ROLLOFF_RATIO * total) / half
+    flatness = np.exp(np.mean(np.log(power + 1e-12))) / (power.mean() + 1e-12)
+    flux = 0.0 if prev_magnitude is None else np.sqrt(((magnitude - prev_magnitude) ** 2).sum())
+
+    edges = [e * FFT_SIZE // SAMPLE_RATE for e in BAND_EDGES_HZ]
+    edges[-1] = len(power)
+    bands = [power[edges[b]:edges[b + 1]].sum() for b in range(len(edges) - 1)]
+
+    return centroid, rolloff, flatness, flux, bands, magnitude
+
+
+def main():
+    prev = None
+    for index in range(2):
+        centroid, rolloff, flatness, flux, bands, prev = spectral_features(test_frame(index), prev)
+        print(f"// frame {index}")
+        print(f"{{{centroid:.6e}f, {rolloff:.6e}f, {flatness:.6e}f, {flux:.6e}f,")
+        print("  {" + ", ".join(f"{b:.6e}f" for b in bands) + "}},")
+
+
+if __name__ == "__main__":
+    main()
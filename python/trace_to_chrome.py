@@ -0,0 +1,250 @@
+"""
+追蹤傾印轉換器
+把 TraceRecorder 的二進位傾印（include/trace_recorder.h，序列埠指令 t）轉成 Chrome trace_event JSON，
+可在 chrome://tracing 或 https://ui.perfetto.dev 開啟。輸入可以混有一般日誌文字、權杖封包與指標快照，
+工具只取出傾印的部分；同一份擷取內有多次傾印時預設轉換最後一次。
+
+時間軸預設為 CPU 計數（裝置上為週期、主機上為奈秒）換算的微秒；每個事件另附樣本時鐘時間
+（由擷取端每個區塊記錄的 sample_clock 錨點內插），--timebase sample 則直接以樣本時鐘排列。
+capture_lag_ms 計數軌跡為 CPU 時間與樣本時鐘的相對差，上升表示處理落後於擷取。
+
+用法:
+  python trace_to_chrome.py --port COM12 -o trace.json        # 送出 t 指令並等待傾印（需要 pyserial）
+  python trace_to_chrome.py --input capture.bin -o trace.json # 轉換錄下的原始資料（主機重播的 stdout 亦可）
+  python trace_to_chrome.py --input capture.bin --dump 0      # 轉換第一次傾印
+"""
+
+import argparse
+import json
+import struct
+import sys
+import time
+
+LOG_TOKEN_SYNC = 0xF5
+METRICS_SNAPSHOT_SYNC = 0xF6
+TRACE_DUMP_SYNC = 0xF7
+TRACE_DUMP_VERSION = 1
+EVENT_FORMAT = "<IIIBBBB"
+EVENT_SIZE = struct.calcsize(EVENT_FORMAT)
+PHASE_SPAN = 0
+PHASE_INSTANT = 1
+
+# 與 audio_module.h VADState、keyword_model.h KeywordClass 相同順序
+VAD_STATES = ("silence", "speech_start", "speech_active", "speech_end")
+KEYWORDS = ("silence", "unknown", "yes", "no", "hello", "on", "off")
+
+
+def find_dumps(data):
+    """找出所有傾印；略過權杖封包與指標快照（其二進位內容可能含 0xF7）"""
+    dumps = []
+    pos = 0
+    while pos < len(data):
+        byte = data[pos]
+        if byte == LOG_TOKEN_SYNC and pos + 1 < len(data):
+            pos += 2 + data[pos + 1]
+        elif byte == METRICS_SNAPSHOT_SYNC and pos + 3 <= len(data):
+            pos += 3 + struct.unpack_from("<H", data, pos + 1)[0]
+        elif byte == TRACE_DUMP_SYNC and pos + 6 <= len(data) and data[pos + 1] == TRACE_DUMP_VERSION:
+            length = struct.unpack_from("<I", data, pos + 2)[0]
+            if pos + 6 + length > len(data):
+                break  # 不完整（序列埠模式下等待其餘位元組）
+            dumps.append(data[pos + 6:pos + 6 + length])
+            pos += 6 + length
+        else:
+            pos += 1
+    return dumps
+
+
+def parse_dump(body):
+    ticks_per_us, sample_rate, count, lost = struct.unpack_from("<IIII", body, 0)
+    pos = 16
+    name_count = body[pos]
+    pos += 1
+    names = []
+    for _ in range(name_count):
+        end = body.index(b"\0", pos)
+        names.append(body[pos:end].decode("utf-8", "replace"))
+        pos = end + 1
+    events = [struct.unpack_from(EVENT_FORMAT, body, pos + k * EVENT_SIZE) for k in range(count)]
+    return {"ticks_per_us": ticks_per_us, "sample_rate": sample_rate, "lost": lost, "names": names,
+            "events": events}
+
+
+def unwrap(events):
+    """32-bit 計數展開為 64-bit：相鄰事件的差以有號 32-bit 計（區間記錄於結束時，開始時間可能早於前一筆）"""
+    times = []
+    previous = None
+    current = 0
+    for start, _, _, _, _, _, _ in events:
+        if previous is not None:
+            delta = (start - previous) & 0xFFFFFFFF
+            current += delta - (1 << 32) if delta >= (1 << 31) else delta
+        previous = start
+        times.append(current)
+    return times
+
+
+class SampleClock:
+    """以錨點（CPU 計數, 樣本時間）內插任意時刻的樣本時鐘"""
+
+    def __init__(self, anchors, ticks_per_us, sample_rate):
+        self.anchors = sorted(anchors)
+        self.ticks_per_sample = ticks_per_us * 1e6 / sample_rate
+
+    def at(self, ticks):
+        if not self.anchors:
+            return None
+        # 最近一個不晚於 ticks 的錨點（都晚於時用第一個往回推）
+        low, high = 0, len(self.anchors) - 1
+        while low < high:
+            mid = (low + high + 1) // 2
+            if self.anchors[mid][0] <= ticks:
+                low = mid
+            else:
+                high = mid - 1
+        anchor_ticks, anchor_samples = self.anchors[low]
+        return anchor_samples + (ticks - anchor_ticks) / self.ticks_per_sample
+
+
+def convert(dump, timebase):
+    names = dump["names"]
+    ticks_per_us = float(dump["ticks_per_us"])
+    sample_rate = dump["sample_rate"]
+    events = dump["events"]
+    times = unwrap(events)
+
+    # 樣本時鐘錨點（低 32 位元樣本時間同樣展開）
+    anchors = []
+    previous_arg = 0
+    clock_id = names.index("sample_clock") if "sample_clock" in names else -1
+    for (_, _, arg, event_id, _, _, _), ticks in zip(events, times):
+        if event_id == clock_id:
+            samples = anchors[-1][1] + ((arg - previous_arg) & 0xFFFFFFFF) if anchors else arg
+            previous_arg = arg
+            anchors.append((ticks, samples))
+    clock = SampleClock(anchors, ticks_per_us, sample_rate)
+
+    origin = min(times) if times else 0
+    if timebase == "sample" and anchors:
+        origin_samples = clock.at(origin)
+
+        def timestamp(ticks):
+            return (clock.at(ticks) - origin_samples) * 1e6 / sample_rate
+    else:
+        def timestamp(ticks):
+            return (ticks - origin) / ticks_per_us
+
+    trace = []
+    cores = set()
+    first_anchor = anchors[0] if anchors else None
+    for (_, duration, arg, event_id, phase, core, _), ticks in zip(events, times):
+        name = names[event_id] if event_id < len(names) else "event_%d" % event_id
+        cores.add(core)
+        entry = {"name": name, "pid": 0, "tid": core, "ts": round(timestamp(ticks), 3)}
+        args = {}
+        samples = clock.at(ticks)
+        if samples is not None:
+            args["sample"] = int(samples)
+            args["sample_ms"] = round(samples * 1000.0 / sample_rate, 3)
+
+        if event_id == clock_id:
+            # 錨點轉為計數軌跡：CPU 經過時間與樣本時鐘經過時間之差
+            cpu_ms = (ticks - first_anchor[0]) / ticks_per_us / 1000.0
+            audio_ms = (clock.at(ticks) - first_anchor[1]) * 1000.0 / sample_rate
+            trace.append({"name": "capture_lag_ms", "ph": "C", "pid": 0, "ts": entry["ts"],
+                          "args": {"lag": round(cpu_ms - audio_ms, 3)}})
+            continue
+
+        if phase == PHASE_SPAN:
+            entry["ph"] = "X"
+            end_ts = timestamp(ticks + duration)
+            entry["dur"] = round(max(end_ts - entry["ts"], 0.0), 3)
+            entry["cat"] = "stage" if name not in ("capture", "hop", "serial") else name
+            if name in ("capture", "hop"):
+                args["start_sample"] = arg
+            elif name == "serial":
+                args["bytes"] = arg
+        else:
+            entry["ph"] = "i"
+            entry["s"] = "g" if name in ("detection", "deadline_miss") else "t"
+            entry["cat"] = "event"
+            if name == "vad_state":
+                entry["name"] = "vad: " + (VAD_STATES[arg] if arg < len(VAD_STATES) else str(arg))
+            elif name == "detection":
+                entry["name"] = "detection: " + (KEYWORDS[arg] if arg < len(KEYWORDS) else str(arg))
+            elif name == "deadline_miss":
+                args["frame_us"] = arg
+            else:
+                args["arg"] = arg
+        entry["args"] = args
+        trace.append(entry)
+
+    trace.append({"name": "process_name", "ph": "M", "pid": 0, "args": {"name": "edge_command"}})
+    for core in sorted(cores):
+        trace.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": core, "args": {"name": "core %d" % core}})
+
+    other = {"ticks_per_us": dump["ticks_per_us"], "sample_rate": sample_rate, "events": len(events),
+             "lost": dump["lost"], "timebase": timebase}
+    return {"traceEvents": trace, "displayTimeUnit": "ms", "otherData": other}
+
+
+def summary(dump, result):
+    events = [e for e in result["traceEvents"] if e.get("ph") in ("X", "i")]
+    span_ms = max((e["ts"] + e.get("dur", 0) for e in events), default=0) / 1000.0
+    hops = sorted(e["dur"] for e in events if e["name"] == "hop")
+    misses = sum(1 for e in events if e["name"] == "deadline_miss")
+    detections = sum(1 for e in events if e["name"].startswith("detection"))
+    text = "事件 %d 筆（覆寫遺失 %d），涵蓋 %.1f ms" % (len(dump["events"]), dump["lost"], span_ms)
+    if hops:
+        text += "；hop %d 個，中位數 %.0f µs，最大 %.0f µs" % (len(hops), hops[len(hops) // 2], hops[-1])
+    text += "；期限未達成 %d 次，激活 %d 次" % (misses, detections)
+    return text
+
+
+def read_port(port_name, baud, timeout):
+    import serial  # pyserial
+
+    data = bytearray()
+    with serial.Serial(port_name, baud, timeout=0.1) as port:
+        port.write(b"t")
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            data.extend(port.read(4096))
+            if find_dumps(bytes(data)):
+                break
+    return bytes(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="追蹤傾印轉 Chrome trace_event JSON")
+    parser.add_argument("--port", help="序列埠（例如 COM12 或 /dev/ttyACM0），自動送出 t 指令")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=10.0, help="序列埠等待傾印的秒數")
+    parser.add_argument("--input", help="錄下的原始資料檔（- 表示 stdin）")
+    parser.add_argument("--dump", type=int, default=-1, help="第幾次傾印（預設最後一次）")
+    parser.add_argument("--timebase", choices=("cpu", "sample"), default="cpu",
+                        help="時間軸：cpu = CPU 計數（預設），sample = 樣本時鐘")
+    parser.add_argument("-o", "--output", default="trace.json")
+    args = parser.parse_args()
+
+    if args.port:
+        data = read_port(args.port, args.baud, args.timeout)
+    else:
+        stream = sys.stdin.buffer if args.input in (None, "-") else open(args.input, "rb")
+        with stream:
+            data = stream.read()
+
+    dumps = find_dumps(data)
+    if not dumps:
+        sys.stderr.write("找不到追蹤傾印（SYNC 0x%02X）\n" % TRACE_DUMP_SYNC)
+        sys.exit(1)
+
+    dump = parse_dump(dumps[args.dump])
+    result = convert(dump, args.timebase)
+    with open(args.output, "w") as out:
+        json.dump(result, out, separators=(",", ":"))
+    sys.stderr.write("%s\n已寫入 %s（傾印 %d 次）\n" % (summary(dump, result), args.output, len(dumps)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,245 @@
+#include "async_log.h"
+#include "trace_recorder.h"
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#define ASYNC_LOG_MASK (ASYNC_LOG_SLOTS - 1)
+
+// 全域實例
+AsyncLog async_log;
+
+AsyncLog::AsyncLog()
+    : enqueue_pos(0), dequeue_pos(0), drain_busy(false), running(false), stop_requested(false), task_alive(false),
+      task_handle(nullptr), written(0), dropped(0),
+      truncated(0), max_depth(0), bytes(0), drained(0), reported_dropped(0), stats_since_ms(0)
+{
+    for (uint32_t i = 0; i < ASYNC_LOG_SLOTS; i++)
+    {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+        slots[i].length = 0;
+    }
+}
+
+bool AsyncLog::begin()
+{
+#if ASYNC_LOG_ENABLED
+    if (is_running())
+        return true;
+
+    running.store(true, std::memory_order_release);
+#if defined(ESP_PLATFORM)
+    stop_requested.store(false, std::memory_order_release);
+    task_alive.store(true, std::memory_order_release);
+    TaskHandle_t handle = nullptr;
+    if (xTaskCreatePinnedToCore(drain_task, "async_log", ASYNC_LOG_TASK_STACK, this, ASYNC_LOG_TASK_PRIORITY, &handle,
+                                ASYNC_LOG_TASK_CORE) != pdPASS)
+    {
+        task_alive.store(false, std::memory_order_release);
+        running.store(false, std::memory_order_release);
+        return false;
+    }
+    task_handle = handle;
+#endif
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AsyncLog::end()
+{
+    if (!is_running())
+        return;
+
+#if defined(ESP_PLATFORM)
+    if (task_handle)
+    {
+        // 不從外部刪除任務：輸出途中被刪除會讓環形緩衝區停在半完成的槽位，或讓 Serial 的鎖永遠不釋放。
+        // 通知任務在目前這次 drain() 結束後自行退出，並等它退出
+        stop_requested.store(true, std::memory_order_release);
+        xTaskNotifyGive((TaskHandle_t)task_handle);
+        while (task_alive.load(std::memory_order_acquire))
+            vTaskDelay(1);
+        task_handle = nullptr;
+    }
+#endif
+    flush();
+    running.store(false, std::memory_order_release);
+}
+
+#if defined(ESP_PLATFORM)
+void AsyncLog::drain_task(void *arg)
+{
+    AsyncLog *log = (AsyncLog *)arg;
+    while (!log->stop_requested.load(std::memory_order_acquire))
+    {
+        log->drain();
+        // 等待下一輪；end() 的通知可提早喚醒
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ASYNC_LOG_DRAIN_INTERVAL_MS));
+    }
+    log->task_alive.store(false, std::memory_order_release);
+    vTaskDelete(nullptr);
+}
+#endif
+
+bool AsyncLog::write(const char *text, size_t length)
+{
+    if (!is_running())
+    {
+        TRACE_SCOPE(TRACE_EVENT_SERIAL, length);
+        Serial.write((const uint8_t *)text, length);
+        bytes.fetch_add(length, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 搶下一個可寫的槽位（位置以 CAS 前進，多個生產者互不阻塞）
+    uint32_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    Slot *slot;
+    for (;;)
+    {
+        slot = &slots[pos & ASYNC_LOG_MASK];
+        uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - pos);
+        if (diff == 0)
+        {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // 消費者尚未讀走這一圈的資料：緩衝區已滿
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    if (length > ASYNC_LOG_RECORD_SIZE)
+    {
+        // 截斷在 UTF-8 字元邊界，保留換行
+        bool newline = text[length - 1] == '\n';
+        length = ASYNC_LOG_RECORD_SIZE - (newline ? 1 : 0);
+        while (length > 0 && ((uint8_t)text[length] & 0xC0) == 0x80)
+            length--;
+        memcpy(slot->text, text, length);
+        if (newline)
+            slot->text[length++] = '\n';
+        truncated.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        memcpy(slot->text, text, length);
+    }
+    slot->length = (uint16_t)length;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    written.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(length, std::memory_order_relaxed);
+    uint32_t depth = pos + 1 - dequeue_pos;
+    if (depth <= ASYNC_LOG_SLOTS && depth > max_depth.load(std::memory_order_relaxed))
+        max_depth.store(depth, std::memory_order_relaxed);
+    return true;
+}
+
+size_t AsyncLog::drain(size_t max_records)
+{
+    bool expected = false;
+    if (!drain_busy.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        return 0;
+
+    size_t count = 0;
+    uint32_t drained_bytes = 0;
+    uint32_t start = profiler_ticks();
+    while (count < max_records)
+    {
+        Slot &slot = slots[dequeue_pos & ASYNC_LOG_MASK];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos + 1)
+            break;
+
+        Serial.write((const uint8_t *)slot.text, slot.length);
+        drained_bytes += slot.length;
+        slot.sequence.store(dequeue_pos + ASYNC_LOG_SLOTS, std::memory_order_release);
+        dequeue_pos++;
+        count++;
+    }
+    drained += count;
+#if TRACE_ENABLED
+    if (count)
+        trace.span(TRACE_EVENT_SERIAL, start, profiler_ticks(), drained_bytes);
+#else
+    (void)start;
+    (void)drained_bytes;
+#endif
+
+    report_drops();
+    drain_busy.store(false, std::memory_order_release);
+    return count;
+}
+
+/**
+ * 輸出端直接提示遺失筆數（不經過緩衝區，避免再次被丟棄）
+ */
+void AsyncLog::report_drops()
+{
+    uint32_t total = dropped.load(std::memory_order_relaxed);
+    if (total == reported_dropped)
+        return;
+
+    Serial.printf("[AsyncLog] ⚠️  %lu 筆訊息因緩衝區已滿而遺失\n", (unsigned long)(total - reported_dropped));
+    reported_dropped = total;
+}
+
+void AsyncLog::flush()
+{
+    while (drain() > 0)
+    {
+    }
+}
+
+size_t AsyncLog::pending() const
+{
+    return enqueue_pos.load(std::memory_order_relaxed) - dequeue_pos;
+}
+
+AsyncLog::AsyncLogStats AsyncLog::get_stats() const
+{
+    AsyncLogStats stats;
+    stats.written = written.load(std::memory_order_relaxed);
+    stats.dropped = dropped.load(std::memory_order_relaxed);
+    stats.truncated = truncated.load(std::memory_order_relaxed);
+    stats.drained = drained;
+    stats.max_depth = max_depth.load(std::memory_order_relaxed);
+    stats.bytes = bytes.load(std::memory_order_relaxed);
+    stats.elapsed_ms = millis() - stats_since_ms;
+    return stats;
+}
+
+void AsyncLog::reset_stats()
+{
+    written.store(0, std::memory_order_relaxed);
+    truncated.store(0, std::memory_order_relaxed);
+    max_depth.store(0, std::memory_order_relaxed);
+    bytes.store(0, std::memory_order_relaxed);
+    drained = 0;
+    stats_since_ms = millis();
+    // 遺失計數只累加，已提示的部分一併歸零
+    dropped.store(0, std::memory_order_relaxed);
+    reported_dropped = 0;
+}
+
+void AsyncLog::print_stats(const DebugPrint &out) const
+{
+    AsyncLogStats stats = get_stats();
+    out.printf("📝 非同步日誌: 寫入 %lu，輸出 %lu，遺失 %lu，截斷 %lu，最高 %lu/%d 筆\n", (unsigned long)stats.written,
+               (unsigned long)stats.drained, (unsigned long)stats.dropped, (unsigned long)stats.truncated,
+               (unsigned long)stats.max_depth, ASYNC_LOG_SLOTS);
+    out.printf("   輸出 %lu bytes（%.0f B/s，%s）\n", (unsigned long)stats.bytes,
+               stats.elapsed_ms ? stats.bytes * 1000.0f / stats.elapsed_ms : 0.0f, LOG_TOKENIZED ? "權杖化" : "文字");
+}
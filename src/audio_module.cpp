@@ -1,5 +1,13 @@
+// 本模組編譯期日誌等級，須在 include 之前定義（可由 build_flags 覆寫，例如 -DAUDIO_MODULE_DEBUG_LEVEL=DEBUG_LEVEL_WARNING）
+#ifndef AUDIO_MODULE_DEBUG_LEVEL
+#define AUDIO_MODULE_DEBUG_LEVEL DEBUG_LEVEL_VERBOSE
+#endif
+#define DEBUG_LOCAL_LEVEL AUDIO_MODULE_DEBUG_LEVEL
+
 #include "audio_module.h"
 #include "esp_log.h"
+#include "stage_profiler.h"
+#include "trace_recorder.h"
 #include <Arduino.h>
 #include <math.h>
 #include <string.h>
@@ -16,9 +24,19 @@ static const char *TAG = "AudioModule";
  * 建構函數
  */
 AudioCaptureModule::AudioCaptureModule()
-    : processed_buffer(nullptr), normalized_buffer(nullptr), frame_buffer(nullptr), frame_write_pos(0), frame_ready_flag(false), vad_current_state(VAD_SILENCE), speech_frame_count(0), silence_frame_count(0), speech_start_time(0), speech_end_time(0), speech_buffer(nullptr), speech_buffer_length(0), is_initialized(false), is_running(false), debug("AudioCapture", false)
+    : processed_buffer(nullptr), normalized_buffer(nullptr), frame_buffer(nullptr), frame_pcm(nullptr), frame_buffer_time(0), frame_pcm_time(0), frame_write_pos(0), frame_ready_flag(false), two_rate_enabled(true), preroll_frames(nullptr), preroll_head(0), preroll_count(0), gate_closed_hops(0), low_power_enabled(false), idle_hops(0), vad_current_state(VAD_SILENCE), speech_frame_count(0), silence_frame_count(0), speech_start_time(0), speech_end_time(0), vad_engine(VAD_ENGINE_ENERGY), noise_suppression_enabled(true), cmvn_enabled(true), speech_buffer(nullptr), speech_buffer_length(0), speech_feature_frames(0), is_initialized(false), is_running(false), debug("AudioCapture", false), load_governor_enabled(true), frames_metric("audio.frames"), deadline_miss_metric("audio.deadline_misses"), speech_segment_metric("audio.speech_segments"), frame_us_metric("audio.frame_us")
 {
-    debug.print("建構函數");
+    reset_vad_engine_stats();
+    reset_pipeline_tier_stats();
+    memset(&speech_features_sum, 0, sizeof(speech_features_sum));
+
+    // 漢寧窗只計算一次
+    for (size_t i = 0; i < AUDIO_FRAME_SIZE; i++)
+    {
+        window_table[i] = 0.5f * (1.0f - cos(2.0f * PI * i / (AUDIO_FRAME_SIZE - 1)));
+    }
+
+    DBG_PRINT(debug, "建構函數");
 }
 
 /**
@@ -27,7 +45,7 @@ AudioCaptureModule::AudioCaptureModule()
 AudioCaptureModule::~AudioCaptureModule()
 {
     deinitialize();
-    debug.print("AudioCaptureModule 解構函數");
+    DBG_PRINT(debug, "AudioCaptureModule 解構函數");
 }
 
 /**
@@ -35,45 +53,51 @@ AudioCaptureModule::~AudioCaptureModule()
  */
 bool AudioCaptureModule::initialize()
 {
-    debug.print("初始化音訊擷取模組...");
+    DBG_PRINT(debug, "初始化音訊擷取模組...");
 
     if (is_initialized)
     {
-        debug.print("模組已經初始化");
+        DBG_PRINT(debug, "模組已經初始化");
         return true;
     }
 
     // 分配記憶體緩衝區
-    processed_buffer = new int16_t[AUDIO_BUFFER_SIZE];
+    processed_buffer = new audio_sample_t[AUDIO_BUFFER_SIZE];
     normalized_buffer = new float[AUDIO_FRAME_SIZE];
-    frame_buffer = new int16_t[AUDIO_BUFFER_SIZE * 2]; // 支持重疊
+    frame_buffer = new audio_sample_t[AUDIO_BUFFER_SIZE * 2]; // 支持重疊
+    frame_pcm = new audio_sample_t[AUDIO_FRAME_SIZE];
+    preroll_frames = new audio_sample_t[AUDIO_PREROLL_FRAMES * AUDIO_FRAME_SIZE];
     speech_buffer = new float[SPEECH_BUFFER_SIZE];
 
     if (!processed_buffer || !normalized_buffer || 
-        !frame_buffer || !speech_buffer)
+        !frame_buffer || !frame_pcm || !preroll_frames || !speech_buffer)
     {
-        debug.print("記憶體分配失敗！");
+        DBG_PRINT(debug, "記憶體分配失敗！");
         deinitialize();
         return false;
     }
 
     // 清零緩衝區
-    memset(processed_buffer, 0, AUDIO_BUFFER_SIZE * sizeof(int16_t));
+    memset(processed_buffer, 0, AUDIO_BUFFER_SIZE * sizeof(audio_sample_t));
     memset(normalized_buffer, 0, AUDIO_FRAME_SIZE * sizeof(float));
-    memset(frame_buffer, 0, AUDIO_BUFFER_SIZE * 2 * sizeof(int16_t));
+    memset(frame_buffer, 0, AUDIO_BUFFER_SIZE * 2 * sizeof(audio_sample_t));
+    memset(frame_pcm, 0, AUDIO_FRAME_SIZE * sizeof(audio_sample_t));
+    memset(preroll_frames, 0, AUDIO_PREROLL_FRAMES * AUDIO_FRAME_SIZE * sizeof(audio_sample_t));
+    preroll_head = 0;
+    preroll_count = 0;
     memset(speech_buffer, 0, SPEECH_BUFFER_SIZE * sizeof(float));
 
     // 初始化 INMP441 模組
     if (!inmp441.initialize())
     {
-        debug.print("INMP441 模組初始化失敗！");
+        DBG_PRINT(debug, "INMP441 模組初始化失敗！");
         deinitialize();
         return false;
     }
     
     // 設置 INMP441 回調函數
-    inmp441.set_audio_data_callback([this](const int16_t *audio_data, size_t sample_count) {
-        this->on_inmp441_audio_data(audio_data, sample_count);
+    inmp441.set_audio_data_callback([this](const audio_sample_t *audio_data, size_t sample_count, sample_time_t timestamp) {
+        this->on_inmp441_audio_data(audio_data, sample_count, timestamp);
     });
     
     inmp441.set_state_change_callback([this](INMP441State state, const char *message) {
@@ -84,7 +108,7 @@ bool AudioCaptureModule::initialize()
     reset_vad();
 
     is_initialized = true;
-    debug.print("音訊擷取模組初始化成功！");
+    DBG_PRINT(debug, "音訊擷取模組初始化成功！");
     return true;
 }
 
@@ -93,45 +117,51 @@ bool AudioCaptureModule::initialize()
  */
 bool AudioCaptureModule::initialize(const INMP441Config &inmp441_config)
 {
-    debug.print("初始化音訊擷取模組（自定義 INMP441 配置）...");
+    DBG_PRINT(debug, "初始化音訊擷取模組（自定義 INMP441 配置）...");
 
     if (is_initialized)
     {
-        debug.print("模組已經初始化");
+        DBG_PRINT(debug, "模組已經初始化");
         return true;
     }
 
     // 分配記憶體緩衝區
-    processed_buffer = new int16_t[AUDIO_BUFFER_SIZE];
+    processed_buffer = new audio_sample_t[AUDIO_BUFFER_SIZE];
     normalized_buffer = new float[AUDIO_FRAME_SIZE];
-    frame_buffer = new int16_t[AUDIO_BUFFER_SIZE * 2]; // 支持重疊
+    frame_buffer = new audio_sample_t[AUDIO_BUFFER_SIZE * 2]; // 支持重疊
+    frame_pcm = new audio_sample_t[AUDIO_FRAME_SIZE];
+    preroll_frames = new audio_sample_t[AUDIO_PREROLL_FRAMES * AUDIO_FRAME_SIZE];
     speech_buffer = new float[SPEECH_BUFFER_SIZE];
 
     if (!processed_buffer || !normalized_buffer || 
-        !frame_buffer || !speech_buffer)
+        !frame_buffer || !frame_pcm || !preroll_frames || !speech_buffer)
     {
-        debug.print("記憶體分配失敗！");
+        DBG_PRINT(debug, "記憶體分配失敗！");
         deinitialize();
         return false;
     }
 
     // 清零緩衝區
-    memset(processed_buffer, 0, AUDIO_BUFFER_SIZE * sizeof(int16_t));
+    memset(processed_buffer, 0, AUDIO_BUFFER_SIZE * sizeof(audio_sample_t));
     memset(normalized_buffer, 0, AUDIO_FRAME_SIZE * sizeof(float));
-    memset(frame_buffer, 0, AUDIO_BUFFER_SIZE * 2 * sizeof(int16_t));
+    memset(frame_buffer, 0, AUDIO_BUFFER_SIZE * 2 * sizeof(audio_sample_t));
+    memset(frame_pcm, 0, AUDIO_FRAME_SIZE * sizeof(audio_sample_t));
+    memset(preroll_frames, 0, AUDIO_PREROLL_FRAMES * AUDIO_FRAME_SIZE * sizeof(audio_sample_t));
+    preroll_head = 0;
+    preroll_count = 0;
     memset(speech_buffer, 0, SPEECH_BUFFER_SIZE * sizeof(float));
 
     // 使用自定義配置初始化 INMP441 模組
     if (!inmp441.initialize(inmp441_config))
     {
-        debug.print("INMP441 模組初始化失敗！");
+        DBG_PRINT(debug, "INMP441 模組初始化失敗！");
         deinitialize();
         return false;
     }
     
     // 設置 INMP441 回調函數
-    inmp441.set_audio_data_callback([this](const int16_t *audio_data, size_t sample_count) {
-        this->on_inmp441_audio_data(audio_data, sample_count);
+    inmp441.set_audio_data_callback([this](const audio_sample_t *audio_data, size_t sample_count, sample_time_t timestamp) {
+        this->on_inmp441_audio_data(audio_data, sample_count, timestamp);
     });
     
     inmp441.set_state_change_callback([this](INMP441State state, const char *message) {
@@ -142,7 +172,7 @@ bool AudioCaptureModule::initialize(const INMP441Config &inmp441_config)
     reset_vad();
 
     is_initialized = true;
-    debug.print("音訊擷取模組初始化成功（自定義配置）！");
+    DBG_PRINT(debug, "音訊擷取模組初始化成功（自定義配置）！");
     return true;
 }
 
@@ -166,14 +196,18 @@ void AudioCaptureModule::deinitialize()
     delete[] processed_buffer;
     delete[] normalized_buffer;
     delete[] frame_buffer;
+    delete[] frame_pcm;
+    delete[] preroll_frames;
     delete[] speech_buffer;
 
     processed_buffer = nullptr;
     normalized_buffer = nullptr;
     frame_buffer = nullptr;
+    frame_pcm = nullptr;
+    preroll_frames = nullptr;
     speech_buffer = nullptr;
 
-    debug.print("音訊擷取模組去初始化完成");
+    DBG_PRINT(debug, "音訊擷取模組去初始化完成");
 }
 
 /**
@@ -183,24 +217,27 @@ bool AudioCaptureModule::start_capture()
 {
     if (!is_initialized)
     {
-        debug.print("模組尚未初始化，無法開始擷取");
+        DBG_PRINT(debug, "模組尚未初始化，無法開始擷取");
         return false;
     }
 
     if (is_running)
     {
-        debug.print("音訊擷取已在運行中");
+        DBG_PRINT(debug, "音訊擷取已在運行中");
         return true;
     }
 
     if (!inmp441.start())
     {
-        debug.print("INMP441 啟動失敗");
+        DBG_PRINT(debug, "INMP441 啟動失敗");
         return false;
     }
 
+    // 樣本時鐘重新起算，期限時間軸與負載調節一併重置
+    deadline_monitor.reset();
+    load_governor.reset();
     is_running = true;
-    debug.print("音訊擷取已開始");
+    DBG_PRINT(debug, "音訊擷取已開始");
     return true;
 }
 
@@ -213,18 +250,18 @@ void AudioCaptureModule::stop_capture()
     {
         inmp441.stop();
         is_running = false;
-        debug.print("音訊擷取已停止");
+        DBG_PRINT(debug, "音訊擷取已停止");
     }
 }
 
 /**
  * 正規化音訊數據
  */
-void AudioCaptureModule::normalize_audio(int16_t *input, float *output, size_t length)
+void AudioCaptureModule::normalize_audio(const audio_sample_t *input, float *output, size_t length)
 {
     for (size_t i = 0; i < length; i++)
     {
-        output[i] = (float)input[i] / AUDIO_MAX_AMPLITUDE * AUDIO_NORMALIZATION_FACTOR;
+        output[i] = (float)input[i] / AUDIO_SAMPLE_FULL_SCALE * AUDIO_NORMALIZATION_FACTOR;
 
         // 限制範圍
         if (output[i] > 1.0f)
@@ -239,6 +276,15 @@ void AudioCaptureModule::normalize_audio(int16_t *input, float *output, size_t l
  */
 void AudioCaptureModule::apply_window_function(float *data, size_t length)
 {
+    if (length == AUDIO_FRAME_SIZE)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            data[i] *= window_table[i];
+        }
+        return;
+    }
+
     for (size_t i = 0; i < length; i++)
     {
         float window_val = 0.5f * (1.0f - cos(2.0f * PI * i / (length - 1)));
@@ -262,7 +308,7 @@ float AudioCaptureModule::calculate_rms(float *data, size_t length)
 /**
  * 計算零穿越率
  */
-float AudioCaptureModule::calculate_zero_crossing_rate(int16_t *data, size_t length)
+float AudioCaptureModule::calculate_zero_crossing_rate(const float *data, size_t length)
 {
     int zero_crossings = 0;
     for (size_t i = 1; i < length; i++)
@@ -278,41 +324,49 @@ float AudioCaptureModule::calculate_zero_crossing_rate(int16_t *data, size_t len
 /**
  * 提取音訊特徵
  */
-void AudioCaptureModule::extract_audio_features(float *frame, AudioFeatures *features)
+void AudioCaptureModule::extract_audio_features(float *frame, AudioFeatures *features, bool with_cepstrum)
 {
+    PROFILE_SCOPE(PROFILE_STAGE_FEATURES);
+
     // 計算 RMS 能量
     features->rms_energy = calculate_rms(frame, AUDIO_FRAME_SIZE);
 
-    // 轉換為整數以計算零穿越率
-    int16_t temp_samples[AUDIO_FRAME_SIZE];
-    for (size_t i = 0; i < AUDIO_FRAME_SIZE; i++)
-    {
-        temp_samples[i] = (int16_t)(frame[i] * AUDIO_MAX_AMPLITUDE);
-    }
+    // 直接在浮點幀上計算零穿越率（Q31 模式下不先截成 16-bit）
+    features->zero_crossing_rate = calculate_zero_crossing_rate(frame, AUDIO_FRAME_SIZE);
 
-    features->zero_crossing_rate = calculate_zero_crossing_rate(temp_samples, AUDIO_FRAME_SIZE);
+    // 頻譜特徵（單次 FFT）
+    SpectralFeatures spectral;
+    spectral_analyzer.analyze(frame, &spectral);
 
-    // 計算頻譜重心（簡化版）
-    float high_freq_energy = 0.0f;
-    float total_energy = 0.0f;
+    features->spectral_centroid = spectral.centroid;
+    features->spectral_rolloff = spectral.rolloff;
+    features->spectral_flatness = spectral.flatness;
+    features->spectral_flux = spectral.flux;
+    memcpy(features->band_energy, spectral.band_energy, sizeof(features->band_energy));
 
-    for (size_t i = 0; i < AUDIO_FRAME_SIZE; i++)
+    if (with_cepstrum)
     {
-        float energy = frame[i] * frame[i];
-        total_energy += energy;
+        // MFCC 直接使用同一份功率譜；梅爾能量先經噪音抑制
+        float mel_energies[MFCC_NUM_FILTERS];
+        mfcc_extractor.compute_mel_energies(spectral_analyzer.get_power_spectrum(), mel_energies);
 
-        if (i > AUDIO_FRAME_SIZE / 2)
+        if (noise_suppression_enabled)
         {
-            high_freq_energy += energy;
+            noise_suppressor.process(mel_energies);
         }
-    }
 
-    features->spectral_centroid = (total_energy > 0) ? (high_freq_energy / total_energy) : 0.0f;
+        mfcc_extractor.compute_from_mel(mel_energies, &features->mfcc);
+    }
+    else
+    {
+        // 負載調節略過倒頻譜：MFCC 留空，噪音估計凍結並沿用上一幀的抑制比例
+        memset(&features->mfcc, 0, sizeof(features->mfcc));
+    }
 
-    // 確保特徵值有足夠精度
-    if (features->rms_energy < 0.001f && total_energy > 0.0f)
+    features->denoised_energy = features->rms_energy;
+    if (noise_suppression_enabled)
     {
-        features->rms_energy = sqrtf(total_energy / AUDIO_FRAME_SIZE);
+        features->denoised_energy = features->rms_energy * sqrtf(noise_suppressor.get_energy_ratio());
     }
 
     // 語音檢測邏輯
@@ -323,61 +377,336 @@ void AudioCaptureModule::extract_audio_features(float *frame, AudioFeatures *fea
 }
 
 /**
- * 檢查幀是否準備好
+ * 分類前的特徵正規化
+ * 能量改用噪音抑制後的值；CMVN 啟用時 MFCC 減去背景平均值，
+ * 與增益成正比的能量特徵縮放到參考背景能量
  */
-bool AudioCaptureModule::check_frame_ready(int16_t *new_samples, size_t sample_count)
+void AudioCaptureModule::normalize_features(AudioFeatures *features, bool update_stats)
 {
-    for (size_t i = 0; i < sample_count; i++)
+    // CMVN 以原始能量估計增益
+    if (cmvn_enabled && update_stats)
     {
-        frame_buffer[frame_write_pos] = new_samples[i];
-        frame_write_pos++;
+        cmvn.update(features->mfcc, features->rms_energy);
+    }
 
-        if (frame_write_pos >= AUDIO_FRAME_SIZE)
-        {
-            frame_ready_flag = true;
+    if (noise_suppression_enabled)
+    {
+        features->rms_energy = features->denoised_energy;
+    }
 
-            // 移動數據以支持重疊處理
-            memmove(frame_buffer, frame_buffer + AUDIO_FRAME_SIZE - AUDIO_FRAME_OVERLAP,
-                    AUDIO_FRAME_OVERLAP * sizeof(int16_t));
-            frame_write_pos = AUDIO_FRAME_OVERLAP;
+    if (!cmvn_enabled)
+        return;
 
-            return true;
-        }
+    cmvn.apply(&features->mfcc);
+
+    float scale = cmvn.get_energy_scale();
+    features->rms_energy *= scale;
+    features->spectral_flux *= scale;
+    for (int b = 0; b < SPECTRAL_BAND_COUNT; b++)
+    {
+        features->band_energy[b] *= scale * scale;
+    }
+}
+
+/**
+ * 將新樣本填入幀緩衝區，直到湊滿一幀為止
+ * @param timestamp new_samples[0] 的樣本時間
+ * @param consumed 本次實際使用的樣本數，剩餘樣本留待下一幀
+ */
+bool AudioCaptureModule::check_frame_ready(const audio_sample_t *new_samples, size_t sample_count, sample_time_t timestamp, size_t *consumed)
+{
+    size_t space = AUDIO_FRAME_SIZE - frame_write_pos;
+    size_t count = min(space, sample_count);
+
+    // 緩衝區內樣本連續，由寫入位置反推起點時間
+    frame_buffer_time = timestamp - frame_write_pos;
+
+    memcpy(frame_buffer + frame_write_pos, new_samples, count * sizeof(audio_sample_t));
+    frame_write_pos += count;
+    *consumed = count;
+
+    if (frame_write_pos >= AUDIO_FRAME_SIZE)
+    {
+        frame_ready_flag = true;
     }
-    return false;
+    return frame_ready_flag;
 }
 
 /**
- * 獲取當前幀
+ * 取出當前幀，並將重疊部分移到緩衝區開頭
  */
-void AudioCaptureModule::get_current_frame(float *frame_output)
+void AudioCaptureModule::get_current_frame(audio_sample_t *pcm_output)
 {
     if (!frame_ready_flag)
         return;
 
-    int16_t temp_frame[AUDIO_FRAME_SIZE];
-    memcpy(temp_frame, frame_buffer, AUDIO_FRAME_SIZE * sizeof(int16_t));
+    PROFILE_SCOPE(PROFILE_STAGE_FRAME);
 
-    normalize_audio(temp_frame, frame_output, AUDIO_FRAME_SIZE);
-    apply_window_function(frame_output, AUDIO_FRAME_SIZE);
+    memcpy(pcm_output, frame_buffer, AUDIO_FRAME_SIZE * sizeof(audio_sample_t));
+    frame_pcm_time = frame_buffer_time;
+
+    // 移動數據以支持重疊處理（必須在複製之後）
+    memmove(frame_buffer, frame_buffer + AUDIO_FRAME_SIZE - AUDIO_FRAME_OVERLAP,
+            AUDIO_FRAME_OVERLAP * sizeof(audio_sample_t));
+    frame_write_pos = AUDIO_FRAME_OVERLAP;
+    frame_buffer_time += AUDIO_FRAME_HOP;
 
     frame_ready_flag = false;
 }
 
+/**
+ * 正規化並套用窗函數
+ */
+void AudioCaptureModule::prepare_frame(const audio_sample_t *pcm, float *frame_output)
+{
+    normalize_audio(pcm, frame_output, AUDIO_FRAME_SIZE);
+    apply_window_function(frame_output, AUDIO_FRAME_SIZE);
+}
+
+/**
+ * 兩段式處理：能量閘門每個 hop 都執行，開啟時才做完整處理
+ */
+void AudioCaptureModule::process_gated_frame()
+{
+    uint32_t start_cycles = ESP.getCycleCount();
+    tier_stats.gate_frames++;
+
+    // 只看本幀新進的樣本，避免重疊部分被重複計算（閘門閾值以 16-bit 刻度設定）
+    bool gate_open;
+    {
+        PROFILE_SCOPE(PROFILE_STAGE_GATE);
+        int16_t hop_q15[AUDIO_FRAME_HOP];
+        const int16_t *hop = audio_samples_to_q15(frame_pcm + AUDIO_FRAME_OVERLAP, hop_q15, AUDIO_FRAME_HOP);
+        gate_open = energy_gate.process(hop, AUDIO_FRAME_HOP);
+    }
+    deadline_monitor.mark(PROFILE_STAGE_GATE);
+
+    // GMM VAD 為整數運算，每個 hop 都執行，不論閘門或負載調節是否略過完整處理
+    bool gmm_speech = run_gmm_vad(frame_pcm);
+
+    // 語音進行中必須持續完整處理，VAD 才能正確結束
+    bool run_full = !two_rate_enabled || gate_open || vad_current_state != VAD_SILENCE;
+
+    // 負載調節：靜音時每兩個 hop 只完整處理一次，略過的 hop 不進補算緩衝區
+    bool strided = run_full && vad_current_state == VAD_SILENCE &&
+                   get_load_level() >= LOAD_LEVEL_SILENCE_STRIDE && (tier_stats.gate_frames & 1);
+    if (strided)
+    {
+        run_full = false;
+        tier_stats.strided_frames++;
+    }
+    else if (run_full)
+    {
+        // 閘門剛開啟：先補算觸發前的歷史幀
+        gate_closed_hops = 0;
+        flush_preroll_frames();
+        process_full_frame(frame_pcm, frame_pcm_time, gmm_speech);
+    }
+    else
+    {
+        push_preroll_frame(frame_pcm, frame_pcm_time, gmm_speech);
+
+        // 自適應統計只在完整處理時更新：閘門長時間關閉時定期取出最舊的歷史幀完整處理，
+        // 背景緩慢變化時仍能追蹤（時間常數放大 AUDIO_GATE_REFRESH_HOPS 倍；突然升高超過 +6 dB 會開啟閘門，
+        // 以完整速率更新）；其餘歷史幀都比它新，補算的時間順序不變
+        if (++gate_closed_hops >= AUDIO_GATE_REFRESH_HOPS)
+        {
+            gate_closed_hops = 0;
+            int oldest = (preroll_head - preroll_count + AUDIO_PREROLL_FRAMES) % AUDIO_PREROLL_FRAMES;
+            preroll_count--;
+            tier_stats.refresh_frames++;
+            process_full_frame(preroll_frames + oldest * AUDIO_FRAME_SIZE, preroll_times[oldest], preroll_gmm_speech[oldest]);
+        }
+    }
+
+    // 低功耗模式：閘門關閉且 VAD 靜音持續一段時間後降為 8kHz
+    if (low_power_enabled)
+    {
+        bool idle = !gate_open && vad_current_state == VAD_SILENCE;
+        idle_hops = idle ? idle_hops + 1 : 0;
+    }
+
+    uint32_t cycles = ESP.getCycleCount() - start_cycles;
+    if (run_full)
+    {
+        tier_stats.speech_cycles += cycles;
+        tier_stats.speech_samples += AUDIO_FRAME_HOP;
+    }
+    else
+    {
+        tier_stats.silence_cycles += cycles;
+        tier_stats.silence_samples += AUDIO_FRAME_HOP;
+    }
+}
+
+/**
+ * 完整處理一幀：窗函數、特徵提取、VAD 與語音收集
+ * @param gmm_speech 該幀到達時 GMM VAD 的判決
+ */
+void AudioCaptureModule::process_full_frame(const audio_sample_t *pcm, sample_time_t timestamp, bool gmm_speech)
+{
+    tier_stats.full_frames++;
+
+    float current_frame[AUDIO_FRAME_SIZE];
+    prepare_frame(pcm, current_frame);
+
+    // 提取音訊特徵
+    AudioFeatures features;
+    features.timestamp = timestamp;
+    // 負載調節：靜音時可略過倒頻譜（CMVN 不以空的 MFCC 更新）
+    bool with_cepstrum = vad_current_state != VAD_SILENCE || get_load_level() < LOAD_LEVEL_SILENCE_LITE;
+    uint32_t start_cycles = ESP.getCycleCount();
+    extract_audio_features(current_frame, &features, with_cepstrum);
+    vad_engine_stats.energy_cycles += ESP.getCycleCount() - start_cycles;
+    vad_engine_stats.frames++;
+
+    // 執行所選的 VAD 判決引擎
+    run_vad_engine(&features, gmm_speech);
+    deadline_monitor.mark(PROFILE_STAGE_FEATURES);
+
+    // 調用音訊幀回調
+    if (audio_frame_callback)
+    {
+        PROFILE_SCOPE(PROFILE_STAGE_CALLBACK);
+        audio_frame_callback(features);
+    }
+    deadline_monitor.mark(PROFILE_STAGE_CALLBACK);
+
+    // 處理 VAD
+    VADResult vad_result = process_vad(&features);
+
+    // 噪音抑制能量與 CMVN：靜音幀更新統計，語音期間凍結；之後收集的特徵皆為正規化後的值
+    normalize_features(&features, with_cepstrum && vad_result.state == VAD_SILENCE);
+    deadline_monitor.mark(PROFILE_STAGE_VAD);
+
+    // 調用 VAD 回調
+    if (vad_callback)
+    {
+        PROFILE_SCOPE(PROFILE_STAGE_CALLBACK);
+        vad_callback(vad_result);
+    }
+    deadline_monitor.mark(PROFILE_STAGE_CALLBACK);
+
+    // 在語音進行中收集數據
+    if (vad_result.state == VAD_SPEECH_ACTIVE)
+    {
+        collect_speech_data(current_frame, AUDIO_FRAME_SIZE);
+        accumulate_speech_features(features);
+        deadline_monitor.mark(PROFILE_STAGE_VAD);
+    }
+
+    // 語音完成時處理
+    if (vad_result.speech_complete)
+    {
+        process_complete_speech_segment();
+        deadline_monitor.mark(PROFILE_STAGE_CALLBACK);
+    }
+}
+
+/**
+ * 閘門關閉時只保存原始幀，不做任何特徵計算
+ */
+void AudioCaptureModule::push_preroll_frame(const audio_sample_t *pcm, sample_time_t timestamp, bool gmm_speech)
+{
+    memcpy(preroll_frames + preroll_head * AUDIO_FRAME_SIZE, pcm, AUDIO_FRAME_SIZE * sizeof(audio_sample_t));
+    preroll_times[preroll_head] = timestamp;
+    preroll_gmm_speech[preroll_head] = gmm_speech;
+    preroll_head = (preroll_head + 1) % AUDIO_PREROLL_FRAMES;
+    if (preroll_count < AUDIO_PREROLL_FRAMES)
+        preroll_count++;
+}
+
+/**
+ * 依時間順序補算保存的歷史幀
+ */
+void AudioCaptureModule::flush_preroll_frames()
+{
+    int start = (preroll_head - preroll_count + AUDIO_PREROLL_FRAMES) % AUDIO_PREROLL_FRAMES;
+
+    for (int i = 0; i < preroll_count; i++)
+    {
+        int idx = (start + i) % AUDIO_PREROLL_FRAMES;
+        tier_stats.preroll_frames++;
+        process_full_frame(preroll_frames + idx * AUDIO_FRAME_SIZE, preroll_times[idx], preroll_gmm_speech[idx]);
+    }
+
+    preroll_count = 0;
+}
+
+/**
+ * 以本幀新進的樣本更新 GMM VAD
+ * 每個 hop 都呼叫，讓濾波器樹與噪音模型看到連續訊號；GMM 引擎未啟用時不執行
+ * @return GMM 判決
+ */
+bool AudioCaptureModule::run_gmm_vad(const audio_sample_t *pcm)
+{
+    if (active_vad_engine() != VAD_ENGINE_GMM)
+        return false;
+
+    uint32_t start_cycles = ESP.getCycleCount();
+    // GMM VAD 以 16-bit 精度設計，Q31 模式在此縮為 16-bit
+    int16_t hop_q15[AUDIO_FRAME_HOP];
+    const int16_t *hop = audio_samples_to_q15(pcm + AUDIO_FRAME_OVERLAP, hop_q15, AUDIO_FRAME_HOP);
+    bool gmm_decision = gmm_vad.process(hop, AUDIO_FRAME_HOP);
+    vad_engine_stats.gmm_cycles += ESP.getCycleCount() - start_cycles;
+    vad_engine_stats.gmm_frames++;
+    return gmm_decision;
+}
+
+/**
+ * 執行所選的 VAD 判決引擎
+ * GMM 引擎啟用時以該幀到達時的 GMM 判決覆寫 is_voice_detected，並與原能量判決比較
+ */
+void AudioCaptureModule::run_vad_engine(AudioFeatures *features, bool gmm_speech)
+{
+    if (active_vad_engine() != VAD_ENGINE_GMM)
+        return;
+
+    bool energy_decision = features->is_voice_detected && (features->rms_energy > VAD_ENERGY_THRESHOLD);
+
+    if (energy_decision && gmm_speech)
+        vad_engine_stats.both_speech++;
+    else if (energy_decision)
+        vad_engine_stats.energy_only++;
+    else if (gmm_speech)
+        vad_engine_stats.gmm_only++;
+
+    features->is_voice_detected = gmm_speech;
+}
+
+/**
+ * 實際使用的 VAD 引擎（負載調節最後一級以能量 VAD 取代 GMM）
+ */
+VADEngine AudioCaptureModule::active_vad_engine() const
+{
+    if (get_load_level() >= LOAD_LEVEL_ENERGY_VAD)
+        return VAD_ENGINE_ENERGY;
+    return vad_engine;
+}
+
 /**
  * 處理語音活動檢測
  */
 VADResult AudioCaptureModule::process_vad(const AudioFeatures *features)
 {
+    PROFILE_SCOPE(PROFILE_STAGE_VAD);
+
     VADResult result;
+    VADState entry_state = vad_current_state;
     result.state = vad_current_state;
     result.speech_detected = false;
     result.speech_complete = false;
     result.energy_level = features->rms_energy;
     result.duration_ms = 0;
 
-    unsigned long current_time = millis();
-    bool is_speech_energy = (features->rms_energy > VAD_ENERGY_THRESHOLD);
+    // 以幀結束的樣本時間計時，與處理延遲或 loop() 排程無關
+    const SampleClock &clock = inmp441.get_sample_clock();
+    sample_time_t current_time = features->timestamp + AUDIO_FRAME_SIZE;
+    result.timestamp = current_time;
+
+    // GMM 引擎本身已包含能量判斷，不再疊加固定能量閾值
+    bool is_speech_energy = (active_vad_engine() == VAD_ENGINE_GMM) ? features->is_voice_detected
+                                                           : (features->rms_energy > VAD_ENERGY_THRESHOLD);
 
     switch (vad_current_state)
     {
@@ -392,10 +721,12 @@ VADResult AudioCaptureModule::process_vad(const AudioFeatures *features)
                 vad_current_state = VAD_SPEECH_START;
                 speech_start_time = current_time;
                 speech_buffer_length = 0;
+                speech_feature_frames = 0;
+                memset(&speech_features_sum, 0, sizeof(speech_features_sum));
                 result.state = VAD_SPEECH_START;
                 result.speech_detected = true;
 
-                debug.print("🎤 語音開始檢測");
+                DBG_PRINT(debug, "🎤 語音開始檢測");
             }
         }
         else
@@ -422,7 +753,7 @@ VADResult AudioCaptureModule::process_vad(const AudioFeatures *features)
             if (silence_frame_count >= VAD_END_FRAMES)
             {
                 speech_end_time = current_time;
-                unsigned long duration = speech_end_time - speech_start_time;
+                unsigned long duration = clock.to_ms(speech_end_time - speech_start_time);
 
                 if (duration >= VAD_MIN_SPEECH_DURATION)
                 {
@@ -431,24 +762,25 @@ VADResult AudioCaptureModule::process_vad(const AudioFeatures *features)
                     result.speech_complete = true;
                     result.duration_ms = duration;
 
-                    debug.printf("✅ 語音結束 - 持續時間: %lu ms\n", duration);
+                    DBG_PRINTF(debug, "✅ 語音結束 - 持續時間: %lu ms\n", duration);
                 }
                 else
                 {
-                    debug.printf("⚠️  語音太短 (%lu ms)，忽略\n", duration);
+                    DBG_PRINTF(debug, "⚠️  語音太短 (%lu ms)，忽略\n", duration);
                     reset_vad();
                 }
             }
         }
 
         // 超時保護
-        if ((current_time - speech_start_time) > VAD_MAX_SPEECH_DURATION)
+        if (clock.to_ms(current_time - speech_start_time) > VAD_MAX_SPEECH_DURATION)
         {
-            debug.print("⏰ 語音超時，強制結束");
+            DBG_PRINT(debug, "⏰ 語音超時，強制結束");
             vad_current_state = VAD_SPEECH_END;
+            speech_end_time = current_time;
             result.state = VAD_SPEECH_END;
             result.speech_complete = true;
-            result.duration_ms = current_time - speech_start_time;
+            result.duration_ms = clock.to_ms(current_time - speech_start_time);
         }
         break;
 
@@ -458,6 +790,10 @@ VADResult AudioCaptureModule::process_vad(const AudioFeatures *features)
         break;
     }
 
+    if (vad_current_state != entry_state)
+        TRACE_INSTANT(TRACE_EVENT_VAD_STATE, vad_current_state);
+
+    result.speech_start = speech_start_time;
     return result;
 }
 
@@ -475,13 +811,9 @@ bool AudioCaptureModule::collect_speech_data(const float *frame, size_t frame_si
         memmove(speech_buffer, &speech_buffer[discard_samples], keep_samples * sizeof(float));
         speech_buffer_length = keep_samples;
 
-        static unsigned long last_warning = 0;
-        unsigned long now = millis();
-        if (now - last_warning > 2000)
-        {
-            debug.printf("🔄 緩衝區循環使用 - 保留最新 %.1f 秒語音\n", (float)keep_samples / AUDIO_SAMPLE_RATE);
-            last_warning = now;
-        }
+        // 每 2 秒（樣本時間）最多提示一次
+        DBG_PRINTF_INTERVAL(debug, inmp441.get_sample_clock().now(), (sample_time_t)AUDIO_SAMPLE_RATE * 2,
+                            "🔄 緩衝區循環使用 - 保留最新 %.1f 秒語音\n", (float)keep_samples / AUDIO_SAMPLE_RATE);
     }
 
     memcpy(&speech_buffer[speech_buffer_length], frame, frame_size * sizeof(float));
@@ -490,6 +822,63 @@ bool AudioCaptureModule::collect_speech_data(const float *frame, size_t frame_si
     return true;
 }
 
+/**
+ * 累加語音段落內的幀特徵（供語音完成時取平均）
+ */
+void AudioCaptureModule::accumulate_speech_features(const AudioFeatures &features)
+{
+    speech_features_sum.rms_energy += features.rms_energy;
+    speech_features_sum.zero_crossing_rate += features.zero_crossing_rate;
+    speech_features_sum.spectral_centroid += features.spectral_centroid;
+    speech_features_sum.spectral_rolloff += features.spectral_rolloff;
+    speech_features_sum.spectral_flatness += features.spectral_flatness;
+    speech_features_sum.spectral_flux += features.spectral_flux;
+    for (int b = 0; b < SPECTRAL_BAND_COUNT; b++)
+    {
+        speech_features_sum.band_energy[b] += features.band_energy[b];
+    }
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        speech_features_sum.mfcc.coeffs[k] += features.mfcc.coeffs[k];
+    }
+    speech_features_sum.timestamp = features.timestamp;
+    speech_feature_frames++;
+}
+
+/**
+ * 獲取當前（或最近一次）語音段落的平均特徵
+ * 在語音完成回調中呼叫，不需重新計算任何轉換
+ */
+AudioFeatures AudioCaptureModule::get_speech_features() const
+{
+    AudioFeatures avg;
+    memset(&avg, 0, sizeof(avg));
+
+    if (speech_feature_frames == 0)
+        return avg;
+
+    float scale = 1.0f / speech_feature_frames;
+    avg.rms_energy = speech_features_sum.rms_energy * scale;
+    avg.zero_crossing_rate = speech_features_sum.zero_crossing_rate * scale;
+    avg.spectral_centroid = speech_features_sum.spectral_centroid * scale;
+    avg.spectral_rolloff = speech_features_sum.spectral_rolloff * scale;
+    avg.spectral_flatness = speech_features_sum.spectral_flatness * scale;
+    avg.spectral_flux = speech_features_sum.spectral_flux * scale;
+    for (int b = 0; b < SPECTRAL_BAND_COUNT; b++)
+    {
+        avg.band_energy[b] = speech_features_sum.band_energy[b] * scale;
+    }
+    // 差分的平均沒有意義，只平均靜態係數
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        avg.mfcc.coeffs[k] = speech_features_sum.mfcc.coeffs[k] * scale;
+    }
+    avg.is_voice_detected = true;
+    avg.timestamp = speech_features_sum.timestamp;
+
+    return avg;
+}
+
 /**
  * 處理完整語音段落
  */
@@ -497,12 +886,14 @@ void AudioCaptureModule::process_complete_speech_segment()
 {
     if (speech_buffer_length == 0) return;
 
-    debug.printf("🔄 處理完整語音段落 - 長度: %d 樣本\n", speech_buffer_length);
+    DBG_PRINTF(debug, "🔄 處理完整語音段落 - 長度: %d 樣本\n", speech_buffer_length);
+    speech_segment_metric.add();
 
     // 調用語音完成回調
     if (speech_complete_callback)
     {
-        unsigned long duration = (speech_end_time - speech_start_time);
+        PROFILE_SCOPE(PROFILE_STAGE_CALLBACK);
+        unsigned long duration = inmp441.get_sample_clock().to_ms(speech_end_time - speech_start_time);
         speech_complete_callback(speech_buffer, speech_buffer_length, duration);
     }
 
@@ -552,6 +943,140 @@ void AudioCaptureModule::reset_vad()
     speech_end_time = 0;
 }
 
+/**
+ * 設置 VAD 判決引擎
+ */
+void AudioCaptureModule::set_vad_engine(VADEngine engine)
+{
+    if (engine == vad_engine)
+        return;
+
+    vad_engine = engine;
+    gmm_vad.reset();
+    reset_vad();
+    reset_vad_engine_stats();
+
+    DBG_PRINTF(debug, "🔀 VAD 引擎切換為: %s\n", engine == VAD_ENGINE_GMM ? "GMM" : "Energy");
+}
+
+/**
+ * 設置 CPU 負載調節（關閉時固定完整處理）
+ */
+void AudioCaptureModule::set_load_governor_enabled(bool enable)
+{
+    if (!enable && load_governor.get_level() >= LOAD_LEVEL_ENERGY_VAD)
+        gmm_vad.reset();
+
+    load_governor_enabled = enable;
+    load_governor.reset();
+}
+
+/**
+ * 設置兩段式處理（關閉時每幀都做完整處理）
+ */
+void AudioCaptureModule::set_two_rate_processing(bool enable)
+{
+    two_rate_enabled = enable;
+    energy_gate.reset();
+    preroll_count = 0;
+    gate_closed_hops = 0;
+    reset_pipeline_tier_stats();
+}
+
+/**
+ * 設置 CMVN 正規化
+ */
+void AudioCaptureModule::set_cmvn_enabled(bool enable)
+{
+    cmvn_enabled = enable;
+    cmvn.reset();
+}
+
+/**
+ * 設置梅爾能量噪音抑制（MFCC 定義改變，CMVN 與差分歷史一併重置）
+ */
+void AudioCaptureModule::set_noise_suppression_enabled(bool enable)
+{
+    noise_suppression_enabled = enable;
+    noise_suppressor.reset();
+    mfcc_extractor.reset();
+    cmvn.reset();
+}
+
+/**
+ * 重置兩段式處理統計
+ */
+void AudioCaptureModule::reset_pipeline_tier_stats()
+{
+    memset(&tier_stats, 0, sizeof(tier_stats));
+}
+
+/**
+ * 打印兩段式處理統計
+ */
+void AudioCaptureModule::print_pipeline_tier_stats() const
+{
+    if (!debug.is_debug_enabled())
+        return;
+
+    const PipelineTierStats &stats = tier_stats;
+
+    // 每秒音訊所花費的週期數 = 累計週期 / (樣本數 / 取樣率)
+    unsigned long silence_cps = stats.silence_samples ?
+        (unsigned long)(stats.silence_cycles * AUDIO_SAMPLE_RATE / stats.silence_samples) : 0UL;
+    unsigned long speech_cps = stats.speech_samples ?
+        (unsigned long)(stats.speech_cycles * AUDIO_SAMPLE_RATE / stats.speech_samples) : 0UL;
+
+    DBG_PRINT(debug, "📊 兩段式處理統計:");
+    DBG_PRINTF(debug, "  閘門幀數: %lu, 完整處理: %lu (補算: %lu)\n",
+               (unsigned long)stats.gate_frames, (unsigned long)stats.full_frames,
+               (unsigned long)stats.preroll_frames);
+    DBG_PRINTF(debug, "  靜音: %lu cycles/s 音訊, 語音: %lu cycles/s 音訊\n", silence_cps, speech_cps);
+    if (stats.refresh_frames)
+    {
+        DBG_PRINTF(debug, "  靜音期間定期更新: %lu 幀\n", (unsigned long)stats.refresh_frames);
+    }
+    if (stats.strided_frames)
+    {
+        DBG_PRINTF(debug, "  負載調節略過: %lu hops\n", (unsigned long)stats.strided_frames);
+    }
+    if (stats.low_power_samples)
+    {
+        unsigned long low_power_cps =
+            (unsigned long)(stats.low_power_cycles * AUDIO_LOW_POWER_SAMPLE_RATE / stats.low_power_samples);
+        DBG_PRINTF(debug, "  8kHz 低功耗: %lu hops, %lu cycles/s 音訊, 喚醒 %lu 次\n",
+                   (unsigned long)stats.low_power_hops, low_power_cps, (unsigned long)stats.wakeups);
+    }
+}
+
+/**
+ * 重置 VAD 引擎比較統計
+ */
+void AudioCaptureModule::reset_vad_engine_stats()
+{
+    memset(&vad_engine_stats, 0, sizeof(vad_engine_stats));
+}
+
+/**
+ * 打印 VAD 引擎比較統計
+ */
+void AudioCaptureModule::print_vad_engine_stats() const
+{
+    if (!debug.is_debug_enabled())
+        return;
+
+    const VADEngineStats &stats = vad_engine_stats;
+
+    DBG_PRINT(debug, "📊 VAD 引擎統計:");
+    DBG_PRINTF(debug, "  處理幀數: %lu (GMM: %lu)\n", (unsigned long)stats.frames, (unsigned long)stats.gmm_frames);
+    DBG_PRINTF(debug, "  能量判決: %lu cycles/frame\n",
+               stats.frames ? (unsigned long)(stats.energy_cycles / stats.frames) : 0UL);
+    DBG_PRINTF(debug, "  GMM 判決: %lu cycles/frame\n",
+               stats.gmm_frames ? (unsigned long)(stats.gmm_cycles / stats.gmm_frames) : 0UL);
+    DBG_PRINTF(debug, "  皆為語音: %lu, 僅能量: %lu, 僅 GMM: %lu\n",
+               (unsigned long)stats.both_speech, (unsigned long)stats.energy_only, (unsigned long)stats.gmm_only);
+}
+
 /**
  * 清除語音緩衝區
  */
@@ -565,87 +1090,175 @@ void AudioCaptureModule::clear_speech_buffer()
 }
 
 /**
- * 獲取音訊統計信息
+ * 獲取音訊統計信息（INMP441 轉換時已累計，不掃描緩衝區）
  */
 AudioCaptureModule::AudioStats AudioCaptureModule::get_audio_stats() const
 {
-    AudioStats stats = {0};
-    
-    if (!processed_buffer) return stats;
-    
-    // 計算當前緩衝區的統計信息
-    int32_t min_val = processed_buffer[0];
-    int32_t max_val = processed_buffer[0];
-    int64_t sum = 0;
-    
-    for (int i = 0; i < AUDIO_BUFFER_SIZE; i++)
-    {
-        int16_t sample = processed_buffer[i];
-        if (sample < min_val) min_val = sample;
-        if (sample > max_val) max_val = sample;
-        sum += abs(sample);
-    }
-    
-    stats.min_amplitude = min_val;
-    stats.max_amplitude = max_val;
-    stats.avg_amplitude = sum / AUDIO_BUFFER_SIZE;
-    stats.samples_processed = AUDIO_BUFFER_SIZE;
-    stats.last_activity_time = millis();
-    
+    AudioLevelMeter::Stats level = inmp441.get_level_stats();
+
+    AudioStats stats;
+    stats.min_amplitude = level.window_min;
+    stats.max_amplitude = level.window_max;
+    stats.peak_amplitude = level.block_peak;
+    stats.rms_amplitude = (int32_t)(level.block_rms + 0.5f);
+    stats.rms_dbfs = level.block_rms_dbfs;
+    stats.peak_dbfs = level.block_peak_dbfs;
+    stats.dc_mean = level.window_dc;
+    stats.clipped_samples = level.clipped_samples;
+    stats.samples_processed = level.total_samples;
+    stats.last_activity_time = level.last_block_time;
+
     return stats;
 }
 
 /**
  * INMP441 音訊數據回調處理
  */
-void AudioCaptureModule::on_inmp441_audio_data(const int16_t *audio_data, size_t sample_count)
+void AudioCaptureModule::on_inmp441_audio_data(const audio_sample_t *audio_data, size_t sample_count, sample_time_t timestamp)
 {
     if (!is_running || !audio_data || sample_count == 0) return;
 
+    if (inmp441.is_low_power_mode())
+    {
+        process_low_power_block(audio_data, sample_count);
+        return;
+    }
+
     // 將音訊數據複製到處理緩衝區
     size_t samples_to_process = min(sample_count, (size_t)AUDIO_BUFFER_SIZE);
-    memcpy(processed_buffer, audio_data, samples_to_process * sizeof(int16_t));
+    memcpy(processed_buffer, audio_data, samples_to_process * sizeof(audio_sample_t));
 
-    // 檢查幀是否準備好
-    if (check_frame_ready(processed_buffer, samples_to_process))
+    // 逐幀處理整個區塊，每湊滿一幀（每個 hop）處理一次
+    size_t offset = 0;
+    while (offset < samples_to_process)
     {
-        // 獲取處理後的音訊幀
-        float current_frame[AUDIO_FRAME_SIZE];
-        get_current_frame(current_frame);
-
-        // 提取音訊特徵
-        AudioFeatures features;
-        extract_audio_features(current_frame, &features);
-
-        // 調用音訊幀回調
-        if (audio_frame_callback)
+        size_t consumed = 0;
+        bool ready = check_frame_ready(processed_buffer + offset, samples_to_process - offset, timestamp + offset, &consumed);
+        offset += consumed;
+
+        if (!ready)
+            break;
+
+        TRACE_SCOPE(TRACE_EVENT_HOP, frame_buffer_time);
+
+        // 期限：幀最後一個樣本擷取後一個 hop 內必須處理完
+        // 遺失樣本的修正由 DeadlineMonitor 自行累計，這裡使用未經 resync 的時間軸以免重複修正
+        const SampleClock &clock = inmp441.get_sample_clock();
+        deadline_monitor.begin_frame(frame_buffer_time,
+                                     clock.get_start_us() + (int64_t)clock.to_us(frame_buffer_time + AUDIO_FRAME_SIZE));
+        get_current_frame(frame_pcm);
+        deadline_monitor.mark(PROFILE_STAGE_FRAME);
+        process_gated_frame();
+        bool on_time = deadline_monitor.end_frame();
+
+        frames_metric.add();
+        frame_us_metric.record(deadline_monitor.get_last_frame_us());
+        if (!on_time)
         {
-            audio_frame_callback(features);
+            deadline_miss_metric.add();
+            TRACE_INSTANT(TRACE_EVENT_DEADLINE_MISS, deadline_monitor.get_last_frame_us());
+            TRACE_FIRE();
         }
 
-        // 處理 VAD
-        VADResult vad_result = process_vad(&features);
+        if (load_governor_enabled)
+            update_load_governor(on_time);
+    }
 
-        // 調用 VAD 回調
-        if (vad_callback)
-        {
-            vad_callback(vad_result);
-        }
+    // 區塊處理完才切換取樣率，避免同一區塊混用兩種取樣率
+    if (low_power_enabled && idle_hops >= AUDIO_LOW_POWER_IDLE_HOPS)
+    {
+        enter_low_power_mode();
+    }
+}
 
-        // 在語音進行中收集數據
-        if (vad_result.state == VAD_SPEECH_ACTIVE)
-        {
-            collect_speech_data(current_frame, AUDIO_FRAME_SIZE);
-        }
+/**
+ * 以本幀處理時間更新負載調節，等級改變時記錄並處理狀態切換
+ */
+void AudioCaptureModule::update_load_governor(bool on_time)
+{
+    LoadLevel previous = load_governor.get_level();
+    // 以樣本時鐘計時，重播或主機測試結果可重現
+    int64_t now_us = (int64_t)inmp441.get_sample_clock().to_us(frame_pcm_time + AUDIO_FRAME_SIZE);
+    LoadLevel level = load_governor.update(now_us, deadline_monitor.get_last_frame_us(),
+                                           deadline_monitor.get_budget_us(), !on_time);
+    if (level == previous)
+        return;
+
+    // 回到 GMM 時濾波器狀態已過時
+    if (previous >= LOAD_LEVEL_ENERGY_VAD && level < LOAD_LEVEL_ENERGY_VAD)
+        gmm_vad.reset();
 
-        // 語音完成時處理
-        if (vad_result.speech_complete)
+    DBG_PRINTF(debug, "🎚️  負載 %.0f%%，品質等級 %s → %s\n", load_governor.get_load() * 100.0f,
+               LoadGovernor::level_name(previous), LoadGovernor::level_name(level));
+}
+
+/**
+ * 8kHz 低功耗模式：每個 hop 只跑能量閘門，不做任何特徵提取
+ * 閘門開啟即切回 16kHz（本區塊剩餘的 8kHz 樣本捨棄），由完整流程接手
+ */
+void AudioCaptureModule::process_low_power_block(const audio_sample_t *samples, size_t sample_count)
+{
+    int16_t hop_q15[AUDIO_LOW_POWER_HOP];
+
+    for (size_t offset = 0; offset + AUDIO_LOW_POWER_HOP <= sample_count; offset += AUDIO_LOW_POWER_HOP)
+    {
+        uint32_t start_cycles = ESP.getCycleCount();
+        const int16_t *hop = audio_samples_to_q15(samples + offset, hop_q15, AUDIO_LOW_POWER_HOP);
+        bool gate_open = energy_gate.process(hop, AUDIO_LOW_POWER_HOP);
+
+        tier_stats.low_power_hops++;
+        tier_stats.low_power_cycles += ESP.getCycleCount() - start_cycles;
+        tier_stats.low_power_samples += AUDIO_LOW_POWER_HOP;
+
+        if (gate_open)
         {
-            process_complete_speech_segment();
+            inmp441.set_low_power_mode(false);
+            tier_stats.wakeups++;
+            idle_hops = 0;
+            DBG_PRINT(debug, "⚡ 能量閘門觸發，切回 16kHz 完整處理");
+            return;
         }
     }
 }
 
+/**
+ * 降為 8kHz：清除 16kHz 的幀與補算緩衝區
+ */
+void AudioCaptureModule::enter_low_power_mode()
+{
+    idle_hops = 0;
+    if (!inmp441.set_low_power_mode(true))
+        return;
+
+    frame_write_pos = 0;
+    frame_ready_flag = false;
+    preroll_count = 0;
+    DBG_PRINT(debug, "🔋 閒置中，降為 8kHz 低功耗模式");
+}
+
+/**
+ * 設置 8kHz 低功耗模式（閒置時自動降頻，閘門觸發時自動恢復）
+ */
+bool AudioCaptureModule::set_low_power_mode(bool enable)
+{
+    INMP441Config config = inmp441.get_config();
+    if (enable && config.decimation_factor != INMP441_OVERSAMPLE_FACTOR)
+    {
+        DBG_PRINT(debug, "❌ 低功耗模式需要 48kHz 過取樣擷取");
+        return false;
+    }
+
+    low_power_enabled = enable;
+    idle_hops = 0;
+    if (!enable && inmp441.is_low_power_mode())
+    {
+        inmp441.set_low_power_mode(false);
+        frame_write_pos = 0;
+        frame_ready_flag = false;
+    }
+    return true;
+}
+
 /**
  * INMP441 狀態變更回調處理
  */
@@ -653,18 +1266,18 @@ void AudioCaptureModule::on_inmp441_state_change(INMP441State state, const char
 {
     if (debug.is_debug_enabled())
     {
-        debug.printf("🔄 INMP441 狀態變更: %s", inmp441_state_to_string(state));
+        DBG_PRINTF(debug, "🔄 INMP441 狀態變更: %s", inmp441_state_to_string(state));
         if (message)
         {
-            debug.printf(" - %s", message);
+            DBG_PRINTF(debug, " - %s", message);
         }
-        debug.print("");
+        DBG_PRINT(debug, "");
     }
 
     // 根據 INMP441 狀態調整模組狀態
     if (state == INMP441_ERROR)
     {
-        debug.print("⚠️  INMP441 發生錯誤，停止音訊擷取");
+        DBG_PRINT(debug, "⚠️  INMP441 發生錯誤，停止音訊擷取");
         is_running = false;
     }
 }
@@ -676,7 +1289,7 @@ bool AudioCaptureModule::configure_inmp441(const INMP441Config &config)
 {
     if (is_running)
     {
-        debug.print("❌ 無法在運行中配置 INMP441");
+        DBG_PRINT(debug, "❌ 無法在運行中配置 INMP441");
         return false;
     }
 
@@ -0,0 +1,123 @@
+#include "beamformer.h"
+#include <string.h>
+
+#define HISTORY_MASK (BEAMFORMER_HISTORY_SIZE - 1)
+
+DelayAndSumBeamformer::DelayAndSumBeamformer() : fixed_steering(false)
+{
+    reset();
+}
+
+void DelayAndSumBeamformer::reset()
+{
+    memset(history_left, 0, sizeof(history_left));
+    memset(history_right, 0, sizeof(history_right));
+    history_pos = 0;
+
+    memset(block_corr, 0, sizeof(block_corr));
+    memset(smoothed_corr, 0, sizeof(smoothed_corr));
+    block_energy = 0;
+    block_count = 0;
+    if (!fixed_steering)
+        steering_delay = 0;
+
+    last_cycles = 0;
+    total_cycles = 0;
+    sample_count = 0;
+    steering_updates = 0;
+    over_budget_calls = 0;
+}
+
+void DelayAndSumBeamformer::set_fixed_steering(int delay)
+{
+    if (delay > BEAMFORMER_MAX_DELAY)
+        delay = BEAMFORMER_MAX_DELAY;
+    if (delay < -BEAMFORMER_MAX_DELAY)
+        delay = -BEAMFORMER_MAX_DELAY;
+
+    fixed_steering = true;
+    steering_delay = delay;
+}
+
+void DelayAndSumBeamformer::set_adaptive_steering()
+{
+    fixed_steering = false;
+    memset(smoothed_corr, 0, sizeof(smoothed_corr));
+}
+
+/**
+ * 區塊結束：平滑互相關並選擇最大值對應的延遲
+ */
+void DelayAndSumBeamformer::update_steering()
+{
+    if (!fixed_steering && block_energy >= BEAMFORMER_MIN_BLOCK_ENERGY)
+    {
+        int best = 0;
+        for (int i = 0; i < BEAMFORMER_NUM_LAGS; i++)
+        {
+            smoothed_corr[i] += (block_corr[i] - smoothed_corr[i]) >> BEAMFORMER_SMOOTHING_SHIFT;
+            if (smoothed_corr[i] > smoothed_corr[best])
+                best = i;
+        }
+        steering_delay = best - BEAMFORMER_MAX_DELAY;
+        steering_updates++;
+    }
+
+    memset(block_corr, 0, sizeof(block_corr));
+    block_energy = 0;
+    block_count = 0;
+}
+
+size_t DelayAndSumBeamformer::process(const int32_t *interleaved, size_t frames, int32_t *output)
+{
+    uint32_t start_cycles = ESP.getCycleCount();
+
+    for (size_t n = 0; n < frames; n++)
+    {
+        // 先讀出兩個聲道再寫輸出，允許原地處理
+        int32_t left = interleaved[2 * n] >> 8;
+        int32_t right = interleaved[2 * n + 1] >> 8;
+
+        history_pos = (history_pos + 1) & HISTORY_MASK;
+        history_left[history_pos] = left;
+        history_right[history_pos] = right;
+
+        // 延遲較早到達的聲道後相加
+        int32_t aligned_left = left;
+        int32_t aligned_right = right;
+        if (steering_delay > 0)
+            aligned_left = history_left[(history_pos - steering_delay) & HISTORY_MASK];
+        else if (steering_delay < 0)
+            aligned_right = history_right[(history_pos + steering_delay) & HISTORY_MASK];
+        output[n] = ((aligned_left + aligned_right) >> 1) * 256;
+
+        // 互相關：R[n]·L[n-τ]（τ >= 0）與 L[n]·R[n-|τ|]（τ < 0）
+        if (!fixed_steering && (block_count % BEAMFORMER_CORR_STRIDE) == 0)
+        {
+            int32_t l0 = left >> BEAMFORMER_CORR_SHIFT;
+            int32_t r0 = right >> BEAMFORMER_CORR_SHIFT;
+            block_energy += (int64_t)l0 * l0 + (int64_t)r0 * r0;
+
+            for (int lag = 0; lag <= BEAMFORMER_MAX_DELAY; lag++)
+            {
+                int32_t l = history_left[(history_pos - lag) & HISTORY_MASK] >> BEAMFORMER_CORR_SHIFT;
+                block_corr[BEAMFORMER_MAX_DELAY + lag] += r0 * l;
+            }
+            for (int lag = 1; lag <= BEAMFORMER_MAX_DELAY; lag++)
+            {
+                int32_t r = history_right[(history_pos - lag) & HISTORY_MASK] >> BEAMFORMER_CORR_SHIFT;
+                block_corr[BEAMFORMER_MAX_DELAY - lag] += l0 * r;
+            }
+        }
+
+        if (++block_count == BEAMFORMER_BLOCK_SIZE)
+            update_steering();
+    }
+
+    last_cycles = ESP.getCycleCount() - start_cycles;
+    total_cycles += last_cycles;
+    sample_count += frames;
+    if (last_cycles > frames * BEAMFORMER_CYCLE_BUDGET)
+        over_budget_calls++;
+    return frames;
+}
@@ -0,0 +1,147 @@
+#include "cmvn.h"
+#include <math.h>
+#include <string.h>
+
+#define CMVN_ALPHA (1.0f / (1 << CMVN_EMA_SHIFT))
+#define CMVN_VARIANCE_FLOOR_Q20 ((int64_t)(CMVN_VARIANCE_FLOOR * (1 << 20)))
+
+/**
+ * 64 位元整數平方根（逐位元法）
+ */
+static uint32_t isqrt64(uint64_t value)
+{
+    uint64_t result = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > value)
+        bit >>= 2;
+
+    while (bit != 0)
+    {
+        if (value >= result + bit)
+        {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
+
+CmvnNormalizer::CmvnNormalizer()
+{
+    reset();
+}
+
+void CmvnNormalizer::reset()
+{
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        mean[k] = 0.0f;
+        variance[k] = 1.0f;
+        inv_std[k] = 1.0f;
+
+        mean_q[k] = 0;
+        variance_q[k] = 1LL << 20;
+        inv_std_q12[k] = 1 << 12;
+    }
+    mean_log_energy = 0.0f;
+    energy_scale = 1.0f;
+    update_count = 0;
+    update_count_q = 0;
+}
+
+void CmvnNormalizer::update(const MfccFeatures &mfcc, float rms_energy)
+{
+    // 暖機期間使用累積平均，之後固定衰減係數
+    float alpha = (update_count < CMVN_WARMUP_FRAMES) ? 1.0f / (update_count + 1) : CMVN_ALPHA;
+
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        float diff = mfcc.coeffs[k] - mean[k];
+        mean[k] += alpha * diff;
+
+        if (update_count == 0)
+            variance[k] = CMVN_VARIANCE_FLOOR;
+        else
+            variance[k] += alpha * (diff * diff - variance[k]);
+
+        float v = (variance[k] > CMVN_VARIANCE_FLOOR) ? variance[k] : CMVN_VARIANCE_FLOOR;
+        inv_std[k] = 1.0f / sqrtf(v);
+    }
+
+    // 背景能量以對數域平均，增益變化即為常數偏移
+    float log_energy = logf(rms_energy + 1e-6f);
+    mean_log_energy += alpha * (log_energy - mean_log_energy);
+    energy_scale = CMVN_REFERENCE_RMS / expf(mean_log_energy);
+
+    update_count++;
+}
+
+void CmvnNormalizer::apply(MfccFeatures *mfcc) const
+{
+    if (update_count == 0)
+        return;
+
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        mfcc->coeffs[k] -= mean[k];
+#if CMVN_NORMALIZE_VARIANCE
+        mfcc->coeffs[k] *= inv_std[k];
+        mfcc->delta[k] *= inv_std[k];
+        mfcc->delta2[k] *= inv_std[k];
+#endif
+    }
+}
+
+void CmvnNormalizer::update_fixed(const MfccFixedFeatures &mfcc)
+{
+    bool warmup = update_count_q < CMVN_WARMUP_FRAMES;
+
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        int32_t diff = mfcc.coeffs[k] - mean_q[k];
+        int64_t diff_sq = (int64_t)diff * diff; // Q20
+
+        if (warmup)
+        {
+            mean_q[k] += diff / (int32_t)(update_count_q + 1);
+            if (update_count_q == 0)
+                variance_q[k] = CMVN_VARIANCE_FLOOR_Q20;
+            else
+                variance_q[k] += (diff_sq - variance_q[k]) / (int64_t)(update_count_q + 1);
+        }
+        else
+        {
+            mean_q[k] += diff >> CMVN_EMA_SHIFT;
+            variance_q[k] += (diff_sq - variance_q[k]) >> CMVN_EMA_SHIFT;
+        }
+
+        // 標準差 Q10，倒數 Q12
+        int64_t v = (variance_q[k] > CMVN_VARIANCE_FLOOR_Q20) ? variance_q[k] : CMVN_VARIANCE_FLOOR_Q20;
+        uint32_t std_q10 = isqrt64((uint64_t)v);
+        inv_std_q12[k] = (int32_t)((1 << 22) / std_q10);
+    }
+
+    update_count_q++;
+}
+
+void CmvnNormalizer::apply_fixed(MfccFixedFeatures *mfcc) const
+{
+    if (update_count_q == 0)
+        return;
+
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        mfcc->coeffs[k] -= mean_q[k];
+#if CMVN_NORMALIZE_VARIANCE
+        mfcc->coeffs[k] = (int32_t)(((int64_t)mfcc->coeffs[k] * inv_std_q12[k]) >> 12);
+        mfcc->delta[k] = (int32_t)(((int64_t)mfcc->delta[k] * inv_std_q12[k]) >> 12);
+        mfcc->delta2[k] = (int32_t)(((int64_t)mfcc->delta2[k] * inv_std_q12[k]) >> 12);
+#endif
+    }
+}
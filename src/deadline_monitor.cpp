@@ -0,0 +1,149 @@
+#include "deadline_monitor.h"
+#include "esp_timer.h"
+#include <string.h>
+
+static int64_t default_time_source()
+{
+    return esp_timer_get_time();
+}
+
+DeadlineMonitor::DeadlineMonitor() : time_source(default_time_source), budget_us(DEADLINE_BUDGET_US)
+{
+    reset();
+}
+
+void DeadlineMonitor::set_time_source(DeadlineTimeSource source)
+{
+    time_source = source ? source : default_time_source;
+    reset();
+}
+
+void DeadlineMonitor::reset()
+{
+    in_frame = false;
+    frame_timestamp = 0;
+    frame_deadline_us = 0;
+    last_mark_us = 0;
+    last_end_us = 0;
+    frame_begin_us = 0;
+    last_frame_us = 0;
+    rebase_us = 0;
+    memset(frame_source_us, 0, sizeof(frame_source_us));
+
+    memset(&stats, 0, sizeof(stats));
+    stats.min_slack_us = INT64_MAX;
+    stats.worst.source = DEADLINE_SOURCE_BETWEEN_FRAMES;
+}
+
+void DeadlineMonitor::begin_frame(sample_time_t timestamp, int64_t release_us)
+{
+    int64_t now = time_source();
+
+    memset(frame_source_us, 0, sizeof(frame_source_us));
+    // 上一幀結束到這一幀開始之間的時間（讀取、轉換、主迴圈其他工作）
+    if (last_end_us)
+        frame_source_us[DEADLINE_SOURCE_BETWEEN_FRAMES] = (uint32_t)(now - last_end_us);
+
+    in_frame = true;
+    frame_timestamp = timestamp;
+    frame_deadline_us = release_us + rebase_us + budget_us;
+    frame_begin_us = now;
+    last_mark_us = now;
+}
+
+void DeadlineMonitor::mark(int source)
+{
+    if (!in_frame || source < 0 || source >= DEADLINE_SOURCE_COUNT)
+        return;
+
+    int64_t now = time_source();
+    frame_source_us[source] += (uint32_t)(now - last_mark_us);
+    last_mark_us = now;
+}
+
+bool DeadlineMonitor::end_frame()
+{
+    if (!in_frame)
+        return true;
+
+    int64_t now = time_source();
+    in_frame = false;
+    last_end_us = now;
+    last_frame_us = (uint32_t)(now - frame_begin_us);
+    stats.frames++;
+
+    int64_t lateness = now - frame_deadline_us;
+    if (-lateness < stats.min_slack_us)
+        stats.min_slack_us = -lateness;
+
+    if (lateness <= 0)
+    {
+        stats.consecutive_misses = 0;
+        return true;
+    }
+
+    // 錯過期限：記在本幀最耗時的來源上
+    int source = 0;
+    for (int s = 1; s < DEADLINE_SOURCE_COUNT; s++)
+    {
+        if (frame_source_us[s] > frame_source_us[source])
+            source = s;
+    }
+
+    stats.misses++;
+    stats.misses_by_source[source]++;
+    stats.consecutive_misses++;
+    if (stats.consecutive_misses > stats.max_consecutive)
+        stats.max_consecutive = stats.consecutive_misses;
+
+    DeadlineMiss miss;
+    miss.timestamp = frame_timestamp;
+    miss.lateness_us = lateness;
+    miss.source = source;
+    miss.source_us = frame_source_us[source];
+    miss.consecutive = stats.consecutive_misses;
+    if (lateness > stats.worst.lateness_us)
+        stats.worst = miss;
+
+    // 遲到超過 DMA 緩衝時間時，超出部分的樣本已被覆寫，之後的樣本比樣本時鐘晚擷取，重新對齊
+    if (lateness > DEADLINE_RESYNC_US)
+    {
+        rebase_us += lateness - DEADLINE_RESYNC_US;
+        stats.resyncs++;
+    }
+
+    if (miss_callback)
+        miss_callback(miss);
+    return false;
+}
+
+void DeadlineMonitor::print_stats(const DebugPrint &out) const
+{
+    out.printf("⏰ 期限監控: %lu 幀，錯過 %lu（最長連續 %lu，重新對齊 %lu），最小餘裕 %lld µs\n",
+               (unsigned long)stats.frames, (unsigned long)stats.misses, (unsigned long)stats.max_consecutive,
+               (unsigned long)stats.resyncs, stats.frames ? (long long)stats.min_slack_us : 0LL);
+
+    for (int s = 0; s < DEADLINE_SOURCE_COUNT; s++)
+    {
+        if (stats.misses_by_source[s])
+            out.printf("  %-22s %lu\n", source_name(s), (unsigned long)stats.misses_by_source[s]);
+    }
+
+    if (stats.misses)
+    {
+        out.printf("  最嚴重: 樣本時間 %llu 遲到 %lld µs，%s 耗時 %lu µs\n", (unsigned long long)stats.worst.timestamp,
+                   (long long)stats.worst.lateness_us, source_name(stats.worst.source),
+                   (unsigned long)stats.worst.source_us);
+    }
+}
+
+const char *DeadlineMonitor::source_name(int source)
+{
+    if (source == DEADLINE_SOURCE_BETWEEN_FRAMES)
+        return "between_frames";
+#if PROFILER_ENABLED
+    return StageProfiler::stage_name((ProfileStage)source);
+#else
+    return "stage";
+#endif
+}
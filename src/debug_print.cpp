@@ -1,4 +1,40 @@
 #include "debug_print.h"
+#include "async_log.h"
 
 // 初始化全域 debug 狀態（預設關閉）
 bool GlobalDebugController::global_debug_enabled = false;
+
+void DebugPrint::emit(const char* label, bool newline, const char* format, ...) const
+{
+    va_list args;
+    va_start(args, format);
+    vemit(label, newline, format, args);
+    va_end(args);
+}
+
+void DebugPrint::vemit(const char* label, bool newline, const char* format, va_list args) const
+{
+    char buffer[DEBUG_PRINT_BUFFER_SIZE];
+    int length = 0;
+
+    if (module_name)
+        length = snprintf(buffer, sizeof(buffer), "[%s] ", module_name);
+    if (label && length < (int)sizeof(buffer))
+        length += snprintf(buffer + length, sizeof(buffer) - length, "%s", label);
+    if (length < (int)sizeof(buffer))
+        length += vsnprintf(buffer + length, sizeof(buffer) - length, format, args);
+
+    // 超出緩衝區時截斷，換行仍保留
+    if (length >= (int)sizeof(buffer) - 1)
+        length = sizeof(buffer) - (newline ? 2 : 1);
+    if (newline)
+        buffer[length++] = '\n';
+
+    async_log.write(buffer, length);
+}
+
+void DebugPrint::write_frame(LogTokenWriter& writer) const
+{
+    size_t length = writer.finish();
+    async_log.write((const char*)writer.data(), length);
+}
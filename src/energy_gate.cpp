@@ -0,0 +1,60 @@
+#include "energy_gate.h"
+
+EnergyGate::EnergyGate()
+{
+    reset();
+}
+
+void EnergyGate::reset()
+{
+    noise_floor = ENERGY_GATE_FLOOR_INIT;
+    last_mean_square = 0;
+    last_peak = 0;
+    hangover = 0;
+    gate_open = false;
+}
+
+bool EnergyGate::process(const int16_t *samples, size_t length)
+{
+    if (!samples || length == 0)
+        return gate_open;
+
+    // 累積平方和與峰值
+    uint64_t sum = 0;
+    int32_t peak = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        int32_t s = samples[i];
+        sum += (uint32_t)(s * s);
+
+        int32_t a = (s < 0) ? -s : s;
+        if (a > peak)
+            peak = a;
+    }
+
+    uint32_t mean_square = (uint32_t)(sum / length);
+    last_mean_square = mean_square;
+    last_peak = peak;
+
+    // 觸發條件：絕對能量、相對噪音底線或峰值（噪音底線可達 2^30，放大後以 64-bit 比較）
+    uint64_t relative_threshold = (uint64_t)noise_floor << ENERGY_GATE_FLOOR_RATIO_SHIFT;
+    bool triggered = (mean_square > ENERGY_GATE_MIN_MEAN_SQUARE) &&
+                     (mean_square > relative_threshold ||
+                      mean_square > ENERGY_GATE_OPEN_MEAN_SQUARE ||
+                      peak > ENERGY_GATE_PEAK_THRESHOLD);
+
+    // 噪音底線為最小值追蹤器：下降快、上升慢，觸發期間也持續更新，
+    // 避免開機時環境噪音高於初值而使閘門永遠無法關閉
+    if (mean_square < noise_floor)
+        noise_floor -= (noise_floor - mean_square) >> ENERGY_GATE_FLOOR_FALL_SHIFT;
+    else
+        noise_floor += (mean_square - noise_floor) >> ENERGY_GATE_FLOOR_RISE_SHIFT;
+
+    if (triggered)
+        hangover = ENERGY_GATE_HANGOVER_FRAMES;
+    else if (hangover > 0)
+        hangover--;
+
+    gate_open = triggered || hangover > 0;
+    return gate_open;
+}
@@ -0,0 +1,270 @@
+#include "gmm_vad.h"
+#include <string.h>
+
+// 全通濾波器係數 (Q15)，與 WebRTC VAD 的 QMF 分頻器相同
+static const int16_t kAllPassCoefsQ15[2] = {20972, 5571};
+
+// 各頻帶在加權總和中的權重 (Q4)
+static const int16_t kBandWeights[GMM_VAD_NUM_BANDS] = {6, 8, 10, 12, 14, 16};
+
+// 80Hz 高通濾波器極點 (Q15)，工作於 500Hz 取樣率
+static const int32_t kHighPassPoleQ15 = 12000;
+
+/**
+ * 一階全通濾波器（每隔一個樣本取值，同時完成 2:1 抽取）
+ */
+static void all_pass_filter(const int16_t *data_in, size_t out_length, int16_t coefficient,
+                            int16_t *filter_state, int16_t *data_out)
+{
+    int32_t state32 = ((int32_t)(*filter_state)) * (1 << 16); // Q15
+
+    for (size_t i = 0; i < out_length; i++)
+    {
+        int32_t tmp32 = state32 + coefficient * (*data_in);
+        int16_t tmp16 = (int16_t)(tmp32 >> 16); // Q(-1)
+        *data_out++ = tmp16;
+        state32 = ((*data_in) * (1 << 14)) - coefficient * tmp16; // Q14
+        state32 *= 2;                                             // Q15
+        data_in += 2;
+    }
+
+    *filter_state = (int16_t)(state32 >> 16);
+}
+
+/**
+ * QMF 分頻器：將輸入切成高低兩個頻帶，各自以一半取樣率輸出
+ * 注意高頻輸出會發生頻譜反轉
+ */
+static void split_filter(const int16_t *data_in, size_t length, int16_t *upper_state, int16_t *lower_state,
+                         int16_t *hp_out, int16_t *lp_out)
+{
+    size_t half_length = length >> 1;
+
+    all_pass_filter(&data_in[0], half_length, kAllPassCoefsQ15[0], upper_state, hp_out);
+    all_pass_filter(&data_in[1], half_length, kAllPassCoefsQ15[1], lower_state, lp_out);
+
+    for (size_t i = 0; i < half_length; i++)
+    {
+        int16_t tmp = hp_out[i];
+        hp_out[i] = tmp - lp_out[i];
+        lp_out[i] = lp_out[i] + tmp;
+    }
+}
+
+/**
+ * 計算 log2(x)，Q4 格式（整數位 + 4 位元線性尾數）
+ */
+static int32_t log2_q4(uint32_t x)
+{
+    if (x == 0)
+        return 0;
+
+    int msb = 31 - __builtin_clz(x);
+    uint32_t frac = (msb >= 4) ? ((x >> (msb - 4)) & 0xF) : ((x << (4 - msb)) & 0xF);
+    return (msb << 4) + (int32_t)frac;
+}
+
+/**
+ * 計算平均能量的 dB 值（10*log10），Q4 格式
+ */
+static int16_t log_energy_q4(const int16_t *data, size_t length)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        sum += (uint32_t)((int32_t)data[i] * data[i]);
+    }
+
+    uint32_t mean_square = (uint32_t)(sum / length);
+
+    // 10*log10(x) = log2(x) * 3.0103，3.0103 ≈ 771/256
+    return (int16_t)((log2_q4(mean_square) * 771) >> 8);
+}
+
+GmmVad::GmmVad()
+{
+    reset();
+}
+
+void GmmVad::reset()
+{
+    memset(split_state, 0, sizeof(split_state));
+    memset(split_state_input, 0, sizeof(split_state_input));
+    hp_prev_in = 0;
+    hp_prev_out = 0;
+
+    for (int b = 0; b < GMM_VAD_NUM_BANDS; b++)
+    {
+        noise_mean[b] = GMM_VAD_NOISE_MEAN_INIT << 6;
+        noise_std[b] = GMM_VAD_NOISE_STD_INIT << 6;
+        speech_mean[b] = (GMM_VAD_NOISE_MEAN_INIT + GMM_VAD_SPEECH_OFFSET) << 6;
+        band_energy[b] = 0;
+    }
+
+    last_llr_sum = 0;
+    last_decision = false;
+    frame_count = 0;
+}
+
+bool GmmVad::process(const int16_t *samples, size_t length)
+{
+    if (!samples || length < 32)
+        return false;
+
+    if (length > GMM_VAD_MAX_INPUT)
+        length = GMM_VAD_MAX_INPUT;
+    length &= ~(size_t)31; // 五層分頻需要 32 的倍數
+
+    compute_band_energies(samples, length);
+
+    // 計算各頻帶對數似然比並進行判決
+    bool local_decision = false;
+    bool has_energy = false;
+    int32_t weighted_sum = 0;
+
+    for (int b = 0; b < GMM_VAD_NUM_BANDS; b++)
+    {
+        int32_t llr = band_log_likelihood_ratio(b);
+        weighted_sum += llr * kBandWeights[b];
+
+        if (llr > GMM_VAD_LOCAL_THRESHOLD)
+            local_decision = true;
+        if (band_energy[b] > GMM_VAD_MIN_ENERGY)
+            has_energy = true;
+    }
+    weighted_sum >>= 4;
+
+    bool is_speech = has_energy && (local_decision || weighted_sum > GMM_VAD_GLOBAL_THRESHOLD);
+
+    // 啟動期間只學習噪音
+    if (frame_count < GMM_VAD_INIT_FRAMES)
+        is_speech = false;
+
+    update_models(is_speech);
+
+    last_llr_sum = weighted_sum;
+    last_decision = is_speech;
+    frame_count++;
+
+    return is_speech;
+}
+
+/**
+ * 以濾波器樹計算 6 個子頻帶的對數能量
+ */
+void GmmVad::compute_band_energies(const int16_t *samples, size_t length)
+{
+    size_t n8k = length / 2;
+    size_t n4k = length / 4;
+    size_t n2k = length / 8;
+    size_t n1k = length / 16;
+    size_t n500 = length / 32;
+
+    // 16kHz -> 0-4kHz @ 8kHz（4-8kHz 不使用）
+    split_filter(samples, length, &split_state_input[0], &split_state_input[1], work_hi, work_lo);
+
+    // 0-4kHz -> 2-4kHz (work_a) / 0-2kHz (work_b)
+    split_filter(work_lo, n8k, &split_state[0][0][0], &split_state[0][1][0], work_a, work_b);
+
+    // 2-4kHz -> 2-3kHz / 3-4kHz（頻譜反轉後低通分支為 3-4kHz）
+    split_filter(work_a, n4k, &split_state[1][0][0], &split_state[1][1][0], work_hi, work_hi + n2k);
+    band_energy[4] = log_energy_q4(work_hi, n2k);
+    band_energy[5] = log_energy_q4(work_hi + n2k, n2k);
+
+    // 0-2kHz -> 1-2kHz (work_hi) / 0-1kHz (work_lo)
+    split_filter(work_b, n4k, &split_state[2][0][0], &split_state[2][1][0], work_hi, work_lo);
+    band_energy[3] = log_energy_q4(work_hi, n2k);
+
+    // 0-1kHz -> 500-1kHz (work_hi) / 0-500Hz (work_a)
+    split_filter(work_lo, n2k, &split_state[3][0][0], &split_state[3][1][0], work_hi, work_a);
+    band_energy[2] = log_energy_q4(work_hi, n1k);
+
+    // 0-500Hz 先經 80Hz 高通濾除直流與低頻噪音
+    for (size_t i = 0; i < n1k; i++)
+    {
+        int16_t x = work_a[i];
+        int32_t y = (int32_t)x - hp_prev_in + ((kHighPassPoleQ15 * hp_prev_out) >> 15);
+        if (y > 32767)
+            y = 32767;
+        if (y < -32768)
+            y = -32768;
+        hp_prev_in = x;
+        hp_prev_out = y;
+        work_a[i] = (int16_t)y;
+    }
+
+    // 80-500Hz -> 250-500Hz (work_hi) / 80-250Hz (work_b)
+    split_filter(work_a, n1k, &split_state[4][0][0], &split_state[4][1][0], work_hi, work_b);
+    band_energy[1] = log_energy_q4(work_hi, n500);
+    band_energy[0] = log_energy_q4(work_b, n500);
+}
+
+/**
+ * 計算單一頻帶的對數似然比 log(p_speech / p_noise)，Q4 自然對數
+ */
+int32_t GmmVad::band_log_likelihood_ratio(int band) const
+{
+    int32_t mn = noise_mean[band] >> 6;
+    int32_t sn = noise_std[band] >> 6;
+    int32_t ms = speech_mean[band] >> 6;
+    int32_t ss = GMM_VAD_SPEECH_STD;
+
+    // 低於噪音平均的能量一律視為噪音，避免窄分佈在尾端反轉判決
+    int32_t x = band_energy[band];
+    if (x < mn)
+        x = mn;
+
+    int32_t dn = x - mn;
+    int32_t ds = x - ms;
+
+    // d^2 / (2 * sigma^2)，Q4
+    int32_t term_n = (dn * dn * 8) / (sn * sn);
+    int32_t term_s = (ds * ds * 8) / (ss * ss);
+
+    // ln(sigma_n / sigma_s)，ln(2) ≈ 177/256
+    int32_t log_ratio = ((log2_q4(sn) - log2_q4(ss)) * 177) >> 8;
+
+    int32_t llr = term_n - term_s + log_ratio;
+    if (llr > 1024)
+        llr = 1024;
+    if (llr < -1024)
+        llr = -1024;
+
+    return llr;
+}
+
+/**
+ * 根據判決結果更新噪音/語音模型
+ */
+void GmmVad::update_models(bool is_speech)
+{
+    for (int b = 0; b < GMM_VAD_NUM_BANDS; b++)
+    {
+        int32_t x = (int32_t)band_energy[b] << 6;
+
+        if (!is_speech)
+        {
+            // 啟動期間快速收斂；能量下降時加快追蹤以貼近噪音底線
+            int shift = (frame_count < GMM_VAD_INIT_FRAMES) ? 2 : ((x < noise_mean[b]) ? 3 : 6);
+            int32_t deviation = abs(x - noise_mean[b]);
+
+            noise_mean[b] += (x - noise_mean[b]) >> shift;
+
+            // 高斯分佈下 sigma ≈ 1.25 * 平均絕對偏差
+            noise_std[b] += ((deviation + (deviation >> 2)) - noise_std[b]) >> 6;
+            if (noise_std[b] < (GMM_VAD_NOISE_STD_MIN << 6))
+                noise_std[b] = GMM_VAD_NOISE_STD_MIN << 6;
+            if (noise_std[b] > (GMM_VAD_NOISE_STD_MAX << 6))
+                noise_std[b] = GMM_VAD_NOISE_STD_MAX << 6;
+        }
+        else
+        {
+            speech_mean[b] += (x - speech_mean[b]) >> 6;
+        }
+
+        // 保持語音模型位於噪音模型之上
+        int32_t min_speech_mean = noise_mean[b] + (GMM_VAD_MIN_SEPARATION << 6);
+        if (speech_mean[b] < min_speech_mean)
+            speech_mean[b] = min_speech_mean;
+    }
+}
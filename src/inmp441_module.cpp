@@ -1,5 +1,14 @@
+// 本模組編譯期日誌等級，須在 include 之前定義（可由 build_flags 覆寫，例如 -DINMP441_DEBUG_LEVEL=DEBUG_LEVEL_WARNING）
+#ifndef INMP441_DEBUG_LEVEL
+#define INMP441_DEBUG_LEVEL DEBUG_LEVEL_VERBOSE
+#endif
+#define DEBUG_LOCAL_LEVEL INMP441_DEBUG_LEVEL
+
 #include "inmp441_module.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "stage_profiler.h"
+#include "trace_recorder.h"
 #include <Arduino.h>
 #include <string.h>
 
@@ -9,19 +18,23 @@ static const char *TAG = "INMP441Module";
  * 預設建構函數
  */
 INMP441Module::INMP441Module()
-    : raw_buffer(nullptr), processed_buffer(nullptr), current_state(INMP441_UNINITIALIZED), i2s_installed(false), total_samples_read(0), last_read_time(0), consecutive_errors(0), debug("INMP441", false)
+    : raw_buffer(nullptr), processed_buffer(nullptr), current_state(INMP441_UNINITIALIZED), i2s_installed(false), dc_prev_input(0), dc_prev_output(0), dc_feedback_frac(0), pre_prev_input(0), agc_envelope(0), agc_gain_q16(0), agc_counter(0), clipped_samples("i2s.clipped"), level_window_ms(LEVEL_METER_WINDOW_MS), low_power_mode(false), block_timestamp(0), total_samples_read(0), last_read_time(0), consecutive_errors(0), i2s_event_queue(nullptr), total_errors("i2s.errors"), dma_overflows("i2s.dma_overflows"), dma_errors("i2s.dma_errors"), empty_reads("i2s.empty_reads"), max_read_gap_us("i2s.max_read_gap_us"), max_read_us("i2s.max_read_us"), read_latency_hist("i2s.read_us"), debug("INMP441", false)
 {
     config = create_default_config();
-    debug.print("建構函數 - 使用預設配置");
+    reset_filter_state();
+    reset_statistics();
+    DBG_PRINT(debug, "建構函數 - 使用預設配置");
 }
 
 /**
  * 自定義配置建構函數
  */
 INMP441Module::INMP441Module(const INMP441Config &custom_config)
-    : raw_buffer(nullptr), processed_buffer(nullptr), current_state(INMP441_UNINITIALIZED), i2s_installed(false), total_samples_read(0), last_read_time(0), consecutive_errors(0), debug("INMP441", false), config(custom_config)
+    : raw_buffer(nullptr), processed_buffer(nullptr), current_state(INMP441_UNINITIALIZED), i2s_installed(false), dc_prev_input(0), dc_prev_output(0), dc_feedback_frac(0), pre_prev_input(0), agc_envelope(0), agc_gain_q16(0), agc_counter(0), clipped_samples("i2s.clipped"), level_window_ms(LEVEL_METER_WINDOW_MS), low_power_mode(false), block_timestamp(0), total_samples_read(0), last_read_time(0), consecutive_errors(0), i2s_event_queue(nullptr), total_errors("i2s.errors"), dma_overflows("i2s.dma_overflows"), dma_errors("i2s.dma_errors"), empty_reads("i2s.empty_reads"), max_read_gap_us("i2s.max_read_gap_us"), max_read_us("i2s.max_read_us"), read_latency_hist("i2s.read_us"), debug("INMP441", false), config(custom_config)
 {
-    debug.print("建構函數 - 使用自定義配置");
+    reset_filter_state();
+    reset_statistics();
+    DBG_PRINT(debug, "建構函數 - 使用自定義配置");
 }
 
 /**
@@ -30,7 +43,7 @@ INMP441Module::INMP441Module(const INMP441Config &custom_config)
 INMP441Module::~INMP441Module()
 {
     deinitialize();
-    debug.print("INMP441Module 解構函數完成");
+    DBG_PRINT(debug, "INMP441Module 解構函數完成");
 }
 
 /**
@@ -38,34 +51,35 @@ INMP441Module::~INMP441Module()
  */
 bool INMP441Module::initialize()
 {
-    debug.print("正在初始化 INMP441 模組...");
+    DBG_PRINT(debug, "正在初始化 INMP441 模組...");
 
     if (current_state != INMP441_UNINITIALIZED)
     {
-        debug.print("模組已經初始化");
+        DBG_PRINT(debug, "模組已經初始化");
         return true;
     }
     
     // 分配緩衝區
-    raw_buffer = new int32_t[config.buffer_size];
-    processed_buffer = new int16_t[config.buffer_size];
+    // 過取樣時每個輸出樣本需要 decimation_factor 個原始樣本
+    raw_buffer = new int32_t[raw_buffer_size()];
+    processed_buffer = new audio_sample_t[config.buffer_size];
     
     if (!raw_buffer || !processed_buffer)
     {
-        debug.print("❌ 記憶體分配失敗");
+        DBG_PRINT(debug, "❌ 記憶體分配失敗");
         update_state(INMP441_ERROR, "記憶體分配失敗");
         deinitialize();
         return false;
     }
     
     // 清零緩衝區
-    memset(raw_buffer, 0, config.buffer_size * sizeof(int32_t));
-    memset(processed_buffer, 0, config.buffer_size * sizeof(int16_t));
+    memset(raw_buffer, 0, raw_buffer_size() * sizeof(int32_t));
+    memset(processed_buffer, 0, config.buffer_size * sizeof(audio_sample_t));
     
     // 安裝 I2S 驅動
     if (!install_i2s_driver())
     {
-        debug.print("❌ I2S 驅動安裝失敗");
+        DBG_PRINT(debug, "❌ I2S 驅動安裝失敗");
         deinitialize();
         return false;
     }
@@ -73,7 +87,7 @@ bool INMP441Module::initialize()
     // 配置 I2S 引腳
     if (!configure_i2s_pins())
     {
-        debug.print("❌ I2S 引腳配置失敗");
+        DBG_PRINT(debug, "❌ I2S 引腳配置失敗");
         deinitialize();
         return false;
     }
@@ -82,14 +96,14 @@ bool INMP441Module::initialize()
     esp_err_t ret = i2s_zero_dma_buffer(config.i2s_port);
     if (ret != ESP_OK)
     {
-        debug.printf("⚠️  清除 I2S 緩衝區失敗: %s\n", esp_err_to_name(ret));
+        DBG_PRINTF(debug, "⚠️  清除 I2S 緩衝區失敗: %s\n", esp_err_to_name(ret));
     }
 
     // 重置統計信息
     reset_statistics();
     
     update_state(INMP441_INITIALIZED, "INMP441 初始化成功");
-    debug.print("✅ INMP441 模組初始化完成");
+    DBG_PRINT(debug, "✅ INMP441 模組初始化完成");
     return true;
 }
 
@@ -121,7 +135,7 @@ void INMP441Module::deinitialize()
     processed_buffer = nullptr;
     
     update_state(INMP441_UNINITIALIZED, "模組已去初始化");
-    debug.print("INMP441 模組去初始化完成");
+    DBG_PRINT(debug, "INMP441 模組去初始化完成");
 }
 
 /**
@@ -131,13 +145,14 @@ bool INMP441Module::start()
 {
     if (current_state != INMP441_INITIALIZED)
     {
-        debug.print("❌ 模組尚未初始化，無法開始");
+        DBG_PRINT(debug, "❌ 模組尚未初始化，無法開始");
         return false;
     }
     
+    reset_filter_state();
+    reset_statistics();
     update_state(INMP441_RUNNING, "開始音訊擷取");
-    last_read_time = millis();
-    debug.print("🎤 INMP441 開始擷取音訊");
+    DBG_PRINT(debug, "🎤 INMP441 開始擷取音訊");
     return true;
 }
 
@@ -149,31 +164,37 @@ void INMP441Module::stop()
     if (current_state == INMP441_RUNNING)
     {
         update_state(INMP441_INITIALIZED, "停止音訊擷取");
-        debug.print("⏹️  INMP441 停止擷取音訊");
+        DBG_PRINT(debug, "⏹️  INMP441 停止擷取音訊");
     }
 }
 
 /**
  * 讀取音訊數據（16-bit）
  */
-size_t INMP441Module::read_audio_data(int16_t *output_buffer, size_t max_samples)
+size_t INMP441Module::read_audio_data(audio_sample_t *output_buffer, size_t max_samples)
 {
     if (current_state != INMP441_RUNNING || !output_buffer)
     {
         return 0;
     }
     
+    int64_t start_us = esp_timer_get_time();
+    uint32_t trace_start = profiler_ticks();
+    poll_i2s_events();
+
     size_t samples_to_read = min(max_samples, (size_t)config.buffer_size);
+    size_t raw_to_read = min(samples_to_read * decimator.get_factor() * config.channels, raw_buffer_size());
     size_t bytes_read = 0;
     
     // 從 I2S 讀取原始數據
     esp_err_t ret = i2s_read(config.i2s_port, raw_buffer, 
-                            samples_to_read * sizeof(int32_t),
+                            raw_to_read * sizeof(int32_t),
                             &bytes_read, 0);  // 非阻塞讀取
     
     if (ret != ESP_OK)
     {
         consecutive_errors++;
+        total_errors.add();
         if (consecutive_errors > 10)
         {
             update_state(INMP441_ERROR, "連續讀取錯誤");
@@ -183,21 +204,45 @@ size_t INMP441Module::read_audio_data(int16_t *output_buffer, size_t max_samples
     
     if (bytes_read == 0)
     {
+        empty_reads.add();
         return 0; // 沒有數據可讀
     }
     
-    size_t samples_read = bytes_read / sizeof(int32_t);
+    size_t raw_read = bytes_read / sizeof(int32_t);
+    raw_frames_read += raw_read / config.channels;
+
+    // 剛讀出的樣本仍在 DMA 緩衝區內，擷取時間不早於緩衝區長度之前；
+    // 樣本時鐘換算得更早表示溢位遺失了樣本，重新對齊牆上時間原點
+    int64_t buffered_us = (int64_t)config.dma_buf_count * config.dma_buf_len * 1000000 /
+                          ((int64_t)config.sample_rate * max((uint8_t)1, config.decimation_factor));
+    sample_clock.resync(sample_clock.now(), start_us - buffered_us);
+
+    // 立體聲先原地合成單聲道（I2S 交錯 L/R），再原地抽取（倍率 1 時直接通過）
+    if (is_stereo())
+    {
+        PROFILE_SCOPE(PROFILE_STAGE_BEAMFORM);
+        raw_read = beamformer.process(raw_buffer, raw_read / 2, raw_buffer);
+    }
+    size_t samples_read;
+    {
+        PROFILE_SCOPE(PROFILE_STAGE_DECIMATE);
+        samples_read = decimator.process(raw_buffer, raw_read, raw_buffer);
+    }
     
     // 轉換音訊數據
     convert_audio_data(raw_buffer, processed_buffer, samples_read);
+    block_timestamp = sample_clock.advance(samples_read * sample_clock_ticks());
+    TRACE_SPAN(TRACE_EVENT_CAPTURE, trace_start, block_timestamp);
+    TRACE_CLOCK(sample_clock.now());
     
     // 複製到輸出緩衝區
-    memcpy(output_buffer, processed_buffer, samples_read * sizeof(int16_t));
+    memcpy(output_buffer, processed_buffer, samples_read * sizeof(audio_sample_t));
     
     // 更新統計信息
     total_samples_read += samples_read;
     last_read_time = millis();
     consecutive_errors = 0;
+    record_read_timing(start_us, esp_timer_get_time());
     
     return samples_read;
 }
@@ -212,6 +257,9 @@ size_t INMP441Module::read_raw_audio_data(int32_t *output_buffer, size_t max_sam
         return 0;
     }
     
+    int64_t start_us = esp_timer_get_time();
+    poll_i2s_events();
+
     size_t samples_to_read = min(max_samples, (size_t)config.buffer_size);
     size_t bytes_read = 0;
     
@@ -222,13 +270,16 @@ size_t INMP441Module::read_raw_audio_data(int32_t *output_buffer, size_t max_sam
     if (ret != ESP_OK || bytes_read == 0)
     {
         consecutive_errors++;
+        total_errors.add();
         return 0;
     }
     
     size_t samples_read = bytes_read / sizeof(int32_t);
     total_samples_read += samples_read;
+    raw_frames_read += samples_read / config.channels;
     last_read_time = millis();
     consecutive_errors = 0;
+    record_read_timing(start_us, esp_timer_get_time());
     
     return samples_read;
 }
@@ -247,7 +298,7 @@ bool INMP441Module::read_audio_frame()
     
     if (samples_read > 0 && audio_data_callback)
     {
-        audio_data_callback(processed_buffer, samples_read);
+        audio_data_callback(processed_buffer, samples_read, block_timestamp);
         return true;
     }
     
@@ -277,12 +328,13 @@ bool INMP441Module::set_config(const INMP441Config &new_config)
 {
     if (current_state == INMP441_RUNNING)
     {
-        debug.print("❌ 無法在運行中更改配置");
+        DBG_PRINT(debug, "❌ 無法在運行中更改配置");
         return false;
     }
     
     config = new_config;
-    debug.print("✅ 配置已更新");
+    reset_filter_state();
+    DBG_PRINT(debug, "✅ 配置已更新");
     return true;
 }
 
@@ -292,6 +344,7 @@ bool INMP441Module::set_config(const INMP441Config &new_config)
 void INMP441Module::reset_to_default_config()
 {
     config = create_default_config();
+    reset_filter_state();
 }
 
 /**
@@ -300,13 +353,39 @@ void INMP441Module::reset_to_default_config()
 INMP441Module::INMP441Stats INMP441Module::get_statistics() const
 {
     INMP441Stats stats;
+    int64_t now_us = esp_timer_get_time();
+    float elapsed_s = (now_us - capture_start_us) / 1000000.0f;
+
     stats.total_samples = total_samples_read;
-    stats.uptime_ms = (current_state == INMP441_RUNNING) ? (millis() - last_read_time) : 0;
-    stats.error_count = consecutive_errors;
-    stats.samples_per_second = (stats.uptime_ms > 0) ? 
-        (float)total_samples_read / (stats.uptime_ms / 1000.0f) : 0.0f;
+    stats.uptime_ms = (unsigned long)((now_us - capture_start_us) / 1000);
+    stats.error_count = total_errors.get();
+    stats.consecutive_errors = consecutive_errors;
+    stats.samples_per_second = (elapsed_s > 0.0f) ? total_samples_read / elapsed_s : 0.0f;
+    stats.capture_rate = (elapsed_s > 0.0f) ? raw_frames_read / elapsed_s : 0.0f;
+    stats.dma_overflows = dma_overflows.get();
+    stats.dma_errors = dma_errors.get();
+    stats.empty_reads = empty_reads.get();
+    stats.max_read_gap_us = max_read_gap_us.get();
+    stats.max_read_us = max_read_us.get();
+    for (int k = 0; k < INMP441_LATENCY_BUCKETS; k++)
+        stats.read_latency_hist[k] = read_latency_hist.get_bucket(k);
+
+    // 樣本時鐘落後牆上時間的部分，扣掉仍在 DMA 緩衝區內、尚未讀取的樣本即為遺失
+    stats.dropped_samples = 0;
+    if (current_state == INMP441_RUNNING)
+    {
+        uint64_t expected = (uint64_t)(now_us - sample_clock.get_start_us()) * config.sample_rate / 1000000;
+        uint64_t buffered = (uint64_t)config.dma_buf_count * config.dma_buf_len / max((uint8_t)1, config.decimation_factor);
+        uint64_t accounted = sample_clock.now() + buffered;
+        stats.dropped_samples = (expected > accounted) ? expected - accounted : 0;
+    }
     stats.last_read_time = last_read_time;
     stats.buffer_size = config.buffer_size;
+    stats.agc_enabled = config.agc_enabled;
+    stats.current_gain = get_current_gain();
+    stats.current_gain_db = 20.0f * log10f(stats.current_gain);
+    stats.clipped_samples = clipped_samples.get();
+    stats.clip_ratio = (total_samples_read > 0) ? (float)stats.clipped_samples / total_samples_read : 0.0f;
     
     return stats;
 }
@@ -318,7 +397,57 @@ void INMP441Module::reset_statistics()
 {
     total_samples_read = 0;
     consecutive_errors = 0;
+    clipped_samples.reset();
+    level_meter.reset();
     last_read_time = millis();
+
+    capture_start_us = esp_timer_get_time();
+    last_read_us = 0;
+    raw_frames_read = 0;
+    total_errors.reset();
+    dma_overflows.reset();
+    dma_errors.reset();
+    empty_reads.reset();
+    max_read_gap_us.reset();
+    max_read_us.reset();
+    read_latency_hist.reset();
+}
+
+/**
+ * 取出 I2S 事件佇列中的所有事件（非阻塞）
+ * 驅動在佇列滿時會丟棄最舊的事件，溢位事件可能被之後的 RX_DONE 擠掉，
+ * 因此遺失樣本另以樣本時鐘與牆上時間比較估計
+ */
+void INMP441Module::poll_i2s_events()
+{
+    if (!i2s_event_queue)
+        return;
+
+    i2s_event_t event;
+    while (xQueueReceive(i2s_event_queue, &event, 0) == pdTRUE)
+    {
+        if (event.type == I2S_EVENT_RX_Q_OVF)
+            dma_overflows.add();
+        else if (event.type == I2S_EVENT_DMA_ERROR)
+            dma_errors.add();
+    }
+}
+
+/**
+ * 記錄讀取耗時（log2 分桶）與兩次成功讀取間的間隔
+ */
+void INMP441Module::record_read_timing(int64_t start_us, int64_t end_us)
+{
+    uint32_t duration = (uint32_t)(end_us - start_us);
+    read_latency_hist.record(duration);
+    max_read_us.update_max((int32_t)duration);
+
+    if (last_read_us)
+    {
+        int64_t gap = start_us - last_read_us;
+        max_read_gap_us.update_max(gap < INT32_MAX ? (int32_t)gap : INT32_MAX);
+    }
+    last_read_us = start_us;
 }
 
 /**
@@ -326,34 +455,34 @@ void INMP441Module::reset_statistics()
  */
 bool INMP441Module::self_test()
 {
-    debug.print("🧪 開始 INMP441 自我測試...");
+    DBG_PRINT(debug, "🧪 開始 INMP441 自我測試...");
 
     if (!is_initialized())
     {
         if (!initialize())
         {
-            debug.print("❌ 自我測試失敗: 初始化錯誤");
+            DBG_PRINT(debug, "❌ 自我測試失敗: 初始化錯誤");
             return false;
         }
     }
     
     if (!start())
     {
-        debug.print("❌ 自我測試失敗: 啟動錯誤");
+        DBG_PRINT(debug, "❌ 自我測試失敗: 啟動錯誤");
         return false;
     }
     
     // 測試讀取數據
-    int16_t test_buffer[64];
+    audio_sample_t test_buffer[64];
     size_t samples_read = read_audio_data(test_buffer, 64);
     
     if (samples_read == 0)
     {
-        debug.print("❌ 自我測試失敗: 無法讀取數據");
+        DBG_PRINT(debug, "❌ 自我測試失敗: 無法讀取數據");
         return false;
     }
 
-    debug.printf("✅ 自我測試成功 - 讀取了 %zu 個樣本\n", samples_read);
+    DBG_PRINTF(debug, "✅ 自我測試成功 - 讀取了 %zu 個樣本\n", samples_read);
     return true;
 }
 
@@ -365,15 +494,22 @@ void INMP441Module::print_config() const
     if (!debug.is_debug_enabled())
         return;
 
-    debug.print("📋 INMP441 配置信息:");
-    debug.printf("  WS 引腳: GPIO%d\n", config.ws_pin);
-    debug.printf("  SCK 引腳: GPIO%d\n", config.sck_pin);
-    debug.printf("  SD 引腳: GPIO%d\n", config.sd_pin);
-    debug.printf("  I2S 端口: %d\n", config.i2s_port);
-    debug.printf("  採樣率: %lu Hz\n", config.sample_rate);
-    debug.printf("  緩衝區大小: %d 樣本\n", config.buffer_size);
-    debug.printf("  DMA 緩衝區: %d x %d\n", config.dma_buf_count, config.dma_buf_len);
-    debug.printf("  增益係數: %d\n", config.gain_factor);
+    DBG_PRINT(debug, "📋 INMP441 配置信息:");
+    DBG_PRINTF(debug, "  WS 引腳: GPIO%d\n", config.ws_pin);
+    DBG_PRINTF(debug, "  SCK 引腳: GPIO%d\n", config.sck_pin);
+    DBG_PRINTF(debug, "  SD 引腳: GPIO%d\n", config.sd_pin);
+    DBG_PRINTF(debug, "  I2S 端口: %d\n", config.i2s_port);
+    DBG_PRINTF(debug, "  採樣率: %lu Hz\n", config.sample_rate);
+    DBG_PRINTF(debug, "  過取樣: x%d (I2S %lu Hz, APLL %s)\n", config.decimation_factor,
+               get_capture_sample_rate(), config.use_apll ? "啟用" : "停用");
+    DBG_PRINTF(debug, "  聲道: %s\n", is_stereo() ? "立體聲（延遲相加波束成形）" : "單聲道");
+    DBG_PRINTF(debug, "  緩衝區大小: %d 樣本\n", config.buffer_size);
+    DBG_PRINTF(debug, "  DMA 緩衝區: %d x %d\n", config.dma_buf_count, config.dma_buf_len);
+    DBG_PRINTF(debug, "  增益係數: %d\n", config.gain_factor);
+    DBG_PRINTF(debug, "  AGC: %s (目標 %u, 最大增益 %u)\n", config.agc_enabled ? "啟用" : "停用",
+               config.agc_target_level, config.agc_max_gain);
+    DBG_PRINTF(debug, "  DC 阻隔: %s (a=%.4f)\n", config.dc_block_coeff ? "啟用" : "停用", config.dc_block_coeff / 32768.0f);
+    DBG_PRINTF(debug, "  預強調: %s (b=%.4f)\n", config.pre_emphasis_coeff ? "啟用" : "停用", config.pre_emphasis_coeff / 32768.0f);
 }
 
 /**
@@ -386,13 +522,32 @@ void INMP441Module::print_statistics() const
 
     INMP441Stats stats = get_statistics();
 
-    debug.print("📊 INMP441 統計信息:");
-    debug.printf("  狀態: %s\n", get_state_string());
-    debug.printf("  總樣本數: %lu\n", stats.total_samples);
-    debug.printf("  運行時間: %lu ms\n", stats.uptime_ms);
-    debug.printf("  錯誤計數: %zu\n", stats.error_count);
-    debug.printf("  採樣率: %.1f samples/sec\n", stats.samples_per_second);
-    debug.printf("  最後讀取: %lu ms ago\n", millis() - stats.last_read_time);
+    DBG_PRINT(debug, "📊 INMP441 統計信息:");
+    DBG_PRINTF(debug, "  狀態: %s\n", get_state_string());
+    DBG_PRINTF(debug, "  總樣本數: %lu\n", stats.total_samples);
+    DBG_PRINTF(debug, "  運行時間: %lu ms\n", stats.uptime_ms);
+    DBG_PRINTF(debug, "  錯誤計數: %zu（連續 %zu）\n", stats.error_count, stats.consecutive_errors);
+    DBG_PRINTF(debug, "  採樣率: %.1f samples/sec（I2S %.1f / %lu Hz）\n", stats.samples_per_second, stats.capture_rate,
+               get_capture_sample_rate());
+    DBG_PRINTF(debug, "  DMA 溢位: %lu，DMA 錯誤: %lu，估計遺失: %llu 樣本\n", (unsigned long)stats.dma_overflows,
+               (unsigned long)stats.dma_errors, (unsigned long long)stats.dropped_samples);
+    DBG_PRINTF(debug, "  讀取: 最大耗時 %lu µs，最大間隔 %lu µs，空讀取 %lu 次\n", (unsigned long)stats.max_read_us,
+               (unsigned long)stats.max_read_gap_us, (unsigned long)stats.empty_reads);
+    for (int k = 0; k < INMP441_LATENCY_BUCKETS; k++)
+    {
+        if (!stats.read_latency_hist[k])
+            continue;
+        if (k == INMP441_LATENCY_BUCKETS - 1)
+            DBG_PRINTF(debug, "    >= %lu µs: %lu\n", 1UL << k, (unsigned long)stats.read_latency_hist[k]);
+        else
+            DBG_PRINTF(debug, "    %lu-%lu µs: %lu\n", k ? 1UL << k : 0UL, (2UL << k) - 1, (unsigned long)stats.read_latency_hist[k]);
+    }
+    DBG_PRINTF(debug, "  目前增益: %.2f (%.1f dB)%s\n", stats.current_gain, stats.current_gain_db, stats.agc_enabled ? " [AGC]" : "");
+    DBG_PRINTF(debug, "  飽和樣本: %lu (%.4f%%)\n", stats.clipped_samples, stats.clip_ratio * 100.0f);
+    AudioLevelMeter::Stats level = level_meter.get_stats();
+    DBG_PRINTF(debug, "  音量: RMS %.1f dBFS，峰值 %.1f dBFS，DC %.1f，視窗 %ld..%ld\n", level.block_rms_dbfs,
+               level.block_peak_dbfs, level.window_dc, (long)level.window_min, (long)level.window_max);
+    DBG_PRINTF(debug, "  最後讀取: %lu ms ago\n", millis() - stats.last_read_time);
 }
 
 /**
@@ -402,22 +557,23 @@ bool INMP441Module::install_i2s_driver()
 {
     i2s_config_t i2s_config = {
         .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
-        .sample_rate = config.sample_rate,
+        .sample_rate = get_capture_sample_rate(),
         .bits_per_sample = I2S_BITS_PER_SAMPLE_32BIT,
-        .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
+        .channel_format = is_stereo() ? I2S_CHANNEL_FMT_RIGHT_LEFT : I2S_CHANNEL_FMT_ONLY_LEFT,
         .communication_format = I2S_COMM_FORMAT_STAND_I2S,
         .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
         .dma_buf_count = config.dma_buf_count,
         .dma_buf_len = config.dma_buf_len,
-        .use_apll = false,
+        .use_apll = config.use_apll,
         .tx_desc_auto_clear = false,
         .fixed_mclk = 0
     };
     
-    esp_err_t ret = i2s_driver_install(config.i2s_port, &i2s_config, 0, NULL);
+    // 事件佇列只用來偵測 DMA 溢位，讀取時非阻塞輪詢
+    esp_err_t ret = i2s_driver_install(config.i2s_port, &i2s_config, INMP441_EVENT_QUEUE_SIZE, &i2s_event_queue);
     if (ret != ESP_OK)
     {
-        debug.printf("❌ I2S 驅動安裝失敗: %s\n", esp_err_to_name(ret));
+        DBG_PRINTF(debug, "❌ I2S 驅動安裝失敗: %s\n", esp_err_to_name(ret));
         return false;
     }
     
@@ -434,6 +590,7 @@ void INMP441Module::uninstall_i2s_driver()
     {
         i2s_driver_uninstall(config.i2s_port);
         i2s_installed = false;
+        i2s_event_queue = nullptr;
     }
 }
 
@@ -452,7 +609,7 @@ bool INMP441Module::configure_i2s_pins()
     esp_err_t ret = i2s_set_pin(config.i2s_port, &pin_config);
     if (ret != ESP_OK)
     {
-        debug.printf("❌ I2S 引腳配置失敗: %s\n", esp_err_to_name(ret));
+        DBG_PRINTF(debug, "❌ I2S 引腳配置失敗: %s\n", esp_err_to_name(ret));
         return false;
     }
     
@@ -460,10 +617,21 @@ bool INMP441Module::configure_i2s_pins()
 }
 
 /**
- * 轉換音訊數據從 32-bit 到 16-bit
+ * 轉換音訊數據從 32-bit 到 audio_sample_t（int16 或 Q31）
+ * DC 阻隔與預強調在同一個迴圈內完成，不需額外一次走訪
  */
-void INMP441Module::convert_audio_data(const int32_t *raw_data, int16_t *processed_data, size_t length)
+void INMP441Module::convert_audio_data(const int32_t *raw_data, audio_sample_t *processed_data, size_t length)
 {
+    PROFILE_SCOPE(PROFILE_STAGE_CONVERT);
+    const int32_t dc_coeff = config.dc_block_coeff;
+    const int32_t pre_coeff = config.pre_emphasis_coeff;
+    const bool agc_enabled = config.agc_enabled;
+    const int output_shift = 24 - AUDIO_SAMPLE_SHIFT;
+    const int64_t output_rounding = (int64_t)1 << (output_shift - 1);
+    uint32_t clipped = 0;
+    AudioLevelAccumulator block_level;
+    block_level.reset();
+
     for (size_t i = 0; i < length; i++)
     {
         // INMP441 輸出 24-bit 數據，位於 32-bit 容器的高 24 位
@@ -471,10 +639,216 @@ void INMP441Module::convert_audio_data(const int32_t *raw_data, int16_t *process
         
         // 右移 8 位獲得 24-bit 值
         sample = sample >> 8;
+
+        // 一階 DC 阻隔：y[n] = x[n] - x[n-1] + a * y[n-1]
+        if (dc_coeff)
+        {
+            int64_t feedback = (int64_t)dc_coeff * dc_prev_output + dc_feedback_frac;
+            dc_feedback_frac = (int32_t)(feedback & 0x7FFF);
+
+            int32_t output = sample - dc_prev_input + (int32_t)(feedback >> 15);
+            dc_prev_input = sample;
+            dc_prev_output = output;
+            sample = output;
+        }
+
+        // 預強調：z[n] = y[n] - b * y[n-1]
+        if (pre_coeff)
+        {
+            int32_t output = sample - (int32_t)(((int64_t)pre_coeff * pre_prev_input) >> 15);
+            pre_prev_input = sample;
+            sample = output;
+        }
         
-        // 轉換為 16-bit 並應用增益
-        processed_data[i] = (int16_t)((sample >> 4) * config.gain_factor);
+        // AGC：追蹤完整 24-bit 幅度的峰值包絡（快速上升、緩慢下降）
+        if (agc_enabled)
+        {
+            uint32_t magnitude = (uint32_t)(sample < 0 ? -sample : sample);
+            if (magnitude > 0x7FFFFF)
+                magnitude = 0x7FFFFF;
+            uint32_t level = magnitude << INMP441_AGC_ENV_FRAC_BITS;
+            if (level > agc_envelope)
+                agc_envelope += (level - agc_envelope) >> INMP441_AGC_ATTACK_SHIFT;
+            else
+                agc_envelope -= (agc_envelope - level) >> INMP441_AGC_RELEASE_SHIFT;
+
+            if (--agc_counter == 0)
+                update_agc_gain();
+        }
+
+        // 24-bit × 增益（Q16）在 32×32→64 乘法中完成，最後才四捨五入並飽和
+        // int16 模式右移 24 位；Q31 模式只右移 8 位，多保留 16 個小數位元
+        int64_t scaled = ((int64_t)sample * agc_gain_q16 + output_rounding) >> output_shift;
+        if (scaled > AUDIO_SAMPLE_MAX)
+        {
+            scaled = AUDIO_SAMPLE_MAX;
+            clipped++;
+        }
+        else if (scaled < AUDIO_SAMPLE_MIN)
+        {
+            scaled = AUDIO_SAMPLE_MIN;
+            clipped++;
+        }
+        processed_data[i] = (audio_sample_t)scaled;
+        block_level.add((int32_t)(scaled >> AUDIO_SAMPLE_SHIFT));
+    }
+
+    if (clipped)
+        clipped_samples.add(clipped);
+    level_meter.add_block(block_level, length, length * sample_clock_ticks(), clipped);
+}
+
+/**
+ * 清除轉換濾波器狀態
+ */
+void INMP441Module::reset_filter_state()
+{
+    dc_prev_input = 0;
+    dc_prev_output = 0;
+    dc_feedback_frac = 0;
+    pre_prev_input = 0;
+
+    // 從固定增益開始（G = gain_factor × 16，與舊的 (x >> 4) × gain_factor 相同）
+    agc_envelope = 0;
+    agc_gain_q16 = (uint32_t)config.gain_factor << 20;
+    agc_counter = INMP441_AGC_UPDATE_INTERVAL;
+
+    // 抽取器回到完整模式並清除歷史
+    low_power_mode = false;
+    decimator.reset();
+    decimator.configure(max((uint8_t)1, config.decimation_factor));
+    beamformer.reset();
+
+    // 樣本時間從 0 重新開始
+    sample_clock.start(config.sample_rate);
+    block_timestamp = 0;
+    TRACE_SET_SAMPLE_RATE(config.sample_rate);
+    set_level_window_ms(level_window_ms);
+}
+
+/**
+ * 設定音量統計的視窗長度（毫秒），並開始新的視窗
+ */
+void INMP441Module::set_level_window_ms(uint32_t ms)
+{
+    level_window_ms = ms;
+    level_meter.set_window((uint32_t)((uint64_t)config.sample_rate * ms / 1000));
+}
+
+/**
+ * 依峰值包絡重算 AGC 增益：G = 目標 × 256 / 包絡
+ * 包絡低於噪音閘門時保持原增益，避免在靜音時把底噪放大到目標值
+ */
+void INMP441Module::update_agc_gain()
+{
+    agc_counter = INMP441_AGC_UPDATE_INTERVAL;
+
+    uint32_t envelope = agc_envelope >> INMP441_AGC_ENV_FRAC_BITS;
+    if (envelope < INMP441_AGC_NOISE_GATE)
+        return;
+
+    uint64_t gain = ((uint64_t)config.agc_target_level << 24) / envelope;
+    uint64_t max_gain = (uint64_t)config.agc_max_gain << 16;
+    if (gain > max_gain)
+        gain = max_gain;
+    if (gain < (1u << 16))
+        gain = 1u << 16;
+    agc_gain_q16 = (uint32_t)gain;
+}
+
+/**
+ * 以目前配置轉換原始樣本（測試與錄音重播用）
+ * 過取樣時 raw_data 為 I2S 取樣率的樣本，回傳抽取後的輸出樣本數
+ */
+size_t INMP441Module::process_raw_samples(const int32_t *raw_data, audio_sample_t *processed_data, size_t length)
+{
+    if (!raw_data || !processed_data)
+        return 0;
+
+    uint32_t trace_start = profiler_ticks();
+    if (decimator.get_factor() == 1 && !is_stereo())
+    {
+        convert_audio_data(raw_data, processed_data, length);
+        block_timestamp = sample_clock.advance(length);
+        TRACE_SPAN(TRACE_EVENT_CAPTURE, trace_start, block_timestamp);
+        TRACE_CLOCK(sample_clock.now());
+        return length;
+    }
+
+    // 分段波束成形／抽取到暫存區，不修改呼叫端的原始資料
+    int32_t chunk[64];
+    const size_t step = 64 * config.channels;
+    size_t produced = 0;
+    for (size_t offset = 0; offset < length; offset += step)
+    {
+        size_t count = min(step, length - offset);
+        const int32_t *input = raw_data + offset;
+        if (is_stereo())
+        {
+            count = beamformer.process(input, count / 2, chunk);
+            input = chunk;
+        }
+        size_t outputs = decimator.process(input, count, chunk);
+        convert_audio_data(chunk, processed_data + produced, outputs);
+        produced += outputs;
     }
+    block_timestamp = sample_clock.advance(produced * sample_clock_ticks());
+    TRACE_SPAN(TRACE_EVENT_CAPTURE, trace_start, block_timestamp);
+    TRACE_CLOCK(sample_clock.now());
+    return produced;
+}
+
+/**
+ * 每個輸出樣本推進的樣本時鐘刻度
+ * 時鐘以標稱取樣率計時，低功耗模式（抽取倍率加倍）每個輸出樣本佔 2 個刻度
+ */
+uint32_t INMP441Module::sample_clock_ticks() const
+{
+    return decimator.get_factor() / max((uint8_t)1, config.decimation_factor);
+}
+
+/**
+ * 原始緩衝區大小（樣本數）
+ */
+size_t INMP441Module::raw_buffer_size() const
+{
+    return (size_t)config.buffer_size * max((uint8_t)1, config.decimation_factor) * max((uint8_t)1, config.channels);
+}
+
+/**
+ * 切換低功耗模式（抽取倍率 3 ↔ 6）
+ */
+bool INMP441Module::set_low_power_mode(bool enable)
+{
+    if (config.decimation_factor != INMP441_OVERSAMPLE_FACTOR)
+    {
+        DBG_PRINT(debug, "❌ 低功耗模式需要 48kHz 過取樣擷取");
+        return false;
+    }
+
+    if (enable == low_power_mode)
+        return true;
+
+    low_power_mode = enable;
+    decimator.configure(enable ? INMP441_LOW_POWER_FACTOR : INMP441_OVERSAMPLE_FACTOR);
+    DBG_PRINTF(debug, "%s 輸出取樣率 %lu Hz\n", enable ? "🔋 低功耗模式：" : "⚡ 完整模式：", get_output_sample_rate());
+    return true;
+}
+
+/**
+ * I2S 實際取樣率
+ */
+uint32_t INMP441Module::get_capture_sample_rate() const
+{
+    return config.sample_rate * max((uint8_t)1, config.decimation_factor);
+}
+
+/**
+ * 抽取後的輸出取樣率
+ */
+uint32_t INMP441Module::get_output_sample_rate() const
+{
+    return get_capture_sample_rate() / decimator.get_factor();
 }
 
 /**
@@ -493,7 +867,7 @@ void INMP441Module::update_state(INMP441State new_state, const char *message)
         
         if (message)
         {
-            debug.printf("🔄 INMP441 狀態變更: %s - %s\n", get_state_string(), message);
+            DBG_PRINTF(debug, "🔄 INMP441 狀態變更: %s - %s\n", get_state_string(), message);
         }
     }
 }
@@ -535,10 +909,42 @@ INMP441Config INMP441Module::create_default_config()
     config.dma_buf_len = INMP441_DMA_BUF_LEN;
     config.buffer_size = INMP441_BUFFER_SIZE;
     config.gain_factor = INMP441_GAIN_FACTOR;
+    config.agc_enabled = INMP441_AGC_ENABLED;
+    config.agc_target_level = INMP441_AGC_TARGET_LEVEL;
+    config.agc_max_gain = INMP441_AGC_MAX_GAIN;
+    config.dc_block_coeff = INMP441_DC_BLOCK_COEFF;
+    config.pre_emphasis_coeff = INMP441_PRE_EMPHASIS_COEFF;
+    config.decimation_factor = INMP441_DECIMATION_FACTOR;
+    config.use_apll = false;
+    config.channels = INMP441_CHANNELS;
     
     return config;
 }
 
+/**
+ * 創建過取樣配置：I2S 以 48kHz 運行（APLL 提供精確時鐘），抽取到 16kHz
+ */
+INMP441Config INMP441Module::create_oversampled_config()
+{
+    INMP441Config config = create_default_config();
+    config.decimation_factor = INMP441_OVERSAMPLE_FACTOR;
+    config.use_apll = true;
+
+    return config;
+}
+
+/**
+ * 創建立體聲配置：兩顆 INMP441 共用 I2S 匯流排（L/R 腳分別接地與 VDD），
+ * 以 48kHz 擷取讓波束成形的整數延遲解析度為 21µs，再抽取到 16kHz
+ */
+INMP441Config INMP441Module::create_stereo_config()
+{
+    INMP441Config config = create_oversampled_config();
+    config.channels = 2;
+
+    return config;
+}
+
 /**
  * 創建自定義配置
  */
@@ -0,0 +1,199 @@
+#include "kernel_benchmark.h"
+#include "audio_sample.h"
+#include "trace_recorder.h"
+#include <math.h>
+
+#if defined(ESP_PLATFORM)
+typedef uint32_t cycle_count_t; // CCOUNT 為 32-bit，單次量測遠短於回繞週期（240 MHz 約 17.9 秒）
+static inline cycle_count_t read_cycles() { return ESP.getCycleCount(); }
+#define BENCHMARK_CYCLE_COUNTER "ccount"
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+typedef uint64_t cycle_count_t;
+static inline cycle_count_t read_cycles() { return __rdtsc(); }
+#define BENCHMARK_CYCLE_COUNTER "tsc"
+#else
+typedef uint64_t cycle_count_t;
+static inline cycle_count_t read_cycles() { return 0; }
+#define BENCHMARK_CYCLE_COUNTER "none"
+#endif
+
+const char *benchmark_cycle_counter_name()
+{
+    return BENCHMARK_CYCLE_COUNTER;
+}
+
+KernelBenchmark::KernelBenchmark() : case_count(0), result_count(0)
+{
+}
+
+bool KernelBenchmark::add(const char *name, KernelBenchmarkFixture *fixture, size_t frame_size)
+{
+    if (case_count >= KERNEL_BENCHMARK_MAX_CASES || !fixture || frame_size == 0)
+        return false;
+
+    cases[case_count].name = name;
+    cases[case_count].fixture = fixture;
+    cases[case_count].frame_size = frame_size;
+    case_count++;
+    return true;
+}
+
+bool KernelBenchmark::add_range(const char *name, KernelBenchmarkFixture *fixture, size_t min_size, size_t max_size)
+{
+    bool ok = min_size > 0;
+    for (size_t size = min_size; ok && size <= max_size; size *= 2)
+        ok = add(name, fixture, size);
+    return ok;
+}
+
+void KernelBenchmark::measure(KernelBenchmarkFixture *fixture, uint32_t iterations, float *ns, float *cycles)
+{
+    uint32_t start = profiler_ticks();
+    cycle_count_t cycle_start = read_cycles();
+    for (uint32_t i = 0; i < iterations; i++)
+        fixture->run();
+    cycle_count_t cycle_end = read_cycles();
+    uint32_t end = profiler_ticks();
+
+    *ns = (float)(end - start) * 1000.0f / profiler_ticks_per_us();
+    *cycles = (float)(cycle_count_t)(cycle_end - cycle_start);
+}
+
+uint32_t KernelBenchmark::calibrate(KernelBenchmarkFixture *fixture)
+{
+    // 同時作為暖身：快取、分支預測與模組內部狀態（例如 AGC、噪音估計）先跑過幾次
+    uint32_t iterations = 1;
+    for (;;)
+    {
+        float ns, cycles;
+        measure(fixture, iterations, &ns, &cycles);
+        if (ns >= KERNEL_BENCHMARK_MIN_BATCH_US * 1000.0f || iterations >= KERNEL_BENCHMARK_MAX_ITERATIONS)
+            return iterations;
+        iterations *= 2;
+    }
+}
+
+void KernelBenchmark::run(const char *filter)
+{
+    result_count = 0;
+    for (size_t c = 0; c < case_count; c++)
+    {
+        const Case &entry = cases[c];
+        if (filter && !strstr(entry.name, filter))
+            continue;
+
+        entry.fixture->set_up(entry.frame_size);
+        uint32_t iterations = calibrate(entry.fixture);
+
+        float ns[KERNEL_BENCHMARK_REPETITIONS];
+        float cycles[KERNEL_BENCHMARK_REPETITIONS];
+        for (int r = 0; r < KERNEL_BENCHMARK_REPETITIONS; r++)
+        {
+            measure(entry.fixture, iterations, &ns[r], &cycles[r]);
+            yield(); // 讓出 CPU，避免長時間佔用 loopTask 觸發看門狗
+        }
+        entry.fixture->tear_down();
+
+        // 依耗時排序（插入排序，週期數跟著同一次量測移動）
+        for (int i = 1; i < KERNEL_BENCHMARK_REPETITIONS; i++)
+        {
+            for (int j = i; j > 0 && ns[j] < ns[j - 1]; j--)
+            {
+                float t = ns[j];
+                ns[j] = ns[j - 1];
+                ns[j - 1] = t;
+                t = cycles[j];
+                cycles[j] = cycles[j - 1];
+                cycles[j - 1] = t;
+            }
+        }
+
+        KernelBenchmarkResult &result = results[result_count++];
+        const int median = KERNEL_BENCHMARK_REPETITIONS / 2;
+        result.name = entry.name;
+        result.frame_size = entry.frame_size;
+        result.iterations = iterations;
+        result.ns_per_frame = ns[median] / iterations;
+        result.min_ns_per_frame = ns[0] / iterations;
+        result.max_ns_per_frame = ns[KERNEL_BENCHMARK_REPETITIONS - 1] / iterations;
+        result.ns_per_sample = result.ns_per_frame / entry.frame_size;
+        result.cycles_per_frame = cycles[median] / iterations;
+    }
+}
+
+const KernelBenchmarkResult *KernelBenchmark::find_result(const char *name, size_t frame_size) const
+{
+    for (size_t i = 0; i < result_count; i++)
+    {
+        if (results[i].frame_size == frame_size && strcmp(results[i].name, name) == 0)
+            return &results[i];
+    }
+    return nullptr;
+}
+
+void KernelBenchmark::print_table() const
+{
+    Serial.printf("  %-30s %6s %9s %11s %9s %12s %11s %11s\n", "核心", "幀長", "迭代", "ns/幀", "ns/樣本",
+                  "週期/幀", "min ns", "max ns");
+    for (size_t i = 0; i < result_count; i++)
+    {
+        const KernelBenchmarkResult &r = results[i];
+        Serial.printf("  %-28s %6u %9lu %11.1f %9.3f %12.0f %11.1f %11.1f\n", r.name, (unsigned)r.frame_size,
+                      (unsigned long)r.iterations, r.ns_per_frame, r.ns_per_sample, r.cycles_per_frame,
+                      r.min_ns_per_frame, r.max_ns_per_frame);
+    }
+}
+
+/**
+ * JSON 不允許 NaN / Inf
+ */
+static double json_number(float value)
+{
+    return isfinite(value) ? value : 0.0;
+}
+
+void KernelBenchmark::print_json(const char *executable) const
+{
+    Serial.println(KERNEL_BENCHMARK_JSON_BEGIN);
+    Serial.println("{");
+    Serial.println("  \"context\": {");
+    Serial.printf("    \"executable\": \"%s\",\n", executable);
+#if defined(ESP_PLATFORM)
+    Serial.printf("    \"platform\": \"esp32s3\",\n");
+    Serial.printf("    \"mhz_per_cpu\": %lu,\n", (unsigned long)ESP.getCpuFreqMHz());
+#else
+    Serial.printf("    \"platform\": \"host\",\n");
+#endif
+    Serial.printf("    \"cycle_counter\": \"%s\",\n", BENCHMARK_CYCLE_COUNTER);
+    Serial.printf("    \"sample_format\": \"%s\",\n", AUDIO_SAMPLE_Q31 ? "q31" : "q15");
+    // 核心內的 PROFILE_SCOPE / TRACE_* 會計入耗時，比較不同提交時兩者設定應相同
+    Serial.printf("    \"profiler_enabled\": %s,\n", PROFILER_ENABLED ? "true" : "false");
+    Serial.printf("    \"trace_enabled\": %s,\n", TRACE_ENABLED ? "true" : "false");
+#if defined(NDEBUG)
+    Serial.printf("    \"library_build_type\": \"release\",\n");
+#else
+    Serial.printf("    \"library_build_type\": \"debug\",\n");
+#endif
+    Serial.printf("    \"repetitions\": %d,\n", KERNEL_BENCHMARK_REPETITIONS);
+    Serial.printf("    \"min_batch_us\": %d\n", KERNEL_BENCHMARK_MIN_BATCH_US);
+    Serial.println("  },");
+    Serial.println("  \"benchmarks\": [");
+    for (size_t i = 0; i < result_count; i++)
+    {
+        // real_time / cpu_time / time_unit 與 Google Benchmark 欄位相同（中位數），其餘為自訂計數
+        const KernelBenchmarkResult &r = results[i];
+        Serial.printf("    {\"name\": \"%s/%u\", \"run_name\": \"%s/%u\", \"run_type\": \"iteration\", "
+                      "\"repetitions\": %d, \"iterations\": %lu, \"real_time\": %.3f, \"cpu_time\": %.3f, "
+                      "\"time_unit\": \"ns\", \"frame_size\": %u, \"ns_per_sample\": %.4f, \"cycles_per_frame\": %.1f, "
+                      "\"min_time\": %.3f, \"max_time\": %.3f}%s\n",
+                      r.name, (unsigned)r.frame_size, r.name, (unsigned)r.frame_size, KERNEL_BENCHMARK_REPETITIONS,
+                      (unsigned long)r.iterations, json_number(r.ns_per_frame), json_number(r.ns_per_frame),
+                      (unsigned)r.frame_size, json_number(r.ns_per_sample), json_number(r.cycles_per_frame),
+                      json_number(r.min_ns_per_frame), json_number(r.max_ns_per_frame),
+                      i + 1 < result_count ? "," : "");
+    }
+    Serial.println("  ]");
+    Serial.println("}");
+    Serial.println(KERNEL_BENCHMARK_JSON_END);
+}
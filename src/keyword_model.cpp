@@ -1,4 +1,12 @@
+// 本模組編譯期日誌等級，須在 include 之前定義（可由 build_flags 覆寫，例如 -DKEYWORD_DEBUG_LEVEL=DEBUG_LEVEL_WARNING）
+#ifndef KEYWORD_DEBUG_LEVEL
+#define KEYWORD_DEBUG_LEVEL DEBUG_LEVEL_VERBOSE
+#endif
+#define DEBUG_LOCAL_LEVEL KEYWORD_DEBUG_LEVEL
+
 #include "keyword_model.h"
+#include "stage_profiler.h"
+#include "trace_recorder.h"
 #include <math.h>
 #include <string.h>
 
@@ -20,7 +28,7 @@ const KeywordPattern keyword_patterns[KEYWORD_COUNT] = {
         .energy_range = {0.008f, 0.8f}, // 調整能量範圍
         .zcr_range = {0.02f, 0.45f},    // 縮窄零穿越率範圍
         .duration_range = {0.15f, 3.5f},
-        .spectral_peak_freq = 0.35f,
+        .spectral_peak_freq = 0.14f, // 語音頻譜重心的中間值
         .examples = {"speech", "talking", "voice"}},
 
     // KEYWORD_YES ("好的"/"是的"/"OK") - 優化為肯定詞彙
@@ -28,7 +36,7 @@ const KeywordPattern keyword_patterns[KEYWORD_COUNT] = {
         .energy_range = {0.015f, 0.7f}, // 中等能量範圍
         .zcr_range = {0.08f, 0.35f},    // 中等零穿越率（清晰發音）
         .duration_range = {0.3f, 2.5f}, // 典型單詞長度
-        .spectral_peak_freq = 0.42f,    // "好"音的頻譜特徵
+        .spectral_peak_freq = 0.19f,    // "好"音的頻譜特徵
         .examples = {"好的", "是的", "OK"}},
 
     // KEYWORD_NO ("不要"/"不是"/"停止") - 優化為否定詞彙
@@ -36,7 +44,7 @@ const KeywordPattern keyword_patterns[KEYWORD_COUNT] = {
         .energy_range = {0.02f, 0.75f}, // 稍高能量（通常更強調）
         .zcr_range = {0.1f, 0.4f},      // 較高零穿越率（"不"音特徵）
         .duration_range = {0.25f, 2.8f},
-        .spectral_peak_freq = 0.32f, // "不"音的頻譜特徵
+        .spectral_peak_freq = 0.12f, // "不"音的頻譜特徵
         .examples = {"不要", "不是", "停止"}},
 
     // KEYWORD_HELLO ("你好"/"嗨"/"Hello") - 優化為問候語
@@ -44,7 +52,7 @@ const KeywordPattern keyword_patterns[KEYWORD_COUNT] = {
         .energy_range = {0.025f, 0.9f}, // 較高能量（友好問候）
         .zcr_range = {0.12f, 0.45f},    // 較高零穿越率（"你"音特徵）
         .duration_range = {0.4f, 3.0f}, // 雙音節詞長度
-        .spectral_peak_freq = 0.52f,    // "你好"音的頻譜特徵
+        .spectral_peak_freq = 0.27f,    // "你好"音的頻譜特徵
         .examples = {"你好", "嗨", "Hello"}},
 
     // KEYWORD_ON ("開") - 單音節開口音特徵
@@ -52,7 +60,7 @@ const KeywordPattern keyword_patterns[KEYWORD_COUNT] = {
         .energy_range = {0.025f, 0.7f}, // 中等能量範圍
         .zcr_range = {0.08f, 0.3f},     // 較低零穿越率（開口音特徵）
         .duration_range = {0.2f, 1.5f}, // 單音節長度
-        .spectral_peak_freq = 0.38f,    // "開"音的頻譜特徵
+        .spectral_peak_freq = 0.16f,    // "開"音的頻譜特徵
         .examples = {"開", "on", "kai"}},
 
     // KEYWORD_OFF ("關") - 單音節閉口音特徵
@@ -60,10 +68,12 @@ const KeywordPattern keyword_patterns[KEYWORD_COUNT] = {
         .energy_range = {0.02f, 0.6f},  // 中等能量範圍
         .zcr_range = {0.1f, 0.35f},     // 中等零穿越率
         .duration_range = {0.2f, 1.5f}, // 單音節長度
-        .spectral_peak_freq = 0.45f,    // "關"音的頻譜特徵
+        .spectral_peak_freq = 0.21f,    // "關"音的頻譜特徵
         .examples = {"關", "off", "guan"}}};
 
 KeywordDetector::KeywordDetector()
+    : total_detections("kws.detections"), cooldown_rejections("kws.cooldown_rejections"),
+      low_confidence("kws.low_confidence"), debug("Keyword", true)
 {
     reset();
 }
@@ -80,39 +90,28 @@ void KeywordDetector::reset()
     last_result.timestamp = 0;
 
     last_detection_time = 0;
-    total_detections = 0;
-    false_positives = 0;
+    has_detection = false;
+    current_time = 0;
+    total_detections.reset();
+    cooldown_rejections.reset();
+    low_confidence.reset();
     running_noise_level = 0.01f;
 }
 
 KeywordResult KeywordDetector::detect(const AudioFeatures &audio_features)
 {
+    PROFILE_SCOPE(PROFILE_STAGE_KEYWORD);
+
     KeywordResult result;
-    result.timestamp = millis();
+    result.timestamp = audio_features.timestamp;
+    current_time = audio_features.timestamp;
 
     // 更新噪音水準校準
     calibrate_noise_level(audio_features);
 
-    // 提取MFCC特徵
+    // 提取特徵向量
     float mfcc_features[FEATURE_SIZE];
-
-    // 簡化的MFCC特徵提取 (基於現有的音頻特徵)
-    mfcc_features[0] = audio_features.rms_energy;
-    mfcc_features[1] = audio_features.zero_crossing_rate;
-    mfcc_features[2] = audio_features.spectral_centroid;
-
-    // 添加一些衍生特徵
-    mfcc_features[3] = log10f(audio_features.rms_energy + 1e-10f);                    // 對數能量
-    mfcc_features[4] = audio_features.zero_crossing_rate * audio_features.rms_energy; // ZCR-Energy乘積
-    mfcc_features[5] = audio_features.spectral_centroid * audio_features.rms_energy;  // SC-Energy乘積
-
-    // 頻譜能量分佈 (模擬不同頻帶的能量)
-    for (int i = 6; i < FEATURE_SIZE; i++)
-    {
-        float freq_weight = (float)(i - 5) / (FEATURE_SIZE - 6);
-        mfcc_features[i] = audio_features.rms_energy *
-                           sinf(audio_features.spectral_centroid * M_PI * freq_weight);
-    }
+    extract_mfcc_features(audio_features, mfcc_features);
 
     // 更新特徵緩衝區
     update_feature_buffer(mfcc_features);
@@ -141,9 +140,10 @@ KeywordResult KeywordDetector::detect(const AudioFeatures &audio_features)
     // 填充結果
     result.detected_keyword = detected_class;
     result.confidence = confidence;
-    result.is_activation = is_activation_keyword(detected_class) &&
-                           confidence > ACTIVATION_THRESHOLD &&
-                           !is_in_cooldown();
+    bool activation_candidate = is_activation_keyword(detected_class) && confidence > ACTIVATION_THRESHOLD;
+    result.is_activation = activation_candidate && !is_in_cooldown(result.timestamp);
+    if (activation_candidate && !result.is_activation)
+        cooldown_rejections.add();
 
     // 計算各類別機率 (簡化版softmax)
     for (int i = 0; i < KEYWORD_COUNT; i++)
@@ -157,47 +157,35 @@ KeywordResult KeywordDetector::detect(const AudioFeatures &audio_features)
     if (result.is_activation)
     {
         last_detection_time = result.timestamp;
-        total_detections++;
+        has_detection = true;
+        total_detections.add();
+        TRACE_INSTANT(TRACE_EVENT_DETECTION, detected_class);
     }
 
     last_result = result;
     return result;
 }
 
-void KeywordDetector::extract_mfcc_features(const float *audio_frame, float *mfcc_features)
+/**
+ * 組合特徵向量
+ * [0..2] 評分邏輯使用的純量特徵，[3..5] 衍生特徵，
+ * [6..12] 來自 MfccExtractor 的 c1..c7（c0 與對數能量重複，不放入）
+ */
+void KeywordDetector::extract_mfcc_features(const AudioFeatures &audio_features, float *mfcc_features)
 {
-    // 這裡實現簡化的MFCC特徵提取
-    // 實際應用中可以使用更完整的MFCC算法
-
-    float energy = 0.0f;
-    float zcr = 0.0f;
-
-    // 計算能量和零穿越率
-    for (int i = 0; i < AUDIO_FRAME_SIZE; i++)
-    {
-        energy += audio_frame[i] * audio_frame[i];
-        if (i > 0 && ((audio_frame[i] >= 0) != (audio_frame[i - 1] >= 0)))
-        {
-            zcr += 1.0f;
-        }
-    }
-
-    energy = sqrtf(energy / AUDIO_FRAME_SIZE);
-    zcr /= (AUDIO_FRAME_SIZE - 1);
+    mfcc_features[0] = audio_features.rms_energy;
+    mfcc_features[1] = audio_features.zero_crossing_rate;
+    mfcc_features[2] = audio_features.spectral_centroid;
 
-    // 簡化的MFCC係數
-    mfcc_features[0] = log10f(energy + 1e-10f);
-    mfcc_features[1] = zcr;
+    // 添加一些衍生特徵
+    mfcc_features[3] = log10f(audio_features.rms_energy + 1e-10f);                    // 對數能量
+    mfcc_features[4] = audio_features.zero_crossing_rate * audio_features.rms_energy; // ZCR-Energy乘積
+    mfcc_features[5] = audio_features.spectral_centroid * audio_features.rms_energy;  // SC-Energy乘積
 
-    // 其他係數基於頻譜分析
-    for (int i = 2; i < FEATURE_SIZE; i++)
+    // 倒頻譜係數
+    for (int i = 6; i < FEATURE_SIZE; i++)
     {
-        float freq_component = 0.0f;
-        for (int j = 0; j < AUDIO_FRAME_SIZE; j++)
-        {
-            freq_component += audio_frame[j] * cosf(2.0f * M_PI * i * j / AUDIO_FRAME_SIZE);
-        }
-        mfcc_features[i] = freq_component / AUDIO_FRAME_SIZE;
+        mfcc_features[i] = audio_features.mfcc.coeffs[i - 5];
     }
 }
 
@@ -211,9 +199,10 @@ KeywordClass KeywordDetector::classify_features(const float features[TOTAL_FEATU
         scores[i] = get_keyword_score(features, (KeywordClass)i);
     }
 
-    // 調試：顯示所有評分
-    Serial.printf("🔍 關鍵字評分 - 靜音:%.2f, 未知:%.2f, 是:%.2f, 否:%.2f, 你好:%.2f, 開:%.2f, 關:%.2f\n",
-                  scores[0], scores[1], scores[2], scores[3], scores[4], scores[5], scores[6]);
+    // 調試：顯示所有評分（每秒最多 LOG_BURST 筆，逐幀呼叫時不塞滿輸出）
+    DBG_PRINTF_BURST(debug, current_time, LOG_PERIOD_SAMPLES, LOG_BURST,
+                     "🔍 關鍵字評分 - 靜音:%.2f, 未知:%.2f, 是:%.2f, 否:%.2f, 你好:%.2f, 開:%.2f, 關:%.2f\n",
+                     scores[0], scores[1], scores[2], scores[3], scores[4], scores[5], scores[6]);
 
     // 找出最高評分的類別
     int best_class = 0;
@@ -238,19 +227,29 @@ KeywordClass KeywordDetector::classify_features(const float features[TOTAL_FEATU
     *confidence = expf(best_score) / exp_sum;
     
     // 調試：顯示最佳結果
-    Serial.printf("🏆 最佳匹配: %s (評分:%.2f, 信心度:%.1f%%)\n", 
-                  keyword_to_string((KeywordClass)best_class), best_score, *confidence * 100.0f);
+    DBG_PRINTF_BURST(debug, current_time, LOG_PERIOD_SAMPLES, LOG_BURST, "🏆 最佳匹配: %s (評分:%.2f, 信心度:%.1f%%)\n",
+                     keyword_to_string((KeywordClass)best_class), best_score, *confidence * 100.0f);
 
     // 如果置信度太低，歸類為UNKNOWN
     if (*confidence < CONFIDENCE_THRESHOLD && best_class != KEYWORD_SILENCE)
     {
         best_class = KEYWORD_UNKNOWN;
         *confidence = 1.0f - *confidence; // 反轉置信度
+        low_confidence.add();
     }
 
     return (KeywordClass)best_class;
 }
 
+/**
+ * 頻譜重心與關鍵字模板的匹配度（1.0 為完全相符）
+ * 差距先除以 KEYWORD_CENTROID_SCALE，讓 0.6/0.8 等門檻維持原本的鑑別度
+ */
+static float centroid_match(float centroid, float target)
+{
+    return 1.0f - fabsf(centroid - target) / KEYWORD_CENTROID_SCALE;
+}
+
 float KeywordDetector::get_keyword_score(const float *features, KeywordClass keyword)
 {
     const KeywordPattern &pattern = keyword_patterns[keyword];
@@ -311,7 +310,7 @@ float KeywordDetector::get_keyword_score(const float *features, KeywordClass key
         bool max_energy_ok = (max_energy >= 0.04f);                   // 降低最小響亮度要求
 
         // 頻譜特徵匹配（適度放寬）
-        float yes_spectral_match = 1.0f - fabsf(avg_spectral - 0.42f);
+        float yes_spectral_match = centroid_match(avg_spectral, pattern.spectral_peak_freq);
         bool spectral_ok = (yes_spectral_match > 0.6f); // 降低頻譜匹配要求
 
         // 雜音排除（保持但放寬）
@@ -354,7 +353,7 @@ float KeywordDetector::get_keyword_score(const float *features, KeywordClass key
         bool emphasis_ok = (max_energy > avg_energy * 1.2f); // 降低強調要求
 
         // 頻譜特徵匹配（適度放寬）
-        float no_spectral_match = 1.0f - fabsf(avg_spectral - 0.32f);
+        float no_spectral_match = centroid_match(avg_spectral, pattern.spectral_peak_freq);
         bool spectral_ok = (no_spectral_match > 0.6f);
 
         // 雜音排除（放寬）
@@ -399,7 +398,7 @@ float KeywordDetector::get_keyword_score(const float *features, KeywordClass key
         bool variance_ok = (energy_variance > 0.002f && energy_variance < 0.02f); // 放寬雙音節變化
 
         // 頻譜特徵匹配（適度放寬）
-        float hello_spectral_match = 1.0f - fabsf(avg_spectral - 0.52f);
+        float hello_spectral_match = centroid_match(avg_spectral, pattern.spectral_peak_freq);
         bool spectral_ok = (hello_spectral_match > 0.6f);
 
         // 雜音排除（放寬）
@@ -447,7 +446,7 @@ float KeywordDetector::get_keyword_score(const float *features, KeywordClass key
         bool short_duration = (energy_variance < 0.008f);      // 單音節，變化較小
         
         // 頻譜特徵 - "開"音有特定的頻譜特性
-        float on_spectral_match = 1.0f - fabsf(avg_spectral - 0.38f);  // 較低頻譜重心
+        float on_spectral_match = centroid_match(avg_spectral, pattern.spectral_peak_freq);
         bool spectral_ok = (on_spectral_match > 0.55f);
         
         // 雜音排除
@@ -483,7 +482,7 @@ float KeywordDetector::get_keyword_score(const float *features, KeywordClass key
         bool short_duration = (energy_variance < 0.01f);       // 單音節
         
         // 頻譜特徵 - "關"音的特性
-        float off_spectral_match = 1.0f - fabsf(avg_spectral - 0.45f);  // 中等頻譜重心
+        float off_spectral_match = centroid_match(avg_spectral, pattern.spectral_peak_freq);
         bool spectral_ok = (off_spectral_match > 0.55f);
         
         // 雜音排除
@@ -588,15 +587,17 @@ void KeywordDetector::calibrate_noise_level(const AudioFeatures &features)
                           features.rms_energy * alpha;
 }
 
-bool KeywordDetector::is_in_cooldown()
+bool KeywordDetector::is_in_cooldown(sample_time_t now) const
 {
-    return (millis() - last_detection_time) < COOLDOWN_MS;
+    return has_detection && (now - last_detection_time) < COOLDOWN_SAMPLES;
 }
 
 void KeywordDetector::print_stats()
 {
     Serial.println("\n🔑 === KEYWORD DETECTOR STATS ===");
-    Serial.printf("Total detections: %d\n", total_detections);
+    Serial.printf("Total detections: %lu (cooldown rejected %lu, low confidence %lu)\n",
+                  (unsigned long)total_detections.get(), (unsigned long)cooldown_rejections.get(),
+                  (unsigned long)low_confidence.get());
     Serial.printf("Running noise level: %.4f\n", running_noise_level);
     Serial.printf("Buffer status: %s\n", buffer_full ? "Full" : "Filling");
     Serial.printf("Last detection: %s (%.1f%%)\n",
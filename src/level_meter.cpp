@@ -0,0 +1,126 @@
+#include "level_meter.h"
+#include <math.h>
+
+AudioLevelMeter::AudioLevelMeter() : window_length(0)
+{
+    reset();
+}
+
+float level_to_dbfs(float level)
+{
+    if (level <= 0.0f)
+        return LEVEL_METER_FLOOR_DBFS;
+    float db = 20.0f * log10f(level / 32767.0f);
+    return db > LEVEL_METER_FLOOR_DBFS ? db : LEVEL_METER_FLOOR_DBFS;
+}
+
+void AudioLevelMeter::reset_window()
+{
+    window_min = INT16_MAX;
+    window_max = INT16_MIN;
+    window_sum = 0;
+    window_sum_squares = 0;
+    window_count = 0;
+    window_ticks = 0;
+}
+
+void AudioLevelMeter::set_window(uint32_t ticks)
+{
+    window_length = ticks ? ticks : 1;
+    reset_window();
+}
+
+void AudioLevelMeter::add_block(const AudioLevelAccumulator &block, uint32_t count, uint32_t ticks, uint32_t clipped)
+{
+    if (count == 0)
+        return;
+
+    int32_t peak = max(block.max_value, -block.min_value);
+    block_peak = peak;
+    block_sum_squares = block.sum_squares;
+    block_count = count;
+    if (peak > peak_hold)
+        peak_hold = peak;
+    total_samples += count;
+    clipped_samples += clipped;
+    last_block_time = millis();
+
+    if (block.min_value < window_min)
+        window_min = block.min_value;
+    if (block.max_value > window_max)
+        window_max = block.max_value;
+    window_sum += block.sum;
+    window_sum_squares += block.sum_squares;
+    window_count += count;
+    window_ticks += ticks;
+
+    // 視窗以區塊為單位結束（長度會略超過設定值，最多一個區塊）
+    if (window_ticks >= window_length)
+    {
+        has_window = true;
+        last_window_min = window_min;
+        last_window_max = window_max;
+        last_window_sum = window_sum;
+        last_window_sum_squares = window_sum_squares;
+        last_window_count = window_count;
+        reset_window();
+    }
+}
+
+AudioLevelMeter::Stats AudioLevelMeter::get_stats() const
+{
+    Stats stats = {};
+    stats.total_samples = total_samples;
+    stats.clipped_samples = clipped_samples;
+    stats.peak_hold = peak_hold;
+    stats.last_block_time = last_block_time;
+
+    if (block_count)
+    {
+        stats.block_peak = block_peak;
+        stats.block_rms = sqrtf((float)block_sum_squares / block_count);
+        stats.block_rms_dbfs = level_to_dbfs(stats.block_rms);
+        stats.block_peak_dbfs = level_to_dbfs((float)block_peak);
+    }
+    else
+    {
+        stats.block_rms_dbfs = LEVEL_METER_FLOOR_DBFS;
+        stats.block_peak_dbfs = LEVEL_METER_FLOOR_DBFS;
+    }
+
+    // 第一個視窗完成前回報累積中的部分視窗
+    uint32_t count = has_window ? last_window_count : window_count;
+    if (count)
+    {
+        stats.window_min = has_window ? last_window_min : window_min;
+        stats.window_max = has_window ? last_window_max : window_max;
+        stats.window_dc = (float)(has_window ? last_window_sum : window_sum) / count;
+        stats.window_rms_dbfs =
+            level_to_dbfs(sqrtf((float)(has_window ? last_window_sum_squares : window_sum_squares) / count));
+        stats.window_samples = count;
+    }
+    else
+    {
+        stats.window_rms_dbfs = LEVEL_METER_FLOOR_DBFS;
+    }
+
+    return stats;
+}
+
+void AudioLevelMeter::reset()
+{
+    reset_window();
+    has_window = false;
+    last_window_min = 0;
+    last_window_max = 0;
+    last_window_sum = 0;
+    last_window_sum_squares = 0;
+    last_window_count = 0;
+    block_peak = 0;
+    block_sum_squares = 0;
+    block_count = 0;
+    total_samples = 0;
+    clipped_samples = 0;
+    peak_hold = 0;
+    last_block_time = 0;
+}
@@ -0,0 +1,164 @@
+#include "load_governor.h"
+#include <string.h>
+
+LoadGovernor::LoadGovernor() : config(create_default_config())
+{
+    reset();
+}
+
+LoadGovernor::LoadGovernor(const LoadGovernorConfig &custom_config) : config(custom_config)
+{
+    reset();
+}
+
+LoadGovernorConfig LoadGovernor::create_default_config()
+{
+    LoadGovernorConfig default_config;
+    default_config.max_level = LOAD_LEVEL_ENERGY_VAD;
+    default_config.degrade_load = LOAD_GOVERNOR_DEGRADE_LOAD;
+    default_config.recover_load = LOAD_GOVERNOR_RECOVER_LOAD;
+    default_config.recover_hold_ms = LOAD_GOVERNOR_RECOVER_HOLD_MS;
+    default_config.min_dwell_ms = LOAD_GOVERNOR_MIN_DWELL_MS;
+    default_config.smoothing = LOAD_GOVERNOR_SMOOTHING;
+    return default_config;
+}
+
+void LoadGovernor::set_config(const LoadGovernorConfig &new_config)
+{
+    config = new_config;
+    reset();
+}
+
+void LoadGovernor::reset()
+{
+    level = LOAD_LEVEL_FULL;
+    smoothed_load = 0.0f;
+    last_update_us = 0;
+    last_transition_us = 0;
+    headroom_since_us = -1;
+    has_update = false;
+
+    memset(&stats, 0, sizeof(stats));
+    stats.level = LOAD_LEVEL_FULL;
+}
+
+LoadLevel LoadGovernor::update(int64_t now_us, uint32_t busy_us, uint32_t budget_us, bool deadline_missed)
+{
+    float load = budget_us ? (float)busy_us / budget_us : 0.0f;
+
+    if (!has_update)
+    {
+        // 第一幀：以當下負載初始化，停留時間從此起算
+        smoothed_load = load;
+        last_transition_us = now_us;
+        has_update = true;
+    }
+    else
+    {
+        smoothed_load += config.smoothing * (load - smoothed_load);
+        stats.time_in_level_us[level] += now_us - last_update_us;
+    }
+    last_update_us = now_us;
+
+    stats.frames++;
+    if (load > stats.peak_load)
+        stats.peak_load = load;
+
+    bool dwell_elapsed = now_us - last_transition_us >= (int64_t)config.min_dwell_ms * 1000;
+
+    // 降級：錯過期限或平滑負載過高
+    bool overloaded = deadline_missed || smoothed_load > config.degrade_load;
+    if (overloaded)
+    {
+        headroom_since_us = -1;
+        if (level < config.max_level && dwell_elapsed)
+            change_level((LoadLevel)(level + 1), now_us,
+                         deadline_missed ? LOAD_REASON_DEADLINE_MISS : LOAD_REASON_OVERLOAD);
+    }
+    else if (smoothed_load < config.recover_load)
+    {
+        // 恢復：餘裕需持續 recover_hold_ms，每次只升一級
+        if (headroom_since_us < 0)
+            headroom_since_us = now_us;
+
+        if (level > LOAD_LEVEL_FULL && dwell_elapsed &&
+            now_us - headroom_since_us >= (int64_t)config.recover_hold_ms * 1000)
+        {
+            change_level((LoadLevel)(level - 1), now_us, LOAD_REASON_HEADROOM);
+            headroom_since_us = now_us;
+        }
+    }
+    else
+    {
+        headroom_since_us = -1;
+    }
+
+    stats.load = smoothed_load;
+    return level;
+}
+
+void LoadGovernor::change_level(LoadLevel to, int64_t now_us, LoadTransitionReason reason)
+{
+    LoadTransition transition;
+    transition.time_us = now_us;
+    transition.from = level;
+    transition.to = to;
+    transition.load = smoothed_load;
+    transition.reason = reason;
+
+    level = to;
+    last_transition_us = now_us;
+
+    stats.level = to;
+    stats.transitions++;
+    if (to > transition.from)
+        stats.degrades++;
+    else
+        stats.recoveries++;
+    stats.last_transition = transition;
+
+    if (transition_callback)
+        transition_callback(transition);
+}
+
+void LoadGovernor::print_stats(const DebugPrint &out) const
+{
+    out.printf("🎚️  負載調節: 等級 %s，平滑負載 %.0f%%（單幀最高 %.0f%%），切換 %lu 次（降級 %lu / 恢復 %lu）\n",
+               level_name(level), smoothed_load * 100.0f, stats.peak_load * 100.0f, (unsigned long)stats.transitions,
+               (unsigned long)stats.degrades, (unsigned long)stats.recoveries);
+
+    uint64_t total_us = 0;
+    for (int l = 0; l < LOAD_LEVEL_COUNT; l++)
+        total_us += stats.time_in_level_us[l];
+    if (total_us == 0)
+        return;
+
+    for (int l = 0; l < LOAD_LEVEL_COUNT; l++)
+    {
+        if (stats.time_in_level_us[l])
+            out.printf("  %-16s %5.1f%%\n", level_name((LoadLevel)l), stats.time_in_level_us[l] * 100.0f / total_us);
+    }
+}
+
+const char *LoadGovernor::level_name(LoadLevel level)
+{
+    switch (level)
+    {
+    case LOAD_LEVEL_FULL: return "full";
+    case LOAD_LEVEL_SILENCE_LITE: return "silence_lite";
+    case LOAD_LEVEL_SILENCE_STRIDE: return "silence_stride";
+    case LOAD_LEVEL_ENERGY_VAD: return "energy_vad";
+    default: return "unknown";
+    }
+}
+
+const char *LoadGovernor::reason_name(LoadTransitionReason reason)
+{
+    switch (reason)
+    {
+    case LOAD_REASON_OVERLOAD: return "overload";
+    case LOAD_REASON_DEADLINE_MISS: return "deadline_miss";
+    case LOAD_REASON_HEADROOM: return "headroom";
+    default: return "unknown";
+    }
+}
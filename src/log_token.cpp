@@ -0,0 +1,55 @@
+#include "log_token.h"
+
+LogTokenWriter::LogTokenWriter(uint32_t token, uint16_t module, uint8_t kind) : length(2), truncated(false)
+{
+    put_bytes(&token, sizeof(token));
+    put_bytes(&module, sizeof(module));
+    put_bytes(&kind, sizeof(kind));
+}
+
+void LogTokenWriter::put_bytes(const void *data, size_t size)
+{
+    if (length + size > sizeof(frame))
+    {
+        truncated = true;
+        return;
+    }
+    memcpy(frame + length, data, size);
+    length += size;
+}
+
+void LogTokenWriter::put(double value)
+{
+    float narrow = (float)value;
+    put_bytes(&narrow, sizeof(narrow));
+}
+
+void LogTokenWriter::put(const char *text)
+{
+    if (!text)
+        text = "(null)";
+
+    size_t size = strlen(text);
+    if (length + size + 1 > sizeof(frame))
+    {
+        // 截斷在 UTF-8 字元邊界，保留 NUL
+        truncated = true;
+        if (length + 1 > sizeof(frame))
+            return;
+        size = sizeof(frame) - length - 1;
+        while (size > 0 && ((uint8_t)text[size] & 0xC0) == 0x80)
+            size--;
+    }
+    memcpy(frame + length, text, size);
+    length += size;
+    frame[length++] = 0;
+}
+
+size_t LogTokenWriter::finish()
+{
+    frame[0] = LOG_TOKEN_SYNC;
+    frame[1] = (uint8_t)(length - 2);
+    if (truncated)
+        frame[2 + LOG_TOKEN_HEADER_SIZE - 1] |= LOG_KIND_TRUNCATED;
+    return length;
+}
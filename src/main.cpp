@@ -1,3 +1,9 @@
+// 本模組編譯期日誌等級，須在 include 之前定義（可由 build_flags 覆寫，例如 -DMAIN_DEBUG_LEVEL=DEBUG_LEVEL_WARNING）
+#ifndef MAIN_DEBUG_LEVEL
+#define MAIN_DEBUG_LEVEL DEBUG_LEVEL_VERBOSE
+#endif
+#define DEBUG_LOCAL_LEVEL MAIN_DEBUG_LEVEL
+
 #include <Arduino.h>
 #include "TensorFlowLite_ESP32.h"
 
@@ -6,6 +12,11 @@
 #include "voice_model.h"
 #include "keyword_model.h"
 #include "debug_print.h"
+#include "async_log.h"
+#include "metrics.h"
+#include "esp_timer.h"
+#include "stage_profiler.h"
+#include "trace_recorder.h"
 
 // 測試模式選擇
 bool audio_test_mode = true; // 設為 true 來測試 INMP441 麥克風
@@ -46,16 +57,19 @@ void setup()
     // 額外延遲確保串口穩定
     delay(2000);
 
+    // 之後所有 DebugPrint 輸出經環形緩衝區由低優先權任務送出，不阻塞音訊處理
+    async_log.begin();
+
     // 發送多個測試訊息
-    debug_main.info("\n\n==================================");
-    debug_main.info("ESP32-S3 BOOT SUCCESSFUL!");
-    debug_main.info("Serial Communication Test");
-    debug_main.info("==================================");
+    DBG_INFO(debug_main, "\n\n==================================");
+    DBG_INFO(debug_main, "ESP32-S3 BOOT SUCCESSFUL!");
+    DBG_INFO(debug_main, "Serial Communication Test");
+    DBG_INFO(debug_main, "==================================");
 
     if (audio_test_mode)
     {
-        debug_main.info("=== 關鍵字檢測模式 ===");
-        debug_main.info("ESP32-S3 + INMP441 + 關鍵字辨識 (模組化版本)");
+        DBG_INFO(debug_main, "=== 關鍵字檢測模式 ===");
+        DBG_INFO(debug_main, "ESP32-S3 + INMP441 + 關鍵字辨識 (模組化版本)");
 
         // 可選: 自定義 INMP441 配置
         // INMP441Config custom_config = INMP441Module::create_custom_config(42, 41, 2, 16000);
@@ -63,7 +77,7 @@ void setup()
         // 初始化音訊模組
         if (audio_module.initialize())  // 或使用 audio_module.initialize(custom_config)
         {
-            debug_main.success("音訊模組初始化成功!");
+            DBG_SUCCESS(debug_main, "音訊模組初始化成功!");
 
             // 顯示 INMP441 配置信息
             audio_module.get_inmp441_module().print_config();
@@ -72,39 +86,46 @@ void setup()
             audio_module.set_audio_frame_callback(on_audio_frame);
             audio_module.set_vad_callback(on_vad_event);
             audio_module.set_speech_complete_callback(on_speech_complete);
+
+            // CPU 過載時逐級降低品質，記錄每次切換
+            audio_module.get_load_governor().set_transition_callback([](const LoadTransition &transition) {
+                DBG_PRINTF(debug_main, "🎚️  品質等級 %s → %s（%s，負載 %.0f%%）\n",
+                           LoadGovernor::level_name(transition.from), LoadGovernor::level_name(transition.to),
+                           LoadGovernor::reason_name(transition.reason), transition.load * 100.0f);
+            });
             
             // 開始音訊擷取
             if (audio_module.start_capture())
             {
-                debug_main.info("🎤 正在聆聽中... 請說出關鍵字:");
-                debug_main.info("👋 \"你好\" | \"Hello\"");
-                debug_main.info("✅ \"好的\" | \"Yes\"");
-                debug_main.info("❌ \"不要\" | \"No\"");
-                debug_main.info("🟢 \"開\" | \"On\"");
-                debug_main.info("🔴 \"關\" | \"Off\"");
-                debug_main.info("----------------------------------------");
+                DBG_INFO(debug_main, "🎤 正在聆聽中... 請說出關鍵字:");
+                DBG_INFO(debug_main, "👋 \"你好\" | \"Hello\"");
+                DBG_INFO(debug_main, "✅ \"好的\" | \"Yes\"");
+                DBG_INFO(debug_main, "❌ \"不要\" | \"No\"");
+                DBG_INFO(debug_main, "🟢 \"開\" | \"On\"");
+                DBG_INFO(debug_main, "🔴 \"關\" | \"Off\"");
+                DBG_INFO(debug_main, "----------------------------------------");
             }
             else
             {
-                debug_main.error("啟動音訊擷取失敗!");
+                DBG_ERROR(debug_main, "啟動音訊擷取失敗!");
                 audio_test_mode = false;
             }
         }
         else
         {
-            debug_main.error("初始化音訊模組失敗!");
+            DBG_ERROR(debug_main, "初始化音訊模組失敗!");
             audio_test_mode = false;
         }
     }
     else
     {
-        debug_main.info("=== Basic Serial Communication Test ===");
-        debug_main.info("ESP32-S3 Serial Port Working!");
-        debug_main.info("Testing basic output before audio features...");
+        DBG_INFO(debug_main, "=== Basic Serial Communication Test ===");
+        DBG_INFO(debug_main, "ESP32-S3 Serial Port Working!");
+        DBG_INFO(debug_main, "Testing basic output before audio features...");
     }
 
-    debug_main.success("Serial communication established!");
-    debug_main.info("Starting main loop in 2 seconds...");
+    DBG_SUCCESS(debug_main, "Serial communication established!");
+    DBG_INFO(debug_main, "Starting main loop in 2 seconds...");
     delay(2000);
 }
 
@@ -126,6 +147,45 @@ void audio_loop()
 {
     // 使用新的音訊模組進行處理
     audio_module.process_audio_loop();
+
+    // 序列埠指令：p = 輸出各階段耗時、期限、負載調節、日誌統計與指標，r = 重置，
+    // m / b = 指標快照（單行文字 / 二進位，供定期擷取；計數器不隨 r 歸零，擷取端自行計算差值），
+    // t = 傾印追蹤緩衝區（python/trace_to_chrome.py 轉換）並重新開始，T = 下次期限未達成時凍結追蹤
+    if (Serial.available())
+    {
+        int command = Serial.read();
+        if (command == 'p')
+        {
+            PROFILE_PRINT(debug_main);
+            audio_module.get_deadline_monitor().print_stats(debug_main);
+            audio_module.get_load_governor().print_stats(debug_main);
+            async_log.print_stats(debug_main);
+            metrics.print(debug_main);
+        }
+        else if (command == 'm' || command == 'b')
+        {
+            metrics.emit_snapshot(command == 'b');
+        }
+#if TRACE_ENABLED
+        else if (command == 't')
+        {
+            trace.dump();
+            trace.start();
+        }
+        else if (command == 'T')
+        {
+            trace.start();
+            trace.arm();
+            DBG_INFO(debug_main, "🧭 追蹤已觸發待命：下次期限未達成時凍結，按 t 傾印");
+        }
+#endif
+        else if (command == 'r')
+        {
+            PROFILE_RESET();
+            audio_module.get_deadline_monitor().reset();
+            async_log.reset_stats();
+        }
+    }
     
     // 獲取音訊統計信息並偶爾顯示
     static unsigned long last_stats_display = 0;
@@ -134,10 +194,22 @@ void audio_loop()
     if (current_time - last_stats_display > 5000) // 每5秒顯示一次統計
     {
         AudioCaptureModule::AudioStats stats = audio_module.get_audio_stats();
-        if (stats.avg_amplitude > 50)
+        if (stats.rms_amplitude > 50)
         {
-            debug_main.printf("📊 音訊統計 - 平均振幅: %d, 最大: %d, 最小: %d\n",
-                              stats.avg_amplitude, stats.max_amplitude, stats.min_amplitude);
+            DBG_PRINTF(debug_main, "📊 音訊統計 - RMS: %.1f dBFS, 峰值: %.1f dBFS, DC: %.1f, 最大: %ld, 最小: %ld\n",
+                       stats.rms_dbfs, stats.peak_dbfs, stats.dc_mean, (long)stats.max_amplitude,
+                       (long)stats.min_amplitude);
+        }
+
+        // 擷取健康：主迴圈太慢時 DMA 會溢位
+        static uint32_t last_overflows = 0;
+        INMP441Module::INMP441Stats health = audio_module.get_inmp441_module().get_statistics();
+        if (health.dma_overflows != last_overflows)
+        {
+            DBG_PRINTF(debug_main, "⚠️  I2S DMA 溢位 %lu 次 - 估計遺失 %llu 樣本，最大讀取間隔 %lu µs\n",
+                       (unsigned long)health.dma_overflows, (unsigned long long)health.dropped_samples,
+                       (unsigned long)health.max_read_gap_us);
+            last_overflows = health.dma_overflows;
         }
         last_stats_display = current_time;
     }
@@ -153,12 +225,12 @@ void original_tensorflow_loop()
     // 計算預期的 sin(x) 值作為對比
     float expected = sin(x);
 
-    debug_main.printf("[%d] Input x = %.3f, Expected sin(x) = %.6f\n", counter, x, expected);
+    DBG_PRINTF(debug_main, "[%d] Input x = %.3f, Expected sin(x) = %.6f\n", counter, x, expected);
 
     // 每隔 10 次輸出一個分隔線
     if (counter % 10 == 0)
     {
-        debug_main.print("----------------------------------------");
+        DBG_PRINT(debug_main, "----------------------------------------");
     }
 
     // 更新輸入
@@ -166,8 +238,8 @@ void original_tensorflow_loop()
     if (x > 2 * 3.14159f)
     {
         x = 0.0f;
-        debug_main.info(">>> Cycle complete - Restarting from x=0 <<<");
-        debug_main.print("");
+        DBG_INFO(debug_main, ">>> Cycle complete - Restarting from x=0 <<<");
+        DBG_PRINT(debug_main, "");
     }
 
     delay(1000);
@@ -182,17 +254,14 @@ void original_tensorflow_loop()
 void on_audio_frame(const AudioFeatures &features)
 {
     // 可以在這裡添加即時特徵監控
-    static int frame_count = 0;
-    frame_count++;
-
-    // 每100幀輸出一次特徵信息（避免過多輸出）
-    if (frame_count % 100 == 0 && features.rms_energy > 0.01f)
+    // 有聲幀每100幀輸出一次特徵信息（避免過多輸出）
+    if (features.rms_energy > 0.01f)
     {
-        debug_main.printf("🎵 幀特徵 - RMS:%.3f ZCR:%.3f SC:%.3f Voice:%s\n",
-                          features.rms_energy,
-                          features.zero_crossing_rate,
-                          features.spectral_centroid,
-                          features.is_voice_detected ? "是" : "否");
+        DBG_PRINTF_EVERY_N(debug_main, 100, "🎵 幀特徵 - RMS:%.3f ZCR:%.3f SC:%.3f Voice:%s\n",
+                           features.rms_energy,
+                           features.zero_crossing_rate,
+                           features.spectral_centroid,
+                           features.is_voice_detected ? "是" : "否");
     }
 }
 
@@ -210,20 +279,20 @@ void on_vad_event(const VADResult &result)
         switch (result.state)
         {
         case VAD_SPEECH_START:
-            debug_main.info("🎤 語音檢測開始...");
+            DBG_INFO(debug_main, "🎤 語音檢測開始...");
             break;
             
         case VAD_SPEECH_ACTIVE:
-            debug_main.info("🗣️  正在收集語音數據...");
+            DBG_INFO(debug_main, "🗣️  正在收集語音數據...");
             break;
             
         case VAD_SPEECH_END:
-            debug_main.printf("⏹️  語音檢測結束 - 持續時間: %lu ms\n", result.duration_ms);
+            DBG_PRINTF(debug_main, "⏹️  語音檢測結束 - 持續時間: %lu ms\n", result.duration_ms);
             break;
             
         case VAD_SILENCE:
             if (last_state != VAD_SILENCE)
-                debug_main.info("🔇 回到靜音狀態");
+                DBG_INFO(debug_main, "🔇 回到靜音狀態");
             break;
         }
         last_state = result.state;
@@ -241,129 +310,75 @@ void on_speech_complete(const float *speech_data, size_t length, unsigned long d
         return;
     }
 
-    debug_main.info("🎯 開始分析完整語音段落...");
+    DBG_INFO(debug_main, "🎯 開始分析完整語音段落...");
 
     // 計算語音持續時間
     float duration_seconds = (float)length / AUDIO_SAMPLE_RATE;
     
-    // 將整個語音段落分段處理以提取更好的特徵
-    AudioFeatures overall_features = {0};
-    int num_segments = (length / AUDIO_FRAME_SIZE) + 1;
-    float total_rms = 0, total_zcr = 0, total_sc = 0;
-    int valid_segments = 0;
-    
-    // 分段分析並累積特徵
-    for (int seg = 0; seg < num_segments && seg * AUDIO_FRAME_SIZE < length; seg++)
-    {
-        int start_pos = seg * AUDIO_FRAME_SIZE;
-        int end_pos = min(start_pos + AUDIO_FRAME_SIZE, (int)length);
-        int segment_size = end_pos - start_pos;
-        
-        if (segment_size >= AUDIO_FRAME_SIZE / 4) // 只處理有足夠長度的段落
-        {
-            // 創建臨時 AudioCaptureModule 實例來提取特徵
-            // 這裡直接計算特徵，因為我們已經有了語音數據
-            float rms = 0.0f;
-            for (int i = start_pos; i < end_pos; i++)
-            {
-                rms += speech_data[i] * speech_data[i];
-            }
-            rms = sqrt(rms / segment_size);
-            
-            // 計算零穿越率
-            int zero_crossings = 0;
-            for (int i = start_pos + 1; i < end_pos; i++)
-            {
-                if ((speech_data[i] >= 0) != (speech_data[i-1] >= 0))
-                {
-                    zero_crossings++;
-                }
-            }
-            float zcr = (float)zero_crossings / (segment_size - 1);
-            
-            // 計算頻譜重心（簡化版）
-            float high_freq_energy = 0.0f;
-            float total_energy = 0.0f;
-            for (int i = start_pos; i < end_pos; i++)
-            {
-                float energy = speech_data[i] * speech_data[i];
-                total_energy += energy;
-                if (i > start_pos + segment_size / 2)
-                {
-                    high_freq_energy += energy;
-                }
-            }
-            float spectral_centroid = (total_energy > 0) ? (high_freq_energy / total_energy) : 0.0f;
-            
-            total_rms += rms;
-            total_zcr += zcr;
-            total_sc += spectral_centroid;
-            valid_segments++;
-        }
-    }
-    
-    // 計算平均特徵
-    if (valid_segments > 0)
+    // 使用音訊模組在語音期間逐幀累積的平均特徵（不重新計算任何轉換）
+    AudioFeatures overall_features = audio_module.get_speech_features();
+
+    if (overall_features.is_voice_detected)
     {
-        overall_features.rms_energy = total_rms / valid_segments;
-        overall_features.zero_crossing_rate = total_zcr / valid_segments;
-        overall_features.spectral_centroid = total_sc / valid_segments;
-        overall_features.is_voice_detected = true;
-        
         // 進行關鍵字檢測
         KeywordResult keyword_result = keyword_detector.detect(overall_features);
         
         // 顯示完整的分析結果
-        debug_main.printf("📏 語音段落 - 長度: %zu 樣本 (%.2f 秒)\n", length, duration_seconds);
+        DBG_PRINTF(debug_main, "📏 語音段落 - 長度: %zu 樣本 (%.2f 秒)\n", length, duration_seconds);
+
+        // 端到端延遲：語音最後一幀的擷取時間（樣本時鐘換算為牆上時間）到目前
+        const SampleClock &clock = audio_module.get_sample_clock();
+        int64_t latency_us = esp_timer_get_time() - clock.to_wall_us(keyword_result.timestamp);
+        DBG_PRINTF(debug_main, "⏱️  樣本時間 %llu，偵測延遲 %.1f ms\n", (unsigned long long)keyword_result.timestamp, latency_us / 1000.0f);
 
-        debug_main.printf("🔊 整體特徵 - RMS: %.3f, ZCR: %.3f, SC: %.3f\n",
-                          overall_features.rms_energy,
-                          overall_features.zero_crossing_rate,
-                          overall_features.spectral_centroid);
+        DBG_PRINTF(debug_main, "🔊 整體特徵 - RMS: %.3f, ZCR: %.3f, SC: %.3f\n",
+                   overall_features.rms_energy,
+                   overall_features.zero_crossing_rate,
+                   overall_features.spectral_centroid);
 
         // 顯示關鍵字檢測結果
         if (keyword_result.detected_keyword != KEYWORD_SILENCE &&
             keyword_result.detected_keyword != KEYWORD_UNKNOWN)
         {
-            debug_main.printf("🎯 關鍵字檢測: %s (信心度: %.1f%%)\n",
-                              keyword_to_string(keyword_result.detected_keyword),
-                              keyword_result.confidence * 100.0f);
+            DBG_PRINTF(debug_main, "🎯 關鍵字檢測: %s (信心度: %.1f%%)\n",
+                       keyword_to_string(keyword_result.detected_keyword),
+                       keyword_result.confidence * 100.0f);
 
             // 顯示所有類別的機率
-            debug_main.printf("📊 機率分佈 - 靜音:%.1f%%, 未知:%.1f%%, 是:%.1f%%, 否:%.1f%%, 你好:%.1f%%, 開:%.1f%%, 關:%.1f%%\n",
-                              keyword_result.probabilities[0] * 100.0f,
-                              keyword_result.probabilities[1] * 100.0f,
-                              keyword_result.probabilities[2] * 100.0f,
-                              keyword_result.probabilities[3] * 100.0f,
-                              keyword_result.probabilities[4] * 100.0f,
-                              keyword_result.probabilities[5] * 100.0f,
-                              keyword_result.probabilities[6] * 100.0f);
+            DBG_PRINTF(debug_main, "📊 機率分佈 - 靜音:%.1f%%, 未知:%.1f%%, 是:%.1f%%, 否:%.1f%%, 你好:%.1f%%, 開:%.1f%%, 關:%.1f%%\n",
+                       keyword_result.probabilities[0] * 100.0f,
+                       keyword_result.probabilities[1] * 100.0f,
+                       keyword_result.probabilities[2] * 100.0f,
+                       keyword_result.probabilities[3] * 100.0f,
+                       keyword_result.probabilities[4] * 100.0f,
+                       keyword_result.probabilities[5] * 100.0f,
+                       keyword_result.probabilities[6] * 100.0f);
 
             // 顯示檢測到的特定關鍵字
             switch (keyword_result.detected_keyword)
             {
             case KEYWORD_YES:
-                debug_main.success("✅ 檢測到: 是的/好的/Yes");
+                DBG_SUCCESS(debug_main, "✅ 檢測到: 是的/好的/Yes");
                 break;
             case KEYWORD_NO:
-                debug_main.info("❌ 檢測到: 不要/不是/No");
+                DBG_INFO(debug_main, "❌ 檢測到: 不要/不是/No");
                 break;
             case KEYWORD_HELLO:
-                debug_main.info("👋 檢測到: 你好/Hello");
+                DBG_INFO(debug_main, "👋 檢測到: 你好/Hello");
                 break;
             case KEYWORD_ON:
-                debug_main.success("🟢 檢測到: 開/On - 系統啟動");
+                DBG_SUCCESS(debug_main, "🟢 檢測到: 開/On - 系統啟動");
                 break;
             case KEYWORD_OFF:
-                debug_main.warning("🔴 檢測到: 關/Off - 系統關閉");
+                DBG_WARNING(debug_main, "🔴 檢測到: 關/Off - 系統關閉");
                 break;
             }
         }
         else
         {
-            debug_main.info("❓ 未檢測到明確關鍵字");
+            DBG_INFO(debug_main, "❓ 未檢測到明確關鍵字");
         }
 
-        debug_main.info("========================================");
+        DBG_INFO(debug_main, "========================================");
     }
 }
@@ -0,0 +1,239 @@
+#include "metrics.h"
+#include "async_log.h"
+#include <string.h>
+
+// 全域實例（常數初始化，早於任何靜態物件的建構）
+MetricsRegistry metrics;
+
+Metric::Metric(const char *metric_name, MetricType metric_type) : name(metric_name), type(metric_type), next(nullptr)
+{
+    metrics.add(this);
+}
+
+Metric::~Metric()
+{
+    metrics.remove(this);
+}
+
+MetricHistogram::MetricHistogram(const char *name) : Metric(name, METRIC_HISTOGRAM)
+{
+    reset();
+}
+
+uint32_t MetricHistogram::get_count() const
+{
+    uint32_t total = 0;
+    for (int k = 0; k < METRIC_HISTOGRAM_BUCKETS; k++)
+        total += get_bucket(k);
+    return total;
+}
+
+void MetricHistogram::reset()
+{
+    for (int k = 0; k < METRIC_HISTOGRAM_BUCKETS; k++)
+        buckets[k].store(0, std::memory_order_relaxed);
+}
+
+void MetricsRegistry::add(Metric *metric)
+{
+    // 加在尾端，快照順序與登錄順序相同
+    Metric **link = &head;
+    while (*link)
+        link = &(*link)->next;
+    *link = metric;
+    metric->next = nullptr;
+    count++;
+}
+
+void MetricsRegistry::remove(Metric *metric)
+{
+    for (Metric **link = &head; *link; link = &(*link)->next)
+    {
+        if (*link == metric)
+        {
+            *link = metric->next;
+            count--;
+            return;
+        }
+    }
+}
+
+const Metric *MetricsRegistry::find(const char *name) const
+{
+    for (const Metric *metric = head; metric; metric = metric->next)
+    {
+        if (strcmp(metric->name, name) == 0)
+            return metric;
+    }
+    return nullptr;
+}
+
+/**
+ * 直方圖最後一個非零桶之後的桶不輸出
+ */
+static int used_buckets(const MetricHistogram *histogram)
+{
+    int used = METRIC_HISTOGRAM_BUCKETS;
+    while (used > 0 && histogram->get_bucket(used - 1) == 0)
+        used--;
+    return used;
+}
+
+size_t MetricsRegistry::snapshot_text(char *buffer, size_t size) const
+{
+    if (size == 0)
+        return 0;
+
+    size_t length = snprintf(buffer, size, "metrics");
+    for (const Metric *metric = head; metric && length < size; metric = metric->next)
+    {
+        char item[160];
+        int item_length;
+        switch (metric->type)
+        {
+        case METRIC_COUNTER:
+            item_length = snprintf(item, sizeof(item), " %s=%lu", metric->name,
+                                   (unsigned long)static_cast<const MetricCounter *>(metric)->get());
+            break;
+        case METRIC_GAUGE:
+            item_length = snprintf(item, sizeof(item), " %s=%ld", metric->name,
+                                   (long)static_cast<const MetricGauge *>(metric)->get());
+            break;
+        default:
+        {
+            const MetricHistogram *histogram = static_cast<const MetricHistogram *>(metric);
+            int used = used_buckets(histogram);
+            item_length = snprintf(item, sizeof(item), " %s=[", metric->name);
+            for (int k = 0; k < used && item_length < (int)sizeof(item); k++)
+                item_length += snprintf(item + item_length, sizeof(item) - item_length, k ? ",%lu" : "%lu",
+                                        (unsigned long)histogram->get_bucket(k));
+            if (item_length < (int)sizeof(item))
+                item_length += snprintf(item + item_length, sizeof(item) - item_length, "]");
+            break;
+        }
+        }
+
+        // 放不下（含換行與 NUL）就停在完整指標邊界
+        if (item_length >= (int)sizeof(item) || length + item_length + 2 > size)
+            break;
+        memcpy(buffer + length, item, item_length);
+        length += item_length;
+    }
+
+    if (length + 2 > size)
+        length = size - 2;
+    buffer[length++] = '\n';
+    buffer[length] = 0;
+    return length;
+}
+
+size_t MetricsRegistry::snapshot_binary(uint8_t *buffer, size_t size) const
+{
+    const size_t header_size = 6; // SYNC + 長度 u16 + 版本 + 指標數 u16
+    if (size < header_size)
+        return 0;
+
+    size_t length = header_size;
+    uint16_t written = 0;
+    for (const Metric *metric = head; metric; metric = metric->next)
+    {
+        size_t name_size = strlen(metric->name) + 1;
+        size_t payload = metric->type == METRIC_HISTOGRAM
+                             ? 1 + used_buckets(static_cast<const MetricHistogram *>(metric)) * sizeof(uint32_t)
+                             : sizeof(uint32_t);
+        if (length + 1 + name_size + payload > size)
+            break;
+
+        buffer[length++] = (uint8_t)metric->type;
+        memcpy(buffer + length, metric->name, name_size);
+        length += name_size;
+
+        if (metric->type == METRIC_HISTOGRAM)
+        {
+            const MetricHistogram *histogram = static_cast<const MetricHistogram *>(metric);
+            uint8_t used = (uint8_t)used_buckets(histogram);
+            buffer[length++] = used;
+            for (int k = 0; k < used; k++)
+            {
+                uint32_t value = histogram->get_bucket(k);
+                memcpy(buffer + length, &value, sizeof(value));
+                length += sizeof(value);
+            }
+        }
+        else
+        {
+            uint32_t value = metric->type == METRIC_COUNTER ? static_cast<const MetricCounter *>(metric)->get()
+                                                            : (uint32_t) static_cast<const MetricGauge *>(metric)->get();
+            memcpy(buffer + length, &value, sizeof(value));
+            length += sizeof(value);
+        }
+        written++;
+    }
+
+    // 長度欄位不含 SYNC 與長度本身
+    uint16_t body = (uint16_t)(length - 3);
+    buffer[0] = METRICS_SNAPSHOT_SYNC;
+    memcpy(buffer + 1, &body, sizeof(body));
+    buffer[3] = METRICS_SNAPSHOT_VERSION;
+    memcpy(buffer + 4, &written, sizeof(written));
+    return length;
+}
+
+void MetricsRegistry::emit_snapshot(bool binary) const
+{
+    static char buffer[METRICS_SNAPSHOT_BUFFER_SIZE];
+    size_t length = binary ? snapshot_binary((uint8_t *)buffer, sizeof(buffer)) : snapshot_text(buffer, sizeof(buffer));
+
+    // 依序分段寫入，輸出端按順序接回
+    for (size_t offset = 0; offset < length; offset += ASYNC_LOG_RECORD_SIZE)
+    {
+        size_t chunk = length - offset < ASYNC_LOG_RECORD_SIZE ? length - offset : ASYNC_LOG_RECORD_SIZE;
+        async_log.write(buffer + offset, chunk);
+    }
+}
+
+void MetricsRegistry::print(const DebugPrint &out) const
+{
+    out.printf("📈 指標: %u 個\n", (unsigned)count);
+    for (const Metric *metric = head; metric; metric = metric->next)
+    {
+        switch (metric->type)
+        {
+        case METRIC_COUNTER:
+            out.printf("  %-24s %lu\n", metric->name, (unsigned long)static_cast<const MetricCounter *>(metric)->get());
+            break;
+        case METRIC_GAUGE:
+            out.printf("  %-24s %ld\n", metric->name, (long)static_cast<const MetricGauge *>(metric)->get());
+            break;
+        default:
+        {
+            // 整行組好再輸出（每次 printf 都會加上模組名稱前綴）
+            const MetricHistogram *histogram = static_cast<const MetricHistogram *>(metric);
+            char line[200];
+            int length = 0;
+            for (int k = 0; k < used_buckets(histogram) && length < (int)sizeof(line); k++)
+            {
+                if (histogram->get_bucket(k))
+                    length += snprintf(line + length, sizeof(line) - length, " [%lu+]:%lu", k ? 1UL << k : 0UL,
+                                       (unsigned long)histogram->get_bucket(k));
+            }
+            line[length < (int)sizeof(line) ? length : sizeof(line) - 1] = 0;
+            out.printf("  %-24s n=%lu%s\n", metric->name, (unsigned long)histogram->get_count(), line);
+            break;
+        }
+        }
+    }
+}
+
+void MetricsRegistry::reset_all()
+{
+    for (Metric *metric = head; metric; metric = metric->next)
+    {
+        switch (metric->type)
+        {
+        case METRIC_COUNTER: static_cast<MetricCounter *>(metric)->reset(); break;
+        case METRIC_GAUGE: static_cast<MetricGauge *>(metric)->reset(); break;
+        default: static_cast<MetricHistogram *>(metric)->reset(); break;
+        }
+    }
+}
@@ -0,0 +1,349 @@
+#include "mfcc.h"
+#include <math.h>
+#include <string.h>
+
+// 數學常數
+#ifndef PI
+#define PI 3.14159265359f
+#endif
+
+#define LN2 0.69314718056f
+#define LN2_Q15 22713 // ln(2) * 2^15
+#define LOG_TABLE_SIZE (1 << MFCC_LOG_TABLE_BITS)
+
+// 差分回歸分母 2 * sum(n^2), n = 1..N
+static const int DELTA_DENOM = MFCC_DELTA_WINDOW * (MFCC_DELTA_WINDOW + 1) * (2 * MFCC_DELTA_WINDOW + 1) / 3;
+
+static float hz_to_mel(float hz)
+{
+    return 2595.0f * log10f(1.0f + hz / 700.0f);
+}
+
+static float mel_to_hz(float mel)
+{
+    return 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f);
+}
+
+MfccExtractor::MfccExtractor()
+{
+    build_filterbank();
+    build_dct_table();
+    build_log_table();
+    reset();
+}
+
+/**
+ * 建立三角濾波器組（梅爾刻度等距）
+ * 相鄰濾波器以彼此中心為邊界，因此每個頻點的上升與下降權重和為 1
+ */
+void MfccExtractor::build_filterbank()
+{
+    // 濾波器邊界點（以頻點為單位的分數位置），共 MFCC_NUM_FILTERS + 2 個
+    float points[MFCC_NUM_FILTERS + 2];
+    float mel_low = hz_to_mel(MFCC_LOW_FREQ);
+    float mel_high = hz_to_mel(MFCC_HIGH_FREQ);
+    for (int i = 0; i < MFCC_NUM_FILTERS + 2; i++)
+    {
+        float mel = mel_low + (mel_high - mel_low) * i / (MFCC_NUM_FILTERS + 1);
+        points[i] = mel_to_hz(mel) * SPECTRAL_FFT_SIZE / SPECTRAL_SAMPLE_RATE;
+    }
+
+    first_bin = SPECTRAL_NUM_BINS;
+    last_bin = 0;
+    int channel = 0;
+    for (int k = 0; k < SPECTRAL_NUM_BINS; k++)
+    {
+        bin_channel[k] = -1;
+        bin_weight[k] = 0.0f;
+        bin_weight_q12[k] = 0;
+
+        if (k < points[0] || k >= points[MFCC_NUM_FILTERS + 1])
+            continue;
+
+        while (channel < MFCC_NUM_FILTERS && k >= points[channel + 1])
+            channel++;
+
+        float w = (k - points[channel]) / (points[channel + 1] - points[channel]);
+        bin_channel[k] = (int8_t)channel;
+        bin_weight[k] = w;
+        bin_weight_q12[k] = (uint16_t)(w * (1 << MFCC_WEIGHT_FRAC_BITS) + 0.5f);
+
+        if (k < first_bin)
+            first_bin = k;
+        last_bin = k;
+    }
+}
+
+/**
+ * 建立正交 DCT-II 表
+ */
+void MfccExtractor::build_dct_table()
+{
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        float scale = sqrtf((k == 0 ? 1.0f : 2.0f) / MFCC_NUM_FILTERS);
+        for (int j = 0; j < MFCC_NUM_FILTERS; j++)
+        {
+            float value = scale * cosf(PI * k * (j + 0.5f) / MFCC_NUM_FILTERS);
+            dct_table[k][j] = value;
+            dct_table_q15[k][j] = (int16_t)lroundf(value * 32767.0f);
+        }
+    }
+}
+
+/**
+ * 建立 log2 尾數表（取區間中點以減半最大誤差）
+ */
+void MfccExtractor::build_log_table()
+{
+    for (int i = 0; i < LOG_TABLE_SIZE; i++)
+    {
+        float value = log2f(1.0f + (i + 0.5f) / LOG_TABLE_SIZE);
+        log2_table[i] = value;
+        log2_table_q10[i] = (uint16_t)(value * (1 << MFCC_FIXED_FRAC_BITS) + 0.5f);
+    }
+}
+
+void MfccExtractor::reset()
+{
+    memset(coeff_history, 0, sizeof(coeff_history));
+    memset(delta_history, 0, sizeof(delta_history));
+    history_head = 0;
+    history_primed = false;
+
+    memset(coeff_history_q, 0, sizeof(coeff_history_q));
+    memset(delta_history_q, 0, sizeof(delta_history_q));
+    history_head_q = 0;
+    history_primed_q = false;
+
+    last_cycles = 0;
+    total_cycles = 0;
+    frame_count = 0;
+}
+
+/**
+ * 查表自然對數：指數直接取自 IEEE-754 位元，尾數查 log2 表
+ */
+float MfccExtractor::fast_log(float x) const
+{
+    if (!(x > MFCC_LOG_FLOOR))
+        x = MFCC_LOG_FLOOR;
+
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int exponent = (int)((bits >> 23) & 0xFF) - 127;
+    uint32_t index = (bits >> (23 - MFCC_LOG_TABLE_BITS)) & (LOG_TABLE_SIZE - 1);
+
+    return (exponent + log2_table[index]) * LN2;
+}
+
+/**
+ * 定點自然對數 (Q10)：最高位元位置加尾數查表
+ */
+int32_t MfccExtractor::fixed_log_q10(uint64_t x) const
+{
+    if (x == 0)
+        x = 1;
+
+    int msb = 63 - __builtin_clzll(x);
+    uint32_t index;
+    if (msb >= MFCC_LOG_TABLE_BITS)
+        index = (uint32_t)(x >> (msb - MFCC_LOG_TABLE_BITS)) & (LOG_TABLE_SIZE - 1);
+    else
+        index = (uint32_t)(x << (MFCC_LOG_TABLE_BITS - msb)) & (LOG_TABLE_SIZE - 1);
+
+    int32_t log2_q10 = (msb << MFCC_FIXED_FRAC_BITS) + log2_table_q10[index];
+    return (log2_q10 * LN2_Q15) >> 15;
+}
+
+void MfccExtractor::compute_mel_energies(const float *power, float *mel_energies) const
+{
+    // 多一格承接最後一個濾波器上方的上升段（丟棄）
+    float acc[MFCC_NUM_FILTERS + 1];
+    memset(acc, 0, sizeof(acc));
+
+    for (int k = first_bin; k <= last_bin; k++)
+    {
+        int channel = bin_channel[k];
+        float p = power[k];
+        float rising = bin_weight[k] * p;
+
+        acc[channel] += rising;
+        if (channel > 0)
+            acc[channel - 1] += p - rising;
+    }
+
+    memcpy(mel_energies, acc, MFCC_NUM_FILTERS * sizeof(float));
+}
+
+void MfccExtractor::compute_from_mel(const float *mel_energies, MfccFeatures *features)
+{
+    uint32_t start_cycles = ESP.getCycleCount();
+
+    float log_mel[MFCC_NUM_FILTERS];
+    for (int j = 0; j < MFCC_NUM_FILTERS; j++)
+    {
+        log_mel[j] = fast_log(mel_energies[j]);
+    }
+
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        float sum = 0.0f;
+        for (int j = 0; j < MFCC_NUM_FILTERS; j++)
+        {
+            sum += dct_table[k][j] * log_mel[j];
+        }
+        features->coeffs[k] = sum;
+    }
+
+    // 寫入係數歷史；重置後第一幀填滿整個窗（邊界複製），差分從 0 開始
+    history_head = (history_head + 1) % MFCC_HISTORY_SIZE;
+    if (!history_primed)
+    {
+        for (int h = 0; h < MFCC_HISTORY_SIZE; h++)
+            memcpy(coeff_history[h], features->coeffs, sizeof(features->coeffs));
+    }
+    else
+    {
+        memcpy(coeff_history[history_head], features->coeffs, sizeof(features->coeffs));
+    }
+
+    // 回歸差分：中心為 MFCC_DELTA_WINDOW 幀之前
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        float sum = 0.0f;
+        for (int n = 1; n <= MFCC_DELTA_WINDOW; n++)
+        {
+            int newer = (history_head - (MFCC_DELTA_WINDOW - n) + MFCC_HISTORY_SIZE) % MFCC_HISTORY_SIZE;
+            int older = (history_head - (MFCC_DELTA_WINDOW + n) + MFCC_HISTORY_SIZE) % MFCC_HISTORY_SIZE;
+            sum += n * (coeff_history[newer][k] - coeff_history[older][k]);
+        }
+        features->delta[k] = sum / DELTA_DENOM;
+    }
+
+    if (!history_primed)
+    {
+        for (int h = 0; h < MFCC_HISTORY_SIZE; h++)
+            memcpy(delta_history[h], features->delta, sizeof(features->delta));
+        history_primed = true;
+    }
+    else
+    {
+        memcpy(delta_history[history_head], features->delta, sizeof(features->delta));
+    }
+
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        float sum = 0.0f;
+        for (int n = 1; n <= MFCC_DELTA_WINDOW; n++)
+        {
+            int newer = (history_head - (MFCC_DELTA_WINDOW - n) + MFCC_HISTORY_SIZE) % MFCC_HISTORY_SIZE;
+            int older = (history_head - (MFCC_DELTA_WINDOW + n) + MFCC_HISTORY_SIZE) % MFCC_HISTORY_SIZE;
+            sum += n * (delta_history[newer][k] - delta_history[older][k]);
+        }
+        features->delta2[k] = sum / DELTA_DENOM;
+    }
+
+    last_cycles = ESP.getCycleCount() - start_cycles;
+    total_cycles += last_cycles;
+    frame_count++;
+}
+
+void MfccExtractor::compute(const float *power, MfccFeatures *features)
+{
+    float mel_energies[MFCC_NUM_FILTERS];
+    compute_mel_energies(power, mel_energies);
+    compute_from_mel(mel_energies, features);
+}
+
+void MfccExtractor::compute_mel_energies_fixed(const uint32_t *power, uint64_t *mel_energies) const
+{
+    uint64_t acc[MFCC_NUM_FILTERS + 1];
+    memset(acc, 0, sizeof(acc));
+
+    for (int k = first_bin; k <= last_bin; k++)
+    {
+        int channel = bin_channel[k];
+        uint64_t p = power[k];
+        uint64_t rising = p * bin_weight_q12[k];
+
+        acc[channel] += rising;
+        if (channel > 0)
+            acc[channel - 1] += (p << MFCC_WEIGHT_FRAC_BITS) - rising;
+    }
+
+    // 結果保留 Q12，對數後只影響 c0 的常數偏移
+    memcpy(mel_energies, acc, MFCC_NUM_FILTERS * sizeof(uint64_t));
+}
+
+void MfccExtractor::compute_from_mel_fixed(const uint64_t *mel_energies, MfccFixedFeatures *features)
+{
+    int32_t log_mel[MFCC_NUM_FILTERS];
+    for (int j = 0; j < MFCC_NUM_FILTERS; j++)
+    {
+        log_mel[j] = fixed_log_q10(mel_energies[j]);
+    }
+
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        int64_t sum = 0;
+        for (int j = 0; j < MFCC_NUM_FILTERS; j++)
+        {
+            sum += (int32_t)dct_table_q15[k][j] * log_mel[j];
+        }
+        features->coeffs[k] = (int32_t)(sum >> 15);
+    }
+
+    history_head_q = (history_head_q + 1) % MFCC_HISTORY_SIZE;
+    if (!history_primed_q)
+    {
+        for (int h = 0; h < MFCC_HISTORY_SIZE; h++)
+            memcpy(coeff_history_q[h], features->coeffs, sizeof(features->coeffs));
+    }
+    else
+    {
+        memcpy(coeff_history_q[history_head_q], features->coeffs, sizeof(features->coeffs));
+    }
+
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        int32_t sum = 0;
+        for (int n = 1; n <= MFCC_DELTA_WINDOW; n++)
+        {
+            int newer = (history_head_q - (MFCC_DELTA_WINDOW - n) + MFCC_HISTORY_SIZE) % MFCC_HISTORY_SIZE;
+            int older = (history_head_q - (MFCC_DELTA_WINDOW + n) + MFCC_HISTORY_SIZE) % MFCC_HISTORY_SIZE;
+            sum += n * (coeff_history_q[newer][k] - coeff_history_q[older][k]);
+        }
+        features->delta[k] = sum / DELTA_DENOM;
+    }
+
+    if (!history_primed_q)
+    {
+        for (int h = 0; h < MFCC_HISTORY_SIZE; h++)
+            memcpy(delta_history_q[h], features->delta, sizeof(features->delta));
+        history_primed_q = true;
+    }
+    else
+    {
+        memcpy(delta_history_q[history_head_q], features->delta, sizeof(features->delta));
+    }
+
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        int32_t sum = 0;
+        for (int n = 1; n <= MFCC_DELTA_WINDOW; n++)
+        {
+            int newer = (history_head_q - (MFCC_DELTA_WINDOW - n) + MFCC_HISTORY_SIZE) % MFCC_HISTORY_SIZE;
+            int older = (history_head_q - (MFCC_DELTA_WINDOW + n) + MFCC_HISTORY_SIZE) % MFCC_HISTORY_SIZE;
+            sum += n * (delta_history_q[newer][k] - delta_history_q[older][k]);
+        }
+        features->delta2[k] = sum / DELTA_DENOM;
+    }
+}
+
+void MfccExtractor::compute_fixed(const uint32_t *power, MfccFixedFeatures *features)
+{
+    uint64_t mel_energies[MFCC_NUM_FILTERS];
+    compute_mel_energies_fixed(power, mel_energies);
+    compute_from_mel_fixed(mel_energies, features);
+}
@@ -0,0 +1,154 @@
+#include "noise_suppression.h"
+#include <math.h>
+#include <string.h>
+
+#define LUT_STEPS (1 << NS_PCAN_LUT_STEP_BITS)
+
+NoiseSuppressor::NoiseSuppressor() : pcan_enabled(true)
+{
+    even_smoothing = (uint16_t)(NS_EVEN_SMOOTHING * (1 << NS_NOISE_BITS) + 0.5f);
+    odd_smoothing = (uint16_t)(NS_ODD_SMOOTHING * (1 << NS_NOISE_BITS) + 0.5f);
+    min_signal_remaining = (uint16_t)(NS_MIN_SIGNAL_REMAINING * (1 << NS_NOISE_BITS) + 0.5f);
+
+    build_gain_lut();
+    reset();
+}
+
+void NoiseSuppressor::reset()
+{
+    memset(noise_estimate, 0, sizeof(noise_estimate));
+    primed = false;
+    energy_ratio = 1.0f;
+
+    last_cycles = 0;
+    total_cycles = 0;
+    frame_count = 0;
+}
+
+/**
+ * 建立 PCAN 增益表 gain(x) = (x + offset)^-strength (Q21)
+ * x >= 2^LUT_STEP_BITS 時以 (8 + frac) << (octave - 3) 為取樣點
+ */
+void NoiseSuppressor::build_gain_lut()
+{
+    const float scale = (float)(1 << NS_PCAN_GAIN_BITS);
+
+    for (int x = 0; x < LUT_STEPS; x++)
+    {
+        small_gain_lut[x] = (uint16_t)(scale * powf(x + NS_PCAN_OFFSET, -NS_PCAN_STRENGTH) + 0.5f);
+    }
+
+    for (int i = 0; i < NS_PCAN_LUT_SIZE; i++)
+    {
+        int octave = i / LUT_STEPS + NS_PCAN_LUT_STEP_BITS;
+        int frac = i % LUT_STEPS;
+        double x = ldexp((double)(LUT_STEPS + frac), octave - NS_PCAN_LUT_STEP_BITS);
+        gain_lut[i] = (uint16_t)(scale * pow(x + NS_PCAN_OFFSET, -NS_PCAN_STRENGTH) + 0.5);
+    }
+}
+
+/**
+ * 查表並在相鄰取樣點間線性內插
+ */
+uint32_t NoiseSuppressor::lookup_gain(uint32_t noise) const
+{
+    if (noise < LUT_STEPS)
+        return small_gain_lut[noise];
+
+    int msb = 31 - __builtin_clz(noise);
+    int shift = msb - NS_PCAN_LUT_STEP_BITS;
+    int index = shift * LUT_STEPS + ((noise >> shift) & (LUT_STEPS - 1));
+    uint32_t remainder = noise & ((1u << shift) - 1);
+
+    int32_t g0 = gain_lut[index];
+    int32_t g1 = gain_lut[index + 1];
+    return (uint32_t)(g0 + (int32_t)(((int64_t)(g1 - g0) * remainder) >> shift));
+}
+
+/**
+ * SNR 壓縮：低 SNR 以平方壓抑，高 SNR 近似線性
+ */
+uint32_t NoiseSuppressor::pcan_shrink(uint64_t snr)
+{
+    if (snr < (2u << NS_PCAN_SNR_BITS))
+        return (uint32_t)((snr * snr) >> (2 + 2 * NS_PCAN_SNR_BITS - NS_PCAN_OUTPUT_BITS));
+
+    uint64_t output = (snr >> (NS_PCAN_SNR_BITS - NS_PCAN_OUTPUT_BITS)) - (1u << NS_PCAN_OUTPUT_BITS);
+    return output > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)output;
+}
+
+void NoiseSuppressor::process_fixed(uint32_t *mel_energies)
+{
+    uint32_t start_cycles = ESP.getCycleCount();
+
+    // 第一幀直接作為噪音初值，避免開機時估計從 0 緩慢爬升
+    if (!primed)
+    {
+        for (int i = 0; i < MFCC_NUM_FILTERS; i++)
+            noise_estimate[i] = (uint64_t)mel_energies[i] << NS_SMOOTHING_BITS;
+        primed = true;
+    }
+
+    uint64_t sum_in = 0;
+    uint64_t sum_out = 0;
+
+    for (int i = 0; i < MFCC_NUM_FILTERS; i++)
+    {
+        uint32_t smoothing = (i & 1) ? odd_smoothing : even_smoothing;
+        uint64_t signal_scaled = (uint64_t)mel_energies[i] << NS_SMOOTHING_BITS;
+
+        // 訊號明顯高於噪音（多半是語音）時放慢上升，避免語音被當成噪音減掉
+        if (signal_scaled > (noise_estimate[i] << NS_SPEECH_RATIO_SHIFT))
+            smoothing >>= NS_SPEECH_SMOOTHING_SHIFT;
+        uint32_t one_minus_smoothing = (1 << NS_NOISE_BITS) - smoothing;
+
+        // 更新噪音估計
+        uint64_t estimate = (signal_scaled * smoothing + noise_estimate[i] * one_minus_smoothing) >> NS_NOISE_BITS;
+        noise_estimate[i] = estimate;
+
+        // 頻譜減法，保留最低比例
+        if (estimate > signal_scaled)
+            estimate = signal_scaled;
+        uint32_t floor = (uint32_t)(((uint64_t)mel_energies[i] * min_signal_remaining) >> NS_NOISE_BITS);
+        uint32_t subtracted = (uint32_t)((signal_scaled - estimate) >> NS_SMOOTHING_BITS);
+        uint32_t output = subtracted > floor ? subtracted : floor;
+
+        sum_in += mel_energies[i];
+        sum_out += output;
+
+        // PCAN：以噪音估計正規化每通道增益
+        if (pcan_enabled)
+        {
+            uint32_t gain = lookup_gain((uint32_t)(noise_estimate[i] >> NS_SMOOTHING_BITS));
+            uint64_t snr = ((uint64_t)output * gain) >> (NS_PCAN_GAIN_BITS - NS_PCAN_SNR_BITS);
+            output = pcan_shrink(snr);
+        }
+
+        mel_energies[i] = output;
+    }
+
+    energy_ratio = sum_in ? (float)sum_out / (float)sum_in : 1.0f;
+
+    last_cycles = ESP.getCycleCount() - start_cycles;
+    total_cycles += last_cycles;
+    frame_count++;
+}
+
+void NoiseSuppressor::process(float *mel_energies)
+{
+    uint32_t fixed[MFCC_NUM_FILTERS];
+    for (int i = 0; i < MFCC_NUM_FILTERS; i++)
+    {
+        float scaled = mel_energies[i] * NS_INPUT_SCALE;
+        fixed[i] = (scaled >= 4294967040.0f) ? 0xFFFFFFFFu : (uint32_t)scaled;
+    }
+
+    process_fixed(fixed);
+
+    // PCAN 輸出為 Q6 SNR；加一個 LSB 讓對數有下限
+    const float output_scale = pcan_enabled ? 1.0f / (1 << NS_PCAN_OUTPUT_BITS) : 1.0f / NS_INPUT_SCALE;
+    for (int i = 0; i < MFCC_NUM_FILTERS; i++)
+    {
+        mel_energies[i] = (fixed[i] + 1.0f) * output_scale;
+    }
+}
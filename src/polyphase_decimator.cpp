@@ -0,0 +1,138 @@
+#include "polyphase_decimator.h"
+#include <math.h>
+#include <string.h>
+
+#define SAMPLE_24BIT_MAX 8388607
+#define SAMPLE_24BIT_MIN (-8388608)
+
+/**
+ * 第一類零階修正 Bessel 函數（Kaiser 窗用）
+ */
+static double bessel_i0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    double half = x / 2.0;
+    for (int k = 1; k < 30; k++)
+    {
+        term *= (half / k) * (half / k);
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+PolyphaseDecimator::PolyphaseDecimator() : factor(1), num_taps(0)
+{
+    memset(coeffs, 0, sizeof(coeffs));
+    reset();
+}
+
+void PolyphaseDecimator::reset()
+{
+    memset(history, 0, sizeof(history));
+    history_pos = 0;
+    phase = 0;
+
+    last_cycles = 0;
+    total_cycles = 0;
+    output_count = 0;
+}
+
+bool PolyphaseDecimator::configure(int decimation_factor)
+{
+    if (decimation_factor < 1 || decimation_factor > DECIMATOR_MAX_FACTOR)
+        return false;
+
+    factor = decimation_factor;
+    num_taps = (factor > 1) ? factor * DECIMATOR_TAPS_PER_PHASE : 0;
+    phase = 0;
+
+    if (factor > 1)
+        design_filter();
+    return true;
+}
+
+/**
+ * Kaiser 窗 sinc 低通，截止於輸出 Nyquist（輸入取樣率的 1/(2M)）
+ * 量化後把誤差補到中央係數，確保 DC 增益剛好為 1
+ */
+void PolyphaseDecimator::design_filter()
+{
+    const double cutoff = 0.5 / factor; // 相對輸入取樣率
+    const double center = (num_taps - 1) / 2.0;
+    const double beta = DECIMATOR_KAISER_BETA;
+    const double window_norm = bessel_i0(beta);
+    const double scale = (double)(1 << DECIMATOR_COEFF_BITS);
+
+    int32_t sum = 0;
+    for (int n = 0; n < num_taps / 2; n++)
+    {
+        double t = n - center;
+        double sinc = 2.0 * cutoff * sin(2.0 * PI * cutoff * t) / (2.0 * PI * cutoff * t);
+        double r = t / center;
+        double window = bessel_i0(beta * sqrt(1.0 - r * r)) / window_norm;
+        coeffs[n] = (int16_t)lround(sinc * window * scale);
+        sum += 2 * coeffs[n];
+    }
+
+    // 偶數長度沒有單一中央係數，誤差平均分給最靠近中央的一對
+    coeffs[num_taps / 2 - 1] += (int16_t)(((1 << DECIMATOR_COEFF_BITS) - sum) / 2);
+}
+
+int16_t PolyphaseDecimator::get_coefficient(int index) const
+{
+    if (index < 0 || index >= num_taps)
+        return 0;
+    return coeffs[index < num_taps / 2 ? index : num_taps - 1 - index];
+}
+
+size_t PolyphaseDecimator::process(const int32_t *input, size_t length, int32_t *output)
+{
+    if (factor == 1)
+    {
+        if (output != input)
+            memmove(output, input, length * sizeof(int32_t));
+        return length;
+    }
+
+    uint32_t start_cycles = ESP.getCycleCount();
+    const int half_taps = num_taps / 2;
+    size_t produced = 0;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        int32_t sample = input[i] >> 8;
+        history[history_pos] = sample;
+        history[history_pos + DECIMATOR_MAX_TAPS] = sample;
+        if (++history_pos == DECIMATOR_MAX_TAPS)
+            history_pos = 0;
+
+        if (++phase < factor)
+            continue;
+        phase = 0;
+
+        // 最新 num_taps 個樣本在雙寫緩衝區中連續存放
+        const int32_t *window = history + history_pos + DECIMATOR_MAX_TAPS - num_taps;
+        int64_t acc = 1 << (DECIMATOR_COEFF_BITS - 1);
+        for (int k = 0; k < half_taps; k++)
+        {
+            acc += (int64_t)(window[k] + window[num_taps - 1 - k]) * coeffs[k];
+        }
+
+        int32_t value = (int32_t)(acc >> DECIMATOR_COEFF_BITS);
+        if (value > SAMPLE_24BIT_MAX)
+            value = SAMPLE_24BIT_MAX;
+        else if (value < SAMPLE_24BIT_MIN)
+            value = SAMPLE_24BIT_MIN;
+
+        // 輸出索引永遠不超過輸入索引，可原地處理
+        output[produced++] = value * 256;
+    }
+
+    last_cycles = ESP.getCycleCount() - start_cycles;
+    total_cycles += last_cycles;
+    output_count += produced;
+    return produced;
+}
@@ -0,0 +1,51 @@
+#include "sample_clock.h"
+#include "esp_timer.h"
+
+SampleClock::SampleClock() : sample_rate(16000), samples(0), start_us(0), origin_us(0)
+{
+}
+
+void SampleClock::start(uint32_t rate)
+{
+    sample_rate = rate ? rate : 1;
+    samples = 0;
+    start_us = esp_timer_get_time();
+    origin_us = start_us;
+}
+
+sample_time_t SampleClock::advance(uint32_t ticks)
+{
+    sample_time_t timestamp = samples;
+    samples += ticks;
+    return timestamp;
+}
+
+uint32_t SampleClock::to_ms(sample_time_t duration) const
+{
+    return (uint32_t)(duration * 1000 / sample_rate);
+}
+
+uint64_t SampleClock::to_us(sample_time_t duration) const
+{
+    return duration * 1000000 / sample_rate;
+}
+
+sample_time_t SampleClock::from_ms(uint32_t ms) const
+{
+    return (sample_time_t)ms * sample_rate / 1000;
+}
+
+int64_t SampleClock::to_wall_us(sample_time_t timestamp) const
+{
+    return origin_us + (int64_t)to_us(timestamp);
+}
+
+int64_t SampleClock::resync(sample_time_t timestamp, int64_t earliest_wall_us)
+{
+    int64_t shift = earliest_wall_us - to_wall_us(timestamp);
+    if (shift <= 0)
+        return 0;
+
+    origin_us += shift;
+    return shift;
+}
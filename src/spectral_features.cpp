@@ -0,0 +1,193 @@
+#include "spectral_features.h"
+#include <math.h>
+#include <string.h>
+
+// 數學常數
+#ifndef PI
+#define PI 3.14159265359f
+#endif
+
+#define FFT_HALF (SPECTRAL_FFT_SIZE / 2)
+
+SpectralAnalyzer::SpectralAnalyzer()
+{
+    // 旋轉因子 W_N^k = exp(-2*pi*i*k/N)
+    for (int k = 0; k < FFT_HALF; k++)
+    {
+        twiddle_re[k] = cosf(2.0f * PI * k / SPECTRAL_FFT_SIZE);
+        twiddle_im[k] = -sinf(2.0f * PI * k / SPECTRAL_FFT_SIZE);
+    }
+
+    // N/2 點複數 FFT 的位元反轉索引
+    int bits = 0;
+    while ((1 << bits) < FFT_HALF)
+        bits++;
+    for (int i = 0; i < FFT_HALF; i++)
+    {
+        int r = 0;
+        for (int b = 0; b < bits; b++)
+        {
+            if (i & (1 << b))
+                r |= 1 << (bits - 1 - b);
+        }
+        bit_reverse[i] = (uint8_t)r;
+    }
+
+    // 頻帶邊界換算為頻點
+    const int edges_hz[SPECTRAL_BAND_COUNT + 1] = SPECTRAL_BAND_EDGES;
+    for (int b = 0; b <= SPECTRAL_BAND_COUNT; b++)
+    {
+        band_edges[b] = edges_hz[b] * SPECTRAL_FFT_SIZE / SPECTRAL_SAMPLE_RATE;
+    }
+    band_edges[SPECTRAL_BAND_COUNT] = SPECTRAL_NUM_BINS; // 最後一個頻帶包含 Nyquist
+
+    reset();
+}
+
+void SpectralAnalyzer::reset()
+{
+    memset(power, 0, sizeof(power));
+    memset(magnitude, 0, sizeof(magnitude));
+    memset(prev_magnitude, 0, sizeof(prev_magnitude));
+    has_previous = false;
+
+    last_cycles = 0;
+    total_cycles = 0;
+    frame_count = 0;
+}
+
+/**
+ * 以 N/2 點複數 FFT 計算 N 點實數 FFT 的功率譜
+ * 偶數樣本作實部、奇數樣本作虛部，再以分離步驟還原
+ */
+void SpectralAnalyzer::compute_power_spectrum(const float *frame)
+{
+    // 打包並位元反轉
+    for (int i = 0; i < FFT_HALF; i++)
+    {
+        int r = bit_reverse[i];
+        fft_re[r] = frame[2 * i];
+        fft_im[r] = frame[2 * i + 1];
+    }
+
+    // 基 2 蝶形運算；W_{N/2}^j = W_N^{2j}
+    for (int size = 2; size <= FFT_HALF; size <<= 1)
+    {
+        int half = size >> 1;
+        int step = SPECTRAL_FFT_SIZE / size;
+
+        for (int start = 0; start < FFT_HALF; start += size)
+        {
+            for (int j = 0; j < half; j++)
+            {
+                float wr = twiddle_re[j * step];
+                float wi = twiddle_im[j * step];
+
+                int a = start + j;
+                int b = a + half;
+
+                float tr = fft_re[b] * wr - fft_im[b] * wi;
+                float ti = fft_re[b] * wi + fft_im[b] * wr;
+
+                fft_re[b] = fft_re[a] - tr;
+                fft_im[b] = fft_im[a] - ti;
+                fft_re[a] += tr;
+                fft_im[a] += ti;
+            }
+        }
+    }
+
+    // 分離步驟：X[k] = Fe[k] + W_N^k * Fo[k]
+    float dc = fft_re[0] + fft_im[0];
+    float nyquist = fft_re[0] - fft_im[0];
+    power[0] = dc * dc;
+    power[FFT_HALF] = nyquist * nyquist;
+
+    for (int k = 1; k < FFT_HALF; k++)
+    {
+        float zr = fft_re[k];
+        float zi = fft_im[k];
+        float cr = fft_re[FFT_HALF - k];
+        float ci = -fft_im[FFT_HALF - k]; // conj(Z[N/2-k])
+
+        float fe_re = 0.5f * (zr + cr);
+        float fe_im = 0.5f * (zi + ci);
+        // Fo = (Z - conj) / 2i
+        float fo_re = 0.5f * (zi - ci);
+        float fo_im = -0.5f * (zr - cr);
+
+        float wr = twiddle_re[k];
+        float wi = twiddle_im[k];
+
+        float xr = fe_re + (fo_re * wr - fo_im * wi);
+        float xi = fe_im + (fo_re * wi + fo_im * wr);
+
+        power[k] = xr * xr + xi * xi;
+    }
+}
+
+void SpectralAnalyzer::analyze(const float *frame, SpectralFeatures *features)
+{
+    uint32_t start_cycles = ESP.getCycleCount();
+
+    compute_power_spectrum(frame);
+
+    float total = 0.0f;
+    float weighted = 0.0f;
+    float log_sum = 0.0f;
+    float flux = 0.0f;
+
+    for (int k = 0; k < SPECTRAL_NUM_BINS; k++)
+    {
+        float p = power[k];
+        total += p;
+        weighted += k * p;
+        log_sum += logf(p + 1e-12f);
+
+        magnitude[k] = sqrtf(p);
+        if (has_previous)
+        {
+            float d = magnitude[k] - prev_magnitude[k];
+            flux += d * d;
+        }
+    }
+
+    // 頻譜重心與平坦度
+    float mean_power = total / SPECTRAL_NUM_BINS;
+    features->centroid = (total > 0.0f) ? (weighted / total) / FFT_HALF : 0.0f;
+    features->flatness = expf(log_sum / SPECTRAL_NUM_BINS) / (mean_power + 1e-12f);
+    features->flux = sqrtf(flux);
+
+    // 滾降點：累積能量達到總能量 85% 的最低頻點
+    float target = SPECTRAL_ROLLOFF_RATIO * total;
+    float cumulative = 0.0f;
+    int rolloff_bin = 0;
+    for (int k = 0; k < SPECTRAL_NUM_BINS; k++)
+    {
+        cumulative += power[k];
+        if (cumulative >= target)
+        {
+            rolloff_bin = k;
+            break;
+        }
+    }
+    features->rolloff = (total > 0.0f) ? (float)rolloff_bin / FFT_HALF : 0.0f;
+
+    // 頻帶能量
+    for (int b = 0; b < SPECTRAL_BAND_COUNT; b++)
+    {
+        float sum = 0.0f;
+        for (int k = band_edges[b]; k < band_edges[b + 1]; k++)
+        {
+            sum += power[k];
+        }
+        features->band_energy[b] = sum;
+    }
+
+    memcpy(prev_magnitude, magnitude, sizeof(magnitude));
+    has_previous = true;
+
+    last_cycles = ESP.getCycleCount() - start_cycles;
+    total_cycles += last_cycles;
+    frame_count++;
+}
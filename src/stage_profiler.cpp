@@ -0,0 +1,130 @@
+#include "stage_profiler.h"
+#include "trace_recorder.h"
+
+#if PROFILER_ENABLED
+
+#include <string.h>
+
+// 全域實例
+StageProfiler stage_profiler;
+
+StageProfiler::StageProfiler()
+{
+    reset();
+}
+
+void StageProfiler::reset()
+{
+    memset(stages, 0, sizeof(stages));
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++)
+        stages[s].min = UINT32_MAX;
+}
+
+/**
+ * 對數直方圖桶：小於 4 的值各佔一桶，之後每個 2 的冪次分 4 個子區間
+ */
+int StageProfiler::bucket_index(uint32_t ticks)
+{
+    if (ticks < PROFILER_SUB_BUCKETS)
+        return (int)ticks;
+
+    int msb = 31 - __builtin_clz(ticks);
+    int sub = (ticks >> (msb - PROFILER_SUB_BUCKET_BITS)) & (PROFILER_SUB_BUCKETS - 1);
+    int index = (msb - PROFILER_SUB_BUCKET_BITS + 1) * PROFILER_SUB_BUCKETS + sub;
+    return index < PROFILER_BUCKETS ? index : PROFILER_BUCKETS - 1;
+}
+
+uint32_t StageProfiler::bucket_upper_bound(int index)
+{
+    if (index < PROFILER_SUB_BUCKETS)
+        return (uint32_t)index;
+    if (index == PROFILER_BUCKETS - 1)
+        return UINT32_MAX; // 最後一桶收容所有超出範圍的值
+
+    int msb = index / PROFILER_SUB_BUCKETS + PROFILER_SUB_BUCKET_BITS - 1;
+    int sub = index % PROFILER_SUB_BUCKETS;
+    int width_bits = msb - PROFILER_SUB_BUCKET_BITS;
+    return ((uint32_t)(PROFILER_SUB_BUCKETS + sub) << width_bits) + (1u << width_bits) - 1;
+}
+
+void StageProfiler::record(ProfileStage stage, uint32_t ticks)
+{
+    StageData &data = stages[stage];
+    data.count++;
+    data.total += ticks;
+    if (ticks < data.min)
+        data.min = ticks;
+    if (ticks > data.max)
+        data.max = ticks;
+    data.histogram[bucket_index(ticks)]++;
+}
+
+void StageProfiler::record_span(ProfileStage stage, uint32_t start, uint32_t end)
+{
+    record(stage, end - start);
+#if TRACE_ENABLED
+    trace.span(stage, start, end);
+#endif
+}
+
+StageProfiler::StageStats StageProfiler::get_stats(ProfileStage stage) const
+{
+    const StageData &data = stages[stage];
+    StageStats stats = {0, 0, 0, 0, 0};
+    if (data.count == 0)
+        return stats;
+
+    stats.count = data.count;
+    stats.min = data.min;
+    stats.max = data.max;
+    stats.mean = (uint32_t)(data.total / data.count);
+
+    // 累計到 99% 的桶，以其上界估計 p99
+    uint32_t target = data.count - data.count / 100;
+    uint32_t cumulative = 0;
+    for (int i = 0; i < PROFILER_BUCKETS; i++)
+    {
+        cumulative += data.histogram[i];
+        if (cumulative >= target)
+        {
+            stats.p99 = min(bucket_upper_bound(i), data.max);
+            break;
+        }
+    }
+    return stats;
+}
+
+void StageProfiler::print(const DebugPrint &out) const
+{
+    const float ticks_per_us = (float)profiler_ticks_per_us();
+
+    out.print("⏱️  階段耗時 (µs)          次數      min     mean      p99      max");
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++)
+    {
+        StageStats stats = get_stats((ProfileStage)s);
+        if (stats.count == 0)
+            continue;
+        out.printf("  %-22s %8lu %8.1f %8.1f %8.1f %8.1f\n", stage_name((ProfileStage)s), (unsigned long)stats.count,
+                   stats.min / ticks_per_us, stats.mean / ticks_per_us, stats.p99 / ticks_per_us,
+                   stats.max / ticks_per_us);
+    }
+}
+
+const char *StageProfiler::stage_name(ProfileStage stage)
+{
+    switch (stage)
+    {
+    case PROFILE_STAGE_BEAMFORM: return "beamform";
+    case PROFILE_STAGE_DECIMATE: return "decimate";
+    case PROFILE_STAGE_CONVERT: return "convert_audio_data";
+    case PROFILE_STAGE_FRAME: return "get_current_frame";
+    case PROFILE_STAGE_GATE: return "energy_gate";
+    case PROFILE_STAGE_FEATURES: return "extract_audio_features";
+    case PROFILE_STAGE_VAD: return "process_vad";
+    case PROFILE_STAGE_KEYWORD: return "keyword_detect";
+    case PROFILE_STAGE_CALLBACK: return "callbacks";
+    default: return "unknown";
+    }
+}
+
+#endif // PROFILER_ENABLED
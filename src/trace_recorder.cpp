@@ -0,0 +1,154 @@
+#include "trace_recorder.h"
+
+#if TRACE_ENABLED
+
+#include "async_log.h"
+#include <string.h>
+
+// 全域實例（開機即開始記錄）
+TraceRecorder trace;
+
+TraceRecorder::TraceRecorder()
+    : head(0), origin(0), recording(false), trigger_armed(false), trigger_fired(false), stop_at(0), sample_rate(16000)
+{
+    memset(events, 0, sizeof(events));
+    start();
+}
+
+uint8_t TraceRecorder::current_core()
+{
+#if defined(ESP_PLATFORM)
+    return (uint8_t)xPortGetCoreID();
+#else
+    return 0;
+#endif
+}
+
+void TraceRecorder::start()
+{
+    recording.store(false, std::memory_order_relaxed);
+    origin = head.load(std::memory_order_relaxed);
+    trigger_armed.store(false, std::memory_order_relaxed);
+    trigger_fired.store(false, std::memory_order_relaxed);
+    recording.store(true, std::memory_order_relaxed);
+}
+
+void TraceRecorder::fire()
+{
+    if (!trigger_armed.exchange(false, std::memory_order_relaxed))
+        return;
+    stop_at.store(head.load(std::memory_order_relaxed) + TRACE_TRIGGER_POST_EVENTS, std::memory_order_relaxed);
+    trigger_fired.store(true, std::memory_order_relaxed);
+}
+
+/**
+ * 最後一筆有效事件之後的位置（觸發停止後 stop_at 之後的位置未寫入）
+ */
+static uint32_t valid_end(uint32_t head, bool fired, uint32_t stop_at)
+{
+    return (fired && (int32_t)(head - stop_at) > 0) ? stop_at : head;
+}
+
+uint32_t TraceRecorder::size() const
+{
+    uint32_t end = valid_end(head.load(std::memory_order_relaxed), has_fired(), stop_at.load(std::memory_order_relaxed));
+    uint32_t total = end - origin;
+    return total < TRACE_RING_EVENTS ? total : TRACE_RING_EVENTS;
+}
+
+uint32_t TraceRecorder::lost() const
+{
+    uint32_t end = valid_end(head.load(std::memory_order_relaxed), has_fired(), stop_at.load(std::memory_order_relaxed));
+    return end - origin - size();
+}
+
+const TraceEvent &TraceRecorder::get_event(uint32_t index) const
+{
+    uint32_t end = valid_end(head.load(std::memory_order_relaxed), has_fired(), stop_at.load(std::memory_order_relaxed));
+    return events[(end - size() + index) & TRACE_RING_MASK];
+}
+
+const char *TraceRecorder::event_name(uint8_t id)
+{
+    if (id < PROFILE_STAGE_COUNT)
+    {
+#if PROFILER_ENABLED
+        return StageProfiler::stage_name((ProfileStage)id);
+#else
+        return "stage";
+#endif
+    }
+
+    switch (id)
+    {
+    case TRACE_EVENT_CAPTURE: return "capture";
+    case TRACE_EVENT_HOP: return "hop";
+    case TRACE_EVENT_VAD_STATE: return "vad_state";
+    case TRACE_EVENT_DETECTION: return "detection";
+    case TRACE_EVENT_DEADLINE_MISS: return "deadline_miss";
+    case TRACE_EVENT_SERIAL: return "serial";
+    case TRACE_EVENT_SAMPLE_CLOCK: return "sample_clock";
+    default: return "unknown";
+    }
+}
+
+/**
+ * 寫入一段傾印；非同步日誌緩衝區滿時由呼叫端自行輸出後重試，確保不遺失也不交錯
+ */
+static void write_chunk(const uint8_t *data, size_t length)
+{
+    while (!async_log.write((const char *)data, length))
+        async_log.flush();
+}
+
+size_t TraceRecorder::dump()
+{
+    stop();
+
+    uint32_t count = size();
+    uint32_t lost_events = lost();
+    uint32_t ticks_per_us = profiler_ticks_per_us();
+
+    // 標頭與名稱表（事件名稱最長約 24 bytes，TRACE_EVENT_COUNT 筆）
+    uint8_t header[16 + TRACE_EVENT_COUNT * 24];
+    size_t length = 6;
+    memcpy(header + length, &ticks_per_us, 4);
+    memcpy(header + length + 4, &sample_rate, 4);
+    memcpy(header + length + 8, &count, 4);
+    memcpy(header + length + 12, &lost_events, 4);
+    length += 16;
+    header[length++] = TRACE_EVENT_COUNT;
+    for (int id = 0; id < TRACE_EVENT_COUNT; id++)
+    {
+        size_t name_size = strlen(event_name(id)) + 1;
+        if (length + name_size > sizeof(header))
+            name_size = 1; // 不應發生；以空名稱保持格式
+        memcpy(header + length, name_size > 1 ? event_name(id) : "", name_size);
+        length += name_size;
+    }
+
+    uint32_t body = (uint32_t)(length - 6 + count * sizeof(TraceEvent));
+    header[0] = TRACE_DUMP_SYNC;
+    header[1] = TRACE_DUMP_VERSION;
+    memcpy(header + 2, &body, 4);
+
+    // 標頭可能超過一筆日誌的長度
+    for (size_t offset = 0; offset < length; offset += ASYNC_LOG_RECORD_SIZE)
+        write_chunk(header + offset, min(length - offset, (size_t)ASYNC_LOG_RECORD_SIZE));
+
+    // 事件由舊到新，每段最多 ASYNC_LOG_RECORD_SIZE bytes
+    const uint32_t per_chunk = ASYNC_LOG_RECORD_SIZE / sizeof(TraceEvent);
+    TraceEvent chunk[per_chunk];
+    for (uint32_t index = 0; index < count; index += per_chunk)
+    {
+        uint32_t n = min(per_chunk, count - index);
+        for (uint32_t k = 0; k < n; k++)
+            chunk[k] = get_event(index + k);
+        write_chunk((const uint8_t *)chunk, n * sizeof(TraceEvent));
+    }
+    async_log.flush();
+
+    return length + count * sizeof(TraceEvent);
+}
+
+#endif // TRACE_ENABLED
@@ -92,10 +92,12 @@ float VoiceModel::calculate_spectral_score(float zcr, float spectral_centroid)
         zcr_score = 0.2f; // 可能是噪音
     }
 
-    // 語音的頻譜重心通常平衡
-    if (spectral_centroid >= 0.2f && spectral_centroid <= 0.8f)
+    // 語音的頻譜重心通常落在 400Hz~3.6kHz，以 1.6kHz 附近最典型
+    if (spectral_centroid >= SPEECH_CENTROID_MIN && spectral_centroid <= SPEECH_CENTROID_MAX)
     {
-        centroid_score = 1.0f - abs_f(spectral_centroid - 0.5f) * 2.0f;
+        float half_range = (spectral_centroid < SPEECH_CENTROID_CENTER) ?
+            (SPEECH_CENTROID_CENTER - SPEECH_CENTROID_MIN) : (SPEECH_CENTROID_MAX - SPEECH_CENTROID_CENTER);
+        centroid_score = 1.0f - abs_f(spectral_centroid - SPEECH_CENTROID_CENTER) / half_range;
     }
 
     return (zcr_score + centroid_score) / 2.0f;
@@ -0,0 +1,155 @@
+/**
+ * 非同步日誌測試
+ * 1. begin() 之前同步輸出，之後寫入緩衝區、drain() 才輸出
+ * 2. 緩衝區滿時丟棄並計數，不阻塞
+ * 3. 過長訊息截斷計數
+ * 4. 寫入成本（不含輸出）
+ *
+ * 主機上 begin() 不建立輸出任務，由測試手動 drain()；
+ * 裝置上輸出任務會同時輸出，依賴 pending() 的檢查只在主機上執行
+ * ASYNC_LOG_ENABLED=0 時一律同步輸出、沒有緩衝區可測，只輸出略過訊息
+ */
+
+#include <Arduino.h>
+#include "async_log.h"
+#include "test_check.h"
+
+#define COST_RUNS 200
+
+#if ASYNC_LOG_ENABLED
+
+DebugPrint debug_test("AsyncLog", true);
+
+void begin_buffered()
+{
+    async_log.begin();
+    async_log.flush();
+    async_log.reset_stats();
+}
+
+void test_sync_before_begin()
+{
+    Serial.println("=== 測試 begin() 前同步輸出 ===");
+
+    debug_test.printf("同步輸出 %d\n", 1);
+    check("未啟用時不進緩衝區", !async_log.is_running() && async_log.pending() == 0, async_log.pending());
+}
+
+void test_buffered()
+{
+    Serial.println("=== 測試緩衝輸出 ===");
+
+    begin_buffered();
+    debug_test.printf("緩衝訊息 %d\n", 1);
+    debug_test.info("緩衝訊息 2");
+    debug_test.warning("緩衝訊息 3");
+
+    AsyncLog::AsyncLogStats stats = async_log.get_stats();
+    check("寫入 3 筆", stats.written == 3, stats.written);
+
+#if !defined(ESP_PLATFORM)
+    check("drain 前尚未輸出", async_log.pending() == 3, async_log.pending());
+#endif
+    async_log.flush();
+    stats = async_log.get_stats();
+    check("flush 後全部輸出", stats.drained == 3 && async_log.pending() == 0, stats.drained);
+}
+
+void test_overflow()
+{
+    Serial.println("=== 測試緩衝區滿 ===");
+
+    begin_buffered();
+#if !defined(ESP_PLATFORM)
+    // 不輸出，連續寫入超過容量
+    uint32_t start = micros();
+    for (int i = 0; i < ASYNC_LOG_SLOTS + 10; i++)
+        debug_test.printf("溢位測試 %d\n", i);
+    uint32_t elapsed = micros() - start;
+
+    AsyncLog::AsyncLogStats stats = async_log.get_stats();
+    check("寫入 = 容量", stats.written == ASYNC_LOG_SLOTS, stats.written);
+    check("丟棄 10 筆", stats.dropped == 10, stats.dropped);
+    check("最高使用 = 容量", stats.max_depth == ASYNC_LOG_SLOTS, stats.max_depth);
+    check("緩衝區滿時仍不阻塞（< 1 ms）", elapsed < 1000, elapsed);
+
+    // 輸出後附帶遺失提示，緩衝區可再寫入
+    async_log.flush();
+    check("輸出後可再寫入", async_log.write("恢復\n", strlen("恢復\n")), 1);
+    async_log.flush();
+#endif
+}
+
+void test_truncation()
+{
+    Serial.println("=== 測試過長訊息截斷 ===");
+
+    begin_buffered();
+    char line[400];
+    size_t length = 0;
+    while (length + 3 < sizeof(line) - 1)
+    {
+        memcpy(line + length, "音", 3); // 3 位元組 UTF-8
+        length += 3;
+    }
+    line[length++] = '\n';
+
+    async_log.write(line, length);
+    AsyncLog::AsyncLogStats stats = async_log.get_stats();
+    check("截斷 1 筆", stats.truncated == 1, stats.truncated);
+    async_log.flush();
+}
+
+void test_write_cost()
+{
+    Serial.println("=== 寫入成本 ===");
+
+    begin_buffered();
+    uint32_t total_us = 0;
+    for (int i = 0; i < COST_RUNS; i++)
+    {
+        uint32_t start = micros();
+        debug_test.printf("成本 %d RMS:%.3f\n", i, 0.125f);
+        total_us += micros() - start;
+
+        // 每滿半個緩衝區輸出一次（計時之外）
+        if (async_log.pending() >= ASYNC_LOG_SLOTS / 2)
+            async_log.flush();
+    }
+    async_log.flush();
+
+    float per_call_us = total_us / (float)COST_RUNS;
+    Serial.printf("    每次 printf（格式化 + 寫入緩衝區）: %.2f µs\n", per_call_us);
+    check("每次 < 50 µs", per_call_us < 50.0f, per_call_us);
+    check("沒有遺失", async_log.get_stats().dropped == 0, async_log.get_stats().dropped);
+
+    async_log.print_stats(debug_test);
+    async_log.end();
+}
+
+void setup()
+{
+    test_begin("非同步日誌測試");
+
+    test_sync_before_begin();
+    test_buffered();
+    test_overflow();
+    test_truncation();
+    test_write_cost();
+
+    test_end();
+}
+
+#else
+
+void setup()
+{
+    test_skip("ASYNC_LOG_ENABLED=0，非同步日誌停用");
+}
+
+#endif // ASYNC_LOG_ENABLED
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,171 @@
+/**
+ * 串流音量統計測試（合成原始樣本，可在主機上執行）
+ * 1. 正弦波 RMS / 峰值 dBFS
+ * 2. DC 平均值（DC 阻隔停用）
+ * 3. 視窗 min/max 只描述最近一個完整視窗
+ * 4. 飽和計數、累計樣本數
+ * 5. 轉換額外成本與查詢成本（與舊的逐樣本掃描比較）
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "inmp441_module.h"
+#include "test_check.h"
+
+#define BLOCK 512
+#define COST_RUNS 200
+
+INMP441Module mic;
+int32_t raw[BLOCK];
+audio_sample_t output[BLOCK];
+
+/**
+ * 固定增益 G = 64：16-bit 輸出 = 24-bit 樣本 / 4
+ */
+void configure()
+{
+    INMP441Config config = INMP441Module::create_default_config();
+    config.dc_block_coeff = 0;
+    config.pre_emphasis_coeff = 0;
+    config.agc_enabled = false;
+    mic.set_config(config);
+    mic.reset_statistics();
+}
+
+/**
+ * 以 16-bit 刻度的偏移與振幅產生一個區塊（500 Hz，每區塊整數週期）
+ */
+void feed(int32_t offset, float amplitude, int blocks)
+{
+    for (int b = 0; b < blocks; b++)
+    {
+        for (int n = 0; n < BLOCK; n++)
+        {
+            int32_t value = offset + (int32_t)lroundf(amplitude * sinf(2.0f * PI * 500.0f * n / INMP441_SAMPLE_RATE));
+            raw[n] = value * 4 * 256;
+        }
+        mic.process_raw_samples(raw, output, BLOCK);
+    }
+}
+
+void test_levels()
+{
+    Serial.println("=== 測試 RMS / 峰值 ===");
+
+    configure();
+    feed(0, 16384.0f, 1);
+    AudioLevelMeter::Stats stats = mic.get_level_stats();
+    check("峰值 16384", abs(stats.block_peak - 16384) <= 1, stats.block_peak);
+    check("峰值 -6.0 dBFS", fabsf(stats.block_peak_dbfs + 6.02f) < 0.1f, stats.block_peak_dbfs);
+    check("正弦波 RMS -9.0 dBFS", fabsf(stats.block_rms_dbfs + 9.03f) < 0.1f, stats.block_rms_dbfs);
+
+    feed(0, 0.0f, 1);
+    stats = mic.get_level_stats();
+    check("靜音回報下限", stats.block_rms_dbfs == LEVEL_METER_FLOOR_DBFS, stats.block_rms_dbfs);
+}
+
+void test_dc()
+{
+    Serial.println("=== 測試 DC 平均 ===");
+
+    configure();
+    feed(-300, 1000.0f, 4);
+    AudioLevelMeter::Stats stats = mic.get_level_stats();
+    check("DC = -300", fabsf(stats.window_dc + 300.0f) < 1.0f, stats.window_dc);
+    check("部分視窗：min = -1300", stats.window_min == -1300, stats.window_min);
+    check("部分視窗：max = 700", stats.window_max == 700, stats.window_max);
+}
+
+void test_window()
+{
+    Serial.println("=== 測試視窗 min/max ===");
+
+    configure();
+    mic.set_level_window_ms(64); // 1024 樣本 = 2 個區塊
+
+    feed(0, 20000.0f, 2); // 第一個視窗：大聲
+    feed(0, 100.0f, 2);   // 第二個視窗：小聲
+    AudioLevelMeter::Stats stats = mic.get_level_stats();
+    check("視窗樣本數 = 1024", stats.window_samples == 1024, stats.window_samples);
+    check("大聲視窗已被取代", stats.window_max == 100, stats.window_max);
+    check("peak hold 保留 20000", stats.peak_hold == 20000, stats.peak_hold);
+
+    feed(0, 20000.0f, 1); // 累積中的視窗不影響已完成的視窗
+    stats = mic.get_level_stats();
+    check("累積中不影響回報", stats.window_max == 100, stats.window_max);
+
+    mic.set_level_window_ms(LEVEL_METER_WINDOW_MS);
+}
+
+void test_clipping()
+{
+    Serial.println("=== 測試飽和與樣本數 ===");
+
+    configure();
+    feed(0, 40000.0f, 3);
+    AudioLevelMeter::Stats stats = mic.get_level_stats();
+    INMP441Module::INMP441Stats capture = mic.get_statistics();
+    check("飽和數與 INMP441 統計一致", stats.clipped_samples == capture.clipped_samples && stats.clipped_samples > 0,
+          stats.clipped_samples);
+    check("峰值為滿刻度", stats.block_peak == INT16_MAX + 1 || stats.block_peak == INT16_MAX, stats.block_peak);
+    check("累計樣本數", stats.total_samples == 3 * BLOCK, (float)stats.total_samples);
+}
+
+void test_cost()
+{
+    Serial.println("=== 成本 ===");
+
+    configure();
+    feed(0, 8000.0f, 1);
+
+    uint32_t start = micros();
+    for (int i = 0; i < COST_RUNS; i++)
+        mic.process_raw_samples(raw, output, BLOCK);
+    float convert_ns = (micros() - start) * 1000.0f / (COST_RUNS * BLOCK);
+
+    // 舊做法：每次查詢掃描整個區塊
+    volatile int64_t sink = 0;
+    start = micros();
+    for (int i = 0; i < COST_RUNS; i++)
+    {
+        int32_t min_val = output[0];
+        int32_t max_val = output[0];
+        int64_t sum = 0;
+        for (int n = 0; n < BLOCK; n++)
+        {
+            int16_t sample = audio_sample_to_q15(output[n]);
+            if (sample < min_val) min_val = sample;
+            if (sample > max_val) max_val = sample;
+            sum += abs(sample);
+        }
+        sink = sink + min_val + max_val + sum;
+    }
+    float scan_ns = (micros() - start) * 1000.0f / COST_RUNS;
+
+    start = micros();
+    for (int i = 0; i < COST_RUNS; i++)
+        sink = sink + mic.get_level_stats().window_max;
+    float query_ns = (micros() - start) * 1000.0f / COST_RUNS;
+
+    Serial.printf("    轉換 %.1f ns/樣本（含累加），舊掃描 %.0f ns/次，O(1) 查詢 %.0f ns/次\n", convert_ns, scan_ns,
+                  query_ns);
+    check("查詢比掃描快", query_ns < scan_ns, scan_ns / (query_ns > 0.0f ? query_ns : 1.0f));
+}
+
+void setup()
+{
+    test_begin("串流音量統計測試");
+
+    test_levels();
+    test_dc();
+    test_window();
+    test_clipping();
+    test_cost();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,213 @@
+/**
+ * 延遲相加波束成形器測試（合成延遲聲源）
+ * 1. 兩聲道間延遲 -3..+3 樣本時估計出正確的導向延遲
+ * 2. 聲道間不相關噪音下，輸出 SNR 提升約 3 dB
+ * 3. 不規則區塊大小與原地處理結果逐樣本相同
+ * 4. 每個輸入樣本 cycles 在預算之內
+ * 5. INMP441Module 立體聲配置：波束成形 + 3:1 抽取後的輸出樣本數
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "beamformer.h"
+#include "inmp441_module.h"
+#include "test_check.h"
+
+#define CAPTURE_RATE 48000
+#define TEST_FRAMES 48000  // 1 秒
+#define SOURCE_OFFSET 8    // 聲源緩衝區前後預留，用於平移
+#define SIGNAL_AMPLITUDE 1048576.0f  // 24-bit，約 -18 dBFS
+#define SETTLE_FRAMES 4096           // 導向收斂前的樣本不計入 SNR
+
+DelayAndSumBeamformer beamformer;
+float source[TEST_FRAMES + 2 * SOURCE_OFFSET];
+float noise_left[TEST_FRAMES];
+float noise_right[TEST_FRAMES];
+int32_t stereo[2 * TEST_FRAMES];
+int32_t output[2 * TEST_FRAMES];
+int32_t output_blocks[2 * TEST_FRAMES];
+
+/**
+ * 固定種子的均勻分布噪音，範圍 [-1, 1)
+ */
+uint32_t rng_state = 12345;
+float next_noise()
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (int32_t)rng_state / 2147483648.0f;
+}
+
+void make_signals()
+{
+    for (int n = 0; n < TEST_FRAMES + 2 * SOURCE_OFFSET; n++)
+        source[n] = next_noise() * SIGNAL_AMPLITUDE;
+    for (int n = 0; n < TEST_FRAMES; n++)
+    {
+        noise_left[n] = next_noise() * SIGNAL_AMPLITUDE;
+        noise_right[n] = next_noise() * SIGNAL_AMPLITUDE;
+    }
+}
+
+/**
+ * 合成立體聲錄音：右聲道比左聲道晚 delay 個樣本到達（delay < 0 則左聲道較晚）
+ * L[n] = s[n] + nL[n]，R[n] = s[n - delay] + nR[n]，I2S 32-bit 容器格式
+ */
+void make_recording(int delay, float noise_scale)
+{
+    for (int n = 0; n < TEST_FRAMES; n++)
+    {
+        float left = source[n + SOURCE_OFFSET] + noise_scale * noise_left[n];
+        float right = source[n + SOURCE_OFFSET - delay] + noise_scale * noise_right[n];
+        stereo[2 * n] = (int32_t)lroundf(left) * 256;
+        stereo[2 * n + 1] = (int32_t)lroundf(right) * 256;
+    }
+}
+
+void test_steering_estimate()
+{
+    Serial.println("=== 測試導向延遲估計（0 dB SNR）===");
+
+    int wrong = 0;
+    for (int delay = -3; delay <= 3; delay++)
+    {
+        make_recording(delay, 1.0f);
+        beamformer.set_adaptive_steering();
+        beamformer.reset();
+        beamformer.process(stereo, TEST_FRAMES, output);
+        int estimate = beamformer.get_steering_delay();
+        Serial.printf("    真實延遲 %+d → 估計 %+d\n", delay, estimate);
+        if (estimate != delay)
+            wrong++;
+    }
+    check("估計錯誤次數", wrong == 0, wrong);
+}
+
+/**
+ * 輸出減去對齊後的聲源即為殘餘噪音
+ */
+float measure_snr_gain(int delay)
+{
+    make_recording(delay, 1.0f);
+    beamformer.set_adaptive_steering();
+    beamformer.reset();
+    beamformer.process(stereo, TEST_FRAMES, output);
+
+    // 對齊的聲源：延遲較早到達的聲道之後，兩者都等於 s[n - max(delay, 0)]
+    const int shift = delay > 0 ? delay : 0;
+    double signal_power = 0.0;
+    double residual_power = 0.0;
+    double input_noise_power = 0.0;
+    for (int n = SETTLE_FRAMES; n < TEST_FRAMES; n++)
+    {
+        double s = source[n + SOURCE_OFFSET - shift];
+        double residual = output[n] / 256.0 - s;
+        signal_power += s * s;
+        residual_power += residual * residual;
+        input_noise_power += (double)noise_left[n] * noise_left[n];
+    }
+
+    double input_snr = 10.0 * log10(signal_power / input_noise_power);
+    double output_snr = 10.0 * log10(signal_power / residual_power);
+    return (float)(output_snr - input_snr);
+}
+
+void test_snr_gain()
+{
+    Serial.println("=== 測試 SNR 提升（不相關噪音）===");
+
+    float worst = 100.0f;
+    for (int delay = -2; delay <= 2; delay += 2)
+    {
+        float gain = measure_snr_gain(delay);
+        Serial.printf("    延遲 %+d: SNR 提升 %.2f dB\n", delay, gain);
+        if (gain < worst)
+            worst = gain;
+    }
+    check("最小 SNR 提升 dB > 2.5", worst > 2.5f, worst);
+}
+
+void test_block_invariance()
+{
+    Serial.println("=== 測試區塊不變性 ===");
+
+    make_recording(2, 0.5f);
+    beamformer.set_adaptive_steering();
+    beamformer.reset();
+    beamformer.process(stereo, TEST_FRAMES, output);
+
+    // 不規則區塊 + 原地處理（輸出寫在該區塊輸入的起點）
+    memcpy(output_blocks, stereo, sizeof(stereo));
+    beamformer.set_adaptive_steering();
+    beamformer.reset();
+    const int sizes[] = {1, 3, 255, 256, 7, 1024};
+    size_t pos = 0;
+    int k = 0;
+    while (pos < TEST_FRAMES)
+    {
+        size_t frames = min((size_t)sizes[k++ % 6], (size_t)TEST_FRAMES - pos);
+        memmove(output_blocks + pos, output_blocks + 2 * pos, 2 * frames * sizeof(int32_t));
+        beamformer.process(output_blocks + pos, frames, output_blocks + pos);
+        pos += frames;
+    }
+
+    int mismatches = 0;
+    for (int n = 0; n < TEST_FRAMES; n++)
+    {
+        if (output[n] != output_blocks[n])
+            mismatches++;
+    }
+    check("不一致樣本數", mismatches == 0, mismatches);
+}
+
+void test_cycles()
+{
+    Serial.println("=== 每個輸入樣本 cycles ===");
+
+    make_recording(1, 1.0f);
+    beamformer.set_adaptive_steering();
+    beamformer.reset();
+    for (int repeat = 0; repeat < 20; repeat++)
+    {
+        for (int offset = 0; offset < TEST_FRAMES; offset += 384)
+            beamformer.process(stereo + 2 * offset, 384, output);
+    }
+
+    uint32_t per_sample = beamformer.get_average_cycles_per_sample();
+    Serial.printf("    %lu cycles/樣本, %lu cycles/秒音訊（48kHz）, 超出預算 %lu 次\n", (unsigned long)per_sample,
+                  (unsigned long)(per_sample * CAPTURE_RATE), (unsigned long)beamformer.get_over_budget_calls());
+    check("cycles/樣本 <= 預算", per_sample <= BEAMFORMER_CYCLE_BUDGET, per_sample);
+}
+
+void test_inmp441_stereo()
+{
+    Serial.println("=== 測試 INMP441 立體聲處理鏈 ===");
+
+    static INMP441Module mic;
+    static audio_sample_t samples[TEST_FRAMES];
+
+    make_recording(-2, 1.0f);
+    mic.set_config(INMP441Module::create_stereo_config());
+    size_t count = mic.process_raw_samples(stereo, samples, 2 * TEST_FRAMES);
+
+    check("輸出樣本數 = 48000 / 3", count == TEST_FRAMES / INMP441_OVERSAMPLE_FACTOR, count);
+    check("估計延遲 = -2", mic.get_beamformer().get_steering_delay() == -2, mic.get_beamformer().get_steering_delay());
+}
+
+void setup()
+{
+    test_begin("延遲相加波束成形器測試");
+
+    make_signals();
+    test_steering_estimate();
+    test_snr_gain();
+    test_block_invariance();
+    test_cycles();
+    test_inmp441_stereo();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,99 @@
+/**
+ * 擷取健康監測測試（裝置需接上 INMP441；主機以手動時鐘執行，時間只由 delay() 推進，結果可重現）
+ * 1. 正常讀取：實際取樣率接近標稱值，無 DMA 溢位、無遺失
+ * 2. 主迴圈過慢（超過 DMA 緩衝時間）：偵測到溢位並估計遺失樣本
+ * 3. 讀取耗時直方圖與最大間隔
+ */
+
+#include <Arduino.h>
+#include "inmp441_module.h"
+#include "host_sim.h"
+#include "test_check.h"
+
+#define NORMAL_RUN_MS 2000
+#define SLOW_LOOP_MS 100   // 大於 DMA 緩衝時間（8 × 64 樣本 / 16kHz = 32 ms）
+#define SLOW_LOOP_COUNT 20
+
+INMP441Module mic;
+audio_sample_t samples[INMP441_BUFFER_SIZE];
+
+void print_histogram(const INMP441Module::INMP441Stats &stats)
+{
+    for (int k = 0; k < INMP441_LATENCY_BUCKETS; k++)
+    {
+        if (stats.read_latency_hist[k])
+            Serial.printf("    [%lu, %lu) µs: %lu\n", k ? 1UL << k : 0UL, 2UL << k, (unsigned long)stats.read_latency_hist[k]);
+    }
+}
+
+void test_normal_capture()
+{
+    Serial.println("=== 測試正常讀取 ===");
+
+    mic.start();
+    unsigned long start = millis();
+    while (millis() - start < NORMAL_RUN_MS)
+    {
+        mic.read_audio_data(samples, INMP441_BUFFER_SIZE);
+        delay(5);
+    }
+
+    INMP441Module::INMP441Stats stats = mic.get_statistics();
+    Serial.printf("    運行 %lu ms，輸出 %.1f samples/sec，I2S %.1f Hz，空讀取 %lu 次\n", stats.uptime_ms,
+                  stats.samples_per_second, stats.capture_rate, (unsigned long)stats.empty_reads);
+    print_histogram(stats);
+
+    check("實際取樣率誤差 < 2%", fabsf(stats.samples_per_second - INMP441_SAMPLE_RATE) < INMP441_SAMPLE_RATE * 0.02f,
+          stats.samples_per_second);
+    check("DMA 溢位次數 = 0", stats.dma_overflows == 0, stats.dma_overflows);
+    check("估計遺失樣本 < 1 個 DMA 緩衝", stats.dropped_samples < INMP441_DMA_BUF_LEN, stats.dropped_samples);
+    check("最大讀取間隔 < 32 ms", stats.max_read_gap_us < 32000, stats.max_read_gap_us);
+    mic.stop();
+}
+
+void test_slow_loop()
+{
+    Serial.println("=== 測試主迴圈過慢 ===");
+
+    mic.start();
+    for (int i = 0; i < SLOW_LOOP_COUNT; i++)
+    {
+        mic.read_audio_data(samples, INMP441_BUFFER_SIZE);
+        delay(SLOW_LOOP_MS);
+    }
+
+    INMP441Module::INMP441Stats stats = mic.get_statistics();
+    Serial.printf("    溢位 %lu 次，估計遺失 %llu 樣本，最大間隔 %lu µs\n", (unsigned long)stats.dma_overflows,
+                  (unsigned long long)stats.dropped_samples, (unsigned long)stats.max_read_gap_us);
+
+    // 每次最多讀 512 樣本（32 ms），其餘 68 ms 的樣本必然遺失
+    const float expected_drop = SLOW_LOOP_COUNT * (SLOW_LOOP_MS - 32) * INMP441_SAMPLE_RATE / 1000.0f;
+    check("偵測到 DMA 溢位", stats.dma_overflows > 0, stats.dma_overflows);
+    check("估計遺失 > 預期的一半", stats.dropped_samples > expected_drop * 0.5f, stats.dropped_samples);
+    check("最大讀取間隔 >= 100 ms", stats.max_read_gap_us >= SLOW_LOOP_MS * 1000, stats.max_read_gap_us);
+    mic.stop();
+}
+
+void setup()
+{
+    test_begin("擷取健康監測測試");
+
+    // 溢位由 delay() 的長度決定，不受主機排程或負載影響
+    host_clock_set_mode(HOST_CLOCK_MANUAL);
+
+    if (!mic.initialize())
+    {
+        Serial.println("❌ INMP441 初始化失敗");
+        return;
+    }
+
+    test_normal_capture();
+    test_slow_loop();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
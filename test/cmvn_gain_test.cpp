@@ -0,0 +1,327 @@
+/**
+ * CMVN 增益穩定性測試
+ * 1. CmvnNormalizer 本身：增益在對數梅爾頻譜上是常數偏移，只改變 c0 與 RMS，
+ *    以不同偏移更新背景統計後，語音幀的正規化結果應相同
+ * 2. 整條 AudioCaptureModule：同一段合成語句（背景噪音 + 諧波語音）以 -12 ~ +12 dB 增益經主機 I2S 送入，
+ *    前端（DC 阻隔、預強調、能量閘門、噪音抑制）與 CMVN 的更新/凍結都由模組本身依 VAD 狀態決定。
+ *    比較模組收集的語音段平均特徵（CMVN 正規化後）與相同幀未正規化的平均，以及關鍵字判決。
+ *    a. 線性前端（關閉兩段式處理與噪音抑制）：每個 hop 都更新 CMVN，增益只是對數域偏移，
+ *       正規化係數與 0 dB 的差異應小於 0.05（實測約 0.01）
+ *    b. 完整前端：能量閘門是絕對門檻，不同增益下參與 CMVN 更新的背景 hop 不同；
+ *       PCAN 偏移也不隨增益縮放，c0 因此差到數個標準差。只要求能量與關鍵字判決不變且不是未知
+ *    AGC 停用（否則增益在 CMVN 之前就被抵消），VAD 使用 GMM 引擎（相對噪音判決，低增益時仍能觸發）。
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "host_sim.h"
+#include "audio_module.h"
+#include "keyword_model.h"
+#include "test_check.h"
+
+#define TEST_NOISE_LEAD_HOPS 375    // 語音前的背景 hop 數（3 秒，GMM 學習與 CMVN 暖機）
+#define TEST_SPEECH_HOPS 100        // 語音 hop 數（0.8 秒）
+#define TEST_RAMP_HOPS 4            // 語音漸入/漸出 hop 數
+#define TEST_NOISE_TAIL_HOPS 60     // 語音後的背景，讓 VAD 結束語音段
+#define TEST_TOTAL_SAMPLES ((TEST_NOISE_LEAD_HOPS + TEST_SPEECH_HOPS + TEST_NOISE_TAIL_HOPS) * AUDIO_FRAME_HOP)
+
+static const int kGainsDb[] = {-12, -6, 0, 6, 12};
+static const int kGainCount = sizeof(kGainsDb) / sizeof(kGainsDb[0]);
+
+struct GainResult
+{
+    AudioFeatures raw;
+    AudioFeatures normalized;
+    KeywordClass raw_keyword;
+    KeywordClass normalized_keyword;
+    int segments;
+};
+
+GainResult results[kGainCount];
+
+// ========== CmvnNormalizer ==========
+
+/**
+ * 背景幀：固定平均加上亂數擾動；c0 與 RMS 依增益偏移/縮放
+ */
+void make_frame(MfccFeatures *mfcc, float *rms, uint32_t *state, float gain_db, bool speech)
+{
+    memset(mfcc, 0, sizeof(*mfcc));
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+    {
+        *state = *state * 1664525u + 1013904223u;
+        float jitter = ((int32_t)*state / 2147483648.0f) * 0.8f;
+        mfcc->coeffs[k] = (speech ? 2.0f - 0.3f * k : -1.0f + 0.1f * k) + jitter;
+    }
+    // 每 dB 對 c0 的偏移量不影響結論，取 0.25
+    mfcc->coeffs[0] += 0.25f * gain_db;
+    *rms = (speech ? 0.02f : 0.002f) * powf(10.0f, gain_db / 20.0f);
+}
+
+void test_normalizer()
+{
+    Serial.println("=== 測試 CmvnNormalizer 增益不變性 ===");
+
+    float reference[MFCC_NUM_COEFFS];
+    float reference_rms = 0.0f;
+    float worst_coeff = 0.0f;
+    float worst_energy = 0.0f;
+    for (int g = 0; g < kGainCount; g++)
+    {
+        CmvnNormalizer normalizer;
+        MfccFeatures mfcc;
+        float rms;
+        uint32_t state = 5;
+        for (int f = 0; f < 300; f++)
+        {
+            make_frame(&mfcc, &rms, &state, kGainsDb[g], false);
+            normalizer.update(mfcc, rms);
+        }
+
+        make_frame(&mfcc, &rms, &state, kGainsDb[g], true);
+        normalizer.apply(&mfcc);
+        rms *= normalizer.get_energy_scale();
+
+        if (g == 0)
+        {
+            memcpy(reference, mfcc.coeffs, sizeof(reference));
+            reference_rms = rms;
+        }
+        for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+            worst_coeff = max(worst_coeff, fabsf(mfcc.coeffs[k] - reference[k]));
+        worst_energy = max(worst_energy, fabsf(rms / reference_rms - 1.0f));
+    }
+    check("正規化係數最大差異 < 0.01", worst_coeff < 0.01f, worst_coeff);
+    check("正規化能量相對誤差 < 1%", worst_energy < 0.01f, worst_energy);
+}
+
+// ========== AudioCaptureModule ==========
+
+/**
+ * 產生第 n 個樣本（0 dB，16-bit 刻度）：均勻白噪音加上 140 Hz 諧波語音
+ */
+float synth_sample(int n, uint32_t *state)
+{
+    *state = (1103515245u * *state + 12345u) & 0x7FFFFFFFu;
+    float noise = ((float)*state / 2147483648.0f - 0.5f) * 400.0f;
+
+    int speech_start = TEST_NOISE_LEAD_HOPS * AUDIO_FRAME_HOP;
+    int speech_length = TEST_SPEECH_HOPS * AUDIO_FRAME_HOP;
+    float speech = 0.0f;
+    if (n >= speech_start && n < speech_start + speech_length)
+    {
+        // 前後 TEST_RAMP_HOPS 的升餘弦漸入漸出，中段固定振幅
+        int offset = min(n - speech_start, speech_start + speech_length - 1 - n);
+        float ramp = (float)offset / (TEST_RAMP_HOPS * AUDIO_FRAME_HOP);
+        float envelope = (ramp < 1.0f) ? 0.5f * (1.0f - cosf(PI * ramp)) : 1.0f;
+        for (int h = 1; h <= 20; h++)
+        {
+            // 500 Hz 附近的共振峰加強
+            float f = 140.0f * h;
+            float formant = 1.0f + 2.0f * expf(-(f - 500.0f) * (f - 500.0f) / (2 * 200.0f * 200.0f));
+            speech += formant / h * sinf(2.0f * PI * f * n / AUDIO_SAMPLE_RATE);
+        }
+        speech *= 1500.0f * envelope;
+    }
+    return noise + speech;
+}
+
+struct SynthSource
+{
+    int position;
+    uint32_t state;
+    float gain;
+};
+
+size_t synth_source(int32_t *slots, size_t frames, uint8_t channels, void *context)
+{
+    SynthSource *source = (SynthSource *)context;
+    size_t n = 0;
+    for (; n < frames && source->position < TEST_TOTAL_SAMPLES; n++, source->position++)
+    {
+        // 固定增益 G = INMP441_GAIN_FACTOR × 16：16-bit 值 v 對應 24-bit 的 v × 256 / G
+        float x = synth_sample(source->position, &source->state) * source->gain;
+        int32_t raw = (int32_t)constrain(x * 16.0f / INMP441_GAIN_FACTOR, -8388608.0f, 8388607.0f);
+        for (uint8_t ch = 0; ch < channels; ch++)
+            slots[n * channels + ch] = raw << 8;
+    }
+    return n;
+}
+
+void accumulate(AudioFeatures *sum, const AudioFeatures &f)
+{
+    sum->rms_energy += f.rms_energy;
+    sum->zero_crossing_rate += f.zero_crossing_rate;
+    sum->spectral_centroid += f.spectral_centroid;
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+        sum->mfcc.coeffs[k] += f.mfcc.coeffs[k];
+}
+
+void scale_features(AudioFeatures *f, float scale)
+{
+    f->rms_energy *= scale;
+    f->zero_crossing_rate *= scale;
+    f->spectral_centroid *= scale;
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+        f->mfcc.coeffs[k] *= scale;
+    f->is_voice_detected = true;
+}
+
+KeywordClass classify(const AudioFeatures &features)
+{
+    keyword_detector.reset();
+    KeywordResult result;
+    for (int i = 0; i < SEQUENCE_LENGTH; i++)
+        result = keyword_detector.detect(features);
+    return result.detected_keyword;
+}
+
+// 幀回調在 CMVN 之前取得未正規化的特徵，VAD 回調決定該幀是否被模組收集
+AudioFeatures pending_raw;
+AudioFeatures raw_sum;
+int raw_frames;
+int segments;
+
+void on_frame(const AudioFeatures &features)
+{
+    pending_raw = features;
+}
+
+void on_vad(const VADResult &result)
+{
+    if (result.state == VAD_SPEECH_START)
+    {
+        memset(&raw_sum, 0, sizeof(raw_sum));
+        raw_frames = 0;
+    }
+    else if (result.state == VAD_SPEECH_ACTIVE)
+    {
+        accumulate(&raw_sum, pending_raw);
+        raw_frames++;
+    }
+    if (result.speech_complete)
+        segments++;
+}
+
+/**
+ * 以指定增益將整段語句送入 AudioCaptureModule
+ * @param full_frontend false 時關閉兩段式處理與噪音抑制，每個 hop 都完整處理且前端為線性
+ */
+void run_gain(int gain_db, bool full_frontend, GainResult *result)
+{
+    SynthSource source = {0, 1, powf(10.0f, gain_db / 20.0f)};
+    host_i2s_set_source(synth_source, &source);
+    memset(&raw_sum, 0, sizeof(raw_sum));
+    raw_frames = 0;
+    segments = 0;
+
+    INMP441Config config = INMP441Module::create_default_config();
+    config.agc_enabled = false;
+
+    AudioCaptureModule module;
+    module.set_audio_frame_callback(on_frame);
+    module.set_vad_callback(on_vad);
+    module.initialize(config);
+    module.set_vad_engine(VAD_ENGINE_GMM);
+    module.set_load_governor_enabled(false); // 主機排程不影響特徵
+    module.set_two_rate_processing(full_frontend);
+    module.set_noise_suppression_enabled(full_frontend);
+    module.start_capture();
+
+    // 手動時鐘：每輪只推進 1 ms，處理速度或主機負載不會造成 DMA 溢位，判決可重現
+    host_clock_set_mode(HOST_CLOCK_MANUAL);
+    unsigned long start = millis();
+    while (!host_i2s_finished() && millis() - start < 20000)
+    {
+        module.process_audio_loop();
+        host_clock_advance_us(1000);
+    }
+    host_clock_set_mode(HOST_CLOCK_SIMULATED);
+
+    scale_features(&raw_sum, 1.0f / max(1, raw_frames));
+    result->raw = raw_sum;
+    result->normalized = module.get_speech_features();
+    result->raw_keyword = classify(result->raw);
+    result->normalized_keyword = classify(result->normalized);
+    result->segments = segments;
+
+    module.deinitialize();
+    host_i2s_set_source(nullptr, nullptr);
+}
+
+/**
+ * 以各增益重播並比較；回傳 0 dB 的正規化關鍵字
+ * 線性前端要求倒頻譜係數與 0 dB 幾乎相同；完整前端只要求能量與判決不變，係數差異僅列出
+ */
+KeywordClass compare_gains(bool full_frontend)
+{
+    for (int g = 0; g < kGainCount; g++)
+    {
+        run_gain(kGainsDb[g], full_frontend, &results[g]);
+    }
+
+    const GainResult &reference = results[kGainCount / 2]; // 0 dB
+
+    Serial.println("    增益   | 語音段 | 原始 RMS  c0      關鍵字   | CMVN RMS  c0      關鍵字");
+    bool one_segment = true;
+    bool same_keyword = true;
+    float worst_energy = 0.0f;
+    float worst_coeff = 0.0f;
+    float raw_c0_min = 1e9f, raw_c0_max = -1e9f, norm_c0_min = 1e9f, norm_c0_max = -1e9f;
+    for (int g = 0; g < kGainCount; g++)
+    {
+        const GainResult &r = results[g];
+        Serial.printf("    %+3d dB | %6d | %.4f  %7.2f  %-8s | %.4f  %7.2f  %-8s\n", kGainsDb[g], r.segments,
+                      r.raw.rms_energy, r.raw.mfcc.coeffs[0], keyword_to_string(r.raw_keyword),
+                      r.normalized.rms_energy, r.normalized.mfcc.coeffs[0], keyword_to_string(r.normalized_keyword));
+
+        one_segment = one_segment && r.segments == 1;
+        same_keyword = same_keyword && r.normalized_keyword == reference.normalized_keyword;
+        worst_energy = max(worst_energy, fabsf(r.normalized.rms_energy / reference.normalized.rms_energy - 1.0f));
+        for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+            worst_coeff = max(worst_coeff, fabsf(r.normalized.mfcc.coeffs[k] - reference.normalized.mfcc.coeffs[k]));
+        raw_c0_min = min(raw_c0_min, r.raw.mfcc.coeffs[0]);
+        raw_c0_max = max(raw_c0_max, r.raw.mfcc.coeffs[0]);
+        norm_c0_min = min(norm_c0_min, r.normalized.mfcc.coeffs[0]);
+        norm_c0_max = max(norm_c0_max, r.normalized.mfcc.coeffs[0]);
+    }
+
+    bool is_keyword = reference.normalized_keyword != KEYWORD_UNKNOWN && reference.normalized_keyword != KEYWORD_SILENCE;
+    check("每種增益都偵測到一個語音段", one_segment, one_segment);
+    check("正規化能量相對誤差 < 5%", worst_energy < 0.05f, worst_energy);
+    check("正規化後判決為關鍵字（非未知）", is_keyword, (int)reference.normalized_keyword);
+    check("正規化後關鍵字判決相同", same_keyword, same_keyword);
+    if (full_frontend)
+    {
+        Serial.printf("  ℹ️ 正規化係數最大差異 %.3f（c0 範圍 原始 %.2f / 正規化 %.2f）\n", worst_coeff,
+                      raw_c0_max - raw_c0_min, norm_c0_max - norm_c0_min);
+    }
+    else
+    {
+        check("c0 變化範圍小於未正規化", norm_c0_max - norm_c0_min < raw_c0_max - raw_c0_min, norm_c0_max - norm_c0_min);
+        check("正規化係數最大差異 < 0.05", worst_coeff < 0.05f, worst_coeff);
+    }
+
+    return reference.normalized_keyword;
+}
+
+void setup()
+{
+    test_begin("CMVN 增益穩定性測試");
+
+    test_normalizer();
+
+    Serial.println("=== 測試線性前端的增益穩定性 ===");
+    KeywordClass linear_keyword = compare_gains(false);
+
+    Serial.println("\n=== 測試完整前端（兩段式處理 + 噪音抑制）的增益穩定性 ===");
+    KeywordClass full_keyword = compare_gains(true);
+    check("兩種前端的關鍵字判決相同", full_keyword == linear_keyword, (int)full_keyword);
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
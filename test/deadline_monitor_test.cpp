@@ -0,0 +1,179 @@
+/**
+ * 即時期限監控測試（模擬時鐘，可在主機上執行）
+ * 1. 預算內完成不計錯過，最小餘裕正確
+ * 2. 注入慢階段：錯過記在最耗時的階段，最嚴重事件含樣本時間
+ * 3. 幀間延遲（讀取、主迴圈）記在 between_frames
+ * 4. 錯過回調（降級策略）被呼叫，連續錯過計數
+ * 5. 遲到超過 DMA 緩衝時間後重新對齊，補處理積壓後恢復準時
+ */
+
+#include <Arduino.h>
+#include "deadline_monitor.h"
+#include "test_check.h"
+
+#define HOP_US 8000 // 128 樣本 @ 16kHz
+#define FRAME_US 16000
+
+DebugPrint debug_test("Deadline", true);
+
+// 模擬時鐘
+int64_t fake_now_us = 0;
+int64_t fake_clock() { return fake_now_us; }
+
+/**
+ * 模擬一幀：第 n 幀的最後一個樣本在 FRAME_US + n * HOP_US 擷取完成，
+ * 處理在擷取完成後 gap_us 開始，各階段依序花費指定時間
+ */
+bool run_frame(DeadlineMonitor &monitor, int n, uint32_t gap_us, uint32_t features_us, uint32_t vad_us)
+{
+    int64_t release = FRAME_US + (int64_t)n * HOP_US;
+    fake_now_us = release + gap_us;
+    monitor.begin_frame((sample_time_t)n * 128, release);
+
+    fake_now_us += 300;
+    monitor.mark(PROFILE_STAGE_GATE);
+    fake_now_us += features_us;
+    monitor.mark(PROFILE_STAGE_FEATURES);
+    fake_now_us += vad_us;
+    monitor.mark(PROFILE_STAGE_VAD);
+    return monitor.end_frame();
+}
+
+void test_within_budget()
+{
+    Serial.println("=== 測試預算內完成 ===");
+
+    DeadlineMonitor monitor;
+    monitor.set_time_source(fake_clock);
+
+    bool all_ok = true;
+    for (int n = 0; n < 100; n++)
+        all_ok &= run_frame(monitor, n, 500, 3000, 200);
+
+    DeadlineMonitor::DeadlineStats stats = monitor.get_stats();
+    check("100 幀全部準時", all_ok && stats.misses == 0, stats.misses);
+    check("幀數 = 100", stats.frames == 100, stats.frames);
+    check("最小餘裕 = 8000 - 4000 µs", stats.min_slack_us == 4000, stats.min_slack_us);
+}
+
+void test_slow_stage()
+{
+    Serial.println("=== 測試注入慢階段 ===");
+
+    DeadlineMonitor monitor;
+    monitor.set_time_source(fake_clock);
+
+    // 第 10 幀特徵提取 9 ms，第 20 幀 VAD 12 ms（遲到較多）
+    for (int n = 0; n < 30; n++)
+    {
+        uint32_t features_us = n == 10 ? 9000 : 3000;
+        uint32_t vad_us = n == 20 ? 12000 : 200;
+        run_frame(monitor, n, 500, features_us, vad_us);
+    }
+
+    DeadlineMonitor::DeadlineStats stats = monitor.get_stats();
+    check("錯過 2 幀", stats.misses == 2, stats.misses);
+    check("特徵提取錯過 1", stats.misses_by_source[PROFILE_STAGE_FEATURES] == 1,
+          stats.misses_by_source[PROFILE_STAGE_FEATURES]);
+    check("VAD 錯過 1", stats.misses_by_source[PROFILE_STAGE_VAD] == 1, stats.misses_by_source[PROFILE_STAGE_VAD]);
+    check("最嚴重來源 = VAD", stats.worst.source == PROFILE_STAGE_VAD, stats.worst.source);
+    check("最嚴重樣本時間 = 20 × 128", stats.worst.timestamp == 20 * 128, (long long)stats.worst.timestamp);
+    check("最嚴重遲到 = 500+300+3000+12000-8000", stats.worst.lateness_us == 7800, stats.worst.lateness_us);
+    check("最嚴重來源耗時 = 12000", stats.worst.source_us == 12000, stats.worst.source_us);
+    check("最小餘裕為負", stats.min_slack_us == -7800, stats.min_slack_us);
+
+    monitor.print_stats(debug_test);
+}
+
+void test_between_frames()
+{
+    Serial.println("=== 測試幀間延遲 ===");
+
+    DeadlineMonitor monitor;
+    monitor.set_time_source(fake_clock);
+
+    run_frame(monitor, 0, 500, 3000, 200);
+    // 主迴圈卡住 6 ms 才開始處理下一幀
+    bool ok = run_frame(monitor, 1, 6000, 3000, 200);
+
+    DeadlineMonitor::DeadlineStats stats = monitor.get_stats();
+    check("第 2 幀錯過", !ok && stats.misses == 1, stats.misses);
+    check("記在 between_frames", stats.misses_by_source[DEADLINE_SOURCE_BETWEEN_FRAMES] == 1,
+          stats.misses_by_source[DEADLINE_SOURCE_BETWEEN_FRAMES]);
+}
+
+void test_miss_callback()
+{
+    Serial.println("=== 測試錯過回調與連續錯過 ===");
+
+    DeadlineMonitor monitor;
+    monitor.set_time_source(fake_clock);
+
+    int callback_count = 0;
+    uint32_t last_consecutive = 0;
+    monitor.set_miss_callback([&](const DeadlineMiss &miss) {
+        callback_count++;
+        last_consecutive = miss.consecutive;
+    });
+
+    // 連續 3 幀各遲到約 1 ms，之後恢復
+    for (int n = 0; n < 10; n++)
+        run_frame(monitor, n, 500, n >= 2 && n < 5 ? 8000 : 3000, 200);
+
+    DeadlineMonitor::DeadlineStats stats = monitor.get_stats();
+    check("回調 3 次", callback_count == 3, callback_count);
+    check("回調內連續錯過 = 3", last_consecutive == 3, last_consecutive);
+    check("最長連續 = 3", stats.max_consecutive == 3, stats.max_consecutive);
+    check("恢復後連續歸零", stats.consecutive_misses == 0, stats.consecutive_misses);
+}
+
+void test_resync()
+{
+    Serial.println("=== 測試樣本遺失後重新對齊 ===");
+
+    DeadlineMonitor monitor;
+    monitor.set_time_source(fake_clock);
+
+    // 第 5 幀卡住 50 ms（超過 DMA 緩衝），DMA 只保留最近 32 ms，其餘樣本遺失：
+    // 之後每幀的實際擷取時間比樣本時鐘晚 dropped_us，積壓的幀連續補處理
+    fake_now_us = 0;
+    int64_t dropped_us = 0;
+    int late_after_catchup = 0;
+    for (int n = 0; n < 20; n++)
+    {
+        int64_t nominal = FRAME_US + (int64_t)n * HOP_US;
+        int64_t release = nominal + dropped_us;
+        fake_now_us = max(fake_now_us, release + 500);
+        monitor.begin_frame((sample_time_t)n * 128, nominal);
+        fake_now_us += n == 5 ? 50000 : 3000;
+        monitor.mark(PROFILE_STAGE_FEATURES);
+        bool ok = monitor.end_frame();
+        if (n == 5)
+            dropped_us = monitor.get_stats().worst.lateness_us - DEADLINE_RESYNC_US;
+        else if (n >= 14 && !ok)
+            late_after_catchup++;
+    }
+
+    DeadlineMonitor::DeadlineStats stats = monitor.get_stats();
+    check("重新對齊 1 次", stats.resyncs == 1, stats.resyncs);
+    check("只有卡住與積壓的幀錯過", stats.misses >= 1 && stats.misses <= 8, stats.misses);
+    check("追上後恢復準時", late_after_catchup == 0, late_after_catchup);
+}
+
+void setup()
+{
+    test_begin("即時期限監控測試");
+
+    test_within_budget();
+    test_slow_stage();
+    test_between_frames();
+    test_miss_callback();
+    test_resync();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
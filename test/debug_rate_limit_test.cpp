@@ -0,0 +1,144 @@
+/**
+ * 限流日誌測試（模擬樣本時間，可在主機上執行）
+ * 1. every-N：每 N 次放行一次
+ * 2. interval：每個區間最多一次，以呼叫端的樣本時間判斷
+ * 3. burst：每個區間最多 N 次，下一次輸出時回報略過筆數
+ * 4. 巨集：每個呼叫點各自的 static 狀態、執行期 debug 關閉時不計數
+ *    輸出改送到計數用的替身（不經過非同步日誌），DEBUG_LEVEL_MAX < VERBOSE 時巨集被移除、預期 0 筆
+ */
+
+#include <Arduino.h>
+#include "debug_print.h"
+#include "test_check.h"
+
+#define SAMPLE_RATE 16000
+#define HOP 128
+
+/**
+ * 日誌巨集的替身：提供巨集用到的介面，只計算輸出筆數
+ */
+struct CountingSink
+{
+    bool enabled;
+    uint32_t lines;
+
+    bool is_debug_enabled() const { return enabled; }
+    void set_debug(bool enable) { enabled = enable; }
+    void printf(const char *, ...) { lines++; }
+
+    template <typename... Args>
+    void tokenized(uint8_t, uint32_t, Args...) { lines++; }
+};
+
+CountingSink debug_test = {true, 0};
+
+/**
+ * 巨集編譯期被移除時預期 0 筆
+ */
+uint32_t expected(uint32_t lines)
+{
+    return DEBUG_LEVEL_ENABLED(DEBUG_LEVEL_VERBOSE) ? lines : 0;
+}
+
+uint32_t written()
+{
+    return debug_test.lines;
+}
+
+void test_every_n()
+{
+    Serial.println("=== 測試 every-N ===");
+
+    DebugRateLimiter limiter = {};
+    int passed = 0;
+    int first = -1;
+    for (int i = 1; i <= 1000; i++)
+    {
+        if (limiter.every_n(100))
+        {
+            passed++;
+            if (first < 0)
+                first = i;
+        }
+    }
+    check("1000 次放行 10 次", passed == 10, passed);
+    check("第 100 次首次放行", first == 100, first);
+}
+
+void test_interval()
+{
+    Serial.println("=== 測試 interval ===");
+
+    // 每個 hop 呼叫一次，持續 5 秒，每 2 秒最多一次
+    DebugRateLimiter limiter = {};
+    int passed = 0;
+    for (uint64_t now = 0; now < 5 * SAMPLE_RATE; now += HOP)
+    {
+        if (limiter.interval(now, 2 * SAMPLE_RATE))
+            passed++;
+    }
+    check("5 秒內放行 3 次（0、2、4 秒）", passed == 3, passed);
+    check("其餘計入略過", limiter.suppressed == 5 * SAMPLE_RATE / HOP - 3, limiter.suppressed);
+    check("取出後歸零", limiter.take_suppressed() > 0 && limiter.suppressed == 0, limiter.suppressed);
+}
+
+void test_burst()
+{
+    Serial.println("=== 測試 burst ===");
+
+    DebugRateLimiter limiter = {};
+    int passed = 0;
+    for (int i = 0; i < 10; i++)
+    {
+        if (limiter.burst(0, SAMPLE_RATE, 3))
+            passed++;
+    }
+    check("同一區間放行 3 次", passed == 3, passed);
+    check("略過 7 次", limiter.suppressed == 7, limiter.suppressed);
+    check("下一區間再放行", limiter.burst(SAMPLE_RATE, SAMPLE_RATE, 3), 1);
+}
+
+void test_macros()
+{
+    Serial.println("=== 測試巨集 ===");
+
+    // 兩個呼叫點各自計數
+    uint32_t start = written();
+    for (int i = 0; i < 20; i++)
+    {
+        DBG_PRINTF_EVERY_N(debug_test, 10, "呼叫點 A %d\n", i);
+        DBG_PRINTF_EVERY_N(debug_test, 5, "呼叫點 B %d\n", i);
+    }
+    check("A 2 筆 + B 4 筆", written() - start == expected(6), written() - start);
+
+    // burst：第一區間 2 筆，第二區間 1 筆略過提示 + 2 筆
+    start = written();
+    for (uint64_t now = 0; now < 2 * SAMPLE_RATE; now += SAMPLE_RATE / 4)
+        DBG_PRINTF_BURST(debug_test, now, SAMPLE_RATE, 2, "burst t=%lu\n", (unsigned long)now);
+    check("2 + 1 + 2 筆", written() - start == expected(5), written() - start);
+
+    // 執行期關閉時不輸出也不推進狀態
+    debug_test.set_debug(false);
+    start = written();
+    for (int i = 0; i < 10; i++)
+        DBG_PRINTF_INTERVAL(debug_test, 0, SAMPLE_RATE, "不應輸出 %d\n", i);
+    check("debug 關閉時不輸出", written() == start, written() - start);
+    debug_test.set_debug(true);
+}
+
+void setup()
+{
+    test_begin("限流日誌測試");
+
+    test_every_n();
+    test_interval();
+    test_burst();
+    test_macros();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
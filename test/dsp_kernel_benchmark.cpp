@@ -0,0 +1,282 @@
+/**
+ * DSP 核心微基準測試（主機由 ctest 執行，裝置上以 CPU 週期計數）
+ * 1. 逐樣本核心於 128 ~ 1024 幀長：normalize_audio、apply_window_function、calculate_rms、
+ *    calculate_zero_crossing_rate、convert_audio_data
+ * 2. 固定輸入的核心：extract_audio_features（AUDIO_FRAME_SIZE）、KeywordDetector::detect、
+ *    VoiceModel::inference、softmax；以所屬幀的長度換算 ns/樣本，各核心可直接相加成每樣本預算
+ * 3. 輸出表格與 Google Benchmark 相容 JSON，以 python/benchmark_compare.py 比較兩次提交
+ *
+ * 主機:  cmake --build build && build/dsp_kernel_benchmark > bench.log
+ *        python python/benchmark_compare.py --input bench.log -o bench.json --baseline previous.json
+ * 裝置:  燒錄後 python python/benchmark_compare.py --port COM12 -o bench.json（送出 b 指令重新量測）
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "kernel_benchmark.h"
+#include "audio_module.h"
+#include "inmp441_module.h"
+#include "voice_model.h"
+#include "keyword_model.h"
+#include "test_check.h"
+
+#define BENCH_MIN_FRAME 128
+#define BENCH_MAX_FRAME 1024
+
+/**
+ * 存取各模組的內部核心（於模組標頭宣告為 friend）
+ */
+struct KernelBenchmarkAccess
+{
+    static void normalize_audio(AudioCaptureModule &m, const audio_sample_t *in, float *out, size_t n) { m.normalize_audio(in, out, n); }
+    static void apply_window_function(AudioCaptureModule &m, float *data, size_t n) { m.apply_window_function(data, n); }
+    static float calculate_rms(AudioCaptureModule &m, float *data, size_t n) { return m.calculate_rms(data, n); }
+    static float calculate_zero_crossing_rate(AudioCaptureModule &m, const float *data, size_t n) { return m.calculate_zero_crossing_rate(data, n); }
+    static void extract_audio_features(AudioCaptureModule &m, float *frame, AudioFeatures *features) { m.extract_audio_features(frame, features, true); }
+    static void convert_audio_data(INMP441Module &m, const int32_t *raw, audio_sample_t *out, size_t n) { m.convert_audio_data(raw, out, n); }
+    static void softmax(KeywordDetector &d, float *input, int size) { d.softmax(input, size); }
+};
+
+AudioCaptureModule capture;
+INMP441Module mic;
+KernelBenchmark benchmark;
+
+// 共用輸入：300 Hz + 1800 Hz 加白雜訊，約 -12 dBFS
+int32_t raw_input[BENCH_MAX_FRAME];
+audio_sample_t pcm_input[BENCH_MAX_FRAME];
+float float_input[BENCH_MAX_FRAME];
+float work[BENCH_MAX_FRAME];
+AudioFeatures speech_features;
+
+void make_inputs()
+{
+    uint32_t noise = 1;
+    for (int n = 0; n < BENCH_MAX_FRAME; n++)
+    {
+        noise = noise * 1664525u + 1013904223u;
+        float x = 0.15f * sinf(2.0f * PI * 300.0f * n / AUDIO_SAMPLE_RATE) +
+                  0.08f * sinf(2.0f * PI * 1800.0f * n / AUDIO_SAMPLE_RATE) + ((int32_t)noise >> 8) / 2.0e8f;
+        float_input[n] = x;
+        raw_input[n] = (int32_t)(x * 8388607.0f) << 8; // INMP441：24-bit 左對齊
+        pcm_input[n] = (audio_sample_t)(x * AUDIO_SAMPLE_MAX);
+    }
+}
+
+// ========== 夾具 ==========
+
+class NormalizeFixture : public KernelBenchmarkFixture
+{
+    size_t n;
+public:
+    void set_up(size_t frame_size) { n = frame_size; }
+    void run()
+    {
+        KernelBenchmarkAccess::normalize_audio(capture, pcm_input, work, n);
+        benchmark_keep(work);
+    }
+};
+
+/**
+ * 就地運算，每次先複製輸入（避免反覆加窗後數值衰減成次正規數），複製的成本一併計入
+ */
+class WindowFixture : public KernelBenchmarkFixture
+{
+    size_t n;
+public:
+    void set_up(size_t frame_size) { n = frame_size; }
+    void run()
+    {
+        memcpy(work, float_input, n * sizeof(float));
+        KernelBenchmarkAccess::apply_window_function(capture, work, n);
+        benchmark_keep(work);
+    }
+};
+
+class RmsFixture : public KernelBenchmarkFixture
+{
+    size_t n;
+public:
+    void set_up(size_t frame_size) { n = frame_size; }
+    void run()
+    {
+        float rms = KernelBenchmarkAccess::calculate_rms(capture, float_input, n);
+        benchmark_keep(rms);
+    }
+};
+
+class ZeroCrossingFixture : public KernelBenchmarkFixture
+{
+    size_t n;
+public:
+    void set_up(size_t frame_size) { n = frame_size; }
+    void run()
+    {
+        float zcr = KernelBenchmarkAccess::calculate_zero_crossing_rate(capture, float_input, n);
+        benchmark_keep(zcr);
+    }
+};
+
+/**
+ * 含 DC 阻隔、預強調、AGC 與飽和，狀態跨幀延續
+ */
+class ConvertFixture : public KernelBenchmarkFixture
+{
+    size_t n;
+    audio_sample_t output[BENCH_MAX_FRAME];
+public:
+    void set_up(size_t frame_size) { n = frame_size; }
+    void run()
+    {
+        KernelBenchmarkAccess::convert_audio_data(mic, raw_input, output, n);
+        benchmark_keep(output);
+    }
+};
+
+/**
+ * 完整特徵提取：RMS、ZCR、FFT 頻譜特徵、梅爾能量、噪音抑制與 MFCC
+ */
+class FeatureFixture : public KernelBenchmarkFixture
+{
+    AudioFeatures features;
+public:
+    void set_up(size_t frame_size)
+    {
+        memcpy(work, float_input, frame_size * sizeof(float));
+        KernelBenchmarkAccess::apply_window_function(capture, work, frame_size);
+    }
+    void run()
+    {
+        KernelBenchmarkAccess::extract_audio_features(capture, work, &features);
+        benchmark_keep(features);
+    }
+};
+
+class KeywordFixture : public KernelBenchmarkFixture
+{
+public:
+    void run()
+    {
+        KeywordResult result = keyword_detector.detect(speech_features);
+        benchmark_keep(result);
+    }
+};
+
+class VoiceFixture : public KernelBenchmarkFixture
+{
+public:
+    void run()
+    {
+        VoiceModelResult result = voice_model.inference(speech_features);
+        benchmark_keep(result);
+    }
+};
+
+class SoftmaxFixture : public KernelBenchmarkFixture
+{
+    float logits[KEYWORD_COUNT];
+    float scores[KEYWORD_COUNT];
+public:
+    void set_up(size_t)
+    {
+        for (int k = 0; k < KEYWORD_COUNT; k++)
+            logits[k] = 0.5f * k - 1.0f;
+    }
+    void run()
+    {
+        memcpy(scores, logits, sizeof(scores));
+        KernelBenchmarkAccess::softmax(keyword_detector, scores, KEYWORD_COUNT);
+        benchmark_keep(scores);
+    }
+};
+
+NormalizeFixture normalize_fixture;
+WindowFixture window_fixture;
+RmsFixture rms_fixture;
+ZeroCrossingFixture zcr_fixture;
+ConvertFixture convert_fixture;
+FeatureFixture feature_fixture;
+KeywordFixture keyword_fixture;
+VoiceFixture voice_fixture;
+SoftmaxFixture softmax_fixture;
+
+// ========== 結果檢查 ==========
+
+void check_results()
+{
+    Serial.println("=== 檢查量測結果 ===");
+
+    size_t expected = 5 * 4 + 4; // 逐樣本核心 × 4 種幀長 + 固定輸入核心
+    check("所有案例都有結果", benchmark.get_result_count() == expected, benchmark.get_result_count());
+
+    bool valid = true;
+    bool cycles_valid = true;
+    bool has_cycle_counter = strcmp(benchmark_cycle_counter_name(), "none") != 0;
+    for (size_t i = 0; i < benchmark.get_result_count(); i++)
+    {
+        const KernelBenchmarkResult &r = benchmark.get_result(i);
+        valid = valid && isfinite(r.ns_per_frame) && r.ns_per_frame > 0.0f &&
+                r.min_ns_per_frame <= r.ns_per_frame && r.ns_per_frame <= r.max_ns_per_frame &&
+                fabsf(r.ns_per_sample * r.frame_size - r.ns_per_frame) <= 0.001f * r.ns_per_frame;
+        cycles_valid = cycles_valid && (!has_cycle_counter || r.cycles_per_frame > 0.0f);
+    }
+    check("耗時為正且 min <= 中位數 <= max", valid, valid);
+    check("週期計數有效", cycles_valid, has_cycle_counter);
+
+    // 線性核心：1024 樣本的最短耗時必然高於 128 樣本
+    const KernelBenchmarkResult *small = benchmark.find_result("calculate_rms", BENCH_MIN_FRAME);
+    const KernelBenchmarkResult *large = benchmark.find_result("calculate_rms", BENCH_MAX_FRAME);
+    bool scales = small && large && large->min_ns_per_frame > small->min_ns_per_frame;
+    check("calculate_rms 耗時隨幀長增加", scales, scales ? large->min_ns_per_frame / small->min_ns_per_frame : 0.0f);
+
+    // 資訊：幀長等於 AUDIO_FRAME_SIZE 時查表，其他長度逐樣本計算 cos
+    const KernelBenchmarkResult *table = benchmark.find_result("apply_window_function", AUDIO_FRAME_SIZE);
+    const KernelBenchmarkResult *direct = benchmark.find_result("apply_window_function", AUDIO_FRAME_SIZE * 2);
+    if (table && direct)
+        Serial.printf("    窗函數 ns/樣本：查表 %.3f，直接計算 %.3f\n", table->ns_per_sample, direct->ns_per_sample);
+}
+
+void setup()
+{
+    test_begin("DSP 核心微基準測試");
+
+    make_inputs();
+
+    // 固定輸入核心的特徵：取合成語音經完整特徵提取的結果
+    memcpy(work, float_input, AUDIO_FRAME_SIZE * sizeof(float));
+    KernelBenchmarkAccess::apply_window_function(capture, work, AUDIO_FRAME_SIZE);
+    KernelBenchmarkAccess::extract_audio_features(capture, work, &speech_features);
+
+    benchmark.add_range("normalize_audio", &normalize_fixture, BENCH_MIN_FRAME, BENCH_MAX_FRAME);
+    benchmark.add_range("apply_window_function", &window_fixture, BENCH_MIN_FRAME, BENCH_MAX_FRAME);
+    benchmark.add_range("calculate_rms", &rms_fixture, BENCH_MIN_FRAME, BENCH_MAX_FRAME);
+    benchmark.add_range("calculate_zero_crossing_rate", &zcr_fixture, BENCH_MIN_FRAME, BENCH_MAX_FRAME);
+    benchmark.add_range("convert_audio_data", &convert_fixture, BENCH_MIN_FRAME, BENCH_MAX_FRAME);
+    benchmark.add("extract_audio_features", &feature_fixture, AUDIO_FRAME_SIZE);
+    benchmark.add("KeywordDetector::detect", &keyword_fixture, AUDIO_FRAME_SIZE);
+    benchmark.add("VoiceModel::inference", &voice_fixture, AUDIO_FRAME_SIZE);
+    benchmark.add("softmax", &softmax_fixture, AUDIO_FRAME_SIZE);
+
+    Serial.printf("週期計數器: %s，每案例 %d 次量測取中位數\n\n", benchmark_cycle_counter_name(),
+                  KERNEL_BENCHMARK_REPETITIONS);
+    benchmark.run();
+    benchmark.print_table();
+    Serial.println();
+    benchmark.print_json("dsp_kernel_benchmark");
+    Serial.println();
+
+    check_results();
+
+    test_end();
+}
+
+void loop()
+{
+    // 序列埠指令 b：重新量測並輸出 JSON
+    if (Serial.available() && Serial.read() == 'b')
+    {
+        benchmark.run();
+        benchmark.print_table();
+        benchmark.print_json("dsp_kernel_benchmark");
+    }
+    delay(100);
+}
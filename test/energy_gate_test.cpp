@@ -0,0 +1,333 @@
+/**
+ * 能量閘門與兩段式處理測試
+ * 1. 開啟條件：最低能量、相對噪音底線、絕對能量與峰值各自觸發
+ * 2. 觸發後維持 ENERGY_GATE_HANGOVER_FRAMES 幀才關閉；滿刻度輸入下噪音底線不溢位
+ * 3. 歷史幀補算：閘門開啟時依時間順序補算觸發前的幀，與定期更新幀交錯時仍連續
+ * 4. 背景緩慢變化、閘門全程關閉時，GMM 噪音模型、噪音抑制與 CMVN 仍追蹤到新的噪音底線
+ *    （與每幀完整處理的結果比較）
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "host_sim.h"
+#include "energy_gate.h"
+#include "audio_module.h"
+#include "test_check.h"
+
+#define HOP AUDIO_FRAME_HOP
+
+/**
+ * 週期 32 樣本的正弦波（整數週期，均方值為振幅平方的一半）
+ */
+void make_sine(int16_t *hop, float amplitude)
+{
+    for (int i = 0; i < HOP; i++)
+        hop[i] = (int16_t)(amplitude * sinf(2.0f * PI * i / 32.0f));
+}
+
+/**
+ * 以穩定訊號餵入，直到噪音底線收斂
+ */
+void settle(EnergyGate &gate, float amplitude)
+{
+    int16_t hop[HOP];
+    make_sine(hop, amplitude);
+    for (int f = 0; f < 2000; f++)
+        gate.process(hop, HOP);
+}
+
+void test_thresholds()
+{
+    Serial.println("=== 測試開啟條件 ===");
+
+    int16_t hop[HOP];
+
+    // 均方值低於 ENERGY_GATE_MIN_MEAN_SQUARE：即使高於噪音底線也不開啟
+    EnergyGate quiet;
+    make_sine(hop, 80.0f);
+    check("低於最低能量不開啟", !quiet.process(hop, HOP), quiet.get_last_mean_square());
+
+    // 相對噪音底線：初值 100^2 的 4 倍為 200^2
+    EnergyGate below;
+    make_sine(hop, 250.0f);
+    check("低於噪音底線 4 倍不開啟", !below.process(hop, HOP), below.get_last_mean_square());
+    EnergyGate above;
+    make_sine(hop, 300.0f);
+    check("高於噪音底線 4 倍開啟", above.process(hop, HOP), above.get_last_mean_square());
+
+    // 噪音底線收斂到 447^2（約 10^5）後，相對門檻為 4 × 10^5
+    EnergyGate loud;
+    settle(loud, 447.0f);
+    check("穩定背景下閘門關閉", !loud.is_open(), loud.get_noise_floor());
+    make_sine(hop, 800.0f);
+    check("高於絕對能量開啟", loud.process(hop, HOP), loud.get_last_mean_square());
+
+    // 單一脈衝：均方值低於相對與絕對門檻，只由峰值觸發
+    EnergyGate click;
+    settle(click, 447.0f);
+    memset(hop, 0, sizeof(hop));
+    hop[HOP / 2] = ENERGY_GATE_PEAK_THRESHOLD + 500;
+    bool opened = click.process(hop, HOP);
+    check("峰值觸發開啟", opened && click.get_last_mean_square() < ENERGY_GATE_OPEN_MEAN_SQUARE,
+          click.get_last_peak());
+}
+
+void test_hangover()
+{
+    Serial.println("=== 測試維持開啟與噪音底線 ===");
+
+    EnergyGate gate;
+    int16_t hop[HOP];
+    make_sine(hop, 2000.0f);
+    gate.process(hop, HOP);
+
+    // 觸發後回到低於最低能量的訊號，含觸發幀恰好開啟 ENERGY_GATE_HANGOVER_FRAMES 幀
+    make_sine(hop, 50.0f);
+    int open_frames = 1;
+    while (gate.process(hop, HOP) && open_frames < 100)
+        open_frames++;
+    check("維持開啟幀數 = HANGOVER", open_frames == ENERGY_GATE_HANGOVER_FRAMES, open_frames);
+
+    // 滿刻度負直流的均方值為 2^30，噪音底線接近上限時相對門檻以 64-bit 比較
+    EnergyGate full_scale;
+    for (int i = 0; i < HOP; i++)
+        hop[i] = -32768;
+    for (int f = 0; f < 5000; f++)
+        full_scale.process(hop, HOP);
+    check("噪音底線追蹤到滿刻度", full_scale.get_noise_floor() > (1u << 29), full_scale.get_noise_floor());
+    make_sine(hop, 50.0f);
+    int open_after = 1;
+    while (full_scale.process(hop, HOP) && open_after < 100)
+        open_after++;
+    check("滿刻度後回到安靜可關閉", open_after == ENERGY_GATE_HANGOVER_FRAMES, open_after);
+}
+
+// ========== 模組層級（主機 I2S 來源） ==========
+
+/**
+ * 白雜訊（振幅依時間線性變化）加上選擇性的 1 kHz 突發音，數值以 16-bit 刻度表示
+ */
+struct GateSource
+{
+    uint64_t position;
+    uint64_t length;
+    uint32_t noise_state;
+    float noise_start;     // 起始雜訊振幅
+    float noise_end;       // 結束雜訊振幅
+    uint64_t ramp_start;   // 振幅開始變化的樣本
+    uint64_t ramp_end;     // 振幅停止變化的樣本
+    uint64_t burst_start;  // 突發音起點（0 = 無）
+    uint64_t burst_end;
+};
+
+size_t gate_source(int32_t *slots, size_t frames, uint8_t channels, void *context)
+{
+    GateSource *s = (GateSource *)context;
+    size_t n = 0;
+    for (; n < frames && s->position < s->length; n++, s->position++)
+    {
+        float ramp = 0.0f;
+        if (s->position >= s->ramp_end)
+            ramp = 1.0f;
+        else if (s->position > s->ramp_start)
+            ramp = (float)(s->position - s->ramp_start) / (s->ramp_end - s->ramp_start);
+
+        s->noise_state = s->noise_state * 1664525u + 1013904223u;
+        float x = (s->noise_start + ramp * (s->noise_end - s->noise_start)) * ((int32_t)s->noise_state / 2147483648.0f);
+        if (s->burst_start && s->position >= s->burst_start && s->position < s->burst_end)
+            x += 3000.0f * sinf(2.0f * PI * 1000.0f * s->position / AUDIO_SAMPLE_RATE);
+
+        // 固定增益 G = INMP441_GAIN_FACTOR × 16：16-bit 值 v 對應 24-bit 的 v × 256 / G
+        int32_t raw = (int32_t)(x * 16.0f / INMP441_GAIN_FACTOR);
+        for (uint8_t ch = 0; ch < channels; ch++)
+            slots[n * channels + ch] = raw << 8;
+    }
+    return n;
+}
+
+/**
+ * AGC 與預強調停用，訊號位準直接對應閘門的 16-bit 刻度
+ */
+void run_module(AudioCaptureModule &module, GateSource *source, bool two_rate, VADEngine engine)
+{
+    INMP441Config config = INMP441Module::create_default_config();
+    config.agc_enabled = false;
+    config.pre_emphasis_coeff = 0;
+
+    host_i2s_set_source(gate_source, source);
+    module.initialize(config);
+    module.set_vad_engine(engine);
+    module.set_two_rate_processing(two_rate);
+    module.set_load_governor_enabled(false);
+    module.start_capture();
+
+    // 手動時鐘：每輪只推進 1 ms，處理速度或主機負載不會造成 DMA 溢位，判決可重現
+    host_clock_set_mode(HOST_CLOCK_MANUAL);
+    unsigned long start = millis();
+    while (!host_i2s_finished() && millis() - start < 60000)
+    {
+        module.process_audio_loop();
+        host_clock_advance_us(1000);
+    }
+    host_clock_set_mode(HOST_CLOCK_SIMULATED);
+}
+
+sample_time_t frame_times[4096];
+int frame_time_count;
+
+void on_preroll_frame(const AudioFeatures &features)
+{
+    if (frame_time_count < (int)(sizeof(frame_times) / sizeof(frame_times[0])))
+        frame_times[frame_time_count++] = features.timestamp;
+}
+
+void test_preroll_replay()
+{
+    Serial.println("=== 測試歷史幀補算 ===");
+
+    // 1.5 秒低於最低能量的背景（閘門關閉，只有定期更新幀），之後 0.3 秒突發音
+    const uint64_t onset = AUDIO_SAMPLE_RATE * 3 / 2 + 37;
+    GateSource source = {0, onset + AUDIO_SAMPLE_RATE * 3 / 10, 99, 60.0f, 60.0f, 0, 0, onset,
+                         onset + AUDIO_SAMPLE_RATE * 3 / 10};
+    frame_time_count = 0;
+
+    AudioCaptureModule module;
+    module.set_audio_frame_callback(on_preroll_frame);
+    run_module(module, &source, true, VAD_ENGINE_ENERGY);
+    AudioCaptureModule::PipelineTierStats stats = module.get_pipeline_tier_stats();
+    module.deinitialize();
+    host_i2s_set_source(nullptr, nullptr);
+
+    Serial.printf("    閘門 %lu hop，完整處理 %lu 幀（補算 %lu，定期更新 %lu）\n", (unsigned long)stats.gate_frames,
+                  (unsigned long)stats.full_frames, (unsigned long)stats.preroll_frames,
+                  (unsigned long)stats.refresh_frames);
+
+    bool ordered = true;
+    for (int i = 1; i < frame_time_count; i++)
+        ordered = ordered && frame_times[i] > frame_times[i - 1];
+    check("完整處理的幀依時間順序", ordered, frame_time_count);
+
+    // 第一個含突發音新樣本的幀，往前數連續（間隔一個 hop）的幀數
+    int open_index = -1;
+    for (int i = 0; i < frame_time_count && open_index < 0; i++)
+    {
+        if (frame_times[i] + AUDIO_FRAME_SIZE > onset)
+            open_index = i;
+    }
+    int contiguous = 0;
+    for (int i = open_index; i > 0 && frame_times[i] - frame_times[i - 1] == HOP; i--)
+        contiguous++;
+    check("開啟前補算的幀連續", open_index > 0 && contiguous >= AUDIO_PREROLL_FRAMES, contiguous);
+    check("補算幀數不超過 AUDIO_PREROLL_FRAMES", stats.preroll_frames > 0 && stats.preroll_frames <= AUDIO_PREROLL_FRAMES,
+          stats.preroll_frames);
+
+    uint32_t closed_hops = (uint32_t)(onset / HOP);
+    check("關閉期間依間隔定期更新", stats.refresh_frames >= closed_hops / AUDIO_GATE_REFRESH_HOPS - 2 &&
+                                    stats.refresh_frames <= closed_hops / AUDIO_GATE_REFRESH_HOPS + 1,
+          stats.refresh_frames);
+}
+
+// ========== 自適應統計追蹤 ==========
+
+struct AdaptiveSnapshot
+{
+    float noise_db;  // 噪音抑制各梅爾通道噪音估計的平均（dB）
+    float cmvn_db;   // CMVN 背景能量（dB）
+    float gmm_db;    // GMM 噪音模型各頻帶平均（dB）
+};
+
+AudioCaptureModule *tracking_module;
+sample_time_t snapshot_time;
+bool snapshot_taken;
+AdaptiveSnapshot ramp_snapshot;
+
+AdaptiveSnapshot take_snapshot(AudioCaptureModule &module)
+{
+    AdaptiveSnapshot s = {0.0f, 0.0f, 0.0f};
+    for (int c = 0; c < MFCC_NUM_FILTERS; c++)
+        s.noise_db += 10.0f * log10f(module.get_noise_suppressor().get_noise_estimate(c) + 1.0f) / MFCC_NUM_FILTERS;
+    s.cmvn_db = -20.0f * log10f(module.get_cmvn().get_energy_scale());
+    for (int b = 0; b < GMM_VAD_NUM_BANDS; b++)
+        s.gmm_db += module.get_gmm_vad().get_noise_mean_db(b) / GMM_VAD_NUM_BANDS;
+    return s;
+}
+
+void on_tracking_frame(const AudioFeatures &features)
+{
+    if (!snapshot_taken && features.timestamp >= snapshot_time)
+    {
+        ramp_snapshot = take_snapshot(*tracking_module);
+        snapshot_taken = true;
+    }
+}
+
+/**
+ * 2 秒固定背景，6 秒內振幅升為 3 倍（約 +9.5 dB），之後維持 16 秒
+ * 回傳結束時的統計，開始升高時的統計存於 *before
+ */
+AdaptiveSnapshot run_tracking(bool two_rate, AdaptiveSnapshot *before, AudioCaptureModule::PipelineTierStats *stats)
+{
+    GateSource source = {0, (uint64_t)AUDIO_SAMPLE_RATE * 24, 4242, 120.0f, 360.0f,
+                         (uint64_t)AUDIO_SAMPLE_RATE * 2, (uint64_t)AUDIO_SAMPLE_RATE * 8, 0, 0};
+    snapshot_time = (sample_time_t)AUDIO_SAMPLE_RATE * 2;
+    snapshot_taken = false;
+
+    AudioCaptureModule module;
+    tracking_module = &module;
+    module.set_audio_frame_callback(on_tracking_frame);
+    run_module(module, &source, two_rate, VAD_ENGINE_GMM);
+
+    AdaptiveSnapshot after = take_snapshot(module);
+    *before = ramp_snapshot;
+    *stats = module.get_pipeline_tier_stats();
+    module.deinitialize();
+    host_i2s_set_source(nullptr, nullptr);
+    return after;
+}
+
+void test_adaptive_tracking()
+{
+    Serial.println("=== 測試閘門關閉時的自適應統計 ===");
+
+    AdaptiveSnapshot full_before, gated_before;
+    AudioCaptureModule::PipelineTierStats full_stats, gated_stats;
+    AdaptiveSnapshot full = run_tracking(false, &full_before, &full_stats);
+    AdaptiveSnapshot gated = run_tracking(true, &gated_before, &gated_stats);
+
+    Serial.printf("    %-8s %18s %18s\n", "", "每幀完整處理", "兩段式");
+    Serial.printf("    %-8s %7.1f → %7.1f dB %7.1f → %7.1f dB\n", "噪音抑制", full_before.noise_db, full.noise_db,
+                  gated_before.noise_db, gated.noise_db);
+    Serial.printf("    %-8s %7.1f → %7.1f dB %7.1f → %7.1f dB\n", "CMVN", full_before.cmvn_db, full.cmvn_db,
+                  gated_before.cmvn_db, gated.cmvn_db);
+    Serial.printf("    %-8s %7.1f → %7.1f dB %7.1f → %7.1f dB\n", "GMM", full_before.gmm_db, full.gmm_db,
+                  gated_before.gmm_db, gated.gmm_db);
+    Serial.printf("    兩段式：閘門 %lu hop，完整處理 %lu 幀（補算 %lu，定期更新 %lu）\n",
+                  (unsigned long)gated_stats.gate_frames, (unsigned long)gated_stats.full_frames,
+                  (unsigned long)gated_stats.preroll_frames, (unsigned long)gated_stats.refresh_frames);
+
+    check("背景升高時閘門維持關閉", gated_stats.full_frames < gated_stats.gate_frames / 4,
+          (float)gated_stats.full_frames / max(1u, gated_stats.gate_frames));
+    check("參考：噪音抑制估計上升 > 6 dB", full.noise_db - full_before.noise_db > 6.0f, full.noise_db - full_before.noise_db);
+    check("噪音抑制追蹤誤差 < 1.5 dB", fabsf(gated.noise_db - full.noise_db) < 1.5f, gated.noise_db - full.noise_db);
+    check("參考：CMVN 背景能量上升 > 6 dB", full.cmvn_db - full_before.cmvn_db > 6.0f, full.cmvn_db - full_before.cmvn_db);
+    check("CMVN 追蹤誤差 < 1.5 dB", fabsf(gated.cmvn_db - full.cmvn_db) < 1.5f, gated.cmvn_db - full.cmvn_db);
+    check("參考：GMM 噪音模型上升 > 6 dB", full.gmm_db - full_before.gmm_db > 6.0f, full.gmm_db - full_before.gmm_db);
+    check("GMM 追蹤誤差 < 1.5 dB", fabsf(gated.gmm_db - full.gmm_db) < 1.5f, gated.gmm_db - full.gmm_db);
+}
+
+void setup()
+{
+    test_begin("能量閘門與兩段式處理測試");
+
+    test_thresholds();
+    test_hangover();
+    test_preroll_replay();
+    test_adaptive_tracking();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,327 @@
+/**
+ * GMM VAD 測試
+ * 1. 純噪音：學習完成後不判為語音
+ * 2. 啟動學習：GMM_VAD_INIT_FRAMES 內強制判為靜音，噪音模型收斂到各頻帶能量
+ * 3. 合成濁音（基頻諧波 + 共振峰包絡）在噪音底上判為語音
+ * 4. 標記重播：整條 AudioCaptureModule 管線（主機 I2S 來源）分別以 GMM / 能量 VAD 執行，
+ *    報告與標記的精確率、召回率，以及兩者的一致率；GMM 另以預設的兩段式處理重播，門檻相同
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "host_sim.h"
+#include "gmm_vad.h"
+#include "audio_module.h"
+#include "test_check.h"
+
+#define HOP AUDIO_FRAME_HOP
+#define REPLAY_SECONDS 6
+#define REPLAY_GATED_GAIN 0.01f // 兩段式重播的訊號縮放（AGC 停用，噪音底低於能量閘門門檻）
+#define REPLAY_FRAMES ((REPLAY_SECONDS * AUDIO_SAMPLE_RATE - AUDIO_FRAME_SIZE) / HOP + 1) // 重播涵蓋的完整幀數
+
+/**
+ * 線性同餘亂數，-1 ~ 1
+ */
+float noise_value(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return ((int32_t)*state) / 2147483648.0f;
+}
+
+/**
+ * 濁音：140 Hz 基頻諧波，以 700 Hz / 1200 Hz 共振峰加權，峰值約 1
+ */
+float voiced_value(uint64_t n)
+{
+    float t = (float)n / AUDIO_SAMPLE_RATE;
+    float x = 0.0f;
+    for (int k = 1; k * 140.0f < 3800.0f; k++)
+    {
+        float f = k * 140.0f;
+        float gain = 1.0f / (1.0f + powf((f - 700.0f) / 300.0f, 2)) + 0.6f / (1.0f + powf((f - 1200.0f) / 400.0f, 2));
+        x += gain * sinf(2.0f * PI * f * t);
+    }
+    return 0.35f * x;
+}
+
+void make_hop(int16_t *hop, uint64_t start, uint32_t *state, float noise_amplitude, float voice_amplitude)
+{
+    for (int i = 0; i < HOP; i++)
+    {
+        float x = noise_amplitude * noise_value(state) + voice_amplitude * voiced_value(start + i);
+        hop[i] = (int16_t)constrain(x, -32768.0f, 32767.0f);
+    }
+}
+
+void test_init_learning()
+{
+    Serial.println("=== 測試啟動學習 ===");
+
+    GmmVad vad;
+    int16_t hop[HOP];
+    uint32_t state = 1;
+
+    // 啟動期間即使輸入濁音也只學習噪音
+    int speech_during_init = 0;
+    for (int f = 0; f < GMM_VAD_INIT_FRAMES; f++)
+    {
+        make_hop(hop, (uint64_t)f * HOP, &state, 300.0f, f < 3 ? 6000.0f : 0.0f);
+        speech_during_init += vad.process(hop, HOP);
+    }
+    check("啟動期間不判為語音", speech_during_init == 0, speech_during_init);
+    check("幀計數 = GMM_VAD_INIT_FRAMES", vad.get_frame_count() == GMM_VAD_INIT_FRAMES, vad.get_frame_count());
+
+    // 噪音平均值由初值 30 dB 收斂到實際頻帶能量（開頭的濁音已被快速遺忘）
+    float worst = 0.0f;
+    for (int b = 0; b < GMM_VAD_NUM_BANDS; b++)
+    {
+        float error = fabsf(vad.get_noise_mean_db(b) - vad.get_band_energy_db(b));
+        Serial.printf("    頻帶 %d：能量 %5.1f dB，噪音平均 %5.1f dB\n", b, vad.get_band_energy_db(b),
+                      vad.get_noise_mean_db(b));
+        worst = max(worst, error);
+    }
+    check("噪音模型誤差 < 3 dB", worst < 3.0f, worst);
+}
+
+void test_noise_and_voiced()
+{
+    Serial.println("=== 測試純噪音與濁音 ===");
+
+    GmmVad vad;
+    int16_t hop[HOP];
+    uint32_t state = 7;
+    uint64_t position = 0;
+
+    // 約 -40 dBFS 白雜訊 4 秒
+    int noise_speech = 0;
+    const int noise_hops = 4 * AUDIO_SAMPLE_RATE / HOP;
+    for (int f = 0; f < noise_hops; f++, position += HOP)
+    {
+        make_hop(hop, position, &state, 330.0f, 0.0f);
+        bool speech = vad.process(hop, HOP);
+        if (f >= GMM_VAD_INIT_FRAMES)
+            noise_speech += speech;
+    }
+    check("純噪音誤判比例", noise_speech == 0, (float)noise_speech / (noise_hops - GMM_VAD_INIT_FRAMES));
+
+    // 同一噪音底上加入約 -20 dBFS 濁音 1 秒
+    int voiced_speech = 0;
+    const int voiced_hops = AUDIO_SAMPLE_RATE / HOP;
+    for (int f = 0; f < voiced_hops; f++, position += HOP)
+    {
+        make_hop(hop, position, &state, 330.0f, 3300.0f);
+        voiced_speech += vad.process(hop, HOP);
+    }
+    check("濁音判為語音比例 > 90%", voiced_speech > voiced_hops * 9 / 10, (float)voiced_speech / voiced_hops);
+}
+
+// ========== 標記重播 ==========
+
+/**
+ * 語音段落（秒）；其餘為穩態低頻噪音（風扇類，能量高於能量 VAD 閾值），語音約高於噪音 20 dB
+ */
+const float kSegments[][2] = {{1.0f, 1.8f}, {2.6f, 3.1f}, {3.8f, 4.9f}};
+const int kSegmentCount = sizeof(kSegments) / sizeof(kSegments[0]);
+
+/**
+ * 幀完全落在語音段內為 1，完全在段外為 0，跨越邊界為 -1（不計分）
+ */
+int frame_label(sample_time_t start)
+{
+    sample_time_t end = start + AUDIO_FRAME_SIZE;
+    for (int s = 0; s < kSegmentCount; s++)
+    {
+        sample_time_t seg_start = (sample_time_t)(kSegments[s][0] * AUDIO_SAMPLE_RATE);
+        sample_time_t seg_end = (sample_time_t)(kSegments[s][1] * AUDIO_SAMPLE_RATE);
+        if (start >= seg_start && end <= seg_end)
+            return 1;
+        if (end > seg_start && start < seg_end)
+            return -1;
+    }
+    return 0;
+}
+
+struct ReplaySource
+{
+    uint64_t position;
+    uint32_t noise_state;
+    float lowpass;
+    float gain; // 整段訊號（噪音與語音）的縮放
+};
+
+size_t replay_source(int32_t *slots, size_t frames, uint8_t channels, void *context)
+{
+    ReplaySource *source = (ReplaySource *)context;
+    size_t n = 0;
+    for (; n < frames && source->position < (uint64_t)REPLAY_SECONDS * AUDIO_SAMPLE_RATE; n++, source->position++)
+    {
+        float t = (float)source->position / AUDIO_SAMPLE_RATE;
+        source->lowpass += 0.08f * (noise_value(&source->noise_state) - source->lowpass);
+        float x = 0.12f * source->lowpass;
+        for (int s = 0; s < kSegmentCount; s++)
+        {
+            if (t >= kSegments[s][0] && t < kSegments[s][1])
+                x += 0.2f * voiced_value(source->position);
+        }
+        for (uint8_t ch = 0; ch < channels; ch++)
+            slots[n * channels + ch] = (int32_t)(x * source->gain * 8388607.0f) << 8;
+    }
+    return n;
+}
+
+struct ReplayScore
+{
+    int true_positive;
+    int false_positive;
+    int false_negative;
+    int true_negative;
+};
+
+VADEngine replay_engine;
+bool decisions[REPLAY_SECONDS * AUDIO_SAMPLE_RATE / HOP + 1];
+int decision_count;
+int processed_frames;
+uint32_t gmm_hops;  // GMM 實際處理的 hop 數
+uint32_t gate_hops; // 經過能量閘門的 hop 數
+
+void on_replay_frame(const AudioFeatures &features)
+{
+    // GMM 引擎覆寫 is_voice_detected；能量引擎的判決另需能量閾值（與 run_vad_engine 相同）
+    bool speech = replay_engine == VAD_ENGINE_GMM
+                      ? features.is_voice_detected
+                      : features.is_voice_detected && features.rms_energy > VAD_ENERGY_THRESHOLD;
+
+    size_t index = features.timestamp / HOP;
+    if (index < sizeof(decisions))
+    {
+        decisions[index] = speech;
+        decision_count = max(decision_count, (int)index + 1);
+    }
+    processed_frames++;
+}
+
+/**
+ * 以指定引擎重播整段訊號，回傳計分；每幀判決留在 decisions[]
+ * @param two_rate 兩段式處理：閘門關閉、未完整處理的幀沒有回調，計為非語音
+ * @param gain 整段訊號的縮放；非 0 時停用 AGC，以固定增益送入
+ */
+ReplayScore replay(VADEngine engine, bool two_rate, float gain = 0.0f)
+{
+    ReplaySource source = {0, 12345, 0.0f, gain > 0.0f ? gain : 1.0f};
+    host_i2s_set_source(replay_source, &source);
+
+    memset(decisions, 0, sizeof(decisions));
+    decision_count = 0;
+    processed_frames = 0;
+    replay_engine = engine;
+
+    AudioCaptureModule module;
+    module.set_audio_frame_callback(on_replay_frame);
+    INMP441Config config = INMP441Module::create_default_config();
+    config.agc_enabled = gain == 0.0f;
+    module.initialize(config);
+    module.set_vad_engine(engine);
+    module.set_two_rate_processing(two_rate);
+    module.set_load_governor_enabled(false); // 主機排程不影響判決
+    module.start_capture();
+
+    // 手動時鐘：每輪只推進 1 ms，處理速度或主機負載不會造成 DMA 溢位，判決可重現
+    host_clock_set_mode(HOST_CLOCK_MANUAL);
+    unsigned long start = millis();
+    while (!host_i2s_finished() && millis() - start < 20000)
+    {
+        module.process_audio_loop();
+        host_clock_advance_us(1000);
+    }
+    host_clock_set_mode(HOST_CLOCK_SIMULATED);
+
+    gmm_hops = module.get_vad_engine_stats().gmm_frames;
+    gate_hops = module.get_pipeline_tier_stats().gate_frames;
+    module.deinitialize();
+    host_i2s_set_source(nullptr, nullptr);
+
+    ReplayScore score = {0, 0, 0, 0};
+    for (int i = 0; i < REPLAY_FRAMES; i++)
+    {
+        int label = frame_label((sample_time_t)i * HOP);
+        if (label < 0)
+            continue;
+        if (decisions[i])
+            label ? score.true_positive++ : score.false_positive++;
+        else
+            label ? score.false_negative++ : score.true_negative++;
+    }
+    return score;
+}
+
+void report(const char *name, const ReplayScore &s, float *precision, float *recall)
+{
+    *precision = (float)s.true_positive / max(1, s.true_positive + s.false_positive);
+    *recall = (float)s.true_positive / max(1, s.true_positive + s.false_negative);
+    Serial.printf("    %-6s TP %3d  FP %3d  FN %3d  TN %3d  精確率 %.3f  召回率 %.3f\n", name, s.true_positive,
+                  s.false_positive, s.false_negative, s.true_negative, *precision, *recall);
+}
+
+void test_labelled_replay()
+{
+    Serial.println("=== 測試標記重播（GMM vs 能量 VAD，每個 hop 完整處理）===");
+
+    ReplayScore gmm = replay(VAD_ENGINE_GMM, false);
+    static bool gmm_decisions[sizeof(decisions)];
+    memcpy(gmm_decisions, decisions, sizeof(decisions));
+    int frames = decision_count;
+
+    ReplayScore energy = replay(VAD_ENGINE_ENERGY, false);
+    int agree = 0;
+    for (int i = 0; i < frames; i++)
+        agree += gmm_decisions[i] == decisions[i];
+
+    float gmm_precision, gmm_recall, energy_precision, energy_recall;
+    report("GMM", gmm, &gmm_precision, &gmm_recall);
+    report("能量", energy, &energy_precision, &energy_recall);
+    Serial.printf("    兩者一致率 %.3f（%d 幀）\n", (float)agree / max(1, frames), frames);
+
+    int scored = gmm.true_positive + gmm.false_positive + gmm.false_negative + gmm.true_negative;
+    check("重播涵蓋所有幀", frames >= REPLAY_FRAMES, frames);
+    check("兩種引擎計分幀數相同",
+          scored == energy.true_positive + energy.false_positive + energy.false_negative + energy.true_negative, scored);
+    check("GMM 精確率 > 0.9", gmm_precision > 0.9f, gmm_precision);
+    check("GMM 召回率 > 0.9", gmm_recall > 0.9f, gmm_recall);
+    check("穩態噪音下 GMM 精確率優於能量 VAD", gmm_precision > energy_precision, gmm_precision - energy_precision);
+
+    Serial.println("=== 測試標記重播（GMM，兩段式處理）===");
+
+    // 預設設定：閘門關閉的 hop 只有 GMM 執行，判決隨補算或定期完整處理的幀送出。
+    // AGC 下的噪音底高於 ENERGY_GATE_OPEN_MEAN_SQUARE，閘門不會關閉，因此改以固定增益送入較低的位準
+    ReplayScore gated = replay(VAD_ENGINE_GMM, true, REPLAY_GATED_GAIN);
+    int gated_frames = processed_frames;
+    agree = 0;
+    for (int i = 0; i < REPLAY_FRAMES; i++)
+        agree += gmm_decisions[i] == decisions[i];
+
+    float gated_precision, gated_recall;
+    report("GMM", gated, &gated_precision, &gated_recall);
+    Serial.printf("    完整處理 %d / %d 幀，與逐幀處理一致率 %.3f\n", gated_frames, REPLAY_FRAMES,
+                  (float)agree / REPLAY_FRAMES);
+
+    check("閘門略過部分幀", gated_frames < REPLAY_FRAMES, gated_frames);
+    check("GMM 處理每個 hop", gmm_hops == gate_hops, gmm_hops);
+    check("兩段式 GMM 精確率 > 0.9", gated_precision > 0.9f, gated_precision);
+    check("兩段式 GMM 召回率 > 0.9", gated_recall > 0.9f, gated_recall);
+}
+
+void setup()
+{
+    test_begin("GMM VAD 測試");
+
+    test_init_learning();
+    test_noise_and_voiced();
+    test_labelled_replay();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,278 @@
+/**
+ * 主機建置替身測試（僅主機：cmake 建置後由 ctest 執行）
+ * 1. 可控時鐘：MANUAL 模式下時間只由 delay() 推進
+ * 2. I2S DMA 模型：依時鐘產生資料、讀取過慢時溢位
+ * 3. WAV 檔案來源：樣本以 24-bit 左對齊送入 INMP441Module
+ * 4. 整條管線不經修改執行：合成語音觸發 VAD，VoiceModel / KeywordDetector 輸出有效結果
+ * 5. FreeRTOS 任務與佇列（std::thread）、序列埠輸入
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "esp_timer.h"
+#include "host_sim.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "inmp441_module.h"
+#include "audio_module.h"
+#include "voice_model.h"
+#include "keyword_model.h"
+#include "test_check.h"
+
+#define WAV_PATH "/tmp/host_platform_test.wav"
+#define WAV_SAMPLES 1600
+
+void test_clock()
+{
+    Serial.println("=== 測試可控時鐘 ===");
+
+    host_clock_set_mode(HOST_CLOCK_MANUAL);
+    unsigned long start = millis();
+    int64_t start_us = esp_timer_get_time();
+    volatile float sink = 0.0f;
+    for (int i = 0; i < 100000; i++)
+        sink = sink + sqrtf((float)i);
+    check("運算不推進時間", millis() == start, millis() - start);
+
+    delay(250);
+    check("delay(250) 推進 250 ms", millis() - start == 250, millis() - start);
+    check("esp_timer 與 micros 一致", esp_timer_get_time() - start_us == 250000, esp_timer_get_time() - start_us);
+    host_clock_set_mode(HOST_CLOCK_SIMULATED);
+    check("切換模式時間不倒退", millis() >= start + 250, millis() - start);
+}
+
+void test_dma_model()
+{
+    Serial.println("=== 測試 I2S DMA 模型 ===");
+
+    host_clock_set_mode(HOST_CLOCK_MANUAL);
+    host_i2s_set_tone(1000.0f, -20.0f, -200.0f);
+
+    INMP441Module mic;
+    mic.initialize();
+    mic.start();
+    audio_sample_t samples[INMP441_BUFFER_SIZE];
+
+    check("時間未前進時沒有資料", mic.read_audio_data(samples, INMP441_BUFFER_SIZE) == 0, 0);
+
+    delay(16); // 256 樣本 = 4 個 DMA 緩衝區
+    size_t read = mic.read_audio_data(samples, INMP441_BUFFER_SIZE);
+    check("16 ms 後讀到 256 樣本", read == 256, read);
+
+    uint32_t overflows_before = host_i2s_overflows();
+    delay(200); // 遠超過 DMA 緩衝時間
+    mic.read_audio_data(samples, INMP441_BUFFER_SIZE);
+    INMP441Module::INMP441Stats stats = mic.get_statistics();
+    check("讀取過慢時丟棄緩衝區", host_i2s_overflows() > overflows_before, host_i2s_overflows() - overflows_before);
+    check("模組偵測到 DMA 溢位", stats.dma_overflows > 0, stats.dma_overflows);
+    check("估計遺失樣本", stats.dropped_samples > 0, (float)stats.dropped_samples);
+
+    mic.deinitialize();
+    host_clock_set_mode(HOST_CLOCK_SIMULATED);
+}
+
+/**
+ * 寫入 16-bit 單聲道 WAV：第 n 個樣本為 n * 16
+ */
+bool write_wav()
+{
+    FILE *file = fopen(WAV_PATH, "wb");
+    if (!file)
+        return false;
+
+    uint32_t data_bytes = WAV_SAMPLES * 2;
+    uint32_t riff_size = 36 + data_bytes;
+    uint32_t fmt_size = 16, rate = INMP441_SAMPLE_RATE, byte_rate = INMP441_SAMPLE_RATE * 2;
+    uint16_t format = 1, channels = 1, block_align = 2, bits = 16;
+    fwrite("RIFF", 1, 4, file);
+    fwrite(&riff_size, 4, 1, file);
+    fwrite("WAVEfmt ", 1, 8, file);
+    fwrite(&fmt_size, 4, 1, file);
+    fwrite(&format, 2, 1, file);
+    fwrite(&channels, 2, 1, file);
+    fwrite(&rate, 4, 1, file);
+    fwrite(&byte_rate, 4, 1, file);
+    fwrite(&block_align, 2, 1, file);
+    fwrite(&bits, 2, 1, file);
+    fwrite("data", 1, 4, file);
+    fwrite(&data_bytes, 4, 1, file);
+    for (int n = 0; n < WAV_SAMPLES; n++)
+    {
+        int16_t sample = (int16_t)(n * 16);
+        fwrite(&sample, 2, 1, file);
+    }
+    fclose(file);
+    return true;
+}
+
+void test_wav_source()
+{
+    Serial.println("=== 測試 WAV 檔案來源 ===");
+
+    check("寫入測試檔", write_wav(), 0);
+    check("開啟 WAV", host_i2s_open_file(WAV_PATH), 0);
+
+    host_clock_set_mode(HOST_CLOCK_MANUAL);
+    INMP441Module mic;
+    mic.initialize();
+    mic.start();
+
+    // 每次 32 ms = 512 樣本，4 次涵蓋整個檔案與之後的靜音
+    int32_t raw[INMP441_BUFFER_SIZE];
+    bool exact = true;
+    bool silent = true;
+    size_t total = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        delay(32);
+        size_t read = mic.read_raw_audio_data(raw, INMP441_BUFFER_SIZE);
+        for (size_t k = 0; k < read; k++, total++)
+        {
+            if (total < WAV_SAMPLES)
+                exact = exact && raw[k] == (int32_t)((uint32_t)(total * 16) << 16);
+            else
+                silent = silent && raw[k] == 0;
+        }
+    }
+    check("樣本以左對齊送入", exact && total == 4 * INMP441_BUFFER_SIZE, total);
+    check("檔案結束", host_i2s_finished(), host_i2s_finished());
+    check("結束後補靜音", silent, silent);
+
+    mic.deinitialize();
+    host_clock_set_mode(HOST_CLOCK_SIMULATED);
+    remove(WAV_PATH);
+}
+
+/**
+ * 合成語音：白雜訊底噪，1.0 ~ 1.8 秒加入 300 Hz + 1500 Hz，共 3 秒
+ */
+size_t speech_source(int32_t *slots, size_t frames, uint8_t channels, void *context)
+{
+    uint64_t *position = (uint64_t *)context;
+    static uint32_t noise = 1;
+    size_t n = 0;
+    for (; n < frames && *position < 3 * INMP441_SAMPLE_RATE; n++, (*position)++)
+    {
+        float t = (float)*position / INMP441_SAMPLE_RATE;
+        noise = noise * 1664525u + 1013904223u;
+        float x = ((int32_t)noise >> 16) / 1600.0f;
+        if (t > 1.0f && t < 1.8f)
+            x += 2000.0f * sinf(2.0f * PI * 300.0f * t) + 2000.0f * sinf(2.0f * PI * 1500.0f * t);
+        for (uint8_t ch = 0; ch < channels; ch++)
+            slots[n * channels + ch] = ((int32_t)(x * 4)) << 12;
+    }
+    return n;
+}
+
+int frames_seen = 0;
+int speech_segments = 0;
+
+void test_pipeline()
+{
+    Serial.println("=== 測試整條管線 ===");
+
+    uint64_t position = 0;
+    host_i2s_set_source(speech_source, &position);
+
+    AudioCaptureModule module;
+    module.set_audio_frame_callback([](const AudioFeatures &) { frames_seen++; });
+    module.set_speech_complete_callback([](const float *, size_t, unsigned long) { speech_segments++; });
+    check("初始化", module.initialize() && module.start_capture(), 0);
+
+    unsigned long start = millis();
+    while (!host_i2s_finished() && millis() - start < 10000)
+        module.process_audio_loop();
+    for (int i = 0; i < 20; i++)
+        module.process_audio_loop(); // 處理 DMA 內剩餘的樣本與結尾靜音
+
+    Serial.printf("    模擬 %lu ms，%d 幀，語音段落 %d\n", millis() - start, frames_seen, speech_segments);
+    check("每個 hop 都有幀回調", frames_seen > 100, frames_seen);
+    check("偵測到語音段落", speech_segments >= 1, speech_segments);
+
+    AudioFeatures features = module.get_speech_features();
+    VoiceModelResult voice = voice_model.inference(features);
+    check("VoiceModel 信心度有效", voice.confidence >= 0.0f && voice.confidence <= 1.0f, voice.confidence);
+
+    KeywordResult keyword = keyword_detector.detect(features);
+    float sum = 0.0f;
+    for (int k = 0; k < KEYWORD_COUNT; k++)
+        sum += keyword.probabilities[k];
+    check("KeywordDetector 機率總和 = 1", fabsf(sum - 1.0f) < 0.01f, sum);
+
+    module.deinitialize();
+    host_i2s_set_source(nullptr, nullptr);
+}
+
+QueueHandle_t queue;
+volatile BaseType_t worker_core = -1;
+
+void producer_task(void *arg)
+{
+    (void)arg;
+    worker_core = xPortGetCoreID();
+    for (uint32_t i = 1; i <= 5; i++)
+    {
+        xQueueSend(queue, &i, portMAX_DELAY);
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    vTaskDelete(nullptr);
+}
+
+void idle_task(void *arg)
+{
+    (void)arg;
+    for (;;)
+        vTaskDelay(pdMS_TO_TICKS(10));
+}
+
+void test_freertos()
+{
+    Serial.println("=== 測試 FreeRTOS 與序列埠輸入 ===");
+
+    queue = xQueueCreate(2, sizeof(uint32_t));
+    TaskHandle_t producer = nullptr;
+    check("建立任務", xTaskCreatePinnedToCore(producer_task, "producer", 2048, nullptr, 1, &producer, 0) == pdPASS, 0);
+
+    uint32_t sum = 0, value = 0;
+    while (xQueueReceive(queue, &value, pdMS_TO_TICKS(1000)) == pdTRUE)
+    {
+        sum += value;
+        if (value == 5)
+            break;
+    }
+    check("佇列依序收到 1..5", sum == 15, sum);
+    check("任務在指定核心", worker_core == 0, worker_core);
+    check("主執行緒為核心 1", xPortGetCoreID() == 1, xPortGetCoreID());
+    check("空佇列逾時", xQueueReceive(queue, &value, pdMS_TO_TICKS(5)) == pdFALSE, 0);
+
+    TaskHandle_t idle = nullptr;
+    xTaskCreatePinnedToCore(idle_task, "idle", 2048, nullptr, 1, &idle, 1);
+    unsigned long start_us = micros();
+    vTaskDelete(idle);
+    check("刪除其他任務後返回", true, (micros() - start_us) / 1000.0f);
+    vQueueDelete(queue);
+
+    host_serial_feed("pt");
+    int first = Serial.read();
+    check("序列埠輸入", Serial.available() == 1 && first == 'p' && Serial.read() == 't', first);
+    check("輸入讀完", Serial.available() == 0 && Serial.read() == -1, Serial.available());
+}
+
+void setup()
+{
+    test_begin("主機建置替身測試");
+
+    test_clock();
+    test_dma_model();
+    test_wav_source();
+    test_pipeline();
+    test_freertos();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,305 @@
+/**
+ * INMP441 轉換階段測試
+ * 以合成的 DC 偏移 + 正弦波原始樣本驗證 DC 阻隔、預強調、
+ * 跨區塊的濾波器狀態延續、16-bit 飽和，以及以階梯音量訊號驗證 AGC
+ * 不需要實際麥克風，直接呼叫 process_raw_samples()
+ * 輸出經 audio_sample_to_q15() 比較，int16 與 Q31 兩種樣本格式使用相同的門檻
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "inmp441_module.h"
+#include "test_check.h"
+
+#define TEST_SAMPLES 8000   // 0.5 秒
+#define SETTLE_SAMPLES 2000 // DC 阻隔收斂時間（約 10 倍時間常數）
+#define AGC_STEP_SAMPLES 32000 // AGC 每個音量階梯 2 秒（包絡下降 20 dB 約需 1.2 秒）
+#define AGC_BLOCK 512
+
+INMP441Module mic;
+int32_t raw[TEST_SAMPLES];
+audio_sample_t output[TEST_SAMPLES];
+audio_sample_t output_blocks[TEST_SAMPLES];
+
+/**
+ * 產生 24-bit 樣本（放在 32-bit 容器高位）
+ */
+void make_raw(int32_t offset, float amplitude, float freq)
+{
+    for (int n = 0; n < TEST_SAMPLES; n++)
+    {
+        int32_t value = offset + (int32_t)lroundf(amplitude * sinf(2.0f * PI * freq * n / INMP441_SAMPLE_RATE));
+        raw[n] = value * 256;
+    }
+}
+
+void configure(int16_t dc_coeff, int16_t pre_coeff)
+{
+    INMP441Config config = INMP441Module::create_default_config();
+    config.dc_block_coeff = dc_coeff;
+    config.pre_emphasis_coeff = pre_coeff;
+    config.agc_enabled = false; // 固定增益，結果可直接與理論值比較
+    mic.set_config(config); // 同時清除濾波器狀態
+}
+
+float mean_of(const audio_sample_t *data, int start, int end)
+{
+    double sum = 0;
+    for (int i = start; i < end; i++)
+        sum += audio_sample_to_q15(data[i]);
+    return (float)(sum / (end - start));
+}
+
+float rms_of(const audio_sample_t *data, int start, int end)
+{
+    double sum = 0;
+    for (int i = start; i < end; i++)
+    {
+        double x = audio_sample_to_q15(data[i]);
+        sum += x * x;
+    }
+    return (float)sqrt(sum / (end - start));
+}
+
+float zcr_of(const audio_sample_t *data, int start, int end)
+{
+    int crossings = 0;
+    for (int i = start + 1; i < end; i++)
+    {
+        if ((data[i] >= 0) != (data[i - 1] >= 0))
+            crossings++;
+    }
+    return (float)crossings / (end - start - 1);
+}
+
+void test_dc_offset()
+{
+    Serial.println("=== 測試 DC 阻隔 ===");
+
+    // 24-bit DC 20000 → 16-bit 約 5000；正弦振幅 16-bit 約 2000，永遠不穿越 0
+    make_raw(20000, 8000.0f, 500.0f);
+    const float tone_rms = 8000.0f / 16 * INMP441_GAIN_FACTOR / sqrtf(2.0f);
+    const float expected_zcr = 2.0f * 500.0f / INMP441_SAMPLE_RATE;
+
+    configure(0, 0);
+    mic.process_raw_samples(raw, output, TEST_SAMPLES);
+    Serial.println(" 停用時:");
+    check("平均值 (偏移)", mean_of(output, SETTLE_SAMPLES, TEST_SAMPLES) > 4000.0f,
+          mean_of(output, SETTLE_SAMPLES, TEST_SAMPLES));
+    check("零穿越率 (塌陷為 0)", zcr_of(output, SETTLE_SAMPLES, TEST_SAMPLES) == 0.0f,
+          zcr_of(output, SETTLE_SAMPLES, TEST_SAMPLES));
+
+    configure(INMP441_DC_BLOCK_COEFF, 0);
+    mic.process_raw_samples(raw, output, TEST_SAMPLES);
+    // 平均值取整數個週期（500 Hz = 32 樣本），避免殘留半週期偏差
+    int whole_periods = SETTLE_SAMPLES + (TEST_SAMPLES - SETTLE_SAMPLES) / 32 * 32;
+    float mean = mean_of(output, SETTLE_SAMPLES, whole_periods);
+    float zcr = zcr_of(output, SETTLE_SAMPLES, TEST_SAMPLES);
+    float rms = rms_of(output, SETTLE_SAMPLES, TEST_SAMPLES);
+    Serial.println(" 啟用時:");
+    check("平均值 |mean| < 2", fabsf(mean) < 2.0f, mean);
+    check("零穿越率 ≈ 2f/fs", fabsf(zcr - expected_zcr) < 0.005f, zcr);
+    check("RMS 誤差 < 2%", fabsf(rms / tone_rms - 1.0f) < 0.02f, rms / tone_rms);
+}
+
+void test_block_continuity()
+{
+    Serial.println("=== 測試跨區塊狀態延續 ===");
+
+    make_raw(-15000, 30000.0f, 1234.0f);
+
+    configure(INMP441_DC_BLOCK_COEFF, 31785);
+    mic.process_raw_samples(raw, output, TEST_SAMPLES);
+
+    // 以不規則的區塊大小重跑，結果必須逐樣本相同
+    configure(INMP441_DC_BLOCK_COEFF, 31785);
+    const int sizes[] = {1, 37, 128, 511, 64, 3};
+    int pos = 0;
+    int k = 0;
+    while (pos < TEST_SAMPLES)
+    {
+        int size = min(sizes[k++ % 6], TEST_SAMPLES - pos);
+        mic.process_raw_samples(raw + pos, output_blocks + pos, size);
+        pos += size;
+    }
+
+    int mismatches = 0;
+    for (int i = 0; i < TEST_SAMPLES; i++)
+    {
+        if (output[i] != output_blocks[i])
+            mismatches++;
+    }
+    check("不一致樣本數", mismatches == 0, mismatches);
+}
+
+void test_pre_emphasis()
+{
+    Serial.println("=== 測試預強調頻率響應 ===");
+
+    const int16_t coeff = 31785; // 0.97
+    const float b = coeff / 32768.0f;
+    const float freqs[] = {200.0f, 1000.0f, 4000.0f};
+
+    for (int f = 0; f < 3; f++)
+    {
+        make_raw(0, 40000.0f, freqs[f]);
+
+        configure(INMP441_DC_BLOCK_COEFF, 0);
+        mic.process_raw_samples(raw, output, TEST_SAMPLES);
+        float reference = rms_of(output, SETTLE_SAMPLES, TEST_SAMPLES);
+
+        configure(INMP441_DC_BLOCK_COEFF, coeff);
+        mic.process_raw_samples(raw, output, TEST_SAMPLES);
+        float emphasized = rms_of(output, SETTLE_SAMPLES, TEST_SAMPLES);
+
+        // |1 - b e^{-jw}|
+        float w = 2.0f * PI * freqs[f] / INMP441_SAMPLE_RATE;
+        float expected = sqrtf((1.0f - b * cosf(w)) * (1.0f - b * cosf(w)) + b * sinf(w) * b * sinf(w));
+
+        char name[32];
+        snprintf(name, sizeof(name), "%.0f Hz 增益", freqs[f]);
+        check(name, fabsf(emphasized / reference / expected - 1.0f) < 0.05f, emphasized / reference);
+    }
+}
+
+void test_saturation()
+{
+    Serial.println("=== 測試 16-bit 飽和 ===");
+
+    // 接近 24-bit 滿刻度，乘上增益後超出 16-bit
+    make_raw(0, 8000000.0f, 300.0f);
+    configure(0, 0);
+    mic.process_raw_samples(raw, output, TEST_SAMPLES);
+
+    // 正弦波峰值附近必須是 +32767，而不是溢位後的負值
+    int peak = INMP441_SAMPLE_RATE / (4 * 300);
+    int16_t positive = audio_sample_to_q15(output[peak]);
+    int16_t negative = audio_sample_to_q15(output[peak * 3]);
+    check("正峰值", positive == INMP441_MAX_AMPLITUDE, positive);
+    check("負峰值", negative == -INMP441_MAX_AMPLITUDE - 1, negative);
+}
+
+/**
+ * 以 AGC_BLOCK 為單位餵入一段固定音量的 1 kHz 正弦波
+ * 回傳最後 0.5 秒的輸出峰值，*clipped 為整段的飽和樣本數
+ */
+int run_level(float level_dbfs, int samples, unsigned long *clipped)
+{
+    static int32_t block_raw[AGC_BLOCK];
+    static audio_sample_t block_out[AGC_BLOCK];
+    static long phase = 0;
+
+    const float amplitude = 8388607.0f * powf(10.0f, level_dbfs / 20.0f);
+    unsigned long clipped_before = mic.get_statistics().clipped_samples;
+    int peak = 0;
+
+    for (int pos = 0; pos < samples; pos += AGC_BLOCK)
+    {
+        for (int i = 0; i < AGC_BLOCK; i++, phase++)
+        {
+            float x = amplitude * sinf(2.0f * PI * 1000.0f * phase / INMP441_SAMPLE_RATE);
+            block_raw[i] = (int32_t)lroundf(x) * 256;
+        }
+        mic.process_raw_samples(block_raw, block_out, AGC_BLOCK);
+
+        if (pos >= samples - INMP441_SAMPLE_RATE / 2)
+        {
+            for (int i = 0; i < AGC_BLOCK; i++)
+                peak = max(peak, abs((int)audio_sample_to_q15(block_out[i])));
+        }
+    }
+
+    *clipped = mic.get_statistics().clipped_samples - clipped_before;
+    return peak;
+}
+
+void configure_agc(bool enabled)
+{
+    INMP441Config config = INMP441Module::create_default_config();
+    config.agc_enabled = enabled;
+    mic.set_config(config);
+    mic.reset_statistics();
+}
+
+void test_agc_levels()
+{
+    Serial.println("=== 測試 AGC 階梯音量 ===");
+
+    // 安靜 → 正常 → 大聲 → 回到中等，每階 2 秒
+    const float levels[] = {-50.0f, -30.0f, -10.0f, -40.0f};
+    const float target = INMP441_AGC_TARGET_LEVEL;
+
+    for (int mode = 0; mode < 2; mode++)
+    {
+        configure_agc(mode == 1);
+        Serial.println(mode ? " AGC 啟用:" : " 固定增益:");
+
+        for (int l = 0; l < 4; l++)
+        {
+            unsigned long clipped;
+            int peak = run_level(levels[l], AGC_STEP_SAMPLES, &clipped);
+            float peak_db = 20.0f * log10f(peak / target);
+            Serial.printf("   %5.0f dBFS 輸入 → 峰值 %5d (%+5.1f dB)，飽和 %lu，增益 %.1f\n",
+                          levels[l], peak, peak_db, clipped, mic.get_current_gain());
+
+            if (mode == 1)
+            {
+                char name[40];
+                snprintf(name, sizeof(name), "%.0f dBFS 峰值 ±3 dB", levels[l]);
+                check(name, fabsf(peak_db) < 3.0f, peak_db);
+            }
+            else if (levels[l] == -10.0f)
+            {
+                check("固定增益大聲時飽和", clipped > 1000, clipped);
+            }
+        }
+    }
+
+    // 穩態不應飽和
+    INMP441Module::INMP441Stats stats = mic.get_statistics();
+    check("AGC 飽和比例 < 0.1%", stats.clip_ratio < 0.001f, stats.clip_ratio * 100.0f);
+    check("統計回報增益", stats.agc_enabled && fabsf(stats.current_gain - mic.get_current_gain()) < 1e-3f,
+          stats.current_gain_db);
+}
+
+void test_agc_attack()
+{
+    Serial.println("=== 測試 AGC 起音 ===");
+
+    configure_agc(true);
+    unsigned long clipped;
+    run_level(-50.0f, AGC_STEP_SAMPLES, &clipped);
+    float quiet_gain = mic.get_current_gain();
+
+    // 突然 +44 dB：只允許起音期間的少量飽和（< 4 ms），之後不再飽和
+    int peak = run_level(-6.0f, INMP441_SAMPLE_RATE, &clipped);
+    check("起音飽和樣本 < 64", clipped < 64, clipped);
+    check("增益下降", mic.get_current_gain() < quiet_gain / 50.0f, mic.get_current_gain());
+    check("穩態峰值未飽和", peak < INMP441_MAX_AMPLITUDE, peak);
+
+    // 包絡降到噪音閘門以下後保持增益，不把底噪放大到目標值
+    run_level(-90.0f, 2 * AGC_STEP_SAMPLES, &clipped);
+    float held_gain = mic.get_current_gain();
+    run_level(-90.0f, AGC_STEP_SAMPLES, &clipped);
+    check("靜音時保持增益", mic.get_current_gain() == held_gain, held_gain);
+    check("靜音增益不超過上限", held_gain <= INMP441_AGC_MAX_GAIN, held_gain);
+}
+
+void setup()
+{
+    test_begin("INMP441 轉換階段測試");
+
+    test_dc_offset();
+    test_block_continuity();
+    test_pre_emphasis();
+    test_saturation();
+    test_agc_levels();
+    test_agc_attack();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,160 @@
+/**
+ * CPU 負載調節測試（模擬時鐘，可在主機上執行）
+ * 1. 預算內不降級
+ * 2. 持續過載逐級降級，兩次切換至少間隔最短停留時間，不超過 max_level
+ * 3. 錯過期限立即降級
+ * 4. 餘裕持續 recover_hold_ms 後逐級恢復；餘裕中斷則重新計時
+ * 5. 遙測：切換回調、各等級停留時間
+ */
+
+#include <Arduino.h>
+#include "load_governor.h"
+#include "test_check.h"
+
+#define HOP_US 8000 // 128 樣本 @ 16kHz
+
+DebugPrint debug_test("Governor", true);
+
+// 模擬時鐘
+int64_t sim_now_us = 0;
+
+/**
+ * 以固定處理時間跑 frames 幀，回傳最後的等級
+ */
+LoadLevel run_frames(LoadGovernor &governor, int frames, uint32_t busy_us, bool missed = false)
+{
+    LoadLevel level = governor.get_level();
+    for (int i = 0; i < frames; i++)
+    {
+        sim_now_us += HOP_US;
+        level = governor.update(sim_now_us, busy_us, HOP_US, missed);
+    }
+    return level;
+}
+
+void test_within_budget()
+{
+    Serial.println("=== 測試預算內不降級 ===");
+
+    sim_now_us = 0;
+    LoadGovernor governor;
+    LoadLevel level = run_frames(governor, 1000, 5000); // 62.5%，介於恢復與降級門檻之間
+
+    check("維持 full", level == LOAD_LEVEL_FULL, level);
+    check("沒有切換", governor.get_stats().transitions == 0, governor.get_stats().transitions);
+    check("平滑負載 = 0.625", fabsf(governor.get_load() - 0.625f) < 0.001f, governor.get_load());
+}
+
+void test_overload_steps()
+{
+    Serial.println("=== 測試持續過載逐級降級 ===");
+
+    sim_now_us = 0;
+    LoadGovernor governor;
+
+    int64_t transition_times[LOAD_LEVEL_COUNT];
+    int transitions = 0;
+    governor.set_transition_callback([&](const LoadTransition &transition) {
+        if (transitions < LOAD_LEVEL_COUNT)
+            transition_times[transitions] = transition.time_us;
+        transitions++;
+    });
+
+    // 110% 負載持續 2 秒：每 200 ms 最多降一級，停在 max_level
+    LoadLevel level = run_frames(governor, 250, 8800);
+
+    check("降到 energy_vad", level == LOAD_LEVEL_ENERGY_VAD, level);
+    check("降級 3 次", governor.get_stats().degrades == 3, governor.get_stats().degrades);
+    check("回調 3 次", transitions == 3, transitions);
+
+    bool dwell_ok = true;
+    for (int i = 1; i < 3 && i < transitions; i++)
+        dwell_ok &= transition_times[i] - transition_times[i - 1] >= LOAD_GOVERNOR_MIN_DWELL_MS * 1000;
+    check("切換間隔 >= 最短停留時間", dwell_ok, dwell_ok);
+
+    // max_level 限制
+    sim_now_us = 0;
+    LoadGovernorConfig config = LoadGovernor::create_default_config();
+    config.max_level = LOAD_LEVEL_SILENCE_LITE;
+    LoadGovernor limited(config);
+    level = run_frames(limited, 250, 8800);
+    check("max_level = silence_lite 時停在該級", level == LOAD_LEVEL_SILENCE_LITE, level);
+}
+
+void test_deadline_miss()
+{
+    Serial.println("=== 測試錯過期限立即降級 ===");
+
+    sim_now_us = 0;
+    LoadGovernor governor;
+    run_frames(governor, 100, 3000);
+
+    sim_now_us += HOP_US;
+    LoadLevel level = governor.update(sim_now_us, 3000, HOP_US, true);
+
+    LoadGovernor::LoadGovernorStats stats = governor.get_stats();
+    check("單次錯過即降一級", level == LOAD_LEVEL_SILENCE_LITE, level);
+    check("原因 = deadline_miss", stats.last_transition.reason == LOAD_REASON_DEADLINE_MISS,
+          stats.last_transition.reason);
+    check("切換時間 = 模擬時鐘", stats.last_transition.time_us == sim_now_us, stats.last_transition.time_us);
+
+    // 停留時間內的第二次錯過不再降級
+    sim_now_us += HOP_US;
+    level = governor.update(sim_now_us, 3000, HOP_US, true);
+    check("停留時間內不連續降級", level == LOAD_LEVEL_SILENCE_LITE, level);
+}
+
+void test_recovery()
+{
+    Serial.println("=== 測試餘裕恢復 ===");
+
+    sim_now_us = 0;
+    LoadGovernor governor;
+    run_frames(governor, 250, 8800);
+
+    // 負載降到 25%：平滑負載約 10 幀後低於門檻，之後持續 1 秒才恢復一級
+    LoadLevel level = run_frames(governor, 125, 2000); // 1 秒
+    check("1 秒內尚未恢復", level == LOAD_LEVEL_ENERGY_VAD, level);
+
+    level = run_frames(governor, 20, 2000);
+    check("約 1.1 秒後恢復一級", level == LOAD_LEVEL_SILENCE_STRIDE, level);
+
+    // 餘裕中斷（負載回到 75%）後重新計時
+    run_frames(governor, 50, 6000);
+    level = run_frames(governor, 100, 2000);
+    check("餘裕中斷後不立即恢復", level == LOAD_LEVEL_SILENCE_STRIDE, level);
+
+    level = run_frames(governor, 500, 2000);
+    check("最終回到 full", level == LOAD_LEVEL_FULL, level);
+
+    LoadGovernor::LoadGovernorStats stats = governor.get_stats();
+    check("恢復 3 次", stats.recoveries == 3, stats.recoveries);
+    check("原因 = headroom", stats.last_transition.reason == LOAD_REASON_HEADROOM, stats.last_transition.reason);
+
+    uint64_t total_us = 0;
+    for (int l = 0; l < LOAD_LEVEL_COUNT; l++)
+        total_us += stats.time_in_level_us[l];
+    check("各等級停留時間總和 = 經過時間", total_us == (uint64_t)(sim_now_us - HOP_US),
+          (float)(total_us / 1000));
+    check("energy_vad 停留時間 > 1 秒", stats.time_in_level_us[LOAD_LEVEL_ENERGY_VAD] > 1000000,
+          stats.time_in_level_us[LOAD_LEVEL_ENERGY_VAD] / 1000.0f);
+
+    governor.print_stats(debug_test);
+}
+
+void setup()
+{
+    test_begin("CPU 負載調節測試");
+
+    test_within_budget();
+    test_overload_steps();
+    test_deadline_miss();
+    test_recovery();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,71 @@
+/**
+ * 編譯期日誌等級評測
+ * 以目前編譯的 DEBUG_LEVEL_MAX 執行，預設與 -DDEBUG_LEVEL_MAX=0 各編譯一次比較：
+ * 1. 韌體大小（PlatformIO 編譯結果的 Flash 用量與此處的 sketch 大小）
+ * 2. 即時擷取每幀 cycles（執行期 debug 開啟 / 關閉兩輪）
+ *
+ * DEBUG_LEVEL_MAX=0 時兩輪應相同：所有日誌呼叫連同參數都已在編譯期移除
+ */
+
+#include <Arduino.h>
+#include "audio_module.h"
+#include "test_check.h"
+
+#define BENCHMARK_MS 10000 // 每輪擷取時間
+
+AudioCaptureModule audio;
+
+/**
+ * 擷取 BENCHMARK_MS 毫秒，回傳每個 hop 的平均處理週期數（閘門之後的逐幀處理）
+ */
+float measure_cycles_per_frame(bool debug_enabled)
+{
+    audio.set_debug(debug_enabled);
+    audio.reset_pipeline_tier_stats();
+    audio.start_capture();
+
+    unsigned long start = millis();
+    while (millis() - start < BENCHMARK_MS)
+        audio.process_audio_loop();
+
+    audio.stop_capture();
+    AudioCaptureModule::PipelineTierStats stats = audio.get_pipeline_tier_stats();
+    if (stats.gate_frames == 0)
+        return 0.0f;
+    return (float)(stats.silence_cycles + stats.speech_cycles) / stats.gate_frames;
+}
+
+void setup()
+{
+    char title[64];
+    snprintf(title, sizeof(title), "編譯期日誌等級評測（DEBUG_LEVEL_MAX = %d）", DEBUG_LEVEL_MAX);
+    test_begin(title);
+
+    // 1. 韌體大小
+    Serial.println("=== 韌體大小 ===");
+#if defined(ESP_PLATFORM)
+    Serial.printf("  sketch: %lu bytes\n", (unsigned long)ESP.getSketchSize());
+#endif
+    Serial.println("  （與另一種 DEBUG_LEVEL_MAX 編譯結果的 Flash 用量比較）");
+
+    if (!audio.initialize())
+    {
+        Serial.println("❌ 音訊模組初始化失敗");
+        return;
+    }
+
+    // 2. 每幀 cycles
+    Serial.println("\n=== 每幀 cycles ===");
+    float quiet = measure_cycles_per_frame(false);
+    float verbose = measure_cycles_per_frame(true);
+    Serial.printf("  執行期 debug 關閉: %.0f cycles\n", quiet);
+    Serial.printf("  執行期 debug 開啟: %.0f cycles\n", verbose);
+
+    check("量測到每幀 cycles", quiet > 0.0f, quiet);
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,114 @@
+/**
+ * 權杖化日誌封包測試
+ * 1. 編譯期雜湊與 FNV-1a 參考值一致（python/log_token_decoder.py 使用相同演算法）
+ * 2. 封包格式：起始位元組、長度、權杖、模組、種類、各型別參數
+ * 3. 過長字串截斷在 UTF-8 邊界並標記
+ * 4. 封包大小與對應文字的比較
+ */
+
+#include <Arduino.h>
+#include "debug_print.h"
+#include "test_check.h"
+
+template <typename T>
+T read_value(const uint8_t *data)
+{
+    T value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+void test_hash()
+{
+    Serial.println("=== 測試編譯期雜湊 ===");
+
+    // FNV-1a 32-bit 參考值
+    check("空字串", LOG_TOKEN("") == 0x811C9DC5u, 0);
+    check("\"a\"", LOG_TOKEN("a") == 0xE40C292Cu, 0);
+    check("\"foobar\"", LOG_TOKEN("foobar") == 0xBF9CF968u, 0);
+    check("執行期與編譯期相同", log_token_hash("RMS:%.3f\n") == LOG_TOKEN("RMS:%.3f\n"), 0);
+}
+
+void test_frame_layout()
+{
+    Serial.println("=== 測試封包格式 ===");
+
+    LogTokenWriter writer(LOG_TOKEN("%d %lu %.2f %s\n"), 0x1234, LOG_KIND_PRINTF);
+    writer.encode(-5, 70000UL, 0.25f, "GMM");
+    size_t length = writer.finish();
+    const uint8_t *frame = writer.data();
+
+    size_t expected = 2 + LOG_TOKEN_HEADER_SIZE + sizeof(int) + sizeof(unsigned long) + sizeof(float) + 4;
+    check("封包長度", length == expected, length);
+    check("起始位元組", frame[0] == LOG_TOKEN_SYNC, frame[0]);
+    check("長度欄位 = 封包 - 2", frame[1] == length - 2, frame[1]);
+    check("權杖", read_value<uint32_t>(frame + 2) == LOG_TOKEN("%d %lu %.2f %s\n"), 0);
+    check("模組", read_value<uint16_t>(frame + 6) == 0x1234, read_value<uint16_t>(frame + 6));
+    check("種類", frame[8] == LOG_KIND_PRINTF, frame[8]);
+
+    const uint8_t *args = frame + 2 + LOG_TOKEN_HEADER_SIZE;
+    check("int 參數", read_value<int>(args) == -5, read_value<int>(args));
+    args += sizeof(int);
+    check("unsigned long 參數", read_value<unsigned long>(args) == 70000UL, read_value<unsigned long>(args));
+    args += sizeof(unsigned long);
+    check("float 參數", read_value<float>(args) == 0.25f, read_value<float>(args));
+    args += sizeof(float);
+    check("字串參數以 NUL 結尾", strcmp((const char *)args, "GMM") == 0, 0);
+}
+
+void test_truncation()
+{
+    Serial.println("=== 測試字串截斷 ===");
+
+    char text[200];
+    size_t length = 0;
+    while (length + 3 < sizeof(text))
+    {
+        memcpy(text + length, "音", 3);
+        length += 3;
+    }
+    text[length] = 0;
+
+    LogTokenWriter writer(LOG_TOKEN("%s"), 0, LOG_KIND_PRINT);
+    writer.encode(text);
+    size_t size = writer.finish();
+    const uint8_t *frame = writer.data();
+    size_t kept = strlen((const char *)frame + 2 + LOG_TOKEN_HEADER_SIZE);
+
+    check("標記截斷", writer.is_truncated() && (frame[8] & LOG_KIND_TRUNCATED), frame[8]);
+    check("不超過封包上限", size <= 2 + LOG_TOKEN_MAX_PAYLOAD, size);
+    check("截斷在 UTF-8 邊界", kept % 3 == 0, kept);
+}
+
+void test_size()
+{
+    Serial.println("=== 封包與文字大小 ===");
+
+    DebugPrint debug_test("AudioCapture", true);
+    LogTokenWriter writer(LOG_TOKEN("📊 機率分佈 - 靜音:%.1f%% 未知:%.1f%% Yes:%.1f%% No:%.1f%%\n"), 0, LOG_KIND_PRINTF);
+    writer.encode(91.5f, 3.2f, 4.1f, 1.2f);
+    size_t frame_size = writer.finish();
+
+    char text[DEBUG_PRINT_BUFFER_SIZE];
+    int text_size = snprintf(text, sizeof(text), "[%s] 📊 機率分佈 - 靜音:%.1f%% 未知:%.1f%% Yes:%.1f%% No:%.1f%%\n",
+                             debug_test.get_module_name(), 91.5f, 3.2f, 4.1f, 1.2f);
+    Serial.printf("    封包 %u bytes，文字 %d bytes\n", (unsigned)frame_size, text_size);
+    check("封包小於文字的一半", frame_size * 2 < (size_t)text_size, (float)text_size / frame_size);
+}
+
+void setup()
+{
+    test_begin("權杖化日誌封包測試");
+
+    test_hash();
+    test_frame_layout();
+    test_truncation();
+    test_size();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,164 @@
+/**
+ * 指標登錄表測試
+ * 1. 靜態登錄與解構時移除
+ * 2. 計數器、量測值（含最大值）、log2 直方圖
+ * 3. 文字快照格式與緩衝區不足時截斷在完整指標邊界
+ * 4. 二進位快照格式
+ * 5. 更新與快照成本（只報告，不判定；實際耗時受主機負載影響）
+ */
+
+#include <Arduino.h>
+#include "metrics.h"
+#include "test_check.h"
+
+#define COST_RUNS 10000
+
+DebugPrint debug_test("Metrics", true);
+
+// 靜態物件：在 setup() 之前就已登錄
+MetricCounter test_counter("test.counter");
+
+void test_registration()
+{
+    Serial.println("=== 測試登錄 ===");
+
+    uint16_t before = metrics.size();
+    check("靜態物件已登錄", metrics.find("test.counter") == &test_counter, before);
+    {
+        MetricGauge scoped("test.scoped");
+        check("建構時登錄", metrics.size() == before + 1 && metrics.find("test.scoped") == &scoped, metrics.size());
+    }
+    check("解構時移除", metrics.size() == before && metrics.find("test.scoped") == nullptr, metrics.size());
+}
+
+void test_values()
+{
+    Serial.println("=== 測試數值 ===");
+
+    test_counter.reset();
+    test_counter.add();
+    test_counter.add(41);
+    check("計數器 = 42", test_counter.get() == 42, test_counter.get());
+
+    MetricGauge gauge("test.gauge");
+    gauge.set(-5);
+    check("量測值可為負", gauge.get() == -5, gauge.get());
+    gauge.update_max(10);
+    gauge.update_max(3);
+    check("update_max 只保留最大值", gauge.get() == 10, gauge.get());
+
+    MetricHistogram histogram("test.hist");
+    const uint32_t values[] = {0, 1, 2, 3, 100, 1000000};
+    for (int i = 0; i < 6; i++)
+        histogram.record(values[i]);
+    check("0 與 1 落在第 0 桶", histogram.get_bucket(0) == 2, histogram.get_bucket(0));
+    check("2、3 落在第 1 桶", histogram.get_bucket(1) == 2, histogram.get_bucket(1));
+    check("100 落在第 6 桶", histogram.get_bucket(6) == 1, histogram.get_bucket(6));
+    check("超出範圍落在最後一桶", histogram.get_bucket(METRIC_HISTOGRAM_BUCKETS - 1) == 1,
+          histogram.get_bucket(METRIC_HISTOGRAM_BUCKETS - 1));
+    check("總數 = 6", histogram.get_count() == 6, histogram.get_count());
+}
+
+void test_text_snapshot()
+{
+    Serial.println("=== 測試文字快照 ===");
+
+    MetricGauge gauge("test.level");
+    MetricHistogram histogram("test.latency");
+    test_counter.reset();
+    test_counter.add(7);
+    gauge.set(-3);
+    histogram.record(5);
+    histogram.record(5);
+
+    char buffer[METRICS_SNAPSHOT_BUFFER_SIZE];
+    size_t length = metrics.snapshot_text(buffer, sizeof(buffer));
+    Serial.printf("    %s", buffer);
+
+    check("單行、以換行結尾", length > 0 && buffer[length - 1] == '\n' && strchr(buffer, '\n') == buffer + length - 1,
+          length);
+    check("計數器", strstr(buffer, " test.counter=7") != nullptr, 0);
+    check("量測值", strstr(buffer, " test.level=-3") != nullptr, 0);
+    check("直方圖省略尾端 0", strstr(buffer, " test.latency=[0,0,2]") != nullptr, 0);
+
+    // 緩衝區不足：只保留完整的指標（"metrics test.counter=7\n" 需要 24 bytes）
+    char small[20];
+    length = metrics.snapshot_text(small, sizeof(small));
+    check("截斷在完整指標邊界", strcmp(small, "metrics\n") == 0, length);
+}
+
+void test_binary_snapshot()
+{
+    Serial.println("=== 測試二進位快照 ===");
+
+    uint8_t buffer[METRICS_SNAPSHOT_BUFFER_SIZE];
+    size_t length = metrics.snapshot_binary(buffer, sizeof(buffer));
+
+    uint16_t body;
+    uint16_t count;
+    memcpy(&body, buffer + 1, sizeof(body));
+    memcpy(&count, buffer + 4, sizeof(count));
+    check("起始位元組", buffer[0] == METRICS_SNAPSHOT_SYNC, buffer[0]);
+    check("長度欄位 = 總長 - 3", body == length - 3, body);
+    check("版本", buffer[3] == METRICS_SNAPSHOT_VERSION, buffer[3]);
+    check("指標數 = 登錄數", count == metrics.size(), count);
+
+    // 第一個登錄的指標就是 test.counter（此測試程式沒有其他靜態指標）
+    const uint8_t *first = buffer + 6;
+    uint32_t value;
+    memcpy(&value, first + 1 + strlen("test.counter") + 1, sizeof(value));
+    check("第一個指標 = test.counter", first[0] == METRIC_COUNTER && strcmp((const char *)first + 1, "test.counter") == 0,
+          first[0]);
+    check("數值", value == test_counter.get(), value);
+
+    char text[METRICS_SNAPSHOT_BUFFER_SIZE];
+    size_t text_length = metrics.snapshot_text(text, sizeof(text));
+    Serial.printf("    二進位 %u bytes，文字 %u bytes\n", (unsigned)length, (unsigned)text_length);
+}
+
+void test_cost()
+{
+    Serial.println("=== 成本 ===");
+
+    MetricHistogram histogram("test.cost");
+    test_counter.reset();
+    uint32_t start = micros();
+    for (int i = 0; i < COST_RUNS; i++)
+        test_counter.add();
+    float counter_ns = (micros() - start) * 1000.0f / COST_RUNS;
+
+    start = micros();
+    for (int i = 0; i < COST_RUNS; i++)
+        histogram.record(i);
+    float histogram_ns = (micros() - start) * 1000.0f / COST_RUNS;
+
+    char buffer[METRICS_SNAPSHOT_BUFFER_SIZE];
+    start = micros();
+    metrics.snapshot_text(buffer, sizeof(buffer));
+    uint32_t snapshot_us = micros() - start;
+
+    Serial.printf("    計數器 %.0f ns，直方圖 %.0f ns，文字快照 %lu µs\n", counter_ns, histogram_ns,
+                  (unsigned long)snapshot_us);
+    check("計數器累計 COST_RUNS 次", test_counter.get() == COST_RUNS, test_counter.get());
+    check("直方圖記錄 COST_RUNS 次", histogram.get_count() == COST_RUNS, histogram.get_count());
+
+    metrics.print(debug_test);
+}
+
+void setup()
+{
+    test_begin("指標登錄表測試");
+
+    test_registration();
+    test_values();
+    test_text_snapshot();
+    test_binary_snapshot();
+    test_cost();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
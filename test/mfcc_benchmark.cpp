@@ -0,0 +1,251 @@
+/**
+ * MfccExtractor 測試與效能評測
+ * 1. 查表實作與直接公式（logf、cosf）比對
+ * 2. 定點路徑與浮點路徑比對
+ * 3. 串流差分對線性變化的回應
+ * 4. 吞吐量（幀/毫秒）
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "spectral_features.h"
+#include "mfcc.h"
+#include "test_check.h"
+
+#define BENCHMARK_FRAMES 1000
+
+SpectralAnalyzer analyzer;
+MfccExtractor mfcc;
+
+void make_test_frame(int index, float *frame)
+{
+    uint32_t state = index + 1;
+    for (int n = 0; n < SPECTRAL_FFT_SIZE; n++)
+    {
+        double x = 0.4 * sin(2 * PI * (300 + 200 * index) * n / SPECTRAL_SAMPLE_RATE) +
+                   0.2 * sin(2 * PI * 2300 * n / SPECTRAL_SAMPLE_RATE + 0.7);
+
+        // 線性同餘亂數底噪
+        state = (1103515245u * state + 12345u) & 0x7FFFFFFFu;
+        x += ((double)state / 2147483648.0 - 0.5) * 0.02;
+
+        float window = (float)(0.5 * (1.0 - cos(2.0 * PI * n / (SPECTRAL_FFT_SIZE - 1))));
+        frame[n] = (float)x * window;
+    }
+}
+
+/**
+ * 直接依定義計算 MFCC（不使用任何表格）
+ */
+void reference_mfcc(const float *power, float *coeffs)
+{
+    float mel_low = 2595.0f * log10f(1.0f + MFCC_LOW_FREQ / 700.0f);
+    float mel_high = 2595.0f * log10f(1.0f + MFCC_HIGH_FREQ / 700.0f);
+    float points[MFCC_NUM_FILTERS + 2];
+    for (int i = 0; i < MFCC_NUM_FILTERS + 2; i++)
+    {
+        float mel = mel_low + (mel_high - mel_low) * i / (MFCC_NUM_FILTERS + 1);
+        points[i] = 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f) * SPECTRAL_FFT_SIZE / SPECTRAL_SAMPLE_RATE;
+    }
+
+    float log_mel[MFCC_NUM_FILTERS];
+    for (int m = 0; m < MFCC_NUM_FILTERS; m++)
+    {
+        float sum = 0.0f;
+        for (int k = 0; k < SPECTRAL_NUM_BINS; k++)
+        {
+            float w = 0.0f;
+            if (k >= points[m] && k < points[m + 1])
+                w = (k - points[m]) / (points[m + 1] - points[m]);
+            else if (k >= points[m + 1] && k < points[m + 2])
+                w = (points[m + 2] - k) / (points[m + 2] - points[m + 1]);
+            sum += w * power[k];
+        }
+        log_mel[m] = logf(fmaxf(sum, MFCC_LOG_FLOOR));
+    }
+
+    for (int c = 0; c < MFCC_NUM_COEFFS; c++)
+    {
+        float scale = sqrtf((c == 0 ? 1.0f : 2.0f) / MFCC_NUM_FILTERS);
+        float sum = 0.0f;
+        for (int m = 0; m < MFCC_NUM_FILTERS; m++)
+        {
+            sum += log_mel[m] * cosf(PI * c * (m + 0.5f) / MFCC_NUM_FILTERS);
+        }
+        coeffs[c] = scale * sum;
+    }
+}
+
+void test_against_reference()
+{
+    Serial.println("=== 測試查表實作 vs 直接公式 ===");
+
+    float frame[SPECTRAL_FFT_SIZE];
+    SpectralFeatures spectral;
+    for (int index = 0; index < 3; index++)
+    {
+        make_test_frame(index, frame);
+        analyzer.analyze(frame, &spectral);
+
+        float expected[MFCC_NUM_COEFFS];
+        reference_mfcc(analyzer.get_power_spectrum(), expected);
+
+        MfccFeatures features;
+        mfcc.compute(analyzer.get_power_spectrum(), &features);
+
+        // 對數表誤差上限約 0.004 nats，經 DCT 放大至多 sqrt(2 * M) 倍
+        for (int c = 0; c < MFCC_NUM_COEFFS; c++)
+        {
+            char name[16];
+            snprintf(name, sizeof(name), "f%d c%d", index, c);
+            check_near(name, features.coeffs[c], expected[c], 0.03f, true);
+        }
+    }
+    Serial.println(failures == 0 ? "  ✅ 通過" : "  ❌ 失敗");
+}
+
+void test_fixed_point()
+{
+    Serial.println("=== 測試定點 vs 浮點 ===");
+    int before = failures;
+
+    // 功率譜放大 2^16 後量化，梅爾能量再帶 Q12 權重；
+    // 對數能量因此整體偏移 (16 + 12) * ln2，只反映在 c0（乘上 sqrt(M)）
+    const int shift = 16;
+    const float c0_offset = (shift + MFCC_WEIGHT_FRAC_BITS) * 0.693147f * sqrtf(MFCC_NUM_FILTERS);
+
+    float frame[SPECTRAL_FFT_SIZE];
+    SpectralFeatures spectral;
+    uint32_t power_q[SPECTRAL_NUM_BINS];
+
+    mfcc.reset();
+    for (int index = 0; index < 3; index++)
+    {
+        make_test_frame(index, frame);
+        analyzer.analyze(frame, &spectral);
+
+        const float *power = analyzer.get_power_spectrum();
+        for (int k = 0; k < SPECTRAL_NUM_BINS; k++)
+        {
+            power_q[k] = (uint32_t)(power[k] * (1 << shift) + 0.5f);
+        }
+
+        MfccFeatures features;
+        MfccFixedFeatures fixed;
+        mfcc.compute(power, &features);
+        mfcc.compute_fixed(power_q, &fixed);
+
+        const float q = 1.0f / (1 << MFCC_FIXED_FRAC_BITS);
+        for (int c = 0; c < MFCC_NUM_COEFFS; c++)
+        {
+            char name[16];
+            snprintf(name, sizeof(name), "f%d c%d", index, c);
+            float expected = features.coeffs[c] + (c == 0 ? c0_offset : 0.0f);
+            check_near(name, fixed.coeffs[c] * q, expected, 0.05f, true);
+
+            snprintf(name, sizeof(name), "f%d d%d", index, c);
+            check_near(name, fixed.delta[c] * q, features.delta[c], 0.05f, true);
+        }
+    }
+    Serial.println(failures == before ? "  ✅ 通過" : "  ❌ 失敗");
+}
+
+void test_streaming_delta()
+{
+    Serial.println("=== 測試串流差分 ===");
+    int before = failures;
+
+    // 每幀梅爾能量乘以 e^slope：對數能量線性上升，只有 c0 隨時間變化
+    const float slope = 0.1f;
+    float mel[MFCC_NUM_FILTERS];
+    for (int j = 0; j < MFCC_NUM_FILTERS; j++)
+    {
+        mel[j] = 0.01f * (j + 1);
+    }
+
+    mfcc.reset();
+    MfccFeatures features;
+    for (int t = 0; t < 3 * MFCC_HISTORY_SIZE; t++)
+    {
+        mfcc.compute_from_mel(mel, &features);
+        for (int j = 0; j < MFCC_NUM_FILTERS; j++)
+        {
+            mel[j] *= expf(slope);
+        }
+    }
+
+    check_near("delta c0", features.delta[0], slope * sqrtf(MFCC_NUM_FILTERS), 0.02f, true);
+    check_near("delta c1", features.delta[1], 0.0f, 0.02f, true);
+    check_near("delta2 c0", features.delta2[0], 0.0f, 0.02f, true);
+    Serial.println(failures == before ? "  ✅ 通過" : "  ❌ 失敗");
+}
+
+void benchmark()
+{
+    Serial.println("=== 吞吐量 ===");
+
+    float frame[SPECTRAL_FFT_SIZE];
+    make_test_frame(0, frame);
+    SpectralFeatures spectral;
+    MfccFeatures features;
+    MfccFixedFeatures fixed;
+
+    analyzer.analyze(frame, &spectral);
+    uint32_t power_q[SPECTRAL_NUM_BINS];
+    for (int k = 0; k < SPECTRAL_NUM_BINS; k++)
+    {
+        power_q[k] = (uint32_t)(analyzer.get_power_spectrum()[k] * 65536.0f);
+    }
+
+    // FFT + 頻譜特徵 + 浮點 MFCC
+    unsigned long start = micros();
+    for (int i = 0; i < BENCHMARK_FRAMES; i++)
+    {
+        analyzer.analyze(frame, &spectral);
+        mfcc.compute(analyzer.get_power_spectrum(), &features);
+    }
+    unsigned long full_us = micros() - start;
+
+    // 僅浮點 MFCC
+    start = micros();
+    for (int i = 0; i < BENCHMARK_FRAMES; i++)
+    {
+        mfcc.compute(analyzer.get_power_spectrum(), &features);
+    }
+    unsigned long float_us = micros() - start;
+
+    // 僅定點 MFCC
+    start = micros();
+    for (int i = 0; i < BENCHMARK_FRAMES; i++)
+    {
+        mfcc.compute_fixed(power_q, &fixed);
+    }
+    unsigned long fixed_us = micros() - start;
+
+    Serial.printf("  FFT + 浮點 MFCC: %.2f 幀/ms (%.1f us/幀)\n",
+                  BENCHMARK_FRAMES * 1000.0f / full_us, (float)full_us / BENCHMARK_FRAMES);
+    Serial.printf("  浮點 MFCC:       %.2f 幀/ms (%.1f us/幀)\n",
+                  BENCHMARK_FRAMES * 1000.0f / float_us, (float)float_us / BENCHMARK_FRAMES);
+    Serial.printf("  定點 MFCC:       %.2f 幀/ms (%.1f us/幀)\n",
+                  BENCHMARK_FRAMES * 1000.0f / fixed_us, (float)fixed_us / BENCHMARK_FRAMES);
+    Serial.printf("  即時需求: %.3f 幀/ms（每 %d 樣本一幀）\n",
+                  (float)SPECTRAL_SAMPLE_RATE / (SPECTRAL_FFT_SIZE / 2) / 1000.0f, SPECTRAL_FFT_SIZE / 2);
+    Serial.printf("  浮點 MFCC 平均: %lu cycles\n", (unsigned long)mfcc.get_average_cycles());
+}
+
+void setup()
+{
+    test_begin("MfccExtractor 測試與效能評測");
+
+    test_against_reference();
+    test_fixed_point();
+    test_streaming_delta();
+    benchmark();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,335 @@
+/**
+ * 噪音抑制評測
+ * 以合成語句加上空調類穩態噪音（低頻隆隆聲 + 60 Hz 諧波 + 寬頻噪音），
+ * 在 10/5/0 dB SNR 下比較關閉與開啟噪音抑制時：
+ * 1. 語音段能量線索相對乾淨訊號的誤差 (dB)
+ * 2. MFCC c1..c12 相對乾淨訊號的距離
+ * 3. 關鍵字判決與乾淨訊號一致的比例
+ * 以及 NoiseSuppressor 每幀 cycles。
+ * 訊號經主機 I2S 送入 AudioCaptureModule，特徵由模組的前端（DC 阻隔、預強調、頻譜、梅爾、噪音抑制）產生；
+ * 幀回調依樣本時間取出語音段的幀平均，兩種模式平均的幀完全相同。
+ * CMVN 會把能量縮放到背景噪音，這裡關閉 CMVN 以單獨評估噪音抑制；AGC 停用，位準固定；
+ * 兩段式處理關閉，每個 hop 都有特徵。
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "host_sim.h"
+#include "audio_module.h"
+#include "keyword_model.h"
+#include "test_check.h"
+
+#define TEST_LEAD_FRAMES 150      // 語音前的噪音幀數（噪音估計與 CMVN 收斂）
+#define TEST_TAIL_FRAMES 10
+#define TEST_MAX_SPEECH_FRAMES 80
+#define TEST_MAX_SAMPLES ((TEST_LEAD_FRAMES + TEST_MAX_SPEECH_FRAMES + TEST_TAIL_FRAMES) * AUDIO_FRAME_HOP + AUDIO_FRAME_OVERLAP)
+#define TEST_UTTERANCES 12
+
+static const float kSnrDb[] = {10.0f, 5.0f, 0.0f};
+static const int kSnrCount = sizeof(kSnrDb) / sizeof(kSnrDb[0]);
+
+static float speech_signal[TEST_MAX_SAMPLES];
+static float noise_signal[TEST_MAX_SAMPLES];
+static int16_t pcm[TEST_MAX_SAMPLES];
+static uint32_t suppressor_cycles; // 最近一次開啟抑制時的 NoiseSuppressor 平均 cycles/幀
+
+struct Utterance
+{
+    float f0;
+    float formant;
+    int frames;
+};
+
+struct UtteranceResult
+{
+    int frames; // 平均的語音幀數
+    float energy;
+    float coeffs[MFCC_NUM_COEFFS];
+    KeywordClass keyword;
+};
+
+Utterance corpus[TEST_UTTERANCES];
+UtteranceResult clean_results[2][TEST_UTTERANCES];
+
+void build_corpus()
+{
+    const float f0s[] = {110.0f, 150.0f, 210.0f};
+    const float formants[] = {450.0f, 750.0f};
+    const int lengths[] = {40, 75};
+    int index = 0;
+    for (int a = 0; a < 3; a++)
+        for (int b = 0; b < 2; b++)
+            for (int c = 0; c < 2; c++)
+                corpus[index++] = {f0s[a], formants[b], lengths[c]};
+}
+
+int total_samples(const Utterance &u)
+{
+    return (TEST_LEAD_FRAMES + u.frames + TEST_TAIL_FRAMES) * AUDIO_FRAME_HOP + AUDIO_FRAME_OVERLAP;
+}
+
+/**
+ * 合成語句：兩個音節的諧波語音，回傳語音段平均功率
+ */
+float synth_speech(const Utterance &u)
+{
+    int samples = total_samples(u);
+    int start = TEST_LEAD_FRAMES * AUDIO_FRAME_HOP;
+    int length = u.frames * AUDIO_FRAME_HOP;
+    float power = 0.0f;
+
+    for (int n = 0; n < samples; n++)
+    {
+        float x = 0.0f;
+        if (n >= start && n < start + length)
+        {
+            float t = (float)(n - start) / length;
+            float envelope = fabsf(sinf(2.0f * PI * t)); // 兩個音節
+            float f0 = u.f0 * (1.0f + 0.1f * t);
+            for (int h = 1; h <= 24; h++)
+            {
+                float f = f0 * h;
+                float d1 = (f - u.formant) / 150.0f;
+                float d2 = (f - 2.4f * u.formant) / 250.0f;
+                float weight = (1.0f + 3.0f * expf(-0.5f * d1 * d1) + 1.5f * expf(-0.5f * d2 * d2)) / h;
+                x += weight * sinf(2.0f * PI * f * n / AUDIO_SAMPLE_RATE);
+            }
+            x *= 1200.0f * envelope;
+            power += x * x;
+        }
+        speech_signal[n] = x;
+    }
+    return power / length;
+}
+
+/**
+ * 空調類穩態噪音，回傳平均功率
+ */
+float synth_noise(int samples)
+{
+    uint32_t state = 12345;
+    float rumble = 0.0f;
+    float power = 0.0f;
+    for (int n = 0; n < samples; n++)
+    {
+        state = (1103515245u * state + 12345u) & 0x7FFFFFFFu;
+        float white = (float)state / 2147483648.0f - 0.5f;
+
+        rumble = 0.98f * rumble + white; // 低頻隆隆聲
+        float hum = sinf(2.0f * PI * 60.0f * n / AUDIO_SAMPLE_RATE) +
+                    0.5f * sinf(2.0f * PI * 120.0f * n / AUDIO_SAMPLE_RATE) +
+                    0.3f * sinf(2.0f * PI * 180.0f * n / AUDIO_SAMPLE_RATE);
+
+        float x = 1.0f * rumble + 0.8f * hum + 0.6f * white;
+        noise_signal[n] = x;
+        power += x * x;
+    }
+    return power / samples;
+}
+
+KeywordClass classify(const AudioFeatures &features)
+{
+    keyword_detector.reset();
+    KeywordResult result;
+    for (int i = 0; i < SEQUENCE_LENGTH; i++)
+        result = keyword_detector.detect(features);
+    return result.detected_keyword;
+}
+
+struct PcmSource
+{
+    int position;
+    int samples;
+};
+
+size_t pcm_source(int32_t *slots, size_t frames, uint8_t channels, void *context)
+{
+    PcmSource *source = (PcmSource *)context;
+    size_t n = 0;
+    for (; n < frames && source->position < source->samples; n++, source->position++)
+    {
+        // AGC 停用時固定增益 G = INMP441_GAIN_FACTOR × 16：16-bit 值 v 對應 24-bit 的 v × 256 / G
+        int32_t raw = (int32_t)pcm[source->position] * 16 / INMP441_GAIN_FACTOR;
+        for (uint8_t ch = 0; ch < channels; ch++)
+            slots[n * channels + ch] = raw << 8;
+    }
+    return n;
+}
+
+// 幀回調在正規化之前取得特徵：MFCC 已經過噪音抑制，能量線索取 normalize_features 會採用的值
+const Utterance *current_utterance;
+bool current_suppress;
+AudioFeatures speech_sum;
+int speech_frames;
+
+void on_frame(const AudioFeatures &f)
+{
+    int frame = f.timestamp / AUDIO_FRAME_HOP;
+    if (frame < TEST_LEAD_FRAMES || frame >= TEST_LEAD_FRAMES + current_utterance->frames)
+        return;
+
+    speech_sum.rms_energy += current_suppress ? f.denoised_energy : f.rms_energy;
+    speech_sum.zero_crossing_rate += f.zero_crossing_rate;
+    speech_sum.spectral_centroid += f.spectral_centroid;
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+        speech_sum.mfcc.coeffs[k] += f.mfcc.coeffs[k];
+    speech_frames++;
+}
+
+/**
+ * 將一段語句送入 AudioCaptureModule，回傳語音段平均特徵
+ */
+void run_utterance(const Utterance &u, bool suppress, UtteranceResult *result)
+{
+    PcmSource source = {0, total_samples(u)};
+    host_i2s_set_source(pcm_source, &source);
+    current_utterance = &u;
+    current_suppress = suppress;
+    memset(&speech_sum, 0, sizeof(speech_sum));
+    speech_frames = 0;
+
+    INMP441Config config = INMP441Module::create_default_config();
+    config.agc_enabled = false;
+
+    AudioCaptureModule module;
+    module.set_audio_frame_callback(on_frame);
+    module.initialize(config);
+    module.set_two_rate_processing(false);
+    module.set_load_governor_enabled(false); // 主機排程不影響特徵
+    module.set_cmvn_enabled(false);
+    module.set_noise_suppression_enabled(suppress);
+    module.start_capture();
+
+    // 手動時鐘：每輪只推進 1 ms，處理速度或主機負載不會造成 DMA 溢位，結果可重現
+    host_clock_set_mode(HOST_CLOCK_MANUAL);
+    unsigned long start = millis();
+    while (!host_i2s_finished() && millis() - start < 20000)
+    {
+        module.process_audio_loop();
+        host_clock_advance_us(1000);
+    }
+    host_clock_set_mode(HOST_CLOCK_SIMULATED);
+
+    if (suppress)
+        suppressor_cycles = module.get_noise_suppressor().get_average_cycles();
+    module.deinitialize();
+    host_i2s_set_source(nullptr, nullptr);
+
+    AudioFeatures &sum = speech_sum;
+    float scale = 1.0f / max(1, speech_frames);
+    sum.rms_energy *= scale;
+    sum.zero_crossing_rate *= scale;
+    sum.spectral_centroid *= scale;
+    for (int k = 0; k < MFCC_NUM_COEFFS; k++)
+        sum.mfcc.coeffs[k] *= scale;
+    sum.is_voice_detected = true;
+
+    result->frames = speech_frames;
+    result->energy = sum.rms_energy;
+    memcpy(result->coeffs, sum.mfcc.coeffs, sizeof(result->coeffs));
+    result->keyword = classify(sum);
+}
+
+/**
+ * 混合語音與噪音（snr_db < 0 表示不加噪音）
+ */
+void mix(const Utterance &u, float speech_power, float noise_power, float snr_db)
+{
+    float noise_gain = (snr_db < 0.0f) ? 0.0f : sqrtf(speech_power / noise_power / powf(10.0f, snr_db / 10.0f));
+    int samples = total_samples(u);
+    for (int n = 0; n < samples; n++)
+    {
+        // 乾淨訊號保留極低的底噪，避免全零幀
+        float x = speech_signal[n] + noise_gain * noise_signal[n] + ((n * 7919) % 17 - 8);
+        pcm[n] = (int16_t)constrain(x, -32768.0f, 32767.0f);
+    }
+}
+
+void setup()
+{
+    test_begin("噪音抑制評測");
+
+    build_corpus();
+    float noise_power = synth_noise(TEST_MAX_SAMPLES);
+
+    // 乾淨參考
+    for (int i = 0; i < TEST_UTTERANCES; i++)
+    {
+        float speech_power = synth_speech(corpus[i]);
+        mix(corpus[i], speech_power, noise_power, -1.0f);
+        run_utterance(corpus[i], false, &clean_results[0][i]);
+        run_utterance(corpus[i], true, &clean_results[1][i]);
+    }
+
+    float energy_error[kSnrCount][2];
+    float coeff_error[kSnrCount][2];
+    int agreement[kSnrCount][2];
+    bool frames_ok = true;
+    memset(energy_error, 0, sizeof(energy_error));
+    memset(coeff_error, 0, sizeof(coeff_error));
+    memset(agreement, 0, sizeof(agreement));
+
+    for (int s = 0; s < kSnrCount; s++)
+    {
+        for (int i = 0; i < TEST_UTTERANCES; i++)
+        {
+            float speech_power = synth_speech(corpus[i]);
+            mix(corpus[i], speech_power, noise_power, kSnrDb[s]);
+
+            for (int mode = 0; mode < 2; mode++)
+            {
+                UtteranceResult noisy;
+                run_utterance(corpus[i], mode == 1, &noisy);
+                frames_ok = frames_ok && noisy.frames == corpus[i].frames;
+
+                // 能量線索一律與未抑制的乾淨訊號比較
+                const UtteranceResult &clean = clean_results[mode][i];
+                energy_error[s][mode] += fabsf(20.0f * log10f(noisy.energy / clean_results[0][i].energy));
+
+                float d = 0.0f;
+                for (int k = 1; k < MFCC_NUM_COEFFS; k++)
+                {
+                    float diff = noisy.coeffs[k] - clean.coeffs[k];
+                    d += diff * diff;
+                }
+                coeff_error[s][mode] += sqrtf(d);
+
+                if (noisy.keyword == clean.keyword)
+                    agreement[s][mode]++;
+            }
+        }
+    }
+
+    Serial.println("\nSNR    | 抑制 | 能量誤差 dB | MFCC 距離 | 判決一致");
+    for (int s = 0; s < kSnrCount; s++)
+    {
+        for (int mode = 0; mode < 2; mode++)
+        {
+            Serial.printf("%4.0f dB | %s | %10.2f | %9.2f | %2d/%d\n", kSnrDb[s], mode ? "開" : "關",
+                          energy_error[s][mode] / TEST_UTTERANCES, coeff_error[s][mode] / TEST_UTTERANCES,
+                          agreement[s][mode], TEST_UTTERANCES);
+        }
+    }
+
+    Serial.printf("\nNoiseSuppressor 平均: %lu cycles/幀\n", (unsigned long)suppressor_cycles);
+
+    // 開啟抑制後，各 SNR 的能量線索誤差與 MFCC 距離都應小於關閉時，判決一致數不得變少
+    char name[64];
+    for (int s = 0; s < kSnrCount; s++)
+    {
+        snprintf(name, sizeof(name), "%.0f dB 能量誤差降低", kSnrDb[s]);
+        check(name, energy_error[s][1] < energy_error[s][0], (energy_error[s][0] - energy_error[s][1]) / TEST_UTTERANCES);
+        snprintf(name, sizeof(name), "%.0f dB MFCC 距離降低", kSnrDb[s]);
+        check(name, coeff_error[s][1] < coeff_error[s][0], (coeff_error[s][0] - coeff_error[s][1]) / TEST_UTTERANCES);
+        snprintf(name, sizeof(name), "%.0f dB 判決一致數不變差", kSnrDb[s]);
+        check(name, agreement[s][1] >= agreement[s][0], agreement[s][1] - agreement[s][0]);
+    }
+    check("每段語句平均的幀數正確", frames_ok, frames_ok);
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,214 @@
+/**
+ * 多相抽取器測試
+ * 1. 3:1 (48k → 16k) 與 6:1 (48k → 8k) 頻率響應：通帶平坦、混疊頻率被壓抑
+ * 2. 不規則區塊大小與原地處理結果逐樣本相同
+ * 3. 每個輸出樣本的 cycles（只輸出，不判定）
+ * 4. 8kHz 低功耗模式：每秒輸出樣本數，前端成本（轉換 + 能量閘門）相對 16kHz 只輸出
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "polyphase_decimator.h"
+#include "audio_module.h"
+#include "test_check.h"
+
+#define INPUT_RATE 48000
+#define TEST_INPUT 48000   // 1 秒
+#define SETTLE_OUTPUTS 64  // 略過濾波器暫態
+
+PolyphaseDecimator decimator;
+int32_t input[TEST_INPUT];
+int32_t output[TEST_INPUT];
+int32_t output_blocks[TEST_INPUT];
+
+/**
+ * 48kHz 正弦波，24-bit 振幅 2^22（-6 dBFS），I2S 容器格式
+ */
+void make_tone(float freq)
+{
+    for (int n = 0; n < TEST_INPUT; n++)
+    {
+        input[n] = (int32_t)lroundf(4194304.0f * sinf(2.0f * PI * freq * n / INPUT_RATE)) * 256;
+    }
+}
+
+float gain_db(int factor, float freq)
+{
+    make_tone(freq);
+    decimator.reset();
+    decimator.configure(factor);
+    size_t count = decimator.process(input, TEST_INPUT, output);
+
+    double sum = 0.0;
+    for (size_t i = SETTLE_OUTPUTS; i < count; i++)
+    {
+        double x = output[i] / 256.0;
+        sum += x * x;
+    }
+    double rms = sqrt(sum / (count - SETTLE_OUTPUTS));
+    return (float)(20.0 * log10(rms / (4194304.0 / sqrt(2.0)) + 1e-12));
+}
+
+void test_frequency_response(int factor)
+{
+    const float out_rate = (float)INPUT_RATE / factor;
+    const float pass_edge = out_rate * 0.4f;  // 16k: 6.4kHz, 8k: 3.2kHz
+    const float stop_edge = out_rate * 0.6f;  // 16k: 9.6kHz, 8k: 4.8kHz
+
+    Serial.printf("=== 測試 %d:1 頻率響應（輸出 %.0f Hz，%d taps）===\n", factor, out_rate, factor * DECIMATOR_TAPS_PER_PHASE);
+
+    float worst_pass = 0.0f;
+    for (float f = 100.0f; f <= pass_edge; f += pass_edge / 16)
+    {
+        float g = gain_db(factor, f);
+        if (fabsf(g) > fabsf(worst_pass))
+            worst_pass = g;
+    }
+    check("通帶最大偏差 |dB| < 0.5", fabsf(worst_pass) < 0.5f, worst_pass);
+
+    float worst_stop = -200.0f;
+    for (float f = stop_edge; f < INPUT_RATE / 2; f += 700.0f)
+    {
+        float g = gain_db(factor, f);
+        if (g > worst_stop)
+            worst_stop = g;
+    }
+    check("混疊頻率最大增益 dB < -55", worst_stop < -55.0f, worst_stop);
+}
+
+void test_block_invariance()
+{
+    Serial.println("=== 測試區塊不變性 ===");
+
+    make_tone(1234.0f);
+    decimator.reset();
+    decimator.configure(3);
+    size_t count = decimator.process(input, TEST_INPUT, output);
+
+    // 不規則區塊 + 原地處理
+    memcpy(output_blocks, input, sizeof(input));
+    decimator.reset();
+    decimator.configure(3);
+    const int sizes[] = {1, 2, 97, 512, 5, 1536};
+    size_t pos = 0;
+    size_t produced = 0;
+    int k = 0;
+    while (pos < TEST_INPUT)
+    {
+        size_t size = min((size_t)sizes[k++ % 6], (size_t)TEST_INPUT - pos);
+        // 先把這段搬到輸出位置之後再原地處理
+        memmove(output_blocks + produced, output_blocks + pos, size * sizeof(int32_t));
+        produced += decimator.process(output_blocks + produced, size, output_blocks + produced);
+        pos += size;
+    }
+
+    int mismatches = (count == produced) ? 0 : 1;
+    for (size_t i = 0; i < count && i < produced; i++)
+    {
+        if (output[i] != output_blocks[i])
+            mismatches++;
+    }
+    check("不一致樣本數", mismatches == 0, mismatches);
+}
+
+void test_cycles()
+{
+    Serial.println("=== 每個輸出樣本 cycles ===");
+    make_tone(1000.0f);
+
+    const int factors[] = {3, 6};
+    for (int f = 0; f < 2; f++)
+    {
+        decimator.reset();
+        decimator.configure(factors[f]);
+        for (int repeat = 0; repeat < 20; repeat++)
+        {
+            for (int offset = 0; offset < TEST_INPUT; offset += 384)
+                decimator.process(input + offset, 384, output);
+        }
+        uint32_t per_output = decimator.get_average_cycles_per_output();
+        Serial.printf("  %d:1  %lu cycles/輸出樣本, %lu cycles/秒音訊\n", factors[f], (unsigned long)per_output,
+                      (unsigned long)(per_output * (INPUT_RATE / factors[f])));
+    }
+}
+
+/**
+ * 每秒音訊的前端成本：抽取、轉換（DC 阻隔 + AGC）與能量閘門
+ * 抽取成本兩種模式相同（每秒乘加數相同），轉換與閘門與輸出取樣率成正比
+ */
+void measure_frontend(bool low_power, uint32_t *decimate_cycles, uint32_t *frontend_cycles, size_t *output_count)
+{
+    static INMP441Module mic;
+    static EnergyGate gate;
+    static audio_sample_t samples[TEST_INPUT];
+    const int repeats = 20;
+    const int factor = low_power ? INMP441_LOW_POWER_FACTOR : INMP441_OVERSAMPLE_FACTOR;
+
+    make_tone(300.0f);
+
+    // 抽取：一次處理整秒輸入
+    decimator.reset();
+    decimator.configure(factor);
+    size_t count = 0;
+    uint32_t start = ESP.getCycleCount();
+    for (int r = 0; r < repeats; r++)
+        count = decimator.process(input, TEST_INPUT, output);
+    *decimate_cycles = (ESP.getCycleCount() - start) / repeats;
+
+    // 轉換（DC 阻隔 + AGC）：對抽取後的樣本計時
+    mic.set_config(INMP441Module::create_default_config());
+    start = ESP.getCycleCount();
+    for (int r = 0; r < repeats; r++)
+        mic.process_raw_samples(output, samples, count);
+    uint32_t convert_cycles = (ESP.getCycleCount() - start) / repeats;
+
+    // 能量閘門：與 AudioCaptureModule 相同的 8ms hop
+    const size_t hop = low_power ? AUDIO_LOW_POWER_HOP : AUDIO_FRAME_HOP;
+    int16_t hop_q15[AUDIO_FRAME_HOP];
+    gate.reset();
+    start = ESP.getCycleCount();
+    for (int r = 0; r < repeats; r++)
+    {
+        for (size_t offset = 0; offset + hop <= count; offset += hop)
+            gate.process(audio_samples_to_q15(samples + offset, hop_q15, hop), hop);
+    }
+    uint32_t gate_cycles = (ESP.getCycleCount() - start) / repeats;
+
+    *frontend_cycles = convert_cycles + gate_cycles;
+    *output_count = count;
+}
+
+void test_low_power_cost()
+{
+    Serial.println("=== 8kHz 低功耗前端成本（每秒音訊）===");
+
+    uint32_t full_decimate, full_frontend, low_decimate, low_frontend;
+    size_t full_count, low_count;
+    measure_frontend(false, &full_decimate, &full_frontend, &full_count);
+    measure_frontend(true, &low_decimate, &low_frontend, &low_count);
+    check("16kHz 每秒輸出樣本數", full_count == INPUT_RATE / INMP441_OVERSAMPLE_FACTOR, full_count);
+    check("8kHz 每秒輸出樣本數", low_count == INPUT_RATE / INMP441_LOW_POWER_FACTOR, low_count);
+
+    // 耗時受排程與其他測試的負載影響，只輸出不判定
+    Serial.printf("  16kHz: 抽取 %lu + 轉換/閘門 %lu cycles\n", (unsigned long)full_decimate, (unsigned long)full_frontend);
+    Serial.printf("   8kHz: 抽取 %lu + 轉換/閘門 %lu cycles\n", (unsigned long)low_decimate, (unsigned long)low_frontend);
+    Serial.printf("  轉換/閘門 8kHz / 16kHz: %.2f\n", (float)low_frontend / max(1u, full_frontend));
+}
+
+void setup()
+{
+    test_begin("多相抽取器測試");
+
+    test_frequency_response(3);
+    test_frequency_response(6);
+    test_block_invariance();
+    test_cycles();
+    test_low_power_cost();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,143 @@
+/**
+ * 樣本時鐘測試
+ * 1. 推進、毫秒與樣本數互換
+ * 2. INMP441 區塊時間戳：16kHz 直接擷取、48kHz 過取樣、8kHz 低功耗切換時時間軸連續
+ * 3. 關鍵字冷卻以樣本時間判斷（開機第一秒不再誤判為冷卻中）
+ * 4. DMA 溢位遺失樣本後，牆上時間換算重新對齊（主機手動時鐘，可重現）
+ */
+
+#include <Arduino.h>
+#include "sample_clock.h"
+#include "inmp441_module.h"
+#include "keyword_model.h"
+#include "host_sim.h"
+#include "test_check.h"
+
+#define TEST_BLOCK 512
+
+int32_t raw[TEST_BLOCK * INMP441_LOW_POWER_FACTOR];
+audio_sample_t samples[TEST_BLOCK * INMP441_LOW_POWER_FACTOR];
+
+void test_conversions()
+{
+    Serial.println("=== 測試時間換算 ===");
+
+    SampleClock clock;
+    clock.start(16000);
+    check("第一個區塊時間 = 0", clock.advance(256) == 0, 0);
+    check("第二個區塊時間 = 256", clock.advance(256) == 256, 256);
+    check("目前時間 = 512", clock.now() == 512, clock.now());
+    check("16000 樣本 = 1000 ms", clock.to_ms(16000) == 1000, clock.to_ms(16000));
+    check("128 樣本 = 8000 µs", clock.to_us(128) == 8000, clock.to_us(128));
+    check("300 ms = 4800 樣本", clock.from_ms(300) == 4800, clock.from_ms(300));
+
+    // 超過 32-bit 毫秒計數的時間（約 3.1 天）仍正確
+    sample_time_t late = (sample_time_t)16000 * 3600 * 80;
+    check("80 小時後的時間差 = 8 ms", clock.to_ms(late + 128 - late) == 8, clock.to_ms(late + 128 - late));
+    check("牆上時間與樣本時間差一致", clock.to_wall_us(16000) - clock.to_wall_us(0) == 1000000,
+          (unsigned long long)(clock.to_wall_us(16000) - clock.to_wall_us(0)));
+}
+
+void test_block_timestamps()
+{
+    Serial.println("=== 測試 INMP441 區塊時間戳 ===");
+
+    static INMP441Module mic;
+    memset(raw, 0, sizeof(raw));
+
+    // 16kHz 直接擷取：每個輸出樣本 1 個刻度
+    mic.set_config(INMP441Module::create_default_config());
+    mic.process_raw_samples(raw, samples, TEST_BLOCK);
+    mic.process_raw_samples(raw, samples, TEST_BLOCK);
+    check("16kHz 第二個區塊 = 512", mic.get_block_timestamp() == TEST_BLOCK, mic.get_block_timestamp());
+
+    // 48kHz 過取樣：1536 個原始樣本 → 512 個輸出樣本 → 512 個刻度
+    mic.set_config(INMP441Module::create_oversampled_config());
+    check("set_config 後時鐘歸零", mic.get_sample_clock().now() == 0, mic.get_sample_clock().now());
+    size_t count = mic.process_raw_samples(raw, samples, TEST_BLOCK * INMP441_OVERSAMPLE_FACTOR);
+    check("48kHz → 16kHz 推進 512", mic.get_sample_clock().now() == count && count == TEST_BLOCK, mic.get_sample_clock().now());
+
+    // 8kHz 低功耗：輸出樣本減半，但每秒推進的刻度相同
+    mic.set_low_power_mode(true);
+    count = mic.process_raw_samples(raw, samples, TEST_BLOCK * INMP441_OVERSAMPLE_FACTOR);
+    check("8kHz 區塊輸出 256 樣本", count == TEST_BLOCK / 2, count);
+    check("8kHz 區塊時間 = 512", mic.get_block_timestamp() == TEST_BLOCK, mic.get_block_timestamp());
+    check("8kHz 區塊推進 512 刻度", mic.get_sample_clock().now() == 2 * TEST_BLOCK, mic.get_sample_clock().now());
+
+    mic.set_low_power_mode(false);
+    mic.process_raw_samples(raw, samples, TEST_BLOCK * INMP441_OVERSAMPLE_FACTOR);
+    check("切回 16kHz 後時間連續 = 1024", mic.get_block_timestamp() == 2 * TEST_BLOCK, mic.get_block_timestamp());
+}
+
+void test_keyword_cooldown()
+{
+    Serial.println("=== 測試關鍵字冷卻（樣本時間）===");
+
+    keyword_detector.reset();
+    check("尚未偵測時不在冷卻中（t = 0）", !keyword_detector.is_in_cooldown(0), 0);
+
+    AudioFeatures features;
+    memset(&features, 0, sizeof(features));
+    features.timestamp = 123456;
+    KeywordResult result = keyword_detector.detect(features);
+    check("結果時間戳 = 輸入幀時間", result.timestamp == 123456, result.timestamp);
+}
+
+void test_drop_resync()
+{
+    Serial.println("=== 測試遺失樣本後的牆上時間 ===");
+
+    static INMP441Module mic;
+    static audio_sample_t block[INMP441_BUFFER_SIZE];
+    host_clock_set_mode(HOST_CLOCK_MANUAL);
+    mic.initialize(INMP441Module::create_default_config());
+    mic.start();
+    const SampleClock &clock = mic.get_sample_clock();
+
+    // 每 8 ms 讀完緩衝區：沒有遺失，原點不動
+    for (int i = 0; i < 100; i++)
+    {
+        host_clock_advance_us(8000);
+        while (mic.read_audio_data(block, INMP441_BUFFER_SIZE) > 0)
+            ;
+    }
+    check("正常讀取不重新對齊", clock.get_resync_us() == 0, clock.get_resync_us());
+
+    // 主迴圈停頓 2 秒（如 setup() 結尾的 delay(2000)）：DMA 只保留最後 8 × 64 樣本
+    host_clock_advance_us(2000000);
+    int64_t read_us = host_clock_now_us();
+    mic.read_audio_data(block, INMP441_BUFFER_SIZE);
+
+    // 讀出的第一個樣本約在緩衝區長度之前擷取（主機 DMA 以整個緩衝區為單位填入，誤差 < 1 個緩衝區）
+    const int64_t buffered_us = (int64_t)INMP441_DMA_BUF_COUNT * INMP441_DMA_BUF_LEN * 1000000 / INMP441_SAMPLE_RATE;
+    const int64_t buf_us = (int64_t)INMP441_DMA_BUF_LEN * 1000000 / INMP441_SAMPLE_RATE;
+    int64_t error = clock.to_wall_us(mic.get_block_timestamp()) - (read_us - buffered_us);
+    check("溢位後區塊牆上時間誤差 < 1 個 DMA 緩衝", error >= 0 && error <= buf_us, error);
+    check("原點後移約 2 秒", llabs(clock.get_resync_us() - 2000000) <= buffered_us, clock.get_resync_us());
+
+    // 遺失樣本統計以 start() 為準，不受重新對齊影響
+    uint64_t dropped = mic.get_statistics().dropped_samples;
+    check("遺失樣本統計約 2 秒", dropped >= INMP441_SAMPLE_RATE * 2 - 2 * INMP441_DMA_BUF_COUNT * INMP441_DMA_BUF_LEN &&
+                                   dropped <= INMP441_SAMPLE_RATE * 2, dropped);
+
+    mic.stop();
+    mic.deinitialize();
+    host_clock_set_mode(HOST_CLOCK_SIMULATED);
+}
+
+void setup()
+{
+    test_begin("樣本時鐘測試");
+
+    test_conversions();
+    test_block_timestamps();
+    test_keyword_cooldown();
+    test_drop_resync();
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
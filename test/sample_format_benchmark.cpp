@@ -0,0 +1,150 @@
+/**
+ * 擷取樣本格式評測（int16 與 Q31）
+ * 以目前編譯的 AUDIO_SAMPLE_Q31 設定執行，兩種模式各編譯一次比較：
+ * 1. 安靜訊號經轉換後的量化 SNR（Q31 應保留 24-bit 解析度）
+ * 2. 每幀 cycles：轉換、正規化 + 窗函數、縮為 16-bit（能量閘門/GMM VAD 用）
+ * 3. 擷取路徑的樣本緩衝區記憶體
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "audio_module.h"
+#include "test_check.h"
+
+#define BENCHMARK_FRAMES 20000
+#define SNR_SAMPLES 16000
+
+INMP441Module mic;
+int32_t raw[SNR_SAMPLES];
+audio_sample_t converted[SNR_SAMPLES];
+
+/**
+ * 產生 1 kHz 正弦波（24-bit，放在 32-bit 容器高位），回傳理想 24-bit 值於 ideal
+ */
+void make_tone(float level_dbfs, float *ideal)
+{
+    const float amplitude = 8388607.0f * powf(10.0f, level_dbfs / 20.0f);
+    for (int n = 0; n < SNR_SAMPLES; n++)
+    {
+        float x = amplitude * sinf(2.0f * PI * 1000.0f * n / INMP441_SAMPLE_RATE);
+        int32_t value = (int32_t)lroundf(x);
+        raw[n] = value * 256;
+        if (ideal)
+            ideal[n] = (float)value;
+    }
+}
+
+/**
+ * 量化 SNR：輸出換回 24-bit 刻度後與輸入比較
+ */
+float measure_snr(float level_dbfs)
+{
+    static float ideal[SNR_SAMPLES];
+    make_tone(level_dbfs, ideal);
+
+    INMP441Config config = INMP441Module::create_default_config();
+    config.agc_enabled = false;
+    config.gain_factor = 1; // G = 16：int16 模式丟棄低 4 位
+    config.dc_block_coeff = 0;
+    mic.set_config(config);
+    mic.process_raw_samples(raw, converted, SNR_SAMPLES);
+
+    // 輸出 = 24-bit × G / 256 × 2^AUDIO_SAMPLE_SHIFT
+    const double to_24bit = 256.0 / (16.0 * (double)(1L << AUDIO_SAMPLE_SHIFT));
+    double signal = 0.0;
+    double noise = 0.0;
+    for (int n = 0; n < SNR_SAMPLES; n++)
+    {
+        double error = converted[n] * to_24bit - ideal[n];
+        signal += (double)ideal[n] * ideal[n];
+        noise += error * error;
+    }
+    return (float)(10.0 * log10(signal / (noise + 1e-12)));
+}
+
+void setup()
+{
+    char title[64];
+    snprintf(title, sizeof(title), "擷取樣本格式評測（%s，%u bytes/樣本）", AUDIO_SAMPLE_Q31 ? "Q31" : "int16",
+             (unsigned)sizeof(audio_sample_t));
+    test_begin(title);
+
+    // 1. 量化 SNR
+    Serial.println("=== 量化 SNR（固定增益 G = 16）===");
+    const float levels[] = {-30.0f, -50.0f, -70.0f};
+    for (int l = 0; l < 3; l++)
+    {
+        float snr = measure_snr(levels[l]);
+        Serial.printf("  %5.0f dBFS 輸入 → SNR %6.1f dB\n", levels[l], snr);
+
+        // Q31 模式不應有額外量化損失（24-bit 輸入本身已四捨五入）
+        if (AUDIO_SAMPLE_Q31)
+            check("Q31 模式保留完整解析度", snr >= 120.0f, snr);
+    }
+
+    // 2. 每幀 cycles
+    Serial.println("\n=== 每幀 cycles ===");
+    make_tone(-30.0f, nullptr);
+    mic.set_config(INMP441Module::create_default_config());
+
+    float window[AUDIO_FRAME_SIZE];
+    for (int i = 0; i < AUDIO_FRAME_SIZE; i++)
+        window[i] = 0.5f * (1.0f - cosf(2.0f * PI * i / (AUDIO_FRAME_SIZE - 1)));
+
+    // 各階段分開計時整個迴圈，避免逐幀讀取計數器的誤差
+    float frame[AUDIO_FRAME_SIZE];
+    int16_t hop_q15[AUDIO_FRAME_HOP];
+    volatile int32_t sink = 0;
+
+    uint32_t start = ESP.getCycleCount();
+    for (int f = 0; f < BENCHMARK_FRAMES; f++)
+    {
+        int offset = (f * AUDIO_FRAME_HOP) % (SNR_SAMPLES - AUDIO_FRAME_SIZE);
+        mic.process_raw_samples(raw + offset, converted + offset, AUDIO_FRAME_HOP);
+    }
+    uint32_t convert_cycles = ESP.getCycleCount() - start;
+
+    // 與 AudioCaptureModule::prepare_frame 相同：正規化 + 窗函數
+    start = ESP.getCycleCount();
+    for (int f = 0; f < BENCHMARK_FRAMES; f++)
+    {
+        const audio_sample_t *pcm = converted + (f * AUDIO_FRAME_HOP) % (SNR_SAMPLES - AUDIO_FRAME_SIZE);
+        for (int i = 0; i < AUDIO_FRAME_SIZE; i++)
+        {
+            float x = (float)pcm[i] / AUDIO_SAMPLE_FULL_SCALE * AUDIO_NORMALIZATION_FACTOR;
+            frame[i] = constrain(x, -1.0f, 1.0f) * window[i];
+        }
+        sink += (int32_t)frame[f % AUDIO_FRAME_SIZE];
+    }
+    uint32_t prepare_cycles = ESP.getCycleCount() - start;
+
+    start = ESP.getCycleCount();
+    for (int f = 0; f < BENCHMARK_FRAMES; f++)
+    {
+        const audio_sample_t *pcm = converted + (f * AUDIO_FRAME_HOP) % (SNR_SAMPLES - AUDIO_FRAME_SIZE);
+        const int16_t *hop = audio_samples_to_q15(pcm + AUDIO_FRAME_OVERLAP, hop_q15, AUDIO_FRAME_HOP);
+        sink += hop[f % AUDIO_FRAME_HOP];
+    }
+    uint32_t narrow_cycles = ESP.getCycleCount() - start;
+
+    Serial.printf("  轉換 (每 hop %d 樣本)      : %lu cycles\n", AUDIO_FRAME_HOP,
+                  (unsigned long)(convert_cycles / BENCHMARK_FRAMES));
+    Serial.printf("  正規化 + 窗函數           : %lu cycles\n", (unsigned long)(prepare_cycles / BENCHMARK_FRAMES));
+    Serial.printf("  縮為 16-bit (閘門/VAD)    : %lu cycles\n", (unsigned long)(narrow_cycles / BENCHMARK_FRAMES));
+
+    // 3. 記憶體：INMP441 讀取緩衝區 + AudioCaptureModule 的 processed/frame/frame_pcm/preroll 緩衝區
+    size_t samples = INMP441_BUFFER_SIZE + AUDIO_BUFFER_SIZE + AUDIO_BUFFER_SIZE * 2 + AUDIO_FRAME_SIZE +
+                     AUDIO_PREROLL_FRAMES * AUDIO_FRAME_SIZE;
+    size_t scratch = AUDIO_SAMPLE_Q31 ? AUDIO_FRAME_HOP * sizeof(int16_t) : 0;
+    Serial.println("\n=== 記憶體 ===");
+    Serial.printf("  樣本緩衝區: %u 樣本 × %u bytes = %u bytes（另有堆疊 %u bytes 縮減暫存）\n",
+                  (unsigned)samples, (unsigned)sizeof(audio_sample_t), (unsigned)(samples * sizeof(audio_sample_t)),
+                  (unsigned)scratch);
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
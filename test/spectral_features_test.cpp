@@ -0,0 +1,123 @@
+/**
+ * SpectralAnalyzer 測試
+ * 以合成訊號驗證頻譜特徵與 NumPy 參考值一致
+ * 參考值由 python/spectral_reference.py 產生
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "spectral_features.h"
+#include "test_check.h"
+
+// NumPy 參考值：重心、滾降、平坦度、通量、頻帶能量
+struct SpectralReference
+{
+    float centroid;
+    float rolloff;
+    float flatness;
+    float flux;
+    float band_energy[SPECTRAL_BAND_COUNT];
+};
+
+static const SpectralReference kReference[2] = {
+    // frame 0
+    {1.802792e-01f, 3.750000e-01f, 2.391617e-04f, 0.000000e+00f,
+     {6.544538e-03f, 5.885556e-03f, 2.571852e+02f, 1.269704e+03f, 6.431496e+01f, 3.194202e+02f, 6.998897e-02f, 1.527118e+01f}},
+    // frame 1
+    {1.792673e-01f, 1.953125e-01f, 3.777395e-04f, 5.425597e+01f,
+     {4.459382e-03f, 6.230506e+01f, 7.262340e-01f, 9.746571e+02f, 7.126074e-02f, 4.357003e-02f, 9.437170e-02f, 1.112319e-01f}},
+};
+
+SpectralAnalyzer analyzer;
+
+/**
+ * 產生與 spectral_reference.py 相同的加窗測試幀
+ */
+void make_test_frame(int index, float *frame)
+{
+    uint32_t state = index + 1;
+    for (int n = 0; n < SPECTRAL_FFT_SIZE; n++)
+    {
+        double x;
+        if (index == 0)
+        {
+            x = 0.5 * sin(2 * PI * 1000 * n / SPECTRAL_SAMPLE_RATE) +
+                0.25 * sin(2 * PI * 3000 * n / SPECTRAL_SAMPLE_RATE + 0.3) +
+                0.05 * sin(2 * PI * 6500 * n / SPECTRAL_SAMPLE_RATE);
+        }
+        else
+        {
+            x = 0.4 * sin(2 * PI * 1500 * n / SPECTRAL_SAMPLE_RATE) +
+                0.1 * sin(2 * PI * 400 * n / SPECTRAL_SAMPLE_RATE + 1.0);
+        }
+
+        // 線性同餘亂數底噪
+        state = (1103515245u * state + 12345u) & 0x7FFFFFFFu;
+        x += ((double)state / 2147483648.0 - 0.5) * 0.02;
+
+        float window = (float)(0.5 * (1.0 - cos(2.0 * PI * n / (SPECTRAL_FFT_SIZE - 1))));
+        frame[n] = (float)x * window;
+    }
+}
+
+void test_reference_frames()
+{
+    Serial.println("=== 測試 NumPy 參考值 ===");
+
+    float frame[SPECTRAL_FFT_SIZE];
+    for (int index = 0; index < 2; index++)
+    {
+        make_test_frame(index, frame);
+
+        SpectralFeatures features;
+        analyzer.analyze(frame, &features);
+
+        const SpectralReference &ref = kReference[index];
+        Serial.printf("幀 %d:\n", index);
+        check_near("centroid", features.centroid, ref.centroid, 1e-4f);
+        check_near("rolloff", features.rolloff, ref.rolloff, 1e-6f);
+        check_near("flatness", features.flatness, ref.flatness, ref.flatness * 0.01f);
+        check_near("flux", features.flux, ref.flux, 1e-3f * (ref.flux + 1.0f));
+
+        for (int b = 0; b < SPECTRAL_BAND_COUNT; b++)
+        {
+            char name[16];
+            snprintf(name, sizeof(name), "band[%d]", b);
+            check_near(name, features.band_energy[b], ref.band_energy[b], 1e-3f * ref.band_energy[b] + 1e-4f);
+        }
+    }
+}
+
+void test_pure_tone_centroid()
+{
+    Serial.println("=== 測試純音頻譜重心 ===");
+
+    // 2 kHz 純音的重心應接近 2000/8000 = 0.25
+    float frame[SPECTRAL_FFT_SIZE];
+    for (int n = 0; n < SPECTRAL_FFT_SIZE; n++)
+    {
+        float window = 0.5f * (1.0f - cosf(2.0f * PI * n / (SPECTRAL_FFT_SIZE - 1)));
+        frame[n] = sinf(2.0f * PI * 2000 * n / SPECTRAL_SAMPLE_RATE) * window;
+    }
+
+    SpectralFeatures features;
+    analyzer.analyze(frame, &features);
+    check_near("centroid", features.centroid, 0.25f, 0.01f);
+}
+
+void setup()
+{
+    test_begin("SpectralAnalyzer 測試程式");
+
+    test_reference_frames();
+    test_pure_tone_centroid();
+
+    Serial.printf("\n每幀平均成本: %lu cycles\n", (unsigned long)analyzer.get_average_cycles());
+
+    test_end();
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,123 @@
+/**
+ * 階段耗時分析器測試
+ * 1. 已知分布的 min/mean/p99/max（p99 由直方圖估計，誤差在一個子區間內）
+ * 2. 區間記錄以無號減法處理計數器回繞；區塊計時器記錄到正確的階段
+ * 3. 每次記錄的額外成本（只報告，不判定；實際耗時受主機負載影響）
+ * PROFILER_ENABLED=0 時整個分析器不編譯，測試只輸出略過訊息
+ */
+
+#include <Arduino.h>
+#include "stage_profiler.h"
+#include "test_check.h"
+
+#define OVERHEAD_RUNS 10000
+
+#if PROFILER_ENABLED
+
+DebugPrint debug_test("Profiler", true);
+
+void test_known_distribution()
+{
+    Serial.println("=== 測試已知分布 ===");
+
+    // 990 次 100 ticks + 10 次 10000 ticks：p99 落在 100 所在的桶
+    stage_profiler.reset();
+    for (int i = 0; i < 990; i++)
+        stage_profiler.record(PROFILE_STAGE_VAD, 100);
+    for (int i = 0; i < 10; i++)
+        stage_profiler.record(PROFILE_STAGE_VAD, 10000);
+
+    StageProfiler::StageStats stats = stage_profiler.get_stats(PROFILE_STAGE_VAD);
+    check("count = 1000", stats.count == 1000, stats.count);
+    check("min = 100", stats.min == 100, stats.min);
+    check("max = 10000", stats.max == 10000, stats.max);
+    check("mean = 199", stats.mean == 199, stats.mean);
+    check("p99 在 [100, 112)", stats.p99 >= 100 && stats.p99 < 112, stats.p99);
+
+    // 1..10000 均勻分布：p99 約 9900，誤差 < 12.5%
+    stage_profiler.reset();
+    for (uint32_t v = 1; v <= 10000; v++)
+        stage_profiler.record(PROFILE_STAGE_FEATURES, v);
+    stats = stage_profiler.get_stats(PROFILE_STAGE_FEATURES);
+    check("均勻分布 mean = 5000", stats.mean == 5000, stats.mean);
+    check("均勻分布 p99 誤差 < 12.5%", fabsf(stats.p99 - 9900.0f) < 9900.0f * 0.125f, stats.p99);
+
+    // 超出直方圖範圍的值仍以 max 為上限
+    stage_profiler.reset();
+    stage_profiler.record(PROFILE_STAGE_KEYWORD, 0xF0000000u);
+    stats = stage_profiler.get_stats(PROFILE_STAGE_KEYWORD);
+    check("超出範圍 p99 = max", stats.p99 == stats.max, stats.p99);
+}
+
+void test_scoped_timer()
+{
+    Serial.println("=== 測試區間記錄與區塊計時器 ===");
+
+    // 合成計數值：跨越 32-bit 回繞的區間仍得到正確長度
+    stage_profiler.reset();
+    stage_profiler.record_span(PROFILE_STAGE_DECIMATE, 1000, 1300);
+    stage_profiler.record_span(PROFILE_STAGE_DECIMATE, 0xFFFFFF00u, 0x100u);
+    StageProfiler::StageStats stats = stage_profiler.get_stats(PROFILE_STAGE_DECIMATE);
+    check("區間 min = 300", stats.min == 300, stats.min);
+    check("回繞區間 max = 512", stats.max == 512, stats.max);
+
+    // 區塊計時器：只檢查記錄到哪個階段與次數，耗時僅供參考
+    stage_profiler.reset();
+    for (int i = 0; i < 5; i++)
+    {
+        PROFILE_SCOPE(PROFILE_STAGE_CONVERT);
+        delayMicroseconds(200);
+    }
+
+    stats = stage_profiler.get_stats(PROFILE_STAGE_CONVERT);
+    check("記錄 5 次", stats.count == 5, stats.count);
+    check("其他階段沒有記錄", stage_profiler.get_stats(PROFILE_STAGE_GATE).count == 0,
+          stage_profiler.get_stats(PROFILE_STAGE_GATE).count);
+    Serial.printf("    delayMicroseconds(200) 量到最短 %.1f µs\n", stats.min / (float)profiler_ticks_per_us());
+
+    PROFILE_PRINT(debug_test);
+}
+
+void test_overhead()
+{
+    Serial.println("=== 每次記錄的額外成本 ===");
+
+    stage_profiler.reset();
+    uint32_t start = profiler_ticks();
+    for (int i = 0; i < OVERHEAD_RUNS; i++)
+    {
+        PROFILE_SCOPE(PROFILE_STAGE_FRAME);
+    }
+    uint32_t elapsed = profiler_ticks() - start;
+
+    float per_scope_us = elapsed / (float)profiler_ticks_per_us() / OVERHEAD_RUNS;
+    StageProfiler::StageStats stats = stage_profiler.get_stats(PROFILE_STAGE_FRAME);
+    Serial.printf("    空區塊：每次 %.3f µs（計時器內量到 mean %.3f µs）\n", per_scope_us,
+                  stats.mean / (float)profiler_ticks_per_us());
+    check("記錄 OVERHEAD_RUNS 次", stats.count == OVERHEAD_RUNS, stats.count);
+}
+
+void setup()
+{
+    test_begin("階段耗時分析器測試");
+
+    test_known_distribution();
+    test_scoped_timer();
+    test_overhead();
+
+    test_end();
+}
+
+#else
+
+void setup()
+{
+    test_skip("PROFILER_ENABLED=0，階段耗時分析器未編譯");
+}
+
+#endif // PROFILER_ENABLED
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,79 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <Arduino.h>
+#include <math.h>
+#include <type_traits>
+
+/**
+ * 測試草稿碼共用的檢查與輸出
+ * 主機 ctest 以輸出判定：「所有測試通過」為通過、「測試失敗」為失敗、「略過測試」為略過
+ * 每個測試是獨立的草稿碼（單一編譯單元），失敗計數直接放在標頭內
+ */
+
+static int failures = 0;
+
+/**
+ * 單項檢查：輸出 ✅/❌、名稱與觀察值（整數照原樣，浮點數取 3 位小數）
+ */
+template <typename T>
+void check(const char *name, bool ok, T value)
+{
+    Serial.printf("  %s %-36s ", ok ? "✅" : "❌", name);
+    if (std::is_floating_point<T>::value)
+        Serial.printf("%.3f\n", (double)value);
+    else if (std::is_signed<T>::value)
+        Serial.printf("%lld\n", (long long)value);
+    else
+        Serial.printf("%llu\n", (unsigned long long)value);
+    if (!ok)
+        failures++;
+}
+
+/**
+ * 容差比較：|actual - expected| <= tolerance
+ * @param quiet 只輸出失敗項（大量逐項比較時使用）
+ */
+inline bool check_near(const char *name, double actual, double expected, double tolerance, bool quiet = false)
+{
+    bool ok = fabs(actual - expected) <= tolerance;
+    if (!ok || !quiet)
+        Serial.printf("  %s %-28s 實際: %.6g 參考: %.6g\n", ok ? "✅" : "❌", name, actual, expected);
+    if (!ok)
+        failures++;
+    return ok;
+}
+
+/**
+ * 開頭橫幅（裝置上先等序列埠監看程式連上）
+ */
+inline void test_begin(const char *title)
+{
+    Serial.begin(115200);
+    delay(2000);
+
+    Serial.println("\n\n========================================");
+    Serial.println(title);
+    Serial.println("========================================\n");
+}
+
+/**
+ * 結尾判定
+ */
+inline void test_end()
+{
+    Serial.println("\n========================================");
+    Serial.println(failures == 0 ? "所有測試通過！" : "❌ 測試失敗！");
+    Serial.println("========================================\n");
+}
+
+/**
+ * 受測功能被編譯期開關移除時，只輸出略過訊息
+ */
+inline void test_skip(const char *reason)
+{
+    Serial.begin(115200);
+    Serial.printf("略過測試：%s\n", reason);
+}
+
+#endif // TEST_CHECK_H
@@ -0,0 +1,230 @@
+/**
+ * 追蹤記錄器測試（可在主機上執行）
+ * 1. 區間與瞬間事件的欄位、順序；跨越計數器回繞的區間長度
+ * 2. 環形緩衝區覆寫：保留最新事件、由舊到新排列並計算遺失數
+ * 3. 觸發：fire() 後再記錄固定筆數即停止
+ * 4. PROFILE_SCOPE 同時產生追蹤區間
+ * 5. 傾印格式：由主機序列埠分接取回位元組，逐欄位解析（python/trace_to_chrome.py 讀取同一格式）
+ * 6. 每筆事件的成本（只報告，不判定；實際耗時受主機負載影響）
+ * TRACE_ENABLED=0 時整個記錄器不編譯，測試只輸出略過訊息
+ */
+
+#include <Arduino.h>
+#include "trace_recorder.h"
+#include "host_sim.h"
+#include "test_check.h"
+
+#define COST_RUNS 10000
+
+#if TRACE_ENABLED
+
+void test_events()
+{
+    Serial.println("=== 測試事件欄位 ===");
+
+    trace.start();
+    trace.span(TRACE_EVENT_HOP, 1000, 1250, 4096);
+    TRACE_INSTANT(TRACE_EVENT_VAD_STATE, 1);
+    TRACE_CLOCK(16000);
+
+    check("3 筆", trace.size() == 3, trace.size());
+    const TraceEvent &hop = trace.get_event(0);
+    check("區間開始與長度", hop.start == 1000 && hop.duration == 250, hop.duration);
+    check("區間參數", hop.id == TRACE_EVENT_HOP && hop.phase == TRACE_PHASE_SPAN && hop.arg == 4096, hop.arg);
+    const TraceEvent &vad = trace.get_event(1);
+    check("瞬間事件", vad.id == TRACE_EVENT_VAD_STATE && vad.phase == TRACE_PHASE_INSTANT && vad.duration == 0,
+          vad.arg);
+    check("樣本時鐘錨點", trace.get_event(2).id == TRACE_EVENT_SAMPLE_CLOCK && trace.get_event(2).arg == 16000,
+          trace.get_event(2).arg);
+    check("每筆 16 bytes", sizeof(TraceEvent) == 16, sizeof(TraceEvent));
+
+    // 合成計數值：區間跨越 32-bit 回繞
+    trace.start();
+    trace.span(TRACE_EVENT_CAPTURE, 0xFFFFFF00u, 0x100u, 0);
+    check("回繞區間長度 = 512", trace.get_event(0).duration == 512, trace.get_event(0).duration);
+}
+
+void test_wrap()
+{
+    Serial.println("=== 測試覆寫 ===");
+
+    trace.start();
+    for (uint32_t i = 0; i < TRACE_RING_EVENTS + 100; i++)
+        trace.instant(TRACE_EVENT_SERIAL, i);
+
+    check("保留 TRACE_RING_EVENTS 筆", trace.size() == TRACE_RING_EVENTS, trace.size());
+    check("遺失 100 筆", trace.lost() == 100, trace.lost());
+    check("最舊一筆為第 100 筆", trace.get_event(0).arg == 100, trace.get_event(0).arg);
+    check("最新一筆", trace.get_event(TRACE_RING_EVENTS - 1).arg == TRACE_RING_EVENTS + 99,
+          trace.get_event(TRACE_RING_EVENTS - 1).arg);
+
+    uint32_t out_of_order = 0;
+    for (uint32_t i = 1; i < trace.size(); i++)
+        out_of_order += trace.get_event(i).arg != trace.get_event(i - 1).arg + 1;
+    check("覆寫後由舊到新連續", out_of_order == 0, out_of_order);
+}
+
+void test_trigger()
+{
+    Serial.println("=== 測試觸發 ===");
+
+    trace.start();
+    trace.arm();
+    for (uint32_t i = 0; i < 500; i++)
+        trace.instant(TRACE_EVENT_SERIAL, i);
+    TRACE_INSTANT(TRACE_EVENT_DEADLINE_MISS, 9999);
+    TRACE_FIRE();
+    for (uint32_t i = 0; i < TRACE_RING_EVENTS; i++)
+        trace.instant(TRACE_EVENT_SERIAL, 1000 + i);
+
+    uint32_t count = trace.size();
+    const TraceEvent &last = trace.get_event(count - 1);
+    check("觸發後停止記錄", !trace.is_recording() && trace.has_fired(), trace.is_recording());
+    check("觸發後保留固定筆數", last.arg == 1000 + TRACE_TRIGGER_POST_EVENTS - 1, last.arg);
+
+    // 觸發點仍在緩衝區內
+    bool found = false;
+    for (uint32_t i = 0; i < count; i++)
+        found = found || trace.get_event(i).id == TRACE_EVENT_DEADLINE_MISS;
+    check("保留觸發點之前的事件", found, count);
+
+    // 未 arm 時 fire() 無作用
+    trace.start();
+    TRACE_FIRE();
+    check("未 arm 不觸發", !trace.has_fired() && trace.is_recording(), trace.has_fired());
+}
+
+void test_profile_scope()
+{
+    Serial.println("=== 測試 PROFILE_SCOPE ===");
+
+    trace.start();
+    {
+        PROFILE_SCOPE(PROFILE_STAGE_FEATURES);
+        delayMicroseconds(200);
+    }
+#if PROFILER_ENABLED
+    const TraceEvent &event = trace.get_event(0);
+    check("產生一筆階段區間", trace.size() == 1 && event.id == PROFILE_STAGE_FEATURES, trace.size());
+    Serial.printf("    delayMicroseconds(200) 區間 %.1f µs\n", event.duration / (float)profiler_ticks_per_us());
+#else
+    check("分析器停用時不產生事件", trace.size() == 0, trace.size());
+#endif
+}
+
+uint8_t captured[4096];
+size_t captured_length;
+
+void capture_serial(const uint8_t *data, size_t length, void *)
+{
+    size_t n = min(length, sizeof(captured) - captured_length);
+    memcpy(captured + captured_length, data, n);
+    captured_length += n;
+}
+
+uint32_t read_u32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+void test_dump()
+{
+    Serial.println("=== 測試傾印 ===");
+
+    trace.start();
+    trace.set_sample_rate(16000);
+    TRACE_CLOCK(0);
+    trace.span(TRACE_EVENT_CAPTURE, 0, 100, 0);
+    TRACE_CLOCK(512);
+
+    Serial.flush();
+    captured_length = 0;
+    host_serial_set_tap(capture_serial, nullptr);
+    size_t length = trace.dump();
+    host_serial_set_tap(nullptr, nullptr);
+
+    check("傾印後停止記錄", !trace.is_recording(), trace.is_recording());
+    check("傳回長度 = 輸出位元組數", length == captured_length, captured_length);
+
+    // 標頭
+    const uint8_t *p = captured;
+    check("起始位元組與版本", p[0] == TRACE_DUMP_SYNC && p[1] == TRACE_DUMP_VERSION, p[1]);
+    check("其後長度 = 總長 - 6", read_u32(p + 2) == captured_length - 6, read_u32(p + 2));
+    check("ticks_per_us", read_u32(p + 6) == profiler_ticks_per_us(), read_u32(p + 6));
+    check("取樣率", read_u32(p + 10) == 16000, read_u32(p + 10));
+    check("事件數 3、遺失 0", read_u32(p + 14) == 3 && read_u32(p + 18) == 0, read_u32(p + 14));
+
+    // 名稱表
+    p += 22;
+    bool names_match = *p++ == TRACE_EVENT_COUNT;
+    for (int id = 0; id < TRACE_EVENT_COUNT && names_match; id++)
+    {
+        names_match = strcmp((const char *)p, TraceRecorder::event_name(id)) == 0;
+        p += strlen((const char *)p) + 1;
+    }
+    check("名稱表", names_match, TRACE_EVENT_COUNT);
+
+    // 事件由舊到新原樣輸出
+    bool events_match = p + 3 * sizeof(TraceEvent) == captured + captured_length;
+    for (uint32_t i = 0; i < 3 && events_match; i++, p += sizeof(TraceEvent))
+        events_match = memcmp(p, &trace.get_event(i), sizeof(TraceEvent)) == 0;
+    check("事件內容與順序", events_match, 3);
+    trace.start();
+}
+
+void test_cost()
+{
+    Serial.println("=== 成本 ===");
+
+    trace.start();
+    uint32_t start = micros();
+    for (int i = 0; i < COST_RUNS; i++)
+        trace.instant(TRACE_EVENT_SERIAL, i);
+    float instant_ns = (micros() - start) * 1000.0f / COST_RUNS;
+
+    start = micros();
+    for (int i = 0; i < COST_RUNS; i++)
+    {
+        TRACE_SCOPE(TRACE_EVENT_HOP, i);
+    }
+    float scope_ns = (micros() - start) * 1000.0f / COST_RUNS;
+
+    trace.stop();
+    start = micros();
+    for (int i = 0; i < COST_RUNS; i++)
+        trace.instant(TRACE_EVENT_SERIAL, i);
+    float stopped_ns = (micros() - start) * 1000.0f / COST_RUNS;
+    trace.start();
+
+    Serial.printf("    瞬間事件 %.0f ns，區間 %.0f ns，停止時 %.0f ns\n", instant_ns, scope_ns, stopped_ns);
+}
+
+void setup()
+{
+    test_begin("追蹤記錄器測試");
+
+    test_events();
+    test_wrap();
+    test_trigger();
+    test_profile_scope();
+    test_dump();
+    test_cost();
+
+    test_end();
+}
+
+#else
+
+void setup()
+{
+    test_skip("TRACE_ENABLED=0，追蹤記錄器未編譯");
+}
+
+#endif // TRACE_ENABLED
+
+void loop()
+{
+    delay(1000);
+}